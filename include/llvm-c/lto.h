@@ -27,7 +27,7 @@
  * @{
  */
 
-#define LTO_API_VERSION 4
+#define LTO_API_VERSION 5
 
 typedef enum {
     LTO_SYMBOL_ALIGNMENT_MASK              = 0x0000001F, /* log2 of alignment */
@@ -284,6 +284,16 @@ lto_codegen_compile(lto_code_gen_t cg, size_t* length);
 extern bool
 lto_codegen_compile_to_file(lto_code_gen_t cg, const char** name);
 
+/**
+ * Generates code for all added modules into parallelism native object files,
+ * each compiled on its own thread.  The names of the files are written to
+ * names and their number to count; the linker must add all of them.  The
+ * names are owned by the lto_code_gen_t.  Returns true on error.
+ */
+extern bool
+lto_codegen_compile_to_files(lto_code_gen_t cg, unsigned parallelism,
+                             const char*** names, unsigned* count);
+
 
 /**
  * Sets options to help debug codegen bugs.
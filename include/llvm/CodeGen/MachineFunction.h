@@ -103,8 +103,12 @@ class MachineFunction {
   // Pool-allocate MachineFunction-lifetime and IR objects.
   BumpPtrAllocator Allocator;
 
-  // Allocation management for instructions in function.
-  Recycler<MachineInstr> InstructionRecycler;
+  // Allocation management for instructions in function. Each instruction is
+  // allocated together with space for MachineInstr::NumInlineOperands
+  // operands.
+  Recycler<MachineInstr, sizeof(MachineInstr) +
+           MachineInstr::NumInlineOperands * sizeof(MachineOperand)>
+    InstructionRecycler;
 
   // Allocation management for operand arrays on instructions.
   ArrayRecycler<MachineOperand> OperandRecycler;
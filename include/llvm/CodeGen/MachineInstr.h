@@ -70,7 +70,8 @@ private:
   const MCInstrDesc *MCID;              // Instruction descriptor.
   MachineBasicBlock *Parent;            // Pointer to the owning basic block.
 
-  // Operands are allocated by an ArrayRecycler.
+  // Operands are allocated by an ArrayRecycler, or stored inline right after
+  // the MachineInstr when they fit in NumInlineOperands.
   MachineOperand *Operands;             // Pointer to the first operand.
   unsigned NumOperands;                 // Number of operands on instruction.
   typedef ArrayRecycler<MachineOperand>::Capacity OperandCapacity;
@@ -115,6 +116,26 @@ private:
   // MachineInstrs are pool-allocated and owned by MachineFunction.
   friend class MachineFunction;
 
+  /// Number of operands that MachineFunction allocates together with each
+  /// instruction. Most instructions have no more operands than this, and
+  /// keeping them in the same memory block as the instruction avoids a
+  /// separate allocation and a cache miss when walking the operands. This must
+  /// be a valid ArrayRecycler capacity.
+  enum { NumInlineOperands = 4 };
+
+  /// getInlineOperands - Return the operand storage that MachineFunction
+  /// allocated right after this instruction.
+  MachineOperand *getInlineOperands() {
+    return reinterpret_cast<MachineOperand*>(this + 1);
+  }
+
+  /// hasInlineOperands - Return true if the operands are stored inline.
+  bool hasInlineOperands() { return Operands == getInlineOperands(); }
+
+  /// allocateOperands - Set up an empty operand array with room for NumOps
+  /// operands, using the inline storage when possible.
+  void allocateOperands(MachineFunction &MF, unsigned NumOps);
+
 public:
   const MachineBasicBlock* getParent() const { return Parent; }
   MachineBasicBlock* getParent() { return Parent; }
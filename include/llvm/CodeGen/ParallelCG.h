@@ -0,0 +1,49 @@
+//===-- llvm/CodeGen/ParallelCG.h - Parallel code generation ----*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file declares splitCodeGen, which generates code for a module on
+// several threads by splitting its definitions into partitions.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CODEGEN_PARALLELCG_H
+#define LLVM_CODEGEN_PARALLELCG_H
+
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/Target/TargetMachine.h"
+#include <string>
+
+namespace llvm {
+  class Module;
+  class raw_ostream;
+
+  /// splitCodeGen - Split the definitions of \p M into OSs.size() partitions
+  /// and generate code for each of them on its own thread, with its own
+  /// LLVMContext and a TargetMachine configured like \p TM.  Partition I is
+  /// written to *OSs[I] as a complete assembly or object file.
+  ///
+  /// A local symbol that is referenced from another partition becomes a
+  /// hidden external symbol with a name unique to \p M, so the partitions
+  /// can be linked like any other set of objects.  Aliases and functions
+  /// whose blocks are referenced by a blockaddress stay with the definitions
+  /// that need them.  The split only depends on the contents of \p M, so the
+  /// output is deterministic.  Module-level inline asm goes to partition 0.
+  /// \p M itself is not modified.
+  ///
+  /// Diagnostics that are not thread safe, such as -stats and -time-passes,
+  /// should not be used with more than one partition.
+  ///
+  /// Returns true on error, with \p ErrMsg describing it.
+  bool splitCodeGen(const Module &M, ArrayRef<raw_ostream*> OSs,
+                    const TargetMachine &TM,
+                    TargetMachine::CodeGenFileType FileType,
+                    std::string &ErrMsg);
+}
+
+#endif
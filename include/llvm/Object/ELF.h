@@ -2078,6 +2078,131 @@ error_code ELFObjectFile<ELFT>::getRelocationTypeName(
       res = "Unknown";
     }
     break;
+  case ELF::EM_TILEGX:
+    switch (type) {
+      LLVM_ELF_SWITCH_RELOC_TYPE_NAME(R_TILEGX_NONE);
+      LLVM_ELF_SWITCH_RELOC_TYPE_NAME(R_TILEGX_64);
+      LLVM_ELF_SWITCH_RELOC_TYPE_NAME(R_TILEGX_32);
+      LLVM_ELF_SWITCH_RELOC_TYPE_NAME(R_TILEGX_16);
+      LLVM_ELF_SWITCH_RELOC_TYPE_NAME(R_TILEGX_8);
+      LLVM_ELF_SWITCH_RELOC_TYPE_NAME(R_TILEGX_64_PCREL);
+      LLVM_ELF_SWITCH_RELOC_TYPE_NAME(R_TILEGX_32_PCREL);
+      LLVM_ELF_SWITCH_RELOC_TYPE_NAME(R_TILEGX_16_PCREL);
+      LLVM_ELF_SWITCH_RELOC_TYPE_NAME(R_TILEGX_8_PCREL);
+      LLVM_ELF_SWITCH_RELOC_TYPE_NAME(R_TILEGX_HW0);
+      LLVM_ELF_SWITCH_RELOC_TYPE_NAME(R_TILEGX_HW1);
+      LLVM_ELF_SWITCH_RELOC_TYPE_NAME(R_TILEGX_HW2);
+      LLVM_ELF_SWITCH_RELOC_TYPE_NAME(R_TILEGX_HW3);
+      LLVM_ELF_SWITCH_RELOC_TYPE_NAME(R_TILEGX_HW0_LAST);
+      LLVM_ELF_SWITCH_RELOC_TYPE_NAME(R_TILEGX_HW1_LAST);
+      LLVM_ELF_SWITCH_RELOC_TYPE_NAME(R_TILEGX_HW2_LAST);
+      LLVM_ELF_SWITCH_RELOC_TYPE_NAME(R_TILEGX_COPY);
+      LLVM_ELF_SWITCH_RELOC_TYPE_NAME(R_TILEGX_GLOB_DAT);
+      LLVM_ELF_SWITCH_RELOC_TYPE_NAME(R_TILEGX_JMP_SLOT);
+      LLVM_ELF_SWITCH_RELOC_TYPE_NAME(R_TILEGX_RELATIVE);
+      LLVM_ELF_SWITCH_RELOC_TYPE_NAME(R_TILEGX_BROFF_X1);
+      LLVM_ELF_SWITCH_RELOC_TYPE_NAME(R_TILEGX_JUMPOFF_X1);
+      LLVM_ELF_SWITCH_RELOC_TYPE_NAME(R_TILEGX_JUMPOFF_X1_PLT);
+      LLVM_ELF_SWITCH_RELOC_TYPE_NAME(R_TILEGX_IMM8_X0);
+      LLVM_ELF_SWITCH_RELOC_TYPE_NAME(R_TILEGX_IMM8_Y0);
+      LLVM_ELF_SWITCH_RELOC_TYPE_NAME(R_TILEGX_IMM8_X1);
+      LLVM_ELF_SWITCH_RELOC_TYPE_NAME(R_TILEGX_IMM8_Y1);
+      LLVM_ELF_SWITCH_RELOC_TYPE_NAME(R_TILEGX_DEST_IMM8_X1);
+      LLVM_ELF_SWITCH_RELOC_TYPE_NAME(R_TILEGX_MT_IMM14_X1);
+      LLVM_ELF_SWITCH_RELOC_TYPE_NAME(R_TILEGX_MF_IMM14_X1);
+      LLVM_ELF_SWITCH_RELOC_TYPE_NAME(R_TILEGX_MMSTART_X0);
+      LLVM_ELF_SWITCH_RELOC_TYPE_NAME(R_TILEGX_MMEND_X0);
+      LLVM_ELF_SWITCH_RELOC_TYPE_NAME(R_TILEGX_SHAMT_X0);
+      LLVM_ELF_SWITCH_RELOC_TYPE_NAME(R_TILEGX_SHAMT_X1);
+      LLVM_ELF_SWITCH_RELOC_TYPE_NAME(R_TILEGX_SHAMT_Y0);
+      LLVM_ELF_SWITCH_RELOC_TYPE_NAME(R_TILEGX_SHAMT_Y1);
+      LLVM_ELF_SWITCH_RELOC_TYPE_NAME(R_TILEGX_IMM16_X0_HW0);
+      LLVM_ELF_SWITCH_RELOC_TYPE_NAME(R_TILEGX_IMM16_X1_HW0);
+      LLVM_ELF_SWITCH_RELOC_TYPE_NAME(R_TILEGX_IMM16_X0_HW1);
+      LLVM_ELF_SWITCH_RELOC_TYPE_NAME(R_TILEGX_IMM16_X1_HW1);
+      LLVM_ELF_SWITCH_RELOC_TYPE_NAME(R_TILEGX_IMM16_X0_HW2);
+      LLVM_ELF_SWITCH_RELOC_TYPE_NAME(R_TILEGX_IMM16_X1_HW2);
+      LLVM_ELF_SWITCH_RELOC_TYPE_NAME(R_TILEGX_IMM16_X0_HW3);
+      LLVM_ELF_SWITCH_RELOC_TYPE_NAME(R_TILEGX_IMM16_X1_HW3);
+      LLVM_ELF_SWITCH_RELOC_TYPE_NAME(R_TILEGX_IMM16_X0_HW0_LAST);
+      LLVM_ELF_SWITCH_RELOC_TYPE_NAME(R_TILEGX_IMM16_X1_HW0_LAST);
+      LLVM_ELF_SWITCH_RELOC_TYPE_NAME(R_TILEGX_IMM16_X0_HW1_LAST);
+      LLVM_ELF_SWITCH_RELOC_TYPE_NAME(R_TILEGX_IMM16_X1_HW1_LAST);
+      LLVM_ELF_SWITCH_RELOC_TYPE_NAME(R_TILEGX_IMM16_X0_HW2_LAST);
+      LLVM_ELF_SWITCH_RELOC_TYPE_NAME(R_TILEGX_IMM16_X1_HW2_LAST);
+      LLVM_ELF_SWITCH_RELOC_TYPE_NAME(R_TILEGX_IMM16_X0_HW0_PCREL);
+      LLVM_ELF_SWITCH_RELOC_TYPE_NAME(R_TILEGX_IMM16_X1_HW0_PCREL);
+      LLVM_ELF_SWITCH_RELOC_TYPE_NAME(R_TILEGX_IMM16_X0_HW1_PCREL);
+      LLVM_ELF_SWITCH_RELOC_TYPE_NAME(R_TILEGX_IMM16_X1_HW1_PCREL);
+      LLVM_ELF_SWITCH_RELOC_TYPE_NAME(R_TILEGX_IMM16_X0_HW2_PCREL);
+      LLVM_ELF_SWITCH_RELOC_TYPE_NAME(R_TILEGX_IMM16_X1_HW2_PCREL);
+      LLVM_ELF_SWITCH_RELOC_TYPE_NAME(R_TILEGX_IMM16_X0_HW3_PCREL);
+      LLVM_ELF_SWITCH_RELOC_TYPE_NAME(R_TILEGX_IMM16_X1_HW3_PCREL);
+      LLVM_ELF_SWITCH_RELOC_TYPE_NAME(R_TILEGX_IMM16_X0_HW0_LAST_PCREL);
+      LLVM_ELF_SWITCH_RELOC_TYPE_NAME(R_TILEGX_IMM16_X1_HW0_LAST_PCREL);
+      LLVM_ELF_SWITCH_RELOC_TYPE_NAME(R_TILEGX_IMM16_X0_HW1_LAST_PCREL);
+      LLVM_ELF_SWITCH_RELOC_TYPE_NAME(R_TILEGX_IMM16_X1_HW1_LAST_PCREL);
+      LLVM_ELF_SWITCH_RELOC_TYPE_NAME(R_TILEGX_IMM16_X0_HW2_LAST_PCREL);
+      LLVM_ELF_SWITCH_RELOC_TYPE_NAME(R_TILEGX_IMM16_X1_HW2_LAST_PCREL);
+      LLVM_ELF_SWITCH_RELOC_TYPE_NAME(R_TILEGX_IMM16_X0_HW0_GOT);
+      LLVM_ELF_SWITCH_RELOC_TYPE_NAME(R_TILEGX_IMM16_X1_HW0_GOT);
+      LLVM_ELF_SWITCH_RELOC_TYPE_NAME(R_TILEGX_IMM16_X0_HW0_PLT_PCREL);
+      LLVM_ELF_SWITCH_RELOC_TYPE_NAME(R_TILEGX_IMM16_X1_HW0_PLT_PCREL);
+      LLVM_ELF_SWITCH_RELOC_TYPE_NAME(R_TILEGX_IMM16_X0_HW1_PLT_PCREL);
+      LLVM_ELF_SWITCH_RELOC_TYPE_NAME(R_TILEGX_IMM16_X1_HW1_PLT_PCREL);
+      LLVM_ELF_SWITCH_RELOC_TYPE_NAME(R_TILEGX_IMM16_X0_HW2_PLT_PCREL);
+      LLVM_ELF_SWITCH_RELOC_TYPE_NAME(R_TILEGX_IMM16_X1_HW2_PLT_PCREL);
+      LLVM_ELF_SWITCH_RELOC_TYPE_NAME(R_TILEGX_IMM16_X0_HW0_LAST_GOT);
+      LLVM_ELF_SWITCH_RELOC_TYPE_NAME(R_TILEGX_IMM16_X1_HW0_LAST_GOT);
+      LLVM_ELF_SWITCH_RELOC_TYPE_NAME(R_TILEGX_IMM16_X0_HW1_LAST_GOT);
+      LLVM_ELF_SWITCH_RELOC_TYPE_NAME(R_TILEGX_IMM16_X1_HW1_LAST_GOT);
+      LLVM_ELF_SWITCH_RELOC_TYPE_NAME(R_TILEGX_IMM16_X0_HW0_TLS_GD);
+      LLVM_ELF_SWITCH_RELOC_TYPE_NAME(R_TILEGX_IMM16_X1_HW0_TLS_GD);
+      LLVM_ELF_SWITCH_RELOC_TYPE_NAME(R_TILEGX_IMM16_X0_HW0_TLS_LE);
+      LLVM_ELF_SWITCH_RELOC_TYPE_NAME(R_TILEGX_IMM16_X1_HW0_TLS_LE);
+      LLVM_ELF_SWITCH_RELOC_TYPE_NAME(R_TILEGX_IMM16_X0_HW0_LAST_TLS_LE);
+      LLVM_ELF_SWITCH_RELOC_TYPE_NAME(R_TILEGX_IMM16_X1_HW0_LAST_TLS_LE);
+      LLVM_ELF_SWITCH_RELOC_TYPE_NAME(R_TILEGX_IMM16_X0_HW1_LAST_TLS_LE);
+      LLVM_ELF_SWITCH_RELOC_TYPE_NAME(R_TILEGX_IMM16_X1_HW1_LAST_TLS_LE);
+      LLVM_ELF_SWITCH_RELOC_TYPE_NAME(R_TILEGX_IMM16_X0_HW0_LAST_TLS_GD);
+      LLVM_ELF_SWITCH_RELOC_TYPE_NAME(R_TILEGX_IMM16_X1_HW0_LAST_TLS_GD);
+      LLVM_ELF_SWITCH_RELOC_TYPE_NAME(R_TILEGX_IMM16_X0_HW1_LAST_TLS_GD);
+      LLVM_ELF_SWITCH_RELOC_TYPE_NAME(R_TILEGX_IMM16_X1_HW1_LAST_TLS_GD);
+      LLVM_ELF_SWITCH_RELOC_TYPE_NAME(R_TILEGX_IRELATIVE);
+      LLVM_ELF_SWITCH_RELOC_TYPE_NAME(R_TILEGX_IMM16_X0_HW0_TLS_IE);
+      LLVM_ELF_SWITCH_RELOC_TYPE_NAME(R_TILEGX_IMM16_X1_HW0_TLS_IE);
+      LLVM_ELF_SWITCH_RELOC_TYPE_NAME(R_TILEGX_IMM16_X0_HW0_LAST_PLT_PCREL);
+      LLVM_ELF_SWITCH_RELOC_TYPE_NAME(R_TILEGX_IMM16_X1_HW0_LAST_PLT_PCREL);
+      LLVM_ELF_SWITCH_RELOC_TYPE_NAME(R_TILEGX_IMM16_X0_HW1_LAST_PLT_PCREL);
+      LLVM_ELF_SWITCH_RELOC_TYPE_NAME(R_TILEGX_IMM16_X1_HW1_LAST_PLT_PCREL);
+      LLVM_ELF_SWITCH_RELOC_TYPE_NAME(R_TILEGX_IMM16_X0_HW2_LAST_PLT_PCREL);
+      LLVM_ELF_SWITCH_RELOC_TYPE_NAME(R_TILEGX_IMM16_X1_HW2_LAST_PLT_PCREL);
+      LLVM_ELF_SWITCH_RELOC_TYPE_NAME(R_TILEGX_IMM16_X0_HW0_LAST_TLS_IE);
+      LLVM_ELF_SWITCH_RELOC_TYPE_NAME(R_TILEGX_IMM16_X1_HW0_LAST_TLS_IE);
+      LLVM_ELF_SWITCH_RELOC_TYPE_NAME(R_TILEGX_IMM16_X0_HW1_LAST_TLS_IE);
+      LLVM_ELF_SWITCH_RELOC_TYPE_NAME(R_TILEGX_IMM16_X1_HW1_LAST_TLS_IE);
+      LLVM_ELF_SWITCH_RELOC_TYPE_NAME(R_TILEGX_TLS_DTPMOD64);
+      LLVM_ELF_SWITCH_RELOC_TYPE_NAME(R_TILEGX_TLS_DTPOFF64);
+      LLVM_ELF_SWITCH_RELOC_TYPE_NAME(R_TILEGX_TLS_TPOFF64);
+      LLVM_ELF_SWITCH_RELOC_TYPE_NAME(R_TILEGX_TLS_DTPMOD32);
+      LLVM_ELF_SWITCH_RELOC_TYPE_NAME(R_TILEGX_TLS_DTPOFF32);
+      LLVM_ELF_SWITCH_RELOC_TYPE_NAME(R_TILEGX_TLS_TPOFF32);
+      LLVM_ELF_SWITCH_RELOC_TYPE_NAME(R_TILEGX_TLS_GD_CALL);
+      LLVM_ELF_SWITCH_RELOC_TYPE_NAME(R_TILEGX_IMM8_X0_TLS_GD_ADD);
+      LLVM_ELF_SWITCH_RELOC_TYPE_NAME(R_TILEGX_IMM8_X1_TLS_GD_ADD);
+      LLVM_ELF_SWITCH_RELOC_TYPE_NAME(R_TILEGX_IMM8_Y0_TLS_GD_ADD);
+      LLVM_ELF_SWITCH_RELOC_TYPE_NAME(R_TILEGX_IMM8_Y1_TLS_GD_ADD);
+      LLVM_ELF_SWITCH_RELOC_TYPE_NAME(R_TILEGX_TLS_IE_LOAD);
+      LLVM_ELF_SWITCH_RELOC_TYPE_NAME(R_TILEGX_IMM8_X0_TLS_ADD);
+      LLVM_ELF_SWITCH_RELOC_TYPE_NAME(R_TILEGX_IMM8_X1_TLS_ADD);
+      LLVM_ELF_SWITCH_RELOC_TYPE_NAME(R_TILEGX_IMM8_Y0_TLS_ADD);
+      LLVM_ELF_SWITCH_RELOC_TYPE_NAME(R_TILEGX_IMM8_Y1_TLS_ADD);
+      LLVM_ELF_SWITCH_RELOC_TYPE_NAME(R_TILEGX_GNU_VTINHERIT);
+      LLVM_ELF_SWITCH_RELOC_TYPE_NAME(R_TILEGX_GNU_VTENTRY);
+    default:
+      res = "Unknown";
+    }
+    break;
   default:
     res = "Unknown";
   }
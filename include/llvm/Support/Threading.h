@@ -54,6 +54,22 @@ namespace llvm {
   /// the thread stack.
   void llvm_execute_on_thread(void (*UserFn)(void*), void *UserData,
                               unsigned RequestedStackSize = 0);
+
+  /// llvm_execute_on_threads - Execute the given \p UserFn once for each of
+  /// the \p NumItems entries of \p UserData, each on its own thread, and wait
+  /// for all of them to finish.
+  ///
+  /// Items whose thread cannot be created, or all of them when there is no
+  /// system thread support, are executed on the calling thread instead.
+  ///
+  /// \param UserFn - The callback to execute.
+  /// \param UserData - The arguments to pass to each call of the callback.
+  /// \param NumItems - The number of entries in \p UserData.
+  /// \param RequestedStackSize - If non-zero, a requested size (in bytes) for
+  /// each thread stack.
+  void llvm_execute_on_threads(void (*UserFn)(void*), void **UserData,
+                               unsigned NumItems,
+                               unsigned RequestedStackSize = 0);
 }
 
 #endif
@@ -187,8 +187,8 @@ MachineFunction::CloneMachineInstr(const MachineInstr *Orig) {
 void
 MachineFunction::DeleteMachineInstr(MachineInstr *MI) {
   // Strip it for parts. The operand array and the MI object itself are
-  // independently recyclable.
-  if (MI->Operands)
+  // independently recyclable, unless the operands are stored inline.
+  if (MI->Operands && !MI->hasInlineOperands())
     deallocateOperandArray(MI->CapOperands, MI->Operands);
   // Don't call ~MachineInstr() which must be trivial anyway because
   // ~MachineFunction drops whole lists of MachineInstrs wihout calling their
@@ -526,6 +526,19 @@ void MachineInstr::addImplicitDefUseOperands(MachineFunction &MF) {
       addOperand(MF, MachineOperand::CreateReg(*ImpUses, false, true));
 }
 
+/// allocateOperands - Set up an empty operand array with room for NumOps
+/// operands. Small operand lists use the storage that MachineFunction
+/// allocated together with the instruction.
+void MachineInstr::allocateOperands(MachineFunction &MF, unsigned NumOps) {
+  if (NumOps <= NumInlineOperands) {
+    CapOperands = OperandCapacity::get(NumInlineOperands);
+    Operands = getInlineOperands();
+    return;
+  }
+  CapOperands = OperandCapacity::get(NumOps);
+  Operands = MF.allocateOperandArray(CapOperands);
+}
+
 /// MachineInstr ctor - This constructor creates a MachineInstr and adds the
 /// implicit operands. It reserves space for the number of operands specified by
 /// the MCInstrDesc.
@@ -535,11 +548,8 @@ MachineInstr::MachineInstr(MachineFunction &MF, const MCInstrDesc &tid,
     Flags(0), AsmPrinterFlags(0),
     NumMemRefs(0), MemRefs(0), debugLoc(dl) {
   // Reserve space for the expected number of operands.
-  if (unsigned NumOps = MCID->getNumOperands() +
-    MCID->getNumImplicitDefs() + MCID->getNumImplicitUses()) {
-    CapOperands = OperandCapacity::get(NumOps);
-    Operands = MF.allocateOperandArray(CapOperands);
-  }
+  allocateOperands(MF, MCID->getNumOperands() + MCID->getNumImplicitDefs() +
+                       MCID->getNumImplicitUses());
 
   if (!NoImp)
     addImplicitDefUseOperands(MF);
@@ -552,8 +562,7 @@ MachineInstr::MachineInstr(MachineFunction &MF, const MachineInstr &MI)
     Flags(0), AsmPrinterFlags(0),
     NumMemRefs(MI.NumMemRefs), MemRefs(MI.MemRefs),
     debugLoc(MI.getDebugLoc()) {
-  CapOperands = OperandCapacity::get(MI.getNumOperands());
-  Operands = MF.allocateOperandArray(CapOperands);
+  allocateOperands(MF, MI.getNumOperands());
 
   // Copy operands.
   for (unsigned i = 0; i != MI.getNumOperands(); ++i)
@@ -674,8 +683,9 @@ void MachineInstr::addOperand(MachineFunction &MF, const MachineOperand &Op) {
                  MRI);
   ++NumOperands;
 
-  // Deallocate the old operand array.
-  if (OldOperands != Operands && OldOperands)
+  // Deallocate the old operand array, unless it was the inline storage.
+  if (OldOperands != Operands && OldOperands &&
+      OldOperands != getInlineOperands())
     MF.deallocateOperandArray(OldCap, OldOperands);
 
   // Copy Op into place. It still needs to be inserted into the MRI use lists.
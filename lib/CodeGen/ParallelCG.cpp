@@ -0,0 +1,431 @@
+//===-- ParallelCG.cpp - Parallel code generation -------------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements splitCodeGen.  The module is written to bitcode once,
+// and every worker thread reads it back into a private LLVMContext, turns the
+// definitions owned by other partitions into declarations, and runs the
+// regular code generation pipeline of its own TargetMachine over the result.
+//
+//===----------------------------------------------------------------------===//
+
+#define DEBUG_TYPE "parallel-cg"
+#include "llvm/CodeGen/ParallelCG.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/EquivalenceClasses.h"
+#include "llvm/ADT/Hashing.h"
+#include "llvm/ADT/OwningPtr.h"
+#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/ADT/StringSet.h"
+#include "llvm/ADT/Triple.h"
+#include "llvm/Bitcode/ReaderWriter.h"
+#include "llvm/IR/Constants.h"
+#include "llvm/IR/DataLayout.h"
+#include "llvm/IR/DerivedTypes.h"
+#include "llvm/IR/GlobalAlias.h"
+#include "llvm/IR/GlobalVariable.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/Module.h"
+#include "llvm/PassManager.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/FormattedStream.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/TargetRegistry.h"
+#include "llvm/Support/Threading.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/Target/TargetLibraryInfo.h"
+#include <algorithm>
+#include <vector>
+using namespace llvm;
+
+namespace {
+  typedef EquivalenceClasses<const GlobalValue*> GVClasses;
+  typedef std::pair<const GlobalValue*, const GlobalValue*> LocalRef;
+
+  /// Partitioning - The partition of every definition of a module, indexed
+  /// by position in the module's function, global and alias lists.  ~0U
+  /// marks declarations.  The Names vectors hold the hidden external name of
+  /// each local symbol that is referenced from another partition, and are
+  /// empty for the rest.
+  struct Partitioning {
+    std::vector<unsigned> Functions, Globals, Aliases;
+    std::vector<std::string> FunctionNames, GlobalNames, AliasNames;
+  };
+
+  /// PartitionJob - The work of one thread.
+  struct PartitionJob {
+    StringRef Bitcode;
+    StringRef ModuleID;
+    const Partitioning *Parts;
+    unsigned Index;
+    const TargetMachine *TM;
+    TargetMachine::CodeGenFileType FileType;
+    raw_ostream *OS;
+    std::string ErrMsg;
+  };
+
+  /// ClassOrder - Orders classes by decreasing weight, then by first
+  /// appearance in the module.
+  struct ClassOrder {
+    const std::vector<unsigned> &Weights;
+    explicit ClassOrder(const std::vector<unsigned> &W) : Weights(W) {}
+    bool operator()(unsigned A, unsigned B) const {
+      if (Weights[A] != Weights[B])
+        return Weights[A] > Weights[B];
+      return A < B;
+    }
+  };
+}
+
+/// addReferences - Record the local symbols V refers to in LocalRefs, they
+/// have to be promoted if they end up in another partition than Def.  A
+/// function whose blocks are referenced by a blockaddress can not be split
+/// from Def, it is put in the same class.
+static void addReferences(const GlobalValue *Def, const Value *V,
+                          GVClasses &Classes,
+                          SmallVectorImpl<LocalRef> &LocalRefs,
+                          SmallPtrSet<const Constant*, 32> &Visited) {
+  const Constant *C = dyn_cast<Constant>(V);
+  if (!C || !Visited.insert(C))
+    return;
+
+  if (const GlobalValue *GV = dyn_cast<GlobalValue>(C)) {
+    if (GV->hasLocalLinkage() && GV != Def)
+      LocalRefs.push_back(std::make_pair(Def, GV));
+    return;
+  }
+
+  if (const BlockAddress *BA = dyn_cast<BlockAddress>(C))
+    Classes.unionSets(Def, BA->getFunction());
+
+  for (User::const_op_iterator OI = C->op_begin(), OE = C->op_end();
+       OI != OE; ++OI)
+    addReferences(Def, *OI, Classes, LocalRefs, Visited);
+}
+
+/// getPromotedName - Return the name a local symbol referenced across
+/// partitions is made external under.  The suffix depends on the module,
+/// so the name does not clash with the symbols of other objects.
+static std::string getPromotedName(const Module &M, const GlobalValue *GV,
+                                   StringRef Suffix, StringSet<> &Used) {
+  std::string Base = GV->hasName() ? GV->getName().str() : "__llvm_split";
+  Base += Suffix;
+  std::string Name = Base;
+  for (unsigned i = 1; M.getNamedValue(Name) || Used.count(Name); ++i)
+    Name = Base + "." + utostr(i);
+  Used.insert(Name);
+  return Name;
+}
+
+/// partitionModule - Assign each definition of M to one of NumParts
+/// partitions, keeping together the definitions that must share an object
+/// and balancing the partitions by instruction count.  Local symbols that
+/// are referenced from another partition are given a name ending in Suffix.
+static void partitionModule(const Module &M, unsigned NumParts,
+                            StringRef Suffix, Partitioning &Parts) {
+  GVClasses Classes;
+  SmallVector<LocalRef, 64> LocalRefs;
+  SmallPtrSet<const Constant*, 32> Visited;
+  SmallVector<const GlobalValue*, 64> Defs;
+  DenseMap<const GlobalValue*, unsigned> Weight;
+
+  for (Module::const_iterator F = M.begin(), E = M.end(); F != E; ++F) {
+    if (F->isDeclaration())
+      continue;
+    Defs.push_back(F);
+    Classes.insert(F);
+    Visited.clear();
+    unsigned Size = 0;
+    for (Function::const_iterator BB = F->begin(), BE = F->end();
+         BB != BE; ++BB) {
+      Size += BB->size();
+      for (BasicBlock::const_iterator I = BB->begin(), IE = BB->end();
+           I != IE; ++I)
+        for (User::const_op_iterator OI = I->op_begin(), OE = I->op_end();
+             OI != OE; ++OI)
+          addReferences(F, *OI, Classes, LocalRefs, Visited);
+    }
+    Weight[F] = Size;
+  }
+  for (Module::const_global_iterator GV = M.global_begin(),
+       E = M.global_end(); GV != E; ++GV) {
+    if (GV->isDeclaration())
+      continue;
+    Defs.push_back(GV);
+    Classes.insert(GV);
+    Visited.clear();
+    addReferences(GV, GV->getInitializer(), Classes, LocalRefs, Visited);
+    Weight[GV] = 1;
+  }
+  for (Module::const_alias_iterator GA = M.alias_begin(),
+       E = M.alias_end(); GA != E; ++GA) {
+    // An alias is emitted as a symbol assignment, its aliasee has to be
+    // defined in the same object.
+    Defs.push_back(GA);
+    Classes.insert(GA);
+    if (const GlobalValue *Aliasee = GA->getAliasedGlobal())
+      if (!Aliasee->isDeclaration())
+        Classes.unionSets(GA, Aliasee);
+    Visited.clear();
+    addReferences(GA, GA->getAliasee(), Classes, LocalRefs, Visited);
+  }
+
+  // Number the classes in order of first appearance so that nothing below
+  // depends on pointer values.
+  DenseMap<const GlobalValue*, unsigned> ClassOf;
+  std::vector<unsigned> ClassWeight;
+  for (unsigned i = 0, e = Defs.size(); i != e; ++i) {
+    const GlobalValue *Leader = Classes.getLeaderValue(Defs[i]);
+    std::pair<DenseMap<const GlobalValue*, unsigned>::iterator, bool> Ins =
+      ClassOf.insert(std::make_pair(Leader, (unsigned)ClassWeight.size()));
+    if (Ins.second)
+      ClassWeight.push_back(0);
+    ClassWeight[Ins.first->second] += Weight.lookup(Defs[i]);
+  }
+
+  // Hand out the classes, heaviest first, to the least loaded partition.
+  std::vector<unsigned> Order(ClassWeight.size());
+  for (unsigned i = 0, e = Order.size(); i != e; ++i)
+    Order[i] = i;
+  std::sort(Order.begin(), Order.end(), ClassOrder(ClassWeight));
+
+  std::vector<unsigned> ClassPart(ClassWeight.size());
+  std::vector<uint64_t> Load(NumParts, 0);
+  for (unsigned i = 0, e = Order.size(); i != e; ++i) {
+    unsigned Part = std::min_element(Load.begin(), Load.end()) - Load.begin();
+    ClassPart[Order[i]] = Part;
+    Load[Part] += ClassWeight[Order[i]];
+  }
+
+  // A local symbol referenced from another partition is promoted.
+  SmallPtrSet<const GlobalValue*, 32> Promoted;
+  for (unsigned i = 0, e = LocalRefs.size(); i != e; ++i) {
+    const GlobalValue *Def = LocalRefs[i].first;
+    const GlobalValue *GV = LocalRefs[i].second;
+    if (ClassPart[ClassOf[Classes.getLeaderValue(Def)]] !=
+        ClassPart[ClassOf[Classes.getLeaderValue(GV)]])
+      Promoted.insert(GV);
+  }
+
+  StringSet<> Used;
+  for (Module::const_iterator F = M.begin(), E = M.end(); F != E; ++F) {
+    Parts.Functions.push_back(F->isDeclaration() ? ~0U :
+                              ClassPart[ClassOf[Classes.getLeaderValue(F)]]);
+    Parts.FunctionNames.push_back(Promoted.count(F) ?
+                                  getPromotedName(M, F, Suffix, Used) : "");
+  }
+  for (Module::const_global_iterator GV = M.global_begin(),
+       E = M.global_end(); GV != E; ++GV) {
+    Parts.Globals.push_back(GV->isDeclaration() ? ~0U :
+                            ClassPart[ClassOf[Classes.getLeaderValue(GV)]]);
+    Parts.GlobalNames.push_back(Promoted.count(GV) ?
+                                getPromotedName(M, GV, Suffix, Used) : "");
+  }
+  for (Module::const_alias_iterator GA = M.alias_begin(),
+       E = M.alias_end(); GA != E; ++GA) {
+    Parts.Aliases.push_back(ClassPart[ClassOf[Classes.getLeaderValue(GA)]]);
+    Parts.AliasNames.push_back(Promoted.count(GA) ?
+                               getPromotedName(M, GA, Suffix, Used) : "");
+  }
+
+  DEBUG(for (unsigned i = 0; i != NumParts; ++i)
+          dbgs() << "Partition " << i << ": " << Load[i]
+                 << " instructions\n";
+        dbgs() << Promoted.size() << " local symbols promoted\n");
+}
+
+/// promote - Make GV, a local symbol referenced across partitions, a hidden
+/// external symbol named Name.
+static void promote(GlobalValue *GV, const std::string &Name) {
+  if (Name.empty())
+    return;
+  GV->setName(Name);
+  GV->setLinkage(GlobalValue::ExternalLinkage);
+  GV->setVisibility(GlobalValue::HiddenVisibility);
+}
+
+/// extractPartition - Reduce M, a copy of the module that was partitioned,
+/// to the definitions of partition Index.
+static void extractPartition(Module &M, const Partitioning &Parts,
+                             unsigned Index) {
+  // Every partition promotes the same local symbols, under the same names.
+  unsigned i = 0;
+  for (Module::iterator F = M.begin(), E = M.end(); F != E; ++F, ++i)
+    promote(F, Parts.FunctionNames[i]);
+  i = 0;
+  for (Module::global_iterator GV = M.global_begin(), E = M.global_end();
+       GV != E; ++GV, ++i)
+    promote(GV, Parts.GlobalNames[i]);
+  i = 0;
+  for (Module::alias_iterator GA = M.alias_begin(), E = M.alias_end();
+       GA != E; ++GA, ++i)
+    promote(GA, Parts.AliasNames[i]);
+
+  // The other partitions' remaining local symbols are only used by
+  // definitions that are dropped here, they go away once those are gone.
+  std::vector<GlobalValue*> Dead;
+
+  i = 0;
+  for (Module::iterator F = M.begin(), E = M.end(); F != E; ++F, ++i) {
+    if (Parts.Functions[i] == Index || F->isDeclaration())
+      continue;
+    if (F->hasLocalLinkage())
+      Dead.push_back(F);
+    F->deleteBody();
+  }
+
+  i = 0;
+  for (Module::global_iterator GV = M.global_begin(), E = M.global_end();
+       GV != E; ++GV, ++i) {
+    if (Parts.Globals[i] == Index || GV->isDeclaration())
+      continue;
+    // llvm.used, llvm.global_ctors and the like are owned by one partition.
+    if (GV->hasLocalLinkage() || GV->hasAppendingLinkage())
+      Dead.push_back(GV);
+    GV->setInitializer(0);
+    GV->setLinkage(GlobalValue::ExternalLinkage);
+  }
+
+  std::vector<GlobalAlias*> Aliases;
+  i = 0;
+  for (Module::alias_iterator GA = M.alias_begin(), E = M.alias_end();
+       GA != E; ++GA, ++i)
+    if (Parts.Aliases[i] != Index)
+      Aliases.push_back(GA);
+  for (unsigned j = 0, e = Aliases.size(); j != e; ++j) {
+    GlobalAlias *GA = Aliases[j];
+    if (!GA->use_empty()) {
+      PointerType *Ty = GA->getType();
+      GlobalValue *Decl;
+      if (FunctionType *FTy = dyn_cast<FunctionType>(Ty->getElementType()))
+        Decl = Function::Create(FTy, GlobalValue::ExternalLinkage, "", &M);
+      else
+        Decl = new GlobalVariable(M, Ty->getElementType(), false,
+                                  GlobalValue::ExternalLinkage, 0, "", 0,
+                                  GlobalVariable::NotThreadLocal,
+                                  Ty->getAddressSpace());
+      Decl->takeName(GA);
+      Decl->setVisibility(GA->getVisibility());
+      GA->replaceAllUsesWith(Decl);
+    }
+    GA->eraseFromParent();
+  }
+
+  for (unsigned j = 0, e = Dead.size(); j != e; ++j)
+    Dead[j]->removeDeadConstantUsers();
+  for (unsigned j = 0, e = Dead.size(); j != e; ++j) {
+    assert(Dead[j]->use_empty() && "Local symbol used across partitions!");
+    Dead[j]->eraseFromParent();
+  }
+
+  if (Index != 0)
+    M.setModuleInlineAsm("");
+}
+
+/// codegenModule - Run the code generation pipeline of a TargetMachine
+/// configured like TM over M.
+static bool codegenModule(Module &M, const TargetMachine &TM,
+                          TargetMachine::CodeGenFileType FileType,
+                          raw_ostream &OS, std::string &ErrMsg) {
+  OwningPtr<TargetMachine> Target(TM.getTarget().createTargetMachine(
+      TM.getTargetTriple(), TM.getTargetCPU(), TM.getTargetFeatureString(),
+      TM.Options, TM.getRelocationModel(), TM.getCodeModel(),
+      TM.getOptLevel()));
+  if (!Target) {
+    ErrMsg = "could not allocate target machine";
+    return true;
+  }
+  Target->setMCRelaxAll(TM.hasMCRelaxAll());
+  Target->setMCSaveTempLabels(TM.hasMCSaveTempLabels());
+  Target->setMCNoExecStack(TM.hasMCNoExecStack());
+  Target->setMCUseLoc(TM.hasMCUseLoc());
+  Target->setMCUseCFI(TM.hasMCUseCFI());
+  Target->setMCUseDwarfDirectory(TM.hasMCUseDwarfDirectory());
+
+  PassManager PM;
+  PM.add(new TargetLibraryInfo(Triple(M.getTargetTriple())));
+  Target->addAnalysisPasses(PM);
+  if (const DataLayout *TD = Target->getDataLayout())
+    PM.add(new DataLayout(*TD));
+  else
+    PM.add(new DataLayout(&M));
+
+  formatted_raw_ostream FOS(OS);
+  if (Target->addPassesToEmitFile(PM, FOS, FileType)) {
+    ErrMsg = "target does not support generation of this file type";
+    return true;
+  }
+  PM.run(M);
+  return false;
+}
+
+static void codegenPartition(void *Arg) {
+  PartitionJob &Job = *static_cast<PartitionJob*>(Arg);
+  LLVMContext Context;
+  OwningPtr<MemoryBuffer> Buffer(
+      MemoryBuffer::getMemBuffer(Job.Bitcode, Job.ModuleID, false));
+  OwningPtr<Module> M(ParseBitcodeFile(Buffer.get(), Context, &Job.ErrMsg));
+  if (!M)
+    return;
+
+  extractPartition(*M, *Job.Parts, Job.Index);
+  codegenModule(*M, *Job.TM, Job.FileType, *Job.OS, Job.ErrMsg);
+}
+
+bool llvm::splitCodeGen(const Module &M, ArrayRef<raw_ostream*> OSs,
+                        const TargetMachine &TM,
+                        TargetMachine::CodeGenFileType FileType,
+                        std::string &ErrMsg) {
+  unsigned NumParts = OSs.size();
+  assert(NumParts && "No output streams!");
+
+  std::string Bitcode;
+  {
+    raw_string_ostream BCOS(Bitcode);
+    WriteBitcodeToFile(&M, BCOS);
+  }
+
+  // Promoted local symbols are named after the module contents.
+  std::string Suffix =
+    ".llvm." + utohexstr((size_t)hash_value(StringRef(Bitcode)));
+  Partitioning Parts;
+  partitionModule(M, NumParts, Suffix, Parts);
+
+  // The threads share the pass registry and the other global state of LLVM.
+  if (NumParts > 1 && !llvm_is_multithreaded())
+    llvm_start_multithreaded();
+
+  std::vector<PartitionJob> Jobs(NumParts);
+  std::vector<void*> JobPtrs(NumParts);
+  for (unsigned i = 0; i != NumParts; ++i) {
+    Jobs[i].Bitcode = Bitcode;
+    Jobs[i].ModuleID = M.getModuleIdentifier();
+    Jobs[i].Parts = &Parts;
+    Jobs[i].Index = i;
+    Jobs[i].TM = &TM;
+    Jobs[i].FileType = FileType;
+    Jobs[i].OS = OSs[i];
+    JobPtrs[i] = &Jobs[i];
+  }
+
+  // Without thread support the partitions are generated one after another.
+  if (llvm_is_multithreaded())
+    llvm_execute_on_threads(codegenPartition, &JobPtrs[0], NumParts);
+  else
+    for (unsigned i = 0; i != NumParts; ++i)
+      codegenPartition(JobPtrs[i]);
+
+  for (unsigned i = 0; i != NumParts; ++i)
+    if (!Jobs[i].ErrMsg.empty()) {
+      ErrMsg = Jobs[i].ErrMsg;
+      return true;
+    }
+  return false;
+}
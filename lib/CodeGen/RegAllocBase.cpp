@@ -43,8 +43,20 @@ static cl::opt<bool, true>
 VerifyRegAlloc("verify-regalloc", cl::location(RegAllocBase::VerifyEnabled),
                cl::desc("Verify during register allocation"));
 
+// Report the time spent in each phase of register allocation without enabling
+// -time-passes for the whole pipeline.
+static cl::opt<bool, true>
+RegAllocStats("regalloc-stats", cl::location(RegAllocBase::StatsEnabled),
+              cl::Hidden,
+              cl::desc("Time the phases of the register allocator"));
+
 const char *RegAllocBase::TimerGroupName = "Register Allocation";
 bool RegAllocBase::VerifyEnabled = false;
+bool RegAllocBase::StatsEnabled = false;
+
+bool RegAllocBase::timersEnabled() {
+  return TimePassesIsEnabled || StatsEnabled;
+}
 
 //===----------------------------------------------------------------------===//
 //                         RegAllocBase Implementation
@@ -66,7 +78,7 @@ void RegAllocBase::init(VirtRegMap &vrm,
 // register, unify them with the corresponding LiveIntervalUnion, otherwise push
 // them on the priority queue for later assignment.
 void RegAllocBase::seedLiveRegs() {
-  NamedRegionTimer T("Seed Live Regs", TimerGroupName, TimePassesIsEnabled);
+  NamedRegionTimer T("Seed Live Regs", TimerGroupName, timersEnabled());
   for (unsigned i = 0, e = MRI->getNumVirtRegs(); i != e; ++i) {
     unsigned Reg = TargetRegisterInfo::index2VirtReg(i);
     if (MRI->reg_nodbg_empty(Reg))
@@ -95,10 +95,17 @@ protected:
   // Use this group name for NamedRegionTimer.
   static const char *TimerGroupName;
 
+  /// timersEnabled - Return true when the NamedRegionTimers in the
+  /// TimerGroupName group should be running.
+  static bool timersEnabled();
+
 public:
   /// VerifyEnabled - True when -verify-regalloc is given.
   static bool VerifyEnabled;
 
+  /// StatsEnabled - True when -regalloc-stats is given.
+  static bool StatsEnabled;
+
 private:
   void seedLiveRegs();
 };
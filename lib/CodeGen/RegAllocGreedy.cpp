@@ -21,6 +21,7 @@
 #include "SpillPlacement.h"
 #include "Spiller.h"
 #include "SplitKit.h"
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/Statistic.h"
 #include "llvm/Analysis/AliasAnalysis.h"
 #include "llvm/CodeGen/CalcSpillWeights.h"
@@ -48,6 +49,7 @@ using namespace llvm;
 STATISTIC(NumGlobalSplits, "Number of split global live ranges");
 STATISTIC(NumLocalSplits,  "Number of split local live ranges");
 STATISTIC(NumEvicted,      "Number of interferences evicted");
+STATISTIC(NumEvictCached,  "Number of eviction costs reused from the cache");
 
 static cl::opt<SplitEditor::ComplementSpillMode>
 SplitSpillMode("split-spill-mode", cl::Hidden,
@@ -58,6 +60,11 @@ SplitSpillMode("split-spill-mode", cl::Hidden,
              clEnumValEnd),
   cl::init(SplitEditor::SM_Partition));
 
+static cl::opt<bool>
+EnableEvictionCache("greedy-eviction-cache", cl::Hidden,
+  cl::desc("Reuse eviction costs while the interference is unchanged"),
+  cl::init(true));
+
 static RegisterRegAlloc greedyRegAlloc("greedy", "greedy register allocator",
                                        createGreedyRegisterAllocator);
 
@@ -127,7 +134,10 @@ class RAGreedy : public MachineFunctionPass,
     // Cascade - Eviction loop prevention. See canEvictInterference().
     unsigned Cascade;
 
-    RegInfo() : Stage(RS_New), Cascade(0) {}
+    // HasEvictionCosts - EvictionCache may hold entries for the live range.
+    bool HasEvictionCosts;
+
+    RegInfo() : Stage(RS_New), Cascade(0), HasEvictionCosts(false) {}
   };
 
   IndexedMap<RegInfo, VirtReg2IndexFunctor> ExtraRegInfo;
@@ -165,6 +175,35 @@ class RAGreedy : public MachineFunctionPass,
     }
   };
 
+  /// Cached result of evicting the interference between a virtual register
+  /// and a physreg.  The entry is valid as long as the LiveIntervalUnions of
+  /// the physreg's register units are unchanged.  That lets an evicted live
+  /// range skip the physregs that haven't seen new assignments since the last
+  /// time it was dequeued.  The entries of a live range are dropped when it
+  /// changes, and when it is assigned, split or spilled.
+  struct EvictionCacheEntry {
+    unsigned Cascade;         ///< Cascade number used for the check.
+    unsigned MaxIntfCascade;  ///< Largest cascade number seen in the check.
+    bool IsHint;              ///< The check was for the preferred register.
+    bool CanEvict;            ///< All interference can be evicted at Cost.
+    EvictionCost Cost;        ///< Cost of evicting all interference.
+    SmallVector<unsigned, 4> UnitTags; ///< LiveIntervalUnion tags.
+
+    EvictionCacheEntry()
+      : Cascade(0), MaxIntfCascade(0), IsHint(false), CanEvict(false) {}
+  };
+
+  /// Eviction costs indexed by (VirtReg, PhysReg).
+  DenseMap<std::pair<unsigned, unsigned>, EvictionCacheEntry> EvictionCache;
+
+  void invalidateEvictionCosts(unsigned Reg) {
+    if (!ExtraRegInfo.inBounds(Reg) || !ExtraRegInfo[Reg].HasEvictionCosts)
+      return;
+    ExtraRegInfo[Reg].HasEvictionCosts = false;
+    for (unsigned PhysReg = 1, e = TRI->getNumRegs(); PhysReg != e; ++PhysReg)
+      EvictionCache.erase(std::make_pair(Reg, PhysReg));
+  }
+
   // splitting state.
   std::auto_ptr<SplitAnalysis> SA;
   std::auto_ptr<SplitEditor> SE;
@@ -249,6 +288,7 @@ private:
   void LRE_WillShrinkVirtReg(unsigned);
   void LRE_DidCloneVirtReg(unsigned, unsigned);
 
+  unsigned selectOrSplitImpl(LiveInterval&, SmallVectorImpl<LiveInterval*>&);
   float calcSpillCost();
   bool addSplitConstraints(InterferenceCache::Cursor, float&);
   void addThroughConstraints(InterferenceCache::Cursor, ArrayRef<unsigned>);
@@ -258,6 +298,10 @@ private:
   void splitAroundRegion(LiveRangeEdit&, ArrayRef<unsigned>);
   void calcGapWeights(unsigned, SmallVectorImpl<float>&);
   bool shouldEvict(LiveInterval &A, bool, LiveInterval &B, bool);
+  bool isCachedEvictionCost(const EvictionCacheEntry&, unsigned, bool,
+                            unsigned);
+  void calcEvictionCost(EvictionCacheEntry&, LiveInterval&, unsigned, bool,
+                        unsigned);
   bool canEvictInterference(LiveInterval&, unsigned, bool, EvictionCost&);
   void evictInterference(LiveInterval&, unsigned,
                          SmallVectorImpl<LiveInterval*>&);
@@ -350,6 +394,7 @@ void RAGreedy::getAnalysisUsage(AnalysisUsage &AU) const {
 //===----------------------------------------------------------------------===//
 
 bool RAGreedy::LRE_CanEraseVirtReg(unsigned VirtReg) {
+  invalidateEvictionCosts(VirtReg);
   if (VRM->hasPhys(VirtReg)) {
     Matrix->unassign(LIS->getInterval(VirtReg));
     return true;
@@ -360,6 +405,7 @@ bool RAGreedy::LRE_CanEraseVirtReg(unsigned VirtReg) {
 }
 
 void RAGreedy::LRE_WillShrinkVirtReg(unsigned VirtReg) {
+  invalidateEvictionCosts(VirtReg);
   if (!VRM->hasPhys(VirtReg))
     return;
 
@@ -379,6 +425,7 @@ void RAGreedy::LRE_DidCloneVirtReg(unsigned New, unsigned Old) {
   // than the original, so they should get a new chance at being assigned.
   // same stage as the parent.
   ExtraRegInfo[Old].Stage = RS_Assign;
+  invalidateEvictionCosts(Old);
   ExtraRegInfo.grow(New);
   ExtraRegInfo[New] = ExtraRegInfo[Old];
 }
@@ -386,6 +433,7 @@ void RAGreedy::LRE_DidCloneVirtReg(unsigned New, unsigned Old) {
 void RAGreedy::releaseMemory() {
   SpillerInstance.reset(0);
   ExtraRegInfo.clear();
+  EvictionCache.clear();
   GlobalCand.clear();
 }
 
@@ -501,38 +549,57 @@ bool RAGreedy::shouldEvict(LiveInterval &A, bool IsHint,
   return A.weight > B.weight;
 }
 
-/// canEvictInterference - Return true if all interferences between VirtReg and
-/// PhysReg can be evicted.  When OnlyCheap is set, don't do anything
+/// isCachedEvictionCost - Return true if CE still describes the interference
+/// between VirtReg and PhysReg.
+bool RAGreedy::isCachedEvictionCost(const EvictionCacheEntry &CE,
+                                    unsigned PhysReg, bool IsHint,
+                                    unsigned Cascade) {
+  if (CE.IsHint != IsHint)
+    return false;
+
+  // A different cascade number only matters if it compares differently to the
+  // cascade numbers of the interfering live ranges.
+  if (CE.Cascade != Cascade &&
+      (CE.Cascade <= CE.MaxIntfCascade || Cascade <= CE.MaxIntfCascade))
+    return false;
+
+  LiveIntervalUnion *LIUs = Matrix->getLiveUnions();
+  unsigned i = 0;
+  for (MCRegUnitIterator Units(PhysReg, TRI); Units.isValid(); ++Units, ++i)
+    if (i == CE.UnitTags.size() || LIUs[*Units].changedSince(CE.UnitTags[i]))
+      return false;
+  return i == CE.UnitTags.size();
+}
+
+/// calcEvictionCost - Compute the cost of evicting all interference between
+/// VirtReg and PhysReg, and store it in CE.
 ///
-/// @param VirtReg Live range that is about to be assigned.
-/// @param PhysReg Desired register for assignment.
-/// @param IsHint  True when PhysReg is VirtReg's preferred register.
-/// @param MaxCost Only look for cheaper candidates and update with new cost
-///                when returning true.
-/// @returns True when interference can be evicted cheaper than MaxCost.
-bool RAGreedy::canEvictInterference(LiveInterval &VirtReg, unsigned PhysReg,
-                                    bool IsHint, EvictionCost &MaxCost) {
+/// The cost doesn't depend on the best candidate seen so far, so unlike a
+/// bounded search, the result can be reused for other MaxCost limits.
+void RAGreedy::calcEvictionCost(EvictionCacheEntry &CE, LiveInterval &VirtReg,
+                                unsigned PhysReg, bool IsHint,
+                                unsigned Cascade) {
+  CE.Cascade = Cascade;
+  CE.MaxIntfCascade = 0;
+  CE.IsHint = IsHint;
+  CE.CanEvict = false;
+  CE.Cost = EvictionCost();
+  CE.UnitTags.clear();
+
+  LiveIntervalUnion *LIUs = Matrix->getLiveUnions();
+  for (MCRegUnitIterator Units(PhysReg, TRI); Units.isValid(); ++Units)
+    CE.UnitTags.push_back(LIUs[*Units].getTag());
+
   // It is only possible to evict virtual register interference.
   if (Matrix->checkInterference(VirtReg, PhysReg) > LiveRegMatrix::IK_VirtReg)
-    return false;
-
-  // Find VirtReg's cascade number. This will be unassigned if VirtReg was never
-  // involved in an eviction before. If a cascade number was assigned, deny
-  // evicting anything with the same or a newer cascade number. This prevents
-  // infinite eviction loops.
-  //
-  // This works out so a register without a cascade number is allowed to evict
-  // anything, and it can be evicted by anything.
-  unsigned Cascade = ExtraRegInfo[VirtReg.reg].Cascade;
-  if (!Cascade)
-    Cascade = NextCascade;
+    return;
 
-  EvictionCost Cost;
+  EvictionCost &Cost = CE.Cost;
   for (MCRegUnitIterator Units(PhysReg, TRI); Units.isValid(); ++Units) {
     LiveIntervalUnion::Query &Q = Matrix->query(VirtReg, *Units);
     // If there is 10 or more interferences, chances are one is heavier.
     if (Q.collectInterferingVRegs(10) >= 10)
-      return false;
+      return;
 
     // Check if any interfering live range is heavier than MaxWeight.
     for (unsigned i = Q.interferingVRegs().size(); i; --i) {
@@ -541,7 +608,7 @@ bool RAGreedy::canEvictInterference(LiveInterval &VirtReg, unsigned PhysReg,
              "Only expecting virtual register interference from query");
       // Never evict spill products. They cannot split or spill.
       if (getStage(*Intf) == RS_Done)
-        return false;
+        return;
       // Once a live range becomes small enough, it is urgent that we find a
       // register for it. This is indicated by an infinite spill weight. These
       // urgent live ranges get to evict almost anything.
@@ -554,9 +621,10 @@ bool RAGreedy::canEvictInterference(LiveInterval &VirtReg, unsigned PhysReg,
          RegClassInfo.getNumAllocatableRegs(MRI->getRegClass(Intf->reg)));
       // Only evict older cascades or live ranges without a cascade.
       unsigned IntfCascade = ExtraRegInfo[Intf->reg].Cascade;
+      CE.MaxIntfCascade = std::max(CE.MaxIntfCascade, IntfCascade);
       if (Cascade <= IntfCascade) {
         if (!Urgent)
-          return false;
+          return;
         // We permit breaking cascades for urgent evictions. It should be the
         // last resort, though, so make it really expensive.
         Cost.BrokenHints += 10;
@@ -566,15 +634,54 @@ bool RAGreedy::canEvictInterference(LiveInterval &VirtReg, unsigned PhysReg,
       // Update eviction cost.
       Cost.BrokenHints += BreaksHint;
       Cost.MaxWeight = std::max(Cost.MaxWeight, Intf->weight);
-      // Abort if this would be too expensive.
-      if (!(Cost < MaxCost))
-        return false;
       // Finally, apply the eviction policy for non-urgent evictions.
       if (!Urgent && !shouldEvict(VirtReg, IsHint, *Intf, BreaksHint))
-        return false;
+        return;
     }
   }
-  MaxCost = Cost;
+  CE.CanEvict = true;
+}
+
+/// canEvictInterference - Return true if all interferences between VirtReg and
+/// PhysReg can be evicted.
+///
+/// @param VirtReg Live range that is about to be assigned.
+/// @param PhysReg Desired register for assignment.
+/// @param IsHint  True when PhysReg is VirtReg's preferred register.
+/// @param MaxCost Only look for cheaper candidates and update with new cost
+///                when returning true.
+/// @returns True when interference can be evicted cheaper than MaxCost.
+bool RAGreedy::canEvictInterference(LiveInterval &VirtReg, unsigned PhysReg,
+                                    bool IsHint, EvictionCost &MaxCost) {
+  // Find VirtReg's cascade number. This will be unassigned if VirtReg was never
+  // involved in an eviction before. If a cascade number was assigned, deny
+  // evicting anything with the same or a newer cascade number. This prevents
+  // infinite eviction loops.
+  //
+  // This works out so a register without a cascade number is allowed to evict
+  // anything, and it can be evicted by anything.
+  unsigned Cascade = ExtraRegInfo[VirtReg.reg].Cascade;
+  if (!Cascade)
+    Cascade = NextCascade;
+
+  // The cost of evicting the interference only changes when VirtReg or the
+  // live ranges assigned to PhysReg change. Reuse the last computed cost
+  // otherwise.
+  EvictionCacheEntry Uncached;
+  EvictionCacheEntry &CE = EnableEvictionCache ?
+    EvictionCache[std::make_pair(VirtReg.reg, PhysReg)] : Uncached;
+  if (EnableEvictionCache &&
+      isCachedEvictionCost(CE, PhysReg, IsHint, Cascade))
+    ++NumEvictCached;
+  else {
+    calcEvictionCost(CE, VirtReg, PhysReg, IsHint, Cascade);
+    ExtraRegInfo[VirtReg.reg].HasEvictionCosts = EnableEvictionCache;
+  }
+
+  // Abort if this would be too expensive.
+  if (!CE.CanEvict || !(CE.Cost < MaxCost))
+    return false;
+  MaxCost = CE.Cost;
   return true;
 }
 
@@ -597,6 +704,8 @@ void RAGreedy::evictInterference(LiveInterval &VirtReg, unsigned PhysReg,
   SmallVector<LiveInterval*, 8> Intfs;
   for (MCRegUnitIterator Units(PhysReg, TRI); Units.isValid(); ++Units) {
     LiveIntervalUnion::Query &Q = Matrix->query(VirtReg, *Units);
+    // The query may not have run if canEvictInterference used a cached cost.
+    Q.collectInterferingVRegs();
     assert(Q.seenAllInterferences() && "Didn't check all interfererences.");
     ArrayRef<LiveInterval*> IVR = Q.interferingVRegs();
     Intfs.append(IVR.begin(), IVR.end());
@@ -626,7 +735,7 @@ unsigned RAGreedy::tryEvict(LiveInterval &VirtReg,
                             AllocationOrder &Order,
                             SmallVectorImpl<LiveInterval*> &NewVRegs,
                             unsigned CostPerUseLimit) {
-  NamedRegionTimer T("Evict", TimerGroupName, TimePassesIsEnabled);
+  NamedRegionTimer T("Evict", TimerGroupName, timersEnabled());
 
   // Keep track of the cheapest interference seen so far.
   EvictionCost BestCost(~0u);
@@ -1663,7 +1772,7 @@ unsigned RAGreedy::trySplit(LiveInterval &VirtReg, AllocationOrder &Order,
 
   // Local intervals are handled separately.
   if (LIS->intervalIsInOneMBB(VirtReg)) {
-    NamedRegionTimer T("Local Splitting", TimerGroupName, TimePassesIsEnabled);
+    NamedRegionTimer T("Local Splitting", TimerGroupName, timersEnabled());
     SA->analyze(&VirtReg);
     unsigned PhysReg = tryLocalSplit(VirtReg, Order, NewVRegs);
     if (PhysReg || !NewVRegs.empty())
@@ -1671,7 +1780,7 @@ unsigned RAGreedy::trySplit(LiveInterval &VirtReg, AllocationOrder &Order,
     return tryInstructionSplit(VirtReg, Order, NewVRegs);
   }
 
-  NamedRegionTimer T("Global Splitting", TimerGroupName, TimePassesIsEnabled);
+  NamedRegionTimer T("Global Splitting", TimerGroupName, timersEnabled());
 
   SA->analyze(&VirtReg);
 
@@ -1682,6 +1791,7 @@ unsigned RAGreedy::trySplit(LiveInterval &VirtReg, AllocationOrder &Order,
   if (SA->didRepairRange()) {
     // VirtReg has changed, so all cached queries are invalid.
     Matrix->invalidateVirtRegs();
+    invalidateEvictionCosts(VirtReg.reg);
     if (unsigned PhysReg = tryAssign(VirtReg, Order, NewVRegs))
       return PhysReg;
   }
@@ -1706,6 +1816,18 @@ unsigned RAGreedy::trySplit(LiveInterval &VirtReg, AllocationOrder &Order,
 
 unsigned RAGreedy::selectOrSplit(LiveInterval &VirtReg,
                                  SmallVectorImpl<LiveInterval*> &NewVRegs) {
+  unsigned Reg = VirtReg.reg;
+  unsigned PhysReg = selectOrSplitImpl(VirtReg, NewVRegs);
+
+  // Unless VirtReg was queued again, it is now assigned, split or spilled.
+  // Its eviction costs won't be looked at again.
+  if (std::find(NewVRegs.begin(), NewVRegs.end(), &VirtReg) == NewVRegs.end())
+    invalidateEvictionCosts(Reg);
+  return PhysReg;
+}
+
+unsigned RAGreedy::selectOrSplitImpl(LiveInterval &VirtReg,
+                                     SmallVectorImpl<LiveInterval*> &NewVRegs) {
   // First try assigning a free register.
   AllocationOrder Order(VirtReg.reg, *VRM, RegClassInfo);
   if (unsigned PhysReg = tryAssign(VirtReg, Order, NewVRegs))
@@ -1745,7 +1867,7 @@ unsigned RAGreedy::selectOrSplit(LiveInterval &VirtReg,
     return PhysReg;
 
   // Finally spill VirtReg itself.
-  NamedRegionTimer T("Spiller", TimerGroupName, TimePassesIsEnabled);
+  NamedRegionTimer T("Spiller", TimerGroupName, timersEnabled());
   LiveRangeEdit LRE(&VirtReg, NewVRegs, *MF, *LIS, VRM, this);
   spiller().spill(LRE);
   setStage(NewVRegs.begin(), NewVRegs.end(), RS_Done);
@@ -1781,6 +1903,7 @@ bool RAGreedy::runOnMachineFunction(MachineFunction &mf) {
   SE.reset(new SplitEditor(*SA, *LIS, *VRM, *DomTree));
   ExtraRegInfo.clear();
   ExtraRegInfo.resize(MRI->getNumVirtRegs());
+  EvictionCache.clear();
   NextCascade = 1;
   IntfCache.init(MF, Matrix->getLiveUnions(), Indexes, LIS, TRI);
   GlobalCand.resize(32);  // This will grow as needed.
@@ -40,6 +40,7 @@ STATISTIC(NumBacktracks, "Number of times scheduler backtracked");
 STATISTIC(NumUnfolds,    "Number of nodes unfolded");
 STATISTIC(NumDups,       "Number of duplicated nodes");
 STATISTIC(NumPRCopies,   "Number of physical register copies");
+STATISTIC(NumLargeDAGs,  "Number of DAGs scheduled by static priority");
 
 static RegisterScheduler
   burrListDAGScheduler("list-burr",
@@ -103,6 +104,11 @@ static cl::opt<unsigned> AvgIPC(
   "sched-avg-ipc", cl::Hidden, cl::init(1),
   cl::desc("Average inst/cycle whan no target itinerary exists."));
 
+static cl::opt<unsigned> LargeDAGThreshold(
+  "sched-large-dag-threshold", cl::Hidden, cl::init(4000),
+  cl::desc("Number of nodes above which a DAG is scheduled from a heap "
+           "ordered by cached static priorities"));
+
 namespace {
 //===----------------------------------------------------------------------===//
 /// ScheduleDAGRRList - The actual register reduction list scheduler
@@ -1619,11 +1625,66 @@ struct ilp_ls_rr_sort : public queue_sort {
 
 class RegReductionPQBase : public SchedulingPriorityQueue {
 protected:
+  /// StaticPriority - The part of the bottom-up priority that does not depend
+  /// on the scheduling state, computed once when a node becomes available.
+  /// Large DAGs are scheduled from a heap ordered by these keys instead of
+  /// scanning the whole queue with the picker on every pop.
+  struct StaticPriority {
+    bool ScheduleLow;
+    unsigned Order;
+    bool HasPhysRegDefs;
+    unsigned Priority;
+    unsigned Dist;
+    unsigned Scratches;
+    unsigned Height;
+    unsigned Depth;
+  };
+
+  /// static_priority_less - Return true if right should be scheduled before
+  /// left.  This mirrors checkSpecialNodes and BURRSort minus the latency,
+  /// register pressure and call adjustments.
+  struct static_priority_less {
+    const std::vector<StaticPriority> *Keys;
+    static_priority_less(const std::vector<StaticPriority> *keys)
+      : Keys(keys) {}
+
+    bool operator()(const SUnit *left, const SUnit *right) const {
+      const StaticPriority &L = (*Keys)[left->NodeNum];
+      const StaticPriority &R = (*Keys)[right->NodeNum];
+      if (L.ScheduleLow != R.ScheduleLow)
+        return L.ScheduleLow < R.ScheduleLow;
+      if (L.Order != R.Order)
+        return L.Order < R.Order;
+      if (L.HasPhysRegDefs != R.HasPhysRegDefs)
+        return L.HasPhysRegDefs < R.HasPhysRegDefs;
+      if (L.Priority != R.Priority)
+        return L.Priority > R.Priority;
+      if (L.Dist != R.Dist)
+        return L.Dist < R.Dist;
+      if (L.Scratches != R.Scratches)
+        return L.Scratches > R.Scratches;
+      if (L.Height != R.Height)
+        return L.Height > R.Height;
+      if (L.Depth != R.Depth)
+        return L.Depth < R.Depth;
+      return left->NodeQueueId > right->NodeQueueId;
+    }
+  };
+
   std::vector<SUnit*> Queue;
   unsigned CurQueueId;
   bool TracksRegPressure;
   bool SrcOrder;
 
+  /// UseStaticPriority - True if the current DAG has more than
+  /// LargeDAGThreshold nodes, in which case Queue is kept as a heap ordered
+  /// by StaticPriorities.
+  bool UseStaticPriority;
+
+  /// StaticPriorities - The cached keys of the available nodes, indexed by
+  /// NodeNum.  Only maintained while UseStaticPriority is set.
+  std::vector<StaticPriority> StaticPriorities;
+
   // SUnits - The SUnits for the current graph.
   std::vector<SUnit> *SUnits;
 
@@ -1654,7 +1715,8 @@ public:
                      const TargetLowering *tli)
     : SchedulingPriorityQueue(hasReadyFilter),
       CurQueueId(0), TracksRegPressure(tracksrp), SrcOrder(srcorder),
-      MF(mf), TII(tii), TRI(tri), TLI(tli), scheduleDAG(NULL) {
+      UseStaticPriority(false), MF(mf), TII(tii), TRI(tri), TLI(tli),
+      scheduleDAG(NULL) {
     if (TracksRegPressure) {
       unsigned NumRC = TRI->getNumRegClasses();
       RegLimit.resize(NumRC);
@@ -1684,6 +1746,8 @@ public:
   void releaseState() {
     SUnits = 0;
     SethiUllmanNumbers.clear();
+    StaticPriorities.clear();
+    UseStaticPriority = false;
     std::fill(RegPressure.begin(), RegPressure.end(), 0);
   }
 
@@ -1701,6 +1765,11 @@ public:
     assert(!U->NodeQueueId && "Node in the queue already");
     U->NodeQueueId = ++CurQueueId;
     Queue.push_back(U);
+    if (UseStaticPriority) {
+      computeStaticPriority(U);
+      std::push_heap(Queue.begin(), Queue.end(),
+                     static_priority_less(&StaticPriorities));
+    }
   }
 
   void remove(SUnit *SU) {
@@ -1712,6 +1781,10 @@ public:
       std::swap(*I, Queue.back());
     Queue.pop_back();
     SU->NodeQueueId = 0;
+    // Nodes are only removed when backtracking, so just rebuild the heap.
+    if (UseStaticPriority)
+      std::make_heap(Queue.begin(), Queue.end(),
+                     static_priority_less(&StaticPriorities));
   }
 
   bool tracksRegPressure() const { return TracksRegPressure; }
@@ -1729,6 +1802,14 @@ public:
   void unscheduledNode(SUnit *SU);
 
 protected:
+  SUnit *popStaticPriority(std::vector<SUnit*> &Q) const {
+    std::pop_heap(Q.begin(), Q.end(), static_priority_less(&StaticPriorities));
+    SUnit *V = Q.back();
+    Q.pop_back();
+    return V;
+  }
+
+  void computeStaticPriority(const SUnit *SU);
   bool canClobber(const SUnit *SU, const SUnit *Op);
   void AddPseudoTwoAddrDeps();
   void PrescheduleNodesWithMultipleUses();
@@ -1785,7 +1866,8 @@ public:
   SUnit *pop() {
     if (Queue.empty()) return NULL;
 
-    SUnit *V = popFromQueue(Queue, Picker, scheduleDAG);
+    SUnit *V = UseStaticPriority ? popStaticPriority(Queue)
+                                 : popFromQueue(Queue, Picker, scheduleDAG);
     V->NodeQueueId = 0;
     return V;
   }
@@ -1796,7 +1878,9 @@ public:
     std::vector<SUnit*> DumpQueue = Queue;
     SF DumpPicker = Picker;
     while (!DumpQueue.empty()) {
-      SUnit *SU = popFromQueue(DumpQueue, DumpPicker, scheduleDAG);
+      SUnit *SU = UseStaticPriority
+        ? popStaticPriority(DumpQueue)
+        : popFromQueue(DumpQueue, DumpPicker, scheduleDAG);
       dbgs() << "Height " << SU->getHeight() << ": ";
       SU->dump(DAG);
     }
@@ -2672,6 +2756,16 @@ void RegReductionPQBase::initNodes(std::vector<SUnit> &sunits) {
   // Calculate node priorities.
   CalculateSethiUllmanNumbers();
 
+  // Comparing nodes with the picker makes every pop linear in the size of the
+  // queue, and the picker itself may walk the operands of both nodes.  Large
+  // DAGs use the heap of static priorities instead.
+  UseStaticPriority = sunits.size() > LargeDAGThreshold;
+  if (UseStaticPriority) {
+    ++NumLargeDAGs;
+    DEBUG(dbgs() << "Scheduling " << sunits.size()
+          << " nodes by static priority\n");
+  }
+
   // For single block loops, mark nodes that look like canonical IV increments.
   if (scheduleDAG->BB->isSuccessor(scheduleDAG->BB)) {
     for (unsigned i = 0, e = sunits.size(); i != e; ++i) {
@@ -2680,6 +2774,27 @@ void RegReductionPQBase::initNodes(std::vector<SUnit> &sunits) {
   }
 }
 
+void RegReductionPQBase::computeStaticPriority(const SUnit *SU) {
+  if (SU->NodeNum >= StaticPriorities.size())
+    StaticPriorities.resize(SUnits->size());
+  StaticPriority &Key = StaticPriorities[SU->NodeNum];
+  Key.ScheduleLow = SU->isScheduleLow;
+  // Bottom-up, nodes without a source order go first, then the higher
+  // orders, so the lowest non-zero order ends up on top of the block.
+  Key.Order = 0;
+  if (SrcOrder) {
+    Key.Order = getNodeOrdering(SU);
+    if (Key.Order == 0)
+      Key.Order = UINT_MAX;
+  }
+  Key.HasPhysRegDefs = !DisableSchedPhysRegJoin && SU->hasPhysRegDefs;
+  Key.Priority = getNodePriority(SU);
+  Key.Dist = closestSucc(SU);
+  Key.Scratches = calcMaxScratches(SU);
+  Key.Height = SU->getHeight();
+  Key.Depth = SU->getDepth();
+}
+
 //===----------------------------------------------------------------------===//
 //                    Preschedule for Register Pressure
 //===----------------------------------------------------------------------===//
@@ -24,6 +24,7 @@ INITIALIZE_PASS(SlotIndexes, "slotindexes",
 
 STATISTIC(NumLocalRenum,  "Number of local renumberings");
 STATISTIC(NumGlobalRenum, "Number of global renumberings");
+STATISTIC(NumRenumEntries, "Number of indexes changed by local renumberings");
 
 void SlotIndexes::getAnalysisUsage(AnalysisUsage &au) const {
   au.setPreservesAll();
@@ -124,22 +125,68 @@ void SlotIndexes::renumberIndexes() {
 
 // Renumber indexes locally after curItr was inserted, but failed to get a new
 // index.
+//
+// This is an order maintenance scheme in the style of Itai, Konheim, and Rodeh.
+// The index space is viewed as a complete binary tree of aligned ranges. We
+// look for the smallest range around curItr that is sparse enough, and spread
+// the entries in it evenly. The density allowed in a range decreases as the
+// range grows, so a renumbering that touches many entries leaves room for
+// proportionally many insertions before the same range fills up again. This
+// keeps the amortized cost of an insertion polylogarithmic, even when a large
+// region has been packed densely by earlier insertions.
 void SlotIndexes::renumberIndexes(IndexList::iterator curItr) {
-  // Number indexes with half the default spacing so we can catch up quickly.
-  const unsigned Space = SlotIndex::InstrDist/2;
-  assert((Space & 3) == 0 && "InstrDist must be a multiple of 2*NUM");
-
-  IndexList::iterator startItr = prior(curItr);
-  unsigned index = startItr->getIndex();
-  do {
-    curItr->setIndex(index += Space);
-    ++curItr;
-    // If the next index is bigger, we have caught up.
-  } while (curItr != indexList.end() && curItr->getIndex() <= index);
-
-  DEBUG(dbgs() << "\n*** Renumbered SlotIndexes " << startItr->getIndex() << '-'
-               << index << " ***\n");
-  ++NumLocalRenum;
+  // Entries must be at least Slot_Count apart to keep their slots distinct.
+  const uint64_t Unit = SlotIndex::Slot_Count;
+  assert((Unit & (Unit - 1)) == 0 && "Slot_Count must be a power of two");
+  // Number of levels in the tree of ranges. The top level covers the whole
+  // 32-bit index space.
+  const unsigned Levels = 32 - Log2_64(Unit);
+
+  // curItr doesn't have a valid index yet. Use its predecessor as the anchor
+  // for the ranges. There is always a predecessor since the first entry of the
+  // list is the function entry block.
+  IndexList::iterator firstItr = prior(curItr), lastItr = curItr;
+  const uint64_t Anchor = firstItr->getIndex();
+  uint64_t Count = 2;
+
+  for (unsigned Level = 1; Level <= Levels; ++Level) {
+    const uint64_t Width = Unit << Level;
+    const uint64_t Lo = Anchor & ~(Width - 1), Hi = Lo + Width;
+
+    // Grow [firstItr;lastItr] to cover all the entries in [Lo;Hi).
+    while (firstItr != indexList.begin() &&
+           prior(firstItr)->getIndex() >= Lo) {
+      --firstItr;
+      ++Count;
+    }
+    while (llvm::next(lastItr) != indexList.end() &&
+           llvm::next(lastItr)->getIndex() < Hi) {
+      ++lastItr;
+      ++Count;
+    }
+
+    // The range has 2^Level positions. Allow a density of 5/8 near the leaves,
+    // decreasing linearly to 1/4 at the root. The root density matches the
+    // InstrDist spacing used by a global renumbering.
+    if (Count * 8 * Levels > (uint64_t(5 * Levels - 3 * Level) << Level))
+      continue;
+
+    const uint64_t Space = (Width / Count) & ~(Unit - 1);
+    assert(Space >= Unit && "Range too dense");
+    uint64_t index = Lo;
+    for (IndexList::iterator I = firstItr, E = llvm::next(lastItr); I != E;
+         ++I, index += Space)
+      I->setIndex(index);
+
+    DEBUG(dbgs() << "\n*** Renumbered SlotIndexes " << Lo << '-' << Hi
+                 << " (" << Count << " entries) ***\n");
+    ++NumLocalRenum;
+    NumRenumEntries += Count;
+    return;
+  }
+
+  // The entire index space is too dense.
+  renumberIndexes();
 }
 
 // Repair indexes after adding and removing instructions.
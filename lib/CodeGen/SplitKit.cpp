@@ -834,6 +834,15 @@ void SplitEditor::hoistCopiesForSize() {
 bool SplitEditor::transferValues() {
   bool Skipped = false;
   RegAssignMap::const_iterator AssignI = RegAssign.begin();
+
+  // The parent segments are visited in order, so the blitted segments can be
+  // added to each new interval in order. Use a LiveRangeUpdater per interval
+  // so the defs that are already there don't have to be shifted for every
+  // segment. An updater must be flushed before its interval is read.
+  SmallVector<LiveRangeUpdater, 4> Updaters(Edit->size());
+  for (unsigned i = 0, e = Edit->size(); i != e; ++i)
+    Updaters[i].setDest(Edit->get(i));
+
   for (LiveInterval::const_iterator ParentI = Edit->getParent().begin(),
          ParentE = Edit->getParent().end(); ParentI != ParentE; ++ParentI) {
     DEBUG(dbgs() << "  blit " << *ParentI << ':');
@@ -865,7 +874,7 @@ bool SplitEditor::transferValues() {
       ValueForcePair VFP = Values.lookup(std::make_pair(RegIdx, ParentVNI->id));
       if (VNInfo *VNI = VFP.getPointer()) {
         DEBUG(dbgs() << ':' << VNI->id);
-        LI->addRange(LiveRange(Start, End, VNI));
+        Updaters[RegIdx].add(Start, End, VNI);
         Start = End;
         continue;
       }
@@ -879,6 +888,7 @@ bool SplitEditor::transferValues() {
       }
 
       LiveRangeCalc &LRC = getLRCalc(RegIdx);
+      Updaters[RegIdx].flush();
 
       // This value has multiple defs in RegIdx, but it wasn't rematerialized,
       // so the live range is accurate. Add live-in blocks in [Start;End) to the
@@ -932,6 +942,9 @@ bool SplitEditor::transferValues() {
     DEBUG(dbgs() << '\n');
   }
 
+  for (unsigned i = 0, e = Updaters.size(); i != e; ++i)
+    Updaters[i].flush();
+
   LRCalc[0].calculateValues();
   if (SpillMode)
     LRCalc[1].calculateValues();
@@ -379,6 +379,18 @@ uint8_t *RuntimeDyldImpl::createStubFunction(uint8_t *Addr) {
     writeInt32BE(Addr+36, 0xE96C0010); // ld    r11, 16(r2)
     writeInt32BE(Addr+40, 0x4E800420); // bctr
 
+    return Addr;
+  } else if (Arch == Triple::tilegx) {
+    // TILE-Gx far-call stub, r29 is free at a call site:
+    //   { moveli r29, hw2_last(addr) }
+    //   { shl16insli r29, r29, hw1(addr) }
+    //   { shl16insli r29, r29, hw0(addr) }
+    //   { jr r29 }
+    uint64_t *StubAddr = (uint64_t*)Addr;
+    StubAddr[0] = 0x000007eed1483000ULL;
+    StubAddr[1] = 0x380003aed1483000ULL;
+    StubAddr[2] = 0x380003aed1483000ULL;
+    StubAddr[3] = 0x286a73a051483000ULL;
     return Addr;
   }
   return Addr;
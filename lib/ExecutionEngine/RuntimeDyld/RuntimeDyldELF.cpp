@@ -159,6 +159,10 @@ ObjectImage *RuntimeDyldELF::createObjectImage(ObjectBuffer *Buffer) {
                          (uint8_t)Buffer->getBufferStart()[ELF::EI_DATA]);
   error_code ec;
 
+  // The TILE-Gx GOT is per object, start a new one for this object.
+  TileGXGOTSectionID = ~0U;
+  TileGXGOTEntries.clear();
+
   if (Ident.first == ELF::ELFCLASS32 && Ident.second == ELF::ELFDATA2LSB) {
     DyldELFObject<ELFType<support::little, 4, false> > *Obj =
       new DyldELFObject<ELFType<support::little, 4, false> >(
@@ -560,6 +564,15 @@ void RuntimeDyldELF::resolvePPC64Relocation(const SectionEntry &Section,
   }
 }
 
+// Write the low 16 bits of Value into the IMM16 field of the X0 or X1
+// instruction of the bundle at TargetPtr, selected by the relocation type.
+static void applyTileGXImm16(uint64_t *TargetPtr, uint32_t Type,
+                             uint64_t Value) {
+  unsigned Shift = (Type & 1) ? 43 : 12;
+  *TargetPtr = ((*TargetPtr) & (~(0xFFFFULL << Shift)))
+                | ((Value & 0xFFFF) << Shift);
+}
+
 void RuntimeDyldELF::resolveTileGXRelocation(const SectionEntry &Section,
                                              uint64_t Offset,
                                              uint64_t Value,
@@ -575,6 +588,7 @@ void RuntimeDyldELF::resolveTileGXRelocation(const SectionEntry &Section,
                << "\n");
 
   uint64_t* TargetPtr = (uint64_t*)(Section.Address + Offset);
+  uint64_t FinalAddress = Section.LoadAddress + Offset;
   Value += Addend;
 
   switch(Type) {
@@ -585,17 +599,20 @@ void RuntimeDyldELF::resolveTileGXRelocation(const SectionEntry &Section,
     *TargetPtr = Value;
     break;
   }
+  case ELF::R_TILEGX_64_PCREL: {
+    *TargetPtr = Value - FinalAddress;
+    break;
+  }
   case ELF::R_TILEGX_32: {
     uint32_t TruncatedValue = (Value & 0xFFFFFFFF);
-    *TargetPtr = TruncatedValue;
+    *(uint32_t*)TargetPtr = TruncatedValue;
     break;
   }
   case ELF::R_TILEGX_32_PCREL: {
-    uint64_t FinalAddress = Section.LoadAddress + Offset;
     int64_t RealOffset = Value - FinalAddress;
     assert(RealOffset <= INT32_MAX && RealOffset >= INT32_MIN);
     int32_t TruncOffset = (RealOffset & 0xFFFFFFFF);
-    *TargetPtr = TruncOffset;
+    *(int32_t*)TargetPtr = TruncOffset;
     break;
   }
   // R_TILEGX_JUMPOFF_X1
@@ -609,69 +626,168 @@ void RuntimeDyldELF::resolveTileGXRelocation(const SectionEntry &Section,
   //               |
   //               V
   //        relocation area
-  case ELF::R_TILEGX_JUMPOFF_X1: {
-    uint64_t FinalAddress = Section.LoadAddress + Offset;
+  //
+  // Calls through the PLT are bound directly, or to a stub in the section's
+  // stub area when the callee is out of range (see processRelocationRef).
+  case ELF::R_TILEGX_JUMPOFF_X1:
+  case ELF::R_TILEGX_JUMPOFF_X1_PLT: {
     int64_t RealOffset = Value - FinalAddress;
+    assert(RealOffset >= -(1LL << 29) && RealOffset < (1LL << 29) &&
+           "R_TILEGX_JUMPOFF_X1 out of range");
     int64_t TruncOffset = (RealOffset >> 3) & 0x7FFFFFFLL;
     *TargetPtr = ((*TargetPtr) & (~(0x7FFFFFFLL << 31)))
                   | (TruncOffset << 31);
     break;
   }
 
-  // R_TILEGX_IMM16_X0_HW2_LAST
+  // R_TILEGX_BROFF_X1
   //
-  // inst-bundle[27-12] = Value[47-32]
-  case ELF::R_TILEGX_IMM16_X0_HW2_LAST: {
-    uint64_t RelVal = (Value >> 32) & 0xFFFF;
-    *TargetPtr = ((*TargetPtr) & (~(0xFFFFLL << 12))) | (RelVal << 12);
+  // inst-bundle[36-31] = Offset[8-3], inst-bundle[53-43] = Offset[19-9]
+  case ELF::R_TILEGX_BROFF_X1: {
+    int64_t RealOffset = Value - FinalAddress;
+    uint64_t BrOff = (RealOffset >> 3) & 0x1FFFFLL;
+    *TargetPtr = ((*TargetPtr) & ~((0x3FLL << 31) | (0x7FFLL << 43)))
+                  | ((BrOff & 0x3F) << 31) | ((BrOff >> 6) << 43);
     break;
   }
 
-  // R_TILEGX_IMM16_X1_HW2_LAST
+  // R_TILEGX_IMM16_{X0,X1}_HW{0,1,2,3}{,_LAST}{,_PCREL,_PLT_PCREL}
   //
-  // inst-bundle[58-43] = Value[47-32]
-  case ELF::R_TILEGX_IMM16_X1_HW2_LAST: {
-    uint64_t RelVal = (Value >> 32) & 0xFFFF;
-    *TargetPtr = ((*TargetPtr) & (~(0xFFFFLL << 43))) | (RelVal << 43);
-    break;
-  }
-
-  // R_TILEGX_IMM16_X0_HW1
+  // inst-bundle[27-12] (X0) or inst-bundle[58-43] (X1) = Value[16n+15-16n]
   //
-  // inst-bundle[27-12] = Value[31-16]
-  case ELF::R_TILEGX_IMM16_X0_HW1: {
-    uint64_t RelVal = (Value >> 16) & 0xFFFF;
-    *TargetPtr = ((*TargetPtr) & (~(0xFFFFLL << 12))) | (RelVal << 12);
+  // The X1 form of each of these is numbered one past its X0 form.
+  case ELF::R_TILEGX_IMM16_X0_HW0:
+  case ELF::R_TILEGX_IMM16_X1_HW0:
+  case ELF::R_TILEGX_IMM16_X0_HW0_LAST:
+  case ELF::R_TILEGX_IMM16_X1_HW0_LAST:
+    applyTileGXImm16(TargetPtr, Type, Value);
     break;
-  }
-
-  // R_TILEGX_IMM16_X1_HW1
-  //
-  // inst-bundle[58-43] = Value[31-16]
-  case ELF::R_TILEGX_IMM16_X1_HW1: {
-    uint64_t RelVal = (Value >> 16) & 0xFFFF;
-    *TargetPtr = ((*TargetPtr) & (~(0xFFFFLL << 43))) | (RelVal << 43);
+  case ELF::R_TILEGX_IMM16_X0_HW1:
+  case ELF::R_TILEGX_IMM16_X1_HW1:
+  case ELF::R_TILEGX_IMM16_X0_HW1_LAST:
+  case ELF::R_TILEGX_IMM16_X1_HW1_LAST:
+    applyTileGXImm16(TargetPtr, Type, Value >> 16);
+    break;
+  case ELF::R_TILEGX_IMM16_X0_HW2:
+  case ELF::R_TILEGX_IMM16_X1_HW2:
+  case ELF::R_TILEGX_IMM16_X0_HW2_LAST:
+  case ELF::R_TILEGX_IMM16_X1_HW2_LAST:
+    applyTileGXImm16(TargetPtr, Type, Value >> 32);
+    break;
+  case ELF::R_TILEGX_IMM16_X0_HW3:
+  case ELF::R_TILEGX_IMM16_X1_HW3:
+    applyTileGXImm16(TargetPtr, Type, Value >> 48);
+    break;
+  case ELF::R_TILEGX_IMM16_X0_HW0_PCREL:
+  case ELF::R_TILEGX_IMM16_X1_HW0_PCREL:
+  case ELF::R_TILEGX_IMM16_X0_HW0_LAST_PCREL:
+  case ELF::R_TILEGX_IMM16_X1_HW0_LAST_PCREL:
+  case ELF::R_TILEGX_IMM16_X0_HW0_PLT_PCREL:
+  case ELF::R_TILEGX_IMM16_X1_HW0_PLT_PCREL:
+  case ELF::R_TILEGX_IMM16_X0_HW0_LAST_PLT_PCREL:
+  case ELF::R_TILEGX_IMM16_X1_HW0_LAST_PLT_PCREL:
+    applyTileGXImm16(TargetPtr, Type, Value - FinalAddress);
+    break;
+  case ELF::R_TILEGX_IMM16_X0_HW1_PCREL:
+  case ELF::R_TILEGX_IMM16_X1_HW1_PCREL:
+  case ELF::R_TILEGX_IMM16_X0_HW1_LAST_PCREL:
+  case ELF::R_TILEGX_IMM16_X1_HW1_LAST_PCREL:
+  case ELF::R_TILEGX_IMM16_X0_HW1_PLT_PCREL:
+  case ELF::R_TILEGX_IMM16_X1_HW1_PLT_PCREL:
+  case ELF::R_TILEGX_IMM16_X0_HW1_LAST_PLT_PCREL:
+  case ELF::R_TILEGX_IMM16_X1_HW1_LAST_PLT_PCREL:
+    applyTileGXImm16(TargetPtr, Type, (Value - FinalAddress) >> 16);
+    break;
+  case ELF::R_TILEGX_IMM16_X0_HW2_PCREL:
+  case ELF::R_TILEGX_IMM16_X1_HW2_PCREL:
+  case ELF::R_TILEGX_IMM16_X0_HW2_LAST_PCREL:
+  case ELF::R_TILEGX_IMM16_X1_HW2_LAST_PCREL:
+  case ELF::R_TILEGX_IMM16_X0_HW2_PLT_PCREL:
+  case ELF::R_TILEGX_IMM16_X1_HW2_PLT_PCREL:
+  case ELF::R_TILEGX_IMM16_X0_HW2_LAST_PLT_PCREL:
+  case ELF::R_TILEGX_IMM16_X1_HW2_LAST_PLT_PCREL:
+    applyTileGXImm16(TargetPtr, Type, (Value - FinalAddress) >> 32);
+    break;
+  case ELF::R_TILEGX_IMM16_X0_HW3_PCREL:
+  case ELF::R_TILEGX_IMM16_X1_HW3_PCREL:
+    applyTileGXImm16(TargetPtr, Type, (Value - FinalAddress) >> 48);
     break;
-  }
 
-  // R_TILEGX_IMM16_X0_HW0
+  // R_TILEGX_IMM16_{X0,X1}_HW{0,0_LAST,1_LAST}_GOT
   //
-  // inst-bundle[27-12] = Value[15-0]
-  case ELF::R_TILEGX_IMM16_X0_HW0: {
-    uint64_t RelVal = Value & 0xFFFF;
-    *TargetPtr = ((*TargetPtr) & (~(0xFFFFLL << 12))) | (RelVal << 12);
+  // Value is the offset of the symbol's slot from the start of the GOT.
+  case ELF::R_TILEGX_IMM16_X0_HW0_GOT:
+  case ELF::R_TILEGX_IMM16_X1_HW0_GOT:
+  case ELF::R_TILEGX_IMM16_X0_HW0_LAST_GOT:
+  case ELF::R_TILEGX_IMM16_X1_HW0_LAST_GOT:
+    applyTileGXImm16(TargetPtr, Type, Value);
+    break;
+  case ELF::R_TILEGX_IMM16_X0_HW1_LAST_GOT:
+  case ELF::R_TILEGX_IMM16_X1_HW1_LAST_GOT:
+    applyTileGXImm16(TargetPtr, Type, Value >> 16);
     break;
   }
+}
 
-  // R_TILEGX_IMM16_X1_HW0
-  //
-  // inst-bundle[58-43] = Value[15-0]
-  case ELF::R_TILEGX_IMM16_X1_HW0: {
-    uint64_t RelVal = Value & 0xFFFF;
-    *TargetPtr = ((*TargetPtr) & (~(0xFFFFLL << 43))) | (RelVal << 43);
-    break;
+static bool isTileGXGOTRelocation(uint32_t Type) {
+  switch (Type) {
+  default:
+    return false;
+  case ELF::R_TILEGX_IMM16_X0_HW0_GOT:
+  case ELF::R_TILEGX_IMM16_X1_HW0_GOT:
+  case ELF::R_TILEGX_IMM16_X0_HW0_LAST_GOT:
+  case ELF::R_TILEGX_IMM16_X1_HW0_LAST_GOT:
+  case ELF::R_TILEGX_IMM16_X0_HW1_LAST_GOT:
+  case ELF::R_TILEGX_IMM16_X1_HW1_LAST_GOT:
+    return true;
   }
+}
+
+static bool isTileGXTLSRelocation(uint32_t Type) {
+  return (Type >= ELF::R_TILEGX_IMM16_X0_HW0_TLS_GD &&
+          Type <= ELF::R_TILEGX_IMM16_X1_HW1_LAST_TLS_GD) ||
+         Type == ELF::R_TILEGX_IMM16_X0_HW0_TLS_IE ||
+         Type == ELF::R_TILEGX_IMM16_X1_HW0_TLS_IE ||
+         (Type >= ELF::R_TILEGX_IMM16_X0_HW0_LAST_TLS_IE &&
+          Type <= ELF::R_TILEGX_IMM8_Y1_TLS_ADD);
+}
+
+// Allocate the GOT for the object being loaded, with room for one slot per
+// GOT relocation in it.  _GLOBAL_OFFSET_TABLE_ refers to its start, and
+// slot 0 is left reserved as in a linked image.
+unsigned RuntimeDyldELF::getTileGXGOTSection(ObjectImage &Obj) {
+  if (TileGXGOTSectionID != ~0U)
+    return TileGXGOTSectionID;
+
+  error_code err;
+  unsigned NumSlots = 1;
+  for (section_iterator si = Obj.begin_sections(), se = Obj.end_sections();
+       si != se; si.increment(err)) {
+    Check(err);
+    for (relocation_iterator i = si->begin_relocations(),
+         e = si->end_relocations(); i != e; i.increment(err)) {
+      Check(err);
+      uint64_t RelType;
+      Check(i->getType(RelType));
+      if (isTileGXGOTRelocation(RelType))
+        ++NumSlots;
+    }
   }
+
+  uintptr_t Size = NumSlots * sizeof(uint64_t);
+  TileGXGOTSectionID = Sections.size();
+  uint8_t *Addr = MemMgr->allocateDataSection(Size, sizeof(uint64_t),
+                                              TileGXGOTSectionID, false);
+  if (!Addr)
+    report_fatal_error("Unable to allocate memory for GOT!");
+  Sections.push_back(SectionEntry(".got", Addr, Size, Size, 0));
+  memset(Addr, 0, Size);
+
+  DEBUG(dbgs() << "emitGOTSection SectionID: " << TileGXGOTSectionID
+               << " new addr: " << format("%p", Addr)
+               << " DataSize: " << Size
+               << "\n");
+  return TileGXGOTSectionID;
 }
 
 void RuntimeDyldELF::resolveRelocation(const SectionEntry &Section,
@@ -702,6 +818,7 @@ void RuntimeDyldELF::resolveRelocation(const SectionEntry &Section,
     break;
   case Triple::ppc64:
     resolvePPC64Relocation(Section, Offset, Value, Type, Addend);
+    break;
   case Triple::tilegx:
     resolveTileGXRelocation(Section, Offset, Value, Type, Addend);
     break;
@@ -943,6 +1060,94 @@ void RuntimeDyldELF::processRelocationRef(const ObjRelocationInfo &Rel,
       else
         addRelocationForSection(RE, Value.SectionID);
     }
+  } else if (Arch == Triple::tilegx) {
+    if (isTileGXTLSRelocation(RelType))
+      report_fatal_error("TILE-Gx TLS relocations are not supported in the "
+                         "JIT; thread-local '" + TargetName + "' cannot be "
+                         "resolved");
+
+    if (TargetName == "_GLOBAL_OFFSET_TABLE_") {
+      Value.SymbolName = 0;
+      Value.SectionID = getTileGXGOTSection(Obj);
+      Value.Addend = Addend;
+    }
+
+    if (isTileGXGOTRelocation(RelType)) {
+      // Give the target a GOT slot, filled in by an R_TILEGX_64 relocation,
+      // and point the instruction at it.  The slot offset does not depend on
+      // where the sections end up, so the instruction is resolved now.
+      unsigned GOTSectionID = getTileGXGOTSection(Obj);
+      uintptr_t GOTOffset;
+      StubMap::const_iterator i = TileGXGOTEntries.find(Value);
+      if (i != TileGXGOTEntries.end()) {
+        GOTOffset = i->second;
+      } else {
+        GOTOffset = (TileGXGOTEntries.size() + 1) * sizeof(uint64_t);
+        assert(GOTOffset < Sections[GOTSectionID].Size && "GOT overflow");
+        TileGXGOTEntries[Value] = GOTOffset;
+        RelocationEntry RE(GOTSectionID, GOTOffset, ELF::R_TILEGX_64,
+                           Value.Addend);
+        if (Value.SymbolName)
+          addRelocationForSymbol(RE, Value.SymbolName);
+        else
+          addRelocationForSection(RE, Value.SectionID);
+      }
+      resolveRelocation(Sections[Rel.SectionID], Rel.Offset, GOTOffset,
+                        RelType, 0);
+    } else if ((RelType == ELF::R_TILEGX_JUMPOFF_X1 ||
+                RelType == ELF::R_TILEGX_JUMPOFF_X1_PLT) &&
+               (Value.SymbolName || Value.SectionID != Rel.SectionID)) {
+      // A call out of this section may be beyond the reach of jal, so it
+      // goes through a far-call stub in this section's stub area.
+      DEBUG(dbgs() << "\t\tThis is a TILE-Gx call relocation.");
+      SectionEntry &Section = Sections[Rel.SectionID];
+
+      uintptr_t StubOffset;
+      StubMap::const_iterator i = Stubs.find(Value);
+      if (i != Stubs.end()) {
+        StubOffset = i->second;
+        DEBUG(dbgs() << " Stub function found\n");
+      } else {
+        // Create a new stub function.
+        DEBUG(dbgs() << " Create a new stub function\n");
+        StubOffset = Section.StubOffset;
+        Stubs[Value] = StubOffset;
+        uint8_t *StubTargetAddr = createStubFunction(Section.Address +
+                                                     StubOffset);
+
+        // The moveli/shl16insli/shl16insli bundles build the address.
+        RelocationEntry REhw2(Rel.SectionID,
+                              StubTargetAddr - Section.Address,
+                              ELF::R_TILEGX_IMM16_X1_HW2_LAST, Value.Addend);
+        RelocationEntry REhw1(Rel.SectionID,
+                              StubTargetAddr - Section.Address + 8,
+                              ELF::R_TILEGX_IMM16_X1_HW1, Value.Addend);
+        RelocationEntry REhw0(Rel.SectionID,
+                              StubTargetAddr - Section.Address + 16,
+                              ELF::R_TILEGX_IMM16_X1_HW0, Value.Addend);
+
+        if (Value.SymbolName) {
+          addRelocationForSymbol(REhw2, Value.SymbolName);
+          addRelocationForSymbol(REhw1, Value.SymbolName);
+          addRelocationForSymbol(REhw0, Value.SymbolName);
+        } else {
+          addRelocationForSection(REhw2, Value.SectionID);
+          addRelocationForSection(REhw1, Value.SectionID);
+          addRelocationForSection(REhw0, Value.SectionID);
+        }
+        Section.StubOffset += getMaxStubSize();
+      }
+
+      // Relative to this section, so it follows the section if it moves.
+      RelocationEntry RE(Rel.SectionID, Rel.Offset, RelType, StubOffset);
+      addRelocationForSection(RE, Rel.SectionID);
+    } else {
+      RelocationEntry RE(Rel.SectionID, Rel.Offset, RelType, Value.Addend);
+      if (Value.SymbolName)
+        addRelocationForSymbol(RE, Value.SymbolName);
+      else
+        addRelocationForSection(RE, Value.SectionID);
+    }
   } else {
     RelocationEntry RE(Rel.SectionID, Rel.Offset, RelType, Value.Addend);
     if (Value.SymbolName)
@@ -85,13 +85,20 @@ protected:
   virtual ObjectImage *createObjectImage(ObjectBuffer *InputBuffer);
 
   uint64_t findPPC64TOC() const;
+
+  // The TILE-Gx GOT of the object being loaded, allocated on its first use,
+  // and the slot already handed out for each GOT relocation target.
+  unsigned TileGXGOTSectionID;
+  StubMap TileGXGOTEntries;
+  unsigned getTileGXGOTSection(ObjectImage &Obj);
+
   void findOPDEntrySection(ObjectImage &Obj,
                            ObjSectionToIDMap &LocalSections,
                            RelocationValueRef &Rel);
 
 public:
   RuntimeDyldELF(RTDyldMemoryManager *mm)
-      : RuntimeDyldImpl(mm) {}
+      : RuntimeDyldImpl(mm), TileGXGOTSectionID(~0U) {}
 
   virtual ~RuntimeDyldELF();
 
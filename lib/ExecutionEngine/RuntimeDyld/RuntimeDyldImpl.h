@@ -112,11 +112,18 @@ public:
   const char *SymbolName;
   RelocationValueRef(): SectionID(0), Addend(0), SymbolName(0) {}
 
+  // Compare the fields rather than the bytes, the padding is not
+  // initialized.
   inline bool operator==(const RelocationValueRef &Other) const {
-    return std::memcmp(this, &Other, sizeof(RelocationValueRef)) == 0;
+    return SectionID == Other.SectionID && Addend == Other.Addend &&
+           SymbolName == Other.SymbolName;
   }
   inline bool operator <(const RelocationValueRef &Other) const {
-    return std::memcmp(this, &Other, sizeof(RelocationValueRef)) < 0;
+    if (SectionID != Other.SectionID)
+      return SectionID < Other.SectionID;
+    if (Addend != Other.Addend)
+      return Addend < Other.Addend;
+    return SymbolName < Other.SymbolName;
   }
 };
 
@@ -172,6 +179,8 @@ protected:
       return 16;
     else if (Arch == Triple::ppc64)
       return 44;
+    else if (Arch == Triple::tilegx)
+      return 32; // Four bundles: build the 48-bit address, then jr.
     else
       return 0;
   }
@@ -16,6 +16,7 @@
 #include "llvm/Support/Atomic.h"
 #include "llvm/Support/Mutex.h"
 #include <cassert>
+#include <vector>
 
 using namespace llvm;
 
@@ -102,6 +103,40 @@ void llvm::llvm_execute_on_thread(void (*Fn)(void*), void *UserData,
  error:
   ::pthread_attr_destroy(&Attr);
 }
+
+void llvm::llvm_execute_on_threads(void (*Fn)(void*), void **UserData,
+                                   unsigned NumItems,
+                                   unsigned RequestedStackSize) {
+  std::vector<ThreadInfo> Infos(NumItems);
+  std::vector<pthread_t> Threads(NumItems);
+  std::vector<bool> Started(NumItems, false);
+  pthread_attr_t Attr;
+  bool HaveAttr = ::pthread_attr_init(&Attr) == 0;
+  if (HaveAttr && RequestedStackSize != 0 &&
+      ::pthread_attr_setstacksize(&Attr, RequestedStackSize) != 0) {
+    ::pthread_attr_destroy(&Attr);
+    HaveAttr = false;
+  }
+
+  for (unsigned i = 0; i != NumItems; ++i) {
+    Infos[i].UserFn = Fn;
+    Infos[i].UserData = UserData[i];
+    if (HaveAttr)
+      Started[i] = ::pthread_create(&Threads[i], &Attr,
+                                    ExecuteOnThread_Dispatch, &Infos[i]) == 0;
+  }
+
+  // Run whatever could not be handed to a thread here, then wait for the rest.
+  for (unsigned i = 0; i != NumItems; ++i)
+    if (!Started[i])
+      Fn(UserData[i]);
+  for (unsigned i = 0; i != NumItems; ++i)
+    if (Started[i])
+      ::pthread_join(Threads[i], 0);
+
+  if (HaveAttr)
+    ::pthread_attr_destroy(&Attr);
+}
 #elif LLVM_ENABLE_THREADS!=0 && defined(LLVM_ON_WIN32)
 #include "Windows/Windows.h"
 #include <process.h>
@@ -136,6 +171,29 @@ void llvm::llvm_execute_on_thread(void (*Fn)(void*), void *UserData,
     ::CloseHandle(hThread);
   }
 }
+
+void llvm::llvm_execute_on_threads(void (*Fn)(void*), void **UserData,
+                                   unsigned NumItems,
+                                   unsigned RequestedStackSize) {
+  std::vector<ThreadInfo> Infos(NumItems);
+  std::vector<HANDLE> Threads(NumItems);
+  for (unsigned i = 0; i != NumItems; ++i) {
+    Infos[i].func = Fn;
+    Infos[i].param = UserData[i];
+    Threads[i] = (HANDLE)::_beginthreadex(NULL, RequestedStackSize,
+                                          ThreadCallback, &Infos[i], 0, NULL);
+  }
+
+  // Run whatever could not be handed to a thread here, then wait for the rest.
+  for (unsigned i = 0; i != NumItems; ++i)
+    if (!Threads[i])
+      Fn(UserData[i]);
+  for (unsigned i = 0; i != NumItems; ++i)
+    if (Threads[i]) {
+      (void)::WaitForSingleObject(Threads[i], INFINITE);
+      ::CloseHandle(Threads[i]);
+    }
+}
 #else
 // Support for non-Win32, non-pthread implementation.
 void llvm::llvm_execute_on_thread(void (*Fn)(void*), void *UserData,
@@ -144,4 +202,12 @@ void llvm::llvm_execute_on_thread(void (*Fn)(void*), void *UserData,
   Fn(UserData);
 }
 
+void llvm::llvm_execute_on_threads(void (*Fn)(void*), void **UserData,
+                                   unsigned NumItems,
+                                   unsigned RequestedStackSize) {
+  (void) RequestedStackSize;
+  for (unsigned i = 0; i != NumItems; ++i)
+    Fn(UserData[i]);
+}
+
 #endif
@@ -263,7 +263,10 @@ bool TileAsmParser::require32bit(StringRef Mnemonic) {
 int TileAsmParser::matchRegisterName(StringRef Name, StringRef Mnemonic) {
   int CC = StringSwitch<unsigned>(Name).Case("fp", Tile::FP)
       .Case("tp", Tile::TP).Case("sp", Tile::SP).Case("lr", Tile::LR)
-      .Case("zero", Tile::ZERO).Default(-1);
+      .Case("zero", Tile::ZERO)
+      .Case("idn0", Tile::IDN0).Case("idn1", Tile::IDN1)
+      .Case("udn0", Tile::UDN0).Case("udn1", Tile::UDN1)
+      .Case("udn2", Tile::UDN2).Case("udn3", Tile::UDN3).Default(-1);
 
   if (CC == -1)
     return -1;
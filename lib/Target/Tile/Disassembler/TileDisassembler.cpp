@@ -0,0 +1,218 @@
+//===-- TileDisassembler.cpp - Disassembler for TILE-Gx ---------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements the TILE-Gx disassembler. Every 64-bit word is one
+// bundle: solo forms are matched against the whole word first, otherwise the
+// word is split into its X0/X1 or Y0/Y1/Y2 slots and each slot is decoded on
+// its own. The result is always a BUNDLE MCInst whose operands are the
+// decoded slot instructions, FNOP fillers left out.
+//
+//===----------------------------------------------------------------------===//
+
+#define DEBUG_TYPE "tile-disassembler"
+#include "Tile.h"
+#include "MCTargetDesc/TileBaseInfo.h"
+#include "llvm/MC/MCDisassembler.h"
+#include "llvm/MC/MCFixedLenDisassembler.h"
+#include "llvm/MC/MCInst.h"
+#include "llvm/MC/MCInstrInfo.h"
+#include "llvm/MC/MCRegisterInfo.h"
+#include "llvm/MC/MCSubtargetInfo.h"
+#include "llvm/Support/MathExtras.h"
+#include "llvm/Support/MemoryObject.h"
+#include "llvm/Support/TargetRegistry.h"
+#include "llvm/Target/TargetOpcodes.h"
+
+using namespace llvm;
+
+typedef MCDisassembler::DecodeStatus DecodeStatus;
+
+// The encoding of FNOP in each slot, as filled in by the code emitter.
+static const uint64_t FNOP_X0 = 0x51483000ULL;
+static const uint64_t FNOP_X1 = 0x50d46000ULL << 31;
+static const uint64_t FNOP_Y0 =
+    (0x6ULL << 27) | (0x3ULL << 18) | (0x3ULL << 12);
+static const uint64_t FNOP_Y1 =
+    (0x7ULL << 58) | (0x3ULL << 49) | (0x8ULL << 43);
+
+// The bits of the bundle word owned by each slot.
+static const uint64_t SLOT_X0 = 0x7fffffffULL;
+static const uint64_t SLOT_X1 = 0x7fffffffULL << 31;
+static const uint64_t SLOT_Y0 = (0xfULL << 27) | 0xfffffULL;
+static const uint64_t SLOT_Y1 = (0xfULL << 58) | (0xfffffULL << 31);
+
+namespace {
+
+/// A disassembler class for TILE-Gx.
+class TileDisassembler : public MCDisassembler {
+  const MCRegisterInfo *RegInfo;
+  const MCInstrInfo *InstrInfo;
+  // Storage for the slot instructions of the last decoded bundle.
+  mutable MCInst Slots[3];
+
+  DecodeStatus decodeSlot(const uint8_t *Table, uint64_t Insn, uint64_t Address,
+                          unsigned &NumSlots) const;
+public:
+  TileDisassembler(const MCSubtargetInfo &STI, const MCRegisterInfo *RI,
+                   const MCInstrInfo *II)
+      : MCDisassembler(STI), RegInfo(RI), InstrInfo(II) {}
+
+  virtual ~TileDisassembler() {
+    delete RegInfo;
+    delete InstrInfo;
+  }
+
+  /// See MCDisassembler.
+  virtual DecodeStatus getInstruction(MCInst &Instr, uint64_t &Size,
+                                      const MemoryObject &Region,
+                                      uint64_t Address, raw_ostream &VStream,
+                                      raw_ostream &CStream) const;
+
+  const MCRegisterInfo *getRegInfo() const { return RegInfo; }
+};
+} // end anonymous namespace
+
+// Register numbers are hardware encodings, look them up in the class.
+static DecodeStatus decodeRegister(MCInst &Inst, unsigned RC, unsigned RegNo,
+                                   const void *Decoder) {
+  const TileDisassembler *Dis = static_cast<const TileDisassembler *>(Decoder);
+  const MCRegisterInfo *RI = Dis->getRegInfo();
+  const MCRegisterClass &Class = RI->getRegClass(RC);
+  for (MCRegisterClass::iterator I = Class.begin(), E = Class.end(); I != E;
+       ++I) {
+    if (RI->getEncodingValue(*I) == RegNo) {
+      Inst.addOperand(MCOperand::CreateReg(*I));
+      return MCDisassembler::Success;
+    }
+  }
+  return MCDisassembler::Fail;
+}
+
+static DecodeStatus DecodeCPURegsRegisterClass(MCInst &Inst, unsigned RegNo,
+                                               uint64_t Address,
+                                               const void *Decoder) {
+  return decodeRegister(Inst, Tile::CPURegsRegClassID, RegNo, Decoder);
+}
+
+static DecodeStatus DecodeCPU32RegsRegisterClass(MCInst &Inst, unsigned RegNo,
+                                                 uint64_t Address,
+                                                 const void *Decoder) {
+  return decodeRegister(Inst, Tile::CPU32RegsRegClassID, RegNo, Decoder);
+}
+
+// Branch offsets count bundles, print them as byte offsets.
+static DecodeStatus DecodeBranchTarget(MCInst &Inst, uint64_t Offset,
+                                       uint64_t Address, const void *Decoder) {
+  Inst.addOperand(MCOperand::CreateImm(SignExtend64<17>(Offset) * 8));
+  return MCDisassembler::Success;
+}
+
+static DecodeStatus DecodeJumpTarget(MCInst &Inst, uint64_t Offset,
+                                     uint64_t Address, const void *Decoder) {
+  Inst.addOperand(MCOperand::CreateImm(SignExtend64<27>(Offset) * 8));
+  return MCDisassembler::Success;
+}
+
+#include "TileGenDisassemblerTables.inc"
+
+// The generated decoder zero extends every immediate field, sign extend the
+// ones the instruction format defines as signed.
+static void signExtendImmediates(MCInst &MI, const MCInstrInfo &MII) {
+  unsigned Format = (MII.get(MI.getOpcode()).TSFlags >> TileII::FormatTypePos) &
+                    TileII::FormatTypeMask;
+  for (unsigned i = 0, e = MI.getNumOperands(); i != e; ++i) {
+    MCOperand &MO = MI.getOperand(i);
+    if (!MO.isImm())
+      continue;
+    switch (Format) {
+    case TileII::FrmImm8:
+    case TileII::FrmLS:
+      MO.setImm(SignExtend64<8>(MO.getImm()));
+      break;
+    case TileII::FrmImm16:
+      MO.setImm(SignExtend64<16>(MO.getImm()));
+      break;
+    default:
+      break;
+    }
+  }
+}
+
+DecodeStatus TileDisassembler::decodeSlot(const uint8_t *Table, uint64_t Insn,
+                                          uint64_t Address,
+                                          unsigned &NumSlots) const {
+  MCInst &MI = Slots[NumSlots];
+  MI.clear();
+  if (decodeInstruction(Table, MI, Insn, Address, this, STI) == Fail)
+    return Fail;
+  signExtendImmediates(MI, *InstrInfo);
+  ++NumSlots;
+  return Success;
+}
+
+DecodeStatus TileDisassembler::getInstruction(MCInst &Instr, uint64_t &Size,
+                                              const MemoryObject &Region,
+                                              uint64_t Address,
+                                              raw_ostream &VStream,
+                                              raw_ostream &CStream) const {
+  uint8_t Bytes[8];
+
+  // Bundles are little-endian 64-bit words.
+  if (Region.readBytes(Address, 8, Bytes, NULL) == -1) {
+    Size = 0;
+    return Fail;
+  }
+  Size = 8;
+
+  uint64_t Insn = 0;
+  for (unsigned i = 0; i != 8; ++i)
+    Insn |= uint64_t(Bytes[i]) << (8 * i);
+
+  unsigned NumSlots = 0;
+  if (decodeSlot(DecoderTableSolo64, Insn, Address, NumSlots) == Fail) {
+    if ((Insn >> 62) == 0) {
+      // X mode.
+      if ((Insn & SLOT_X0) != FNOP_X0 &&
+          decodeSlot(DecoderTableX064, Insn, Address, NumSlots) == Fail)
+        return Fail;
+      if ((Insn & SLOT_X1) != FNOP_X1 &&
+          decodeSlot(DecoderTableX164, Insn, Address, NumSlots) == Fail)
+        return Fail;
+    } else {
+      // Y mode, Y2 is never filled with FNOP.
+      if ((Insn & SLOT_Y0) != FNOP_Y0 &&
+          decodeSlot(DecoderTableY064, Insn, Address, NumSlots) == Fail)
+        return Fail;
+      if ((Insn & SLOT_Y1) != FNOP_Y1 &&
+          decodeSlot(DecoderTableY164, Insn, Address, NumSlots) == Fail)
+        return Fail;
+      if (decodeSlot(DecoderTableY264, Insn, Address, NumSlots) == Fail)
+        return Fail;
+    }
+  }
+
+  // An empty bundle is the all FNOP word.
+  Instr.clear();
+  Instr.setOpcode(TargetOpcode::BUNDLE);
+  for (unsigned i = 0; i != NumSlots; ++i)
+    Instr.addOperand(MCOperand::CreateInst(&Slots[i]));
+  return Success;
+}
+
+static MCDisassembler *createTileDisassembler(const Target &T,
+                                              const MCSubtargetInfo &STI) {
+  return new TileDisassembler(STI, T.createMCRegInfo(""),
+                              T.createMCInstrInfo());
+}
+
+extern "C" void LLVMInitializeTileDisassembler() {
+  // Register the disassembler.
+  TargetRegistry::RegisterMCDisassembler(TheTileGXTarget,
+                                         createTileDisassembler);
+}
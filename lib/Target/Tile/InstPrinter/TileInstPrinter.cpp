@@ -23,6 +23,8 @@
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/Support/Format.h"
 #include "llvm/Support/Debug.h"
+#include "llvm/Target/TargetOpcodes.h"
+#include <cctype>
 using namespace llvm;
 
 #include "TileGenAsmWriter.inc"
@@ -33,6 +35,35 @@ void TileInstPrinter::printRegName(raw_ostream &OS, unsigned RegNo) const {
 
 void TileInstPrinter::printInst(const MCInst *MI, raw_ostream &O,
                                 StringRef Annot) {
+  // Bundles come from the disassembler, print them on one line as
+  // "{ a ; b ; c }". An empty bundle is the all FNOP word.
+  if (MI->getOpcode() == TargetOpcode::BUNDLE) {
+    if (MI->getNumOperands() == 0)
+      O << "\tfnop";
+    else if (MI->getNumOperands() == 1)
+      printInstruction(MI->getOperand(0).getInst(), O);
+    else {
+      O << "\t{";
+      for (unsigned i = 0, e = MI->getNumOperands(); i != e; ++i) {
+        std::string Str;
+        raw_string_ostream OS(Str);
+        printInstruction(MI->getOperand(i).getInst(), OS);
+        O << (i ? " ; " : " ");
+        // Squeeze the operand padding to single spaces.
+        StringRef Text = StringRef(OS.str()).trim();
+        for (unsigned j = 0, je = Text.size(); j != je; ++j) {
+          if (!isspace(Text[j]))
+            O << Text[j];
+          else if (!isspace(Text[j - 1]))
+            O << ' ';
+        }
+      }
+      O << " }";
+    }
+    printAnnotation(O, Annot);
+    return;
+  }
+
   printInst((const TileMCInst *)(MI), O, Annot);
 }
 
@@ -24,6 +24,7 @@
 #include "llvm/MC/MCObjectWriter.h"
 #include "llvm/MC/MCSubtargetInfo.h"
 #include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/MathExtras.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/Support/Debug.h"
 
@@ -47,6 +48,11 @@ static uint64_t adjustFixupValue(const MCFixup &Fixup, uint64_t Value) {
     return (Adj_Value & 0x7FFFFFF) << 31;
   }
   case Tile::fixup_Tile_X1_BROFF: {
+    // Solo branches are relaxed, branches inside a bundle can not be. The
+    // packetizer keeps a branch that may be far out of bundles, this only
+    // catches hand written assembly.
+    if (!isInt<17>((int64_t)Value >> 3))
+      report_fatal_error("conditional branch target out of range");
     // inst{36-31} = Value >> 3 {5-0}
     // inst{53-43} = Value >> 3 {16-6}
     uint64_t Adj_Value = Value >> 3;
@@ -57,6 +63,33 @@ static uint64_t adjustFixupValue(const MCFixup &Fixup, uint64_t Value) {
   return Value;
 }
 
+// Return the 16 byte form a solo conditional branch is relaxed to, or 0 if
+// Opc can not be relaxed.
+static unsigned getRelaxedOpcode(unsigned Opc) {
+  switch (Opc) {
+  default:
+    return 0;
+  case Tile::BEQZ:
+  case Tile::BEQZ32:
+    return Tile::BEQZ_LONG;
+  case Tile::BNEZ:
+  case Tile::BNEZ32:
+    return Tile::BNEZ_LONG;
+  case Tile::BLEZ:
+  case Tile::BLEZ32:
+    return Tile::BLEZ_LONG;
+  case Tile::BGTZ:
+  case Tile::BGTZ32:
+    return Tile::BGTZ_LONG;
+  case Tile::BLTZ:
+  case Tile::BLTZ32:
+    return Tile::BLTZ_LONG;
+  case Tile::BGEZ:
+  case Tile::BGEZ32:
+    return Tile::BGEZ_LONG;
+  }
+}
+
 namespace {
 class TileAsmBackend : public MCAsmBackend {
   Triple::OSType OSType;
@@ -79,6 +112,7 @@ public:
       return; // Doesn't change encoding.
 
     unsigned Offset = Fixup.getOffset();
+    assert(Offset + NumBytes <= DataSize && "Invalid fixup offset!");
 
     // For each byte of the fragment that the fixup touches,
     // mask in the bits from the fixup value. The Value has
@@ -109,8 +143,8 @@ public:
       { "fixup_Tile_X1_HW1_LAST", 0, 16, 0 },
       { "fixup_Tile_X0_HW1_LAST_PCREL", 0, 16, MCFixupKindInfo::FKF_IsPCRel },
       { "fixup_Tile_X1_HW1_LAST_PCREL", 0, 16, MCFixupKindInfo::FKF_IsPCRel },
-      { "fixup_Tile_X0_HW1_LAST_GOT", 0, 16, MCFixupKindInfo::FKF_IsPCRel },
-      { "fixup_Tile_X1_HW1_LAST_GOT", 0, 16, MCFixupKindInfo::FKF_IsPCRel },
+      { "fixup_Tile_X0_HW1_LAST_GOT", 0, 16, 0 },
+      { "fixup_Tile_X1_HW1_LAST_GOT", 0, 16, 0 },
       { "fixup_Tile_X0_HW2_LAST", 0, 16, 0 },
       { "fixup_Tile_X1_HW2_LAST", 0, 16, 0 },
       { "fixup_Tile_X1_JUMPOFF", 0, 27, MCFixupKindInfo::FKF_IsPCRel },
@@ -126,25 +160,40 @@ public:
     return Infos[Kind - FirstTargetFixupKind];
   }
 
-  // Check whether the given instruction may need relaxation.
-  bool mayNeedRelaxation(const MCInst &Inst) const { return false; }
+  // Check whether the given instruction may need relaxation. A branch
+  // issued inside a bundle carries its *0_X1 opcode and is never relaxed.
+  // The check is on the opcode, a relaxable fragment keeps a plain MCInst
+  // copy that has lost the TileMCInst issue slot.
+  bool mayNeedRelaxation(const MCInst &Inst) const {
+    return getRelaxedOpcode(Inst.getOpcode()) != 0 &&
+           Inst.getOperand(1).isExpr();
+  }
 
   // Target specific predicate for whether a given fixup
   // requires the associated instruction to be relaxed.
   bool fixupNeedsRelaxation(const MCFixup &Fixup, uint64_t Value,
                             const MCRelaxableFragment *DF,
                             const MCAsmLayout &Layout) const {
-    // FIXME.
-    assert(0 && "RelaxInstruction() unimplemented");
-    return false;
+    // The branch offset is a signed 17 bit count of bundles.
+    return !isInt<17>((int64_t)Value >> 3);
   }
 
   /// Relax the instruction in the given fragment to the next wider instruction.
-  void relaxInstruction(const MCInst &Inst, MCInst &Res) const {}
+  void relaxInstruction(const MCInst &Inst, MCInst &Res) const {
+    Res = Inst;
+    Res.setOpcode(getRelaxedOpcode(Inst.getOpcode()));
+  }
 
   // Write an (optimal) nop sequence of Count bytes to the given output.
   // If the target cannot generate such a sequence, it should return an error.
-  bool writeNopData(uint64_t Count, MCObjectWriter *OW) const { return true; }
+  bool writeNopData(uint64_t Count, MCObjectWriter *OW) const {
+    // Pad with { fnop ; fnop } bundles.
+    if (Count % 8)
+      return false;
+    for (uint64_t i = 0; i != Count; i += 8)
+      OW->Write64(0x286a300051483000ULL);
+    return true;
+  }
 }; // class TileAsmBackend
 
 } // namespace
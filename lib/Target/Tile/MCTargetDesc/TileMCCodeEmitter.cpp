@@ -61,6 +61,10 @@ public:
   void EncodeInstruction(const MCInst &MI, raw_ostream &OS,
                          SmallVectorImpl<MCFixup> &Fixups) const;
 
+  // Emit a relaxed conditional branch as the inverted branch over a jump.
+  void EncodeLongBranch(const MCInst &MI, unsigned InvertedOpc, raw_ostream &OS,
+                        SmallVectorImpl<MCFixup> &Fixups) const;
+
   // TableGen'erated function for getting the binary encoding for
   // an instruction.
   uint64_t getBinaryCodeForInstr(const MCInst &MI,
@@ -91,6 +95,49 @@ MCCodeEmitter *llvm::createTileGXMCCodeEmitter(
   return new TileMCCodeEmitter(MCII, STI, Ctx, true);
 }
 
+// Return the solo branch testing the opposite condition of the relaxed
+// branch Opc, or 0 if Opc is not a relaxed branch.
+static unsigned getInvertedLongBranchOpc(unsigned Opc) {
+  switch (Opc) {
+  default:
+    return 0;
+  case Tile::BEQZ_LONG:
+    return Tile::BNEZ;
+  case Tile::BNEZ_LONG:
+    return Tile::BEQZ;
+  case Tile::BLEZ_LONG:
+    return Tile::BGTZ;
+  case Tile::BGTZ_LONG:
+    return Tile::BLEZ;
+  case Tile::BLTZ_LONG:
+    return Tile::BGEZ;
+  case Tile::BGEZ_LONG:
+    return Tile::BLTZ;
+  }
+}
+
+void TileMCCodeEmitter::EncodeLongBranch(
+    const MCInst &MI, unsigned InvertedOpc, raw_ostream &OS,
+    SmallVectorImpl<MCFixup> &Fixups) const {
+  // {
+  // b<!cond> rs, .+16
+  // j target
+  // }
+  MCInst Branch;
+  Branch.setOpcode(InvertedOpc);
+  Branch.addOperand(MI.getOperand(0));
+  Branch.addOperand(MCOperand::CreateImm(16));
+  EmitInstruction(getBinaryCodeForInstr(Branch, Fixups), 8, OS);
+
+  MCInst Jump;
+  Jump.setOpcode(Tile::J);
+  Jump.addOperand(MI.getOperand(1));
+  unsigned FirstJumpFixup = Fixups.size();
+  EmitInstruction(getBinaryCodeForInstr(Jump, Fixups), 8, OS);
+  for (unsigned i = FirstJumpFixup, e = Fixups.size(); i != e; ++i)
+    Fixups[i].setOffset(Fixups[i].getOffset() + 8);
+}
+
 /// Emit the instruction.
 void TileMCCodeEmitter::EncodeInstruction(
     const MCInst &MI, raw_ostream &OS, SmallVectorImpl<MCFixup> &Fixups) const {
@@ -100,6 +147,15 @@ void TileMCCodeEmitter::EncodeInstruction(
   static bool IsBundling = false;
   static unsigned InstBundleSize = 0;
   static unsigned InstBundledType[3] = { 0 };
+
+  // Relaxed branches come from the assembler as plain MCInsts, they are
+  // always issued solo.
+  if (unsigned InvertedOpc = getInvertedLongBranchOpc(MI.getOpcode())) {
+    assert(!IsBundling && "relaxed branch inner a instruction bundle");
+    EncodeLongBranch(MI, InvertedOpc, OS, Fixups);
+    return;
+  }
+
   const TileMCInst &TileMI = (const TileMCInst &)MI;
   uint64_t Binary = getBinaryCodeForInstr(MI, Fixups);
   const MCInstrDesc &Desc = MCII.get(MI.getOpcode());
@@ -169,6 +225,10 @@ unsigned TileMCCodeEmitter::getBranchTargetOpValue(
     const MCInst &MI, unsigned OpNo, SmallVectorImpl<MCFixup> &Fixups) const {
 
   const MCOperand &MO = MI.getOperand(OpNo);
+  // A resolved byte offset, counted in bundles.
+  if (MO.isImm())
+    return MO.getImm() >> 3;
+
   assert(MO.isExpr() && "getBranchTargetOpValue expects only expressions");
 
   const MCExpr *Expr = MO.getExpr();
@@ -265,8 +325,9 @@ unsigned TileMCCodeEmitter::getMachineOpValue(
     break;
   } // switch
 
+  // The PC-relative kinds follow the X0/X1 pair of their absolute form.
   if (IsPCRel)
-    FixupKind = (Tile::Fixups)((unsigned) FixupKind + 1);
+    FixupKind = (Tile::Fixups)((unsigned) FixupKind + 2);
 
   Fixups.push_back(MCFixup::Create(0, MO.getExpr(), MCFixupKind(FixupKind)));
 
@@ -30,6 +30,9 @@ FunctionPass *createTileDelaySlotFillerPass(TileTargetMachine &TM);
 FunctionPass *createTileExpandPseudoPass(TileTargetMachine &TM);
 FunctionPass *createTileEmitGPRestorePass(TileTargetMachine &TM);
 FunctionPass *createTileVLIWPacketizer();
+FunctionPass *createTileModuloSchedulerPass();
+FunctionPass *createTileWriteHintPass();
+FunctionPass *createTileBitIdiomsPass();
 void LowerTileMachineInstrToMCInst(const MachineInstr *MI, MCInst &OutMI,
                                    AsmPrinter &AP);
 
@@ -149,7 +149,8 @@ void TileAsmPrinter::EmitInstruction(const MachineInstr *MI) {
     while (MII != MBB->end() && MII->isInsideBundle()) {
       const MachineInstr *MInst = MII;
       if (MInst->getOpcode() == TargetOpcode::DBG_VALUE ||
-          MInst->getOpcode() == TargetOpcode::IMPLICIT_DEF) {
+          MInst->getOpcode() == TargetOpcode::IMPLICIT_DEF ||
+          MInst->getOpcode() == TargetOpcode::KILL) {
         IgnoreCount++;
         ++MII;
         continue;
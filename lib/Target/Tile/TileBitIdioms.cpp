@@ -0,0 +1,652 @@
+//===-- TileBitIdioms.cpp - Form crc32 and revbits from portable code -----===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This pass rewrites portable CRC-32 and bit reversal code into the TILE-Gx
+// crc32_8, crc32_32 and revbits instructions, in the spirit of
+// LoopIdiomRecognize. It recognizes
+//
+//  - the table driven byte step, crc = T[(crc ^ b) & 0xff] ^ (crc >> 8),
+//    where T is the constant table of the reflected 0xEDB88320 polynomial,
+//  - the bitwise step, crc = (crc >> 1) ^ (crc & 1 ? 0xEDB88320 : 0), in
+//    its select and mask forms, either unrolled or as the body of a loop
+//    running a multiple of 8 times,
+//  - bit reversal done with shifts and masks, and the loop
+//    r = (r << 1) | (x & 1), x >>= 1 running once for every bit of x.
+//
+// Loops which compute nothing but the replaced value are deleted.
+//
+//===----------------------------------------------------------------------===//
+
+#define DEBUG_TYPE "tile-bit-idioms"
+#include "Tile.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/Analysis/LoopInfo.h"
+#include "llvm/Analysis/ScalarEvolution.h"
+#include "llvm/IR/Constants.h"
+#include "llvm/IR/GlobalVariable.h"
+#include "llvm/IR/IRBuilder.h"
+#include "llvm/IR/IntrinsicInst.h"
+#include "llvm/IR/Intrinsics.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Pass.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/InstIterator.h"
+#include "llvm/Support/PatternMatch.h"
+#include "llvm/Support/ValueHandle.h"
+#include "llvm/Transforms/Utils/Local.h"
+using namespace llvm;
+using namespace PatternMatch;
+
+STATISTIC(NumCRCTableSteps, "Number of table driven CRC-32 steps replaced");
+STATISTIC(NumCRCBitRuns, "Number of bitwise CRC-32 runs replaced");
+STATISTIC(NumRevBits, "Number of bit reversals replaced");
+STATISTIC(NumLoopsDeleted, "Number of idiom loops deleted");
+
+// The reflected CRC-32 polynomial crc32_8 and crc32_32 divide by.
+static const uint64_t CRC32Poly = 0xEDB88320ULL;
+
+// Bound on the expression depth followed when tracking bits.
+static const unsigned MaxBitDepth = 32;
+
+namespace {
+// Where the bits of a value come from: bit i is bit Bits[i] of Provider, or
+// zero if Bits[i] is negative. Provider is null if all bits are zero.
+struct BitSource {
+  Value *Provider;
+  SmallVector<int, 64> Bits;
+};
+
+class TileBitIdioms : public FunctionPass {
+  LoopInfo *LI;
+  ScalarEvolution *SE;
+  Module *M;
+  DenseMap<Value *, BitSource> BitMemo;
+  SmallVector<WeakVH, 16> DeadInsts;
+
+public:
+  static char ID;
+  TileBitIdioms() : FunctionPass(ID) {}
+
+  virtual const char *getPassName() const {
+    return "Tile CRC-32 and Bit Reverse Idioms";
+  }
+
+  virtual void getAnalysisUsage(AnalysisUsage &AU) const {
+    AU.addRequired<LoopInfo>();
+    AU.addRequired<ScalarEvolution>();
+  }
+
+  virtual bool runOnFunction(Function &F);
+
+private:
+  bool runOnLoop(Loop *L);
+  void deleteLoop(Loop *L, Instruction *Live, Value *Result);
+  bool replaceCRCTableSteps(Function &F);
+  bool replaceCRCBitRuns(Function &F);
+  bool replaceRevBits(Function &F);
+  BitSource collectBits(Value *V, unsigned Depth);
+  Value *emitCRCSteps(IRBuilder<> &B, Value *Base, unsigned N);
+  Value *emitRevBits(IRBuilder<> &B, Value *X);
+};
+char TileBitIdioms::ID = 0;
+} // end of anonymous namespace
+
+static bool isCRC32Poly(Value *V) {
+  ConstantInt *CI = dyn_cast<ConstantInt>(V);
+  return CI && CI->getType()->isIntegerTy(32) &&
+         CI->getZExtValue() == CRC32Poly;
+}
+
+// Return true if Cond is set exactly when bit 0 of C is, or exactly when it
+// is clear if Inverted is set on return.
+static bool matchBit0(Value *Cond, Value *&C, bool &Inverted) {
+  ICmpInst::Predicate Pred;
+  Value *X;
+  if (Cond->getType()->isIntegerTy(1) && match(Cond, m_Trunc(m_Value(X)))) {
+    C = X;
+    Inverted = false;
+    return true;
+  }
+  if (match(Cond, m_ICmp(Pred, m_And(m_Value(X), m_One()), m_Zero())) &&
+      ICmpInst::isEquality(Pred)) {
+    C = X;
+    Inverted = Pred == ICmpInst::ICMP_EQ;
+    return true;
+  }
+  if (match(Cond, m_ICmp(Pred, m_And(m_Value(X), m_One()), m_One())) &&
+      ICmpInst::isEquality(Pred)) {
+    C = X;
+    Inverted = Pred == ICmpInst::ICMP_NE;
+    return true;
+  }
+  return false;
+}
+
+// Return C if V is all ones when bit 0 of C is set and zero otherwise.
+static Value *matchBit0Mask(Value *V) {
+  Value *C, *Cond, *T, *F;
+  bool Inverted;
+  ConstantInt *Amt1, *Amt2;
+  // -(c & 1)
+  if (match(V, m_Sub(m_Zero(), m_And(m_Value(C), m_One()))))
+    return C;
+  // (c << 31) >> 31, what instcombine makes of the negation.
+  if (match(V, m_AShr(m_Shl(m_Value(C), m_ConstantInt(Amt1)),
+                      m_ConstantInt(Amt2))) &&
+      Amt1 == Amt2 && Amt1->getZExtValue() == 31)
+    return C;
+  if (match(V, m_SExt(m_Value(Cond))) && matchBit0(Cond, C, Inverted) &&
+      !Inverted)
+    return C;
+  if (match(V, m_Select(m_Value(Cond), m_Value(T), m_Value(F))) &&
+      matchBit0(Cond, C, Inverted)) {
+    if (Inverted)
+      std::swap(T, F);
+    if (match(T, m_AllOnes()) && match(F, m_Zero()))
+      return C;
+  }
+  return 0;
+}
+
+// Return C if V is the polynomial when bit 0 of C is set and zero otherwise.
+static Value *matchPolyIfBit0(Value *V) {
+  Value *C, *Cond, *T, *F;
+  bool Inverted;
+  if (match(V, m_Select(m_Value(Cond), m_Value(T), m_Value(F))) &&
+      matchBit0(Cond, C, Inverted)) {
+    if (Inverted)
+      std::swap(T, F);
+    return isCRC32Poly(T) && match(F, m_Zero()) ? C : 0;
+  }
+
+  BinaryOperator *BO = dyn_cast<BinaryOperator>(V);
+  if (!BO || (BO->getOpcode() != Instruction::And &&
+              BO->getOpcode() != Instruction::Mul))
+    return 0;
+  Value *Mask = BO->getOperand(0), *Poly = BO->getOperand(1);
+  if (!isCRC32Poly(Poly))
+    std::swap(Mask, Poly);
+  if (!isCRC32Poly(Poly))
+    return 0;
+  // (c & 1) * Poly
+  if (BO->getOpcode() == Instruction::Mul)
+    return match(Mask, m_And(m_Value(C), m_One())) ? C : 0;
+  return matchBit0Mask(Mask);
+}
+
+// Return the input of V if V is one bitwise CRC-32 step.
+static Value *matchCRCBitStep(Value *V) {
+  if (!V->getType()->isIntegerTy(32))
+    return 0;
+
+  // (c >> 1) ^ (c & 1 ? Poly : 0)
+  Value *C;
+  if (BinaryOperator *BO = dyn_cast<BinaryOperator>(V))
+    if (BO->getOpcode() == Instruction::Xor)
+      for (unsigned i = 0; i != 2; ++i)
+        if (match(BO->getOperand(i), m_LShr(m_Value(C), m_One())) &&
+            matchPolyIfBit0(BO->getOperand(1 - i)) == C)
+          return C;
+
+  // c & 1 ? (c >> 1) ^ Poly : c >> 1
+  Value *Cond, *T, *F;
+  bool Inverted;
+  if (!match(V, m_Select(m_Value(Cond), m_Value(T), m_Value(F))) ||
+      !matchBit0(Cond, C, Inverted))
+    return 0;
+  if (Inverted)
+    std::swap(T, F);
+  Value *X, *Poly;
+  if (!match(F, m_LShr(m_Specific(C), m_One())) ||
+      !match(T, m_Xor(m_Value(X), m_Value(Poly))))
+    return 0;
+  if (!isCRC32Poly(Poly))
+    std::swap(X, Poly);
+  if (isCRC32Poly(Poly) && match(X, m_LShr(m_Specific(C), m_One())))
+    return C;
+  return 0;
+}
+
+// Return true if V is a constant table of the 256 byte steps.
+static bool isCRC32Table(Value *V) {
+  GlobalVariable *GV = dyn_cast<GlobalVariable>(V);
+  if (!GV || !GV->isConstant() || !GV->hasDefinitiveInitializer())
+    return false;
+  ConstantDataArray *Init = dyn_cast<ConstantDataArray>(GV->getInitializer());
+  if (!Init || Init->getNumElements() != 256 ||
+      !Init->getElementType()->isIntegerTy(32))
+    return false;
+  for (unsigned i = 0; i != 256; ++i) {
+    uint64_t Entry = i;
+    for (unsigned k = 0; k != 8; ++k)
+      Entry = (Entry >> 1) ^ (Entry & 1 ? CRC32Poly : 0);
+    if (Init->getElementAsInteger(i) != Entry)
+      return false;
+  }
+  return true;
+}
+
+// Return the input of V if V is one table driven CRC-32 step, and set Data
+// to the value xored into the index, or null if there is none.
+static Value *matchCRCTableStep(Value *V, Value *&Data) {
+  BinaryOperator *BO = dyn_cast<BinaryOperator>(V);
+  if (!V->getType()->isIntegerTy(32) || !BO ||
+      BO->getOpcode() != Instruction::Xor)
+    return 0;
+
+  for (unsigned i = 0; i != 2; ++i) {
+    Value *C;
+    LoadInst *LD = dyn_cast<LoadInst>(BO->getOperand(1 - i));
+    if (!LD || !LD->isSimple() ||
+        !match(BO->getOperand(i), m_LShr(m_Value(C), m_ConstantInt<8>())))
+      continue;
+    GetElementPtrInst *GEP = dyn_cast<GetElementPtrInst>(LD->getOperand(0));
+    if (!GEP || GEP->getNumIndices() != 2 ||
+        !match(GEP->getOperand(1), m_Zero()) ||
+        !isCRC32Table(GEP->getPointerOperand()))
+      continue;
+
+    // The index is the low byte of c, or of c ^ data.
+    Value *Idx = GEP->getOperand(2), *X;
+    if (ZExtInst *ZI = dyn_cast<ZExtInst>(Idx))
+      Idx = ZI->getOperand(0);
+    if (!match(Idx, m_And(m_Value(X), m_ConstantInt<255>())) &&
+        !(Idx->getType()->isIntegerTy(8) && match(Idx, m_Trunc(m_Value(X)))))
+      continue;
+    if (ZExtInst *ZI = dyn_cast<ZExtInst>(X))
+      X = ZI->getOperand(0);
+
+    Value *D;
+    if (X == C) {
+      Data = 0;
+      return C;
+    }
+    if (match(X, m_Xor(m_Specific(C), m_Value(D))) ||
+        match(X, m_Xor(m_Value(D), m_Specific(C)))) {
+      Data = D;
+      return C;
+    }
+  }
+  return 0;
+}
+
+// Return true if only the low Width bits of the i32 value V can be set.
+static bool fitsIn(Value *V, unsigned Width) {
+  if (Width >= 32)
+    return true;
+  if (ZExtInst *ZI = dyn_cast<ZExtInst>(V))
+    return ZI->getSrcTy()->getIntegerBitWidth() <= Width;
+  ConstantInt *Mask;
+  return match(V, m_And(m_Value(), m_ConstantInt(Mask))) &&
+         Mask->getZExtValue() < (1ULL << Width);
+}
+
+// Apply N bitwise CRC-32 steps, N a multiple of 8, to the i32 Base.
+Value *TileBitIdioms::emitCRCSteps(IRBuilder<> &B, Value *Base, unsigned N) {
+  Type *I64 = B.getInt64Ty();
+
+  // Data xored in just before the steps is the second operand of the
+  // first instruction, as long as it fits in the bits that one consumes.
+  unsigned First = N >= 32 ? 32 : 8;
+  Value *Acc = Base, *Data = 0;
+  if (BinaryOperator *BO = dyn_cast<BinaryOperator>(Base))
+    if (BO->getOpcode() == Instruction::Xor)
+      for (unsigned i = 0; i != 2 && !Data; ++i)
+        if (fitsIn(BO->getOperand(i), First)) {
+          Data = BO->getOperand(i);
+          Acc = BO->getOperand(1 - i);
+        }
+
+  Value *Acc64 = B.CreateZExt(Acc, I64);
+  Value *Data64 = Data ? B.CreateZExt(Data, I64) : B.getInt64(0);
+  for (unsigned Done = 0; Done != N;) {
+    unsigned Steps = N - Done >= 32 ? 32 : 8;
+    Intrinsic::ID IID =
+        Steps == 32 ? Intrinsic::tilegx_crc32_32 : Intrinsic::tilegx_crc32_8;
+    Function *CRC = Intrinsic::getDeclaration(M, IID);
+    Acc64 = B.CreateCall2(CRC, Acc64, Data64);
+    Data64 = B.getInt64(0);
+    Done += Steps;
+  }
+  return B.CreateTrunc(Acc64, Base->getType());
+}
+
+Value *TileBitIdioms::emitRevBits(IRBuilder<> &B, Value *X) {
+  Type *I64 = B.getInt64Ty();
+  Function *RevBits = Intrinsic::getDeclaration(M, Intrinsic::tilegx_revbits);
+  if (X->getType() == I64)
+    return B.CreateCall(RevBits, X);
+
+  // The low word lands in the high word, shift it back down.
+  Value *R = B.CreateCall(RevBits, B.CreateSExt(X, I64));
+  return B.CreateTrunc(B.CreateAShr(R, 32), X->getType());
+}
+
+bool TileBitIdioms::runOnFunction(Function &F) {
+  LI = &getAnalysis<LoopInfo>();
+  SE = &getAnalysis<ScalarEvolution>();
+  M = F.getParent();
+
+  // The loop forms first, before the loop analyses go stale.
+  SmallVector<Loop *, 8> Worklist(LI->begin(), LI->end());
+  SmallVector<Loop *, 8> Innermost;
+  while (!Worklist.empty()) {
+    Loop *L = Worklist.pop_back_val();
+    if (L->empty())
+      Innermost.push_back(L);
+    Worklist.append(L->begin(), L->end());
+  }
+
+  bool Changed = false;
+  for (unsigned i = 0, e = Innermost.size(); i != e; ++i)
+    Changed |= runOnLoop(Innermost[i]);
+
+  Changed |= replaceCRCTableSteps(F);
+  Changed |= replaceCRCBitRuns(F);
+  Changed |= replaceRevBits(F);
+
+  BitMemo.clear();
+  // Replaced values may feed each other, some are gone by their turn.
+  while (!DeadInsts.empty())
+    if (Value *V = DeadInsts.pop_back_val())
+      RecursivelyDeleteTriviallyDeadInstructions(V);
+  return Changed;
+}
+
+bool TileBitIdioms::runOnLoop(Loop *L) {
+  BasicBlock *Header = L->getHeader();
+  BasicBlock *Preheader = L->getLoopPreheader();
+  BasicBlock *Exit = L->getExitBlock();
+  if (L->getNumBlocks() != 1 || !Preheader || !Exit)
+    return false;
+
+  unsigned TripCount = SE->getSmallConstantTripCount(L, Header);
+  if (!TripCount)
+    return false;
+
+  for (BasicBlock::iterator I = Header->begin(), E = Header->end(); I != E;
+       ++I)
+    if (!isa<TerminatorInst>(I) && I->mayHaveSideEffects())
+      return false;
+
+  Instruction *Live = 0;
+  Value *Init = 0;
+  bool IsCRC = false;
+  for (BasicBlock::iterator I = Header->begin(); isa<PHINode>(I); ++I) {
+    PHINode *PN = cast<PHINode>(I);
+    Instruction *Next =
+        dyn_cast<Instruction>(PN->getIncomingValueForBlock(Header));
+    if (!Next)
+      continue;
+
+    // crc = step(crc), a multiple of 8 times.
+    if (TripCount % 8 == 0 && matchCRCBitStep(Next) == PN) {
+      Live = Next;
+      Init = PN->getIncomingValueForBlock(Preheader);
+      IsCRC = true;
+      break;
+    }
+
+    // r = (r << 1) | (x & 1), x >>= 1, once for every bit of x. The initial
+    // value of r is shifted out entirely.
+    unsigned Width = PN->getType()->getPrimitiveSizeInBits();
+    if ((Width != 32 && Width != 64) || TripCount != Width)
+      continue;
+    BinaryOperator *BO = dyn_cast<BinaryOperator>(Next);
+    if (!BO || (BO->getOpcode() != Instruction::Or &&
+                BO->getOpcode() != Instruction::Add))
+      continue;
+    for (unsigned j = 0; j != 2 && !Live; ++j) {
+      Value *X;
+      if (!match(BO->getOperand(j), m_Shl(m_Specific(PN), m_One())) ||
+          !match(BO->getOperand(1 - j), m_And(m_Value(X), m_One())))
+        continue;
+      PHINode *XPN = dyn_cast<PHINode>(X);
+      if (!XPN || XPN->getParent() != Header)
+        continue;
+      Value *XNext = XPN->getIncomingValueForBlock(Header);
+      if (match(XNext, m_LShr(m_Specific(XPN), m_One())) ||
+          match(XNext, m_AShr(m_Specific(XPN), m_One()))) {
+        Live = Next;
+        Init = XPN->getIncomingValueForBlock(Preheader);
+      }
+    }
+    if (Live)
+      break;
+  }
+  if (!Live)
+    return false;
+
+  // Nothing else may be seen outside of the loop.
+  for (BasicBlock::iterator I = Header->begin(), E = Header->end(); I != E;
+       ++I) {
+    if (&*I == Live)
+      continue;
+    for (Value::use_iterator UI = I->use_begin(), UE = I->use_end(); UI != UE;
+         ++UI)
+      if (cast<Instruction>(*UI)->getParent() != Header)
+        return false;
+  }
+
+  DEBUG(dbgs() << "Tile bit idioms: replacing loop computing " << *Live
+               << '\n');
+  IRBuilder<> B(Preheader->getTerminator());
+  Value *Result;
+  if (IsCRC) {
+    Result = emitCRCSteps(B, Init, TripCount);
+    ++NumCRCBitRuns;
+  } else {
+    Result = emitRevBits(B, Init);
+    ++NumRevBits;
+  }
+  deleteLoop(L, Live, Result);
+  return true;
+}
+
+// Branch around the single block loop L, using Result in place of Live.
+void TileBitIdioms::deleteLoop(Loop *L, Instruction *Live, Value *Result) {
+  BasicBlock *Header = L->getHeader();
+  BasicBlock *Preheader = L->getLoopPreheader();
+  BasicBlock *Exit = L->getExitBlock();
+
+  for (Value::use_iterator UI = Live->use_begin(); UI != Live->use_end();) {
+    Use &U = UI.getUse();
+    ++UI;
+    if (cast<Instruction>(U.getUser())->getParent() != Header)
+      U.set(Result);
+  }
+
+  Preheader->getTerminator()->replaceUsesOfWith(Header, Exit);
+  for (BasicBlock::iterator I = Exit->begin(); isa<PHINode>(I); ++I) {
+    PHINode *PN = cast<PHINode>(I);
+    PN->setIncomingBlock(PN->getBasicBlockIndex(Header), Preheader);
+  }
+
+  SE->forgetLoop(L);
+  Header->dropAllReferences();
+  LI->removeBlock(Header);
+  LI->updateUnloop(L);
+  delete L;
+  Header->eraseFromParent();
+  ++NumLoopsDeleted;
+}
+
+bool TileBitIdioms::replaceCRCTableSteps(Function &F) {
+  bool Changed = false;
+  for (inst_iterator I = inst_begin(F), E = inst_end(F); I != E; ++I) {
+    Value *Data;
+    Value *C = matchCRCTableStep(&*I, Data);
+    if (!C)
+      continue;
+
+    DEBUG(dbgs() << "Tile bit idioms: replacing table step " << *I << '\n');
+    IRBuilder<> B(&*I);
+    Type *I64 = B.getInt64Ty();
+    Function *CRC = Intrinsic::getDeclaration(M, Intrinsic::tilegx_crc32_8);
+    Value *Step =
+        B.CreateCall2(CRC, B.CreateZExt(C, I64),
+                      Data ? B.CreateZExt(Data, I64) : B.getInt64(0));
+    I->replaceAllUsesWith(B.CreateTrunc(Step, I->getType()));
+    DeadInsts.push_back(&*I);
+    ++NumCRCTableSteps;
+    Changed = true;
+  }
+  return Changed;
+}
+
+bool TileBitIdioms::replaceCRCBitRuns(Function &F) {
+  DenseMap<Value *, Value *> StepInput;
+  SmallPtrSet<Value *, 16> Inputs;
+  SmallVector<Instruction *, 16> Steps;
+  for (inst_iterator I = inst_begin(F), E = inst_end(F); I != E; ++I)
+    if (Value *C = matchCRCBitStep(&*I)) {
+      StepInput[&*I] = C;
+      Inputs.insert(C);
+      Steps.push_back(&*I);
+    }
+
+  bool Changed = false;
+  for (unsigned i = 0, e = Steps.size(); i != e; ++i) {
+    // Walk back from the last step of each run.
+    if (Inputs.count(Steps[i]))
+      continue;
+    SmallVector<Instruction *, 32> Run;
+    Value *Base = Steps[i];
+    for (DenseMap<Value *, Value *>::iterator It = StepInput.find(Base);
+         It != StepInput.end(); It = StepInput.find(Base)) {
+      Run.push_back(cast<Instruction>(It->first));
+      Base = It->second;
+    }
+    unsigned N = Run.size() & ~7U;
+    if (!N)
+      continue;
+
+    // Run is in reverse order, the value after N steps is Run[size - N].
+    Instruction *At = Run[Run.size() - N];
+    DEBUG(dbgs() << "Tile bit idioms: replacing " << N << " steps ending at "
+                 << *At << '\n');
+    IRBuilder<> B(At);
+    At->replaceAllUsesWith(emitCRCSteps(B, Base, N));
+    DeadInsts.push_back(At);
+    ++NumCRCBitRuns;
+    Changed = true;
+  }
+  return Changed;
+}
+
+BitSource TileBitIdioms::collectBits(Value *V, unsigned Depth) {
+  DenseMap<Value *, BitSource>::iterator It = BitMemo.find(V);
+  if (It != BitMemo.end())
+    return It->second;
+
+  // By default V is its own source.
+  unsigned Width = V->getType()->getPrimitiveSizeInBits();
+  BitSource Res;
+  Res.Provider = V;
+  for (unsigned i = 0; i != Width; ++i)
+    Res.Bits.push_back(i);
+
+  Instruction *I = dyn_cast<Instruction>(V);
+  ConstantInt *CI;
+  if (!I || Depth >= MaxBitDepth) {
+    // Leave V as its own source.
+  } else if (I->getOpcode() == Instruction::Or) {
+    BitSource A = collectBits(I->getOperand(0), Depth + 1);
+    BitSource B = collectBits(I->getOperand(1), Depth + 1);
+    if (!A.Provider || !B.Provider || A.Provider == B.Provider) {
+      BitSource Merged;
+      Merged.Provider = A.Provider ? A.Provider : B.Provider;
+      bool Overlap = false;
+      for (unsigned i = 0; i != Width && !Overlap; ++i) {
+        int Bit = A.Bits[i] < 0 ? B.Bits[i] : A.Bits[i];
+        Overlap = A.Bits[i] >= 0 && B.Bits[i] >= 0 && A.Bits[i] != B.Bits[i];
+        Merged.Bits.push_back(Bit);
+      }
+      if (!Overlap)
+        Res = Merged;
+    }
+  } else if (I->getOpcode() == Instruction::And &&
+             (CI = dyn_cast<ConstantInt>(I->getOperand(1)))) {
+    Res = collectBits(I->getOperand(0), Depth + 1);
+    uint64_t Mask = CI->getZExtValue();
+    for (unsigned i = 0; i != Width; ++i)
+      if (!(Mask & (1ULL << i)))
+        Res.Bits[i] = -1;
+  } else if ((I->getOpcode() == Instruction::Shl ||
+              I->getOpcode() == Instruction::LShr) &&
+             (CI = dyn_cast<ConstantInt>(I->getOperand(1))) &&
+             CI->getZExtValue() < Width) {
+    BitSource Src = collectBits(I->getOperand(0), Depth + 1);
+    unsigned Amt = CI->getZExtValue();
+    bool Left = I->getOpcode() == Instruction::Shl;
+    Res.Provider = Src.Provider;
+    for (unsigned i = 0; i != Width; ++i) {
+      if (Left)
+        Res.Bits[i] = i >= Amt ? Src.Bits[i - Amt] : -1;
+      else
+        Res.Bits[i] = i + Amt < Width ? Src.Bits[i + Amt] : -1;
+    }
+  } else if (IntrinsicInst *II = dyn_cast<IntrinsicInst>(I)) {
+    if (II->getIntrinsicID() == Intrinsic::bswap) {
+      BitSource Src = collectBits(II->getArgOperand(0), Depth + 1);
+      Res.Provider = Src.Provider;
+      for (unsigned i = 0; i != Width; ++i)
+        Res.Bits[i] = Src.Bits[Width - 8 - (i & ~7U) + (i & 7)];
+    }
+  }
+
+  // All zero bits have no provider.
+  bool AllZero = true;
+  for (unsigned i = 0; i != Width && AllZero; ++i)
+    AllZero = Res.Bits[i] < 0;
+  if (AllZero)
+    Res.Provider = 0;
+
+  BitMemo[V] = Res;
+  return Res;
+}
+
+bool TileBitIdioms::replaceRevBits(Function &F) {
+  SmallVector<std::pair<Instruction *, Value *>, 4> Reversals;
+  for (inst_iterator I = inst_begin(F), E = inst_end(F); I != E; ++I) {
+    Type *Ty = I->getType();
+    if (!Ty->isIntegerTy(32) && !Ty->isIntegerTy(64))
+      continue;
+    IntrinsicInst *II = dyn_cast<IntrinsicInst>(&*I);
+    if (I->getOpcode() != Instruction::Or &&
+        !(II && II->getIntrinsicID() == Intrinsic::bswap))
+      continue;
+
+    BitSource Src = collectBits(&*I, 0);
+    if (!Src.Provider || Src.Provider == &*I)
+      continue;
+    unsigned Width = Ty->getPrimitiveSizeInBits();
+    bool Reversed = true;
+    for (unsigned i = 0; i != Width && Reversed; ++i)
+      Reversed = Src.Bits[i] == int(Width - 1 - i);
+    if (Reversed)
+      Reversals.push_back(std::make_pair(&*I, Src.Provider));
+  }
+
+  for (unsigned i = 0, e = Reversals.size(); i != e; ++i) {
+    Instruction *I = Reversals[i].first;
+    DEBUG(dbgs() << "Tile bit idioms: replacing bit reversal " << *I << '\n');
+    IRBuilder<> B(I);
+    I->replaceAllUsesWith(emitRevBits(B, Reversals[i].second));
+    DeadInsts.push_back(I);
+    ++NumRevBits;
+  }
+  return !Reversals.empty();
+}
+
+FunctionPass *llvm::createTileBitIdiomsPass() {
+  return new TileBitIdioms();
+}
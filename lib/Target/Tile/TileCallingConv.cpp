@@ -0,0 +1,78 @@
+//===-- TileCallingConv.cpp - Tile Custom Calling Convention Routines -----===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file contains the custom routines for the Tile Calling Convention that
+// aren't done by tablegen.
+//
+//===----------------------------------------------------------------------===//
+
+#include "TileCallingConv.h"
+#include "llvm/Support/MathExtras.h"
+
+using namespace llvm;
+
+const uint16_t llvm::TileIntRegs[TILEGX_AREG_NUM] = {
+  Tile::R0, Tile::R1, Tile::R2, Tile::R3, Tile::R4, Tile::R5, Tile::R6,
+  Tile::R7, Tile::R8, Tile::R9
+};
+
+// Byval arguments are passed in consecutive integer argument registers,
+// spilling to the caller's stack once they run out.
+bool llvm::CC_TileByval(unsigned ValNo, MVT ValVT, MVT LocVT,
+                        CCValAssign::LocInfo LocInfo,
+                        ISD::ArgFlagsTy ArgFlags, CCState &State) {
+  unsigned Align = std::max(ArgFlags.getByValAlign(), (unsigned) 8);
+  unsigned Size = RoundUpToAlignment(ArgFlags.getByValSize(), Align);
+  unsigned FirstIdx = State.getFirstUnallocated(TileIntRegs, TILEGX_AREG_NUM);
+
+  assert(Align <= 16 && "Cannot handle alignments larger than 16.");
+
+  // If byval is 16-byte aligned, the first arg register must be even.
+  if ((Align == 16) && (FirstIdx % 2)) {
+    State.AllocateReg(TileIntRegs[FirstIdx]);
+    ++FirstIdx;
+  }
+
+  // Mark the registers allocated.
+  for (unsigned I = FirstIdx; Size && (I < TILEGX_AREG_NUM); Size -= 8, ++I)
+    State.AllocateReg(TileIntRegs[I]);
+
+  // Allocate space on caller's stack.
+  unsigned Offset = State.AllocateStack(Size, Align);
+
+  if (FirstIdx < TILEGX_AREG_NUM)
+    State.addLoc(CCValAssign::getReg(ValNo, ValVT, TileIntRegs[FirstIdx], LocVT,
+                                     LocInfo));
+  else
+    State.addLoc(CCValAssign::getMem(ValNo, ValVT, Offset, LocVT, LocInfo));
+
+  return true;
+}
+
+// For Tile, the stack frame have a special zone, the bottom
+// 16bytes are reserved to keep incoming sp/lr, so both
+// incoming and outgoing args on stack should be lifted by 16bytes.
+bool llvm::CC_Tile_StackArg(unsigned &ValNo, MVT &ValVT, MVT &LocVT,
+                            CCValAssign::LocInfo &LocInfo,
+                            ISD::ArgFlagsTy &ArgFlags, CCState &State) {
+
+  if (LocVT == MVT::i32 || LocVT == MVT::f32) {
+    unsigned Offset4 = State.AllocateStack(4, 8) + 16;
+    State.addLoc(CCValAssign::getMem(ValNo, ValVT, Offset4, LocVT, LocInfo));
+    return true;
+  }
+
+  if (LocVT == MVT::i64 || LocVT == MVT::f64) {
+    unsigned Offset5 = State.AllocateStack(8, 8) + 16;
+    State.addLoc(CCValAssign::getMem(ValNo, ValVT, Offset5, LocVT, LocInfo));
+    return true;
+  }
+
+  return false;
+}
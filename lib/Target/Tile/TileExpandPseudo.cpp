@@ -10,12 +10,20 @@
 // This pass expands pseudo instructions into target instructions after register
 // allocation but before post-RA scheduling.
 //
+// Network reads and sends are also folded into the instruction that consumes
+// or produces the word when possible, so e.g. "add r0, zero, udn0" followed by
+// "add r2, r0, r1" becomes "add r2, udn0, r1". Every instruction touching a
+// network is given implicit defs of all of that network's registers, which
+// keeps accesses in program order through the post-RA scheduler and keeps
+// them out of each other's bundles.
+//
 //===----------------------------------------------------------------------===//
 
 #define DEBUG_TYPE "tile-expand-pseudo"
 
 #include "Tile.h"
 #include "TileTargetMachine.h"
+#include "MCTargetDesc/TileBaseInfo.h"
 #include "llvm/CodeGen/MachineFunctionPass.h"
 #include "llvm/CodeGen/MachineInstrBuilder.h"
 #include "llvm/Target/TargetInstrInfo.h"
@@ -23,6 +31,13 @@
 
 using namespace llvm;
 
+STATISTIC(NumNetReadsFolded, "Number of network reads folded into their user");
+STATISTIC(NumNetSendsFolded, "Number of network sends folded into their def");
+
+static const uint16_t UDNRegs[] = { Tile::UDN0, Tile::UDN1, Tile::UDN2,
+                                    Tile::UDN3 };
+static const uint16_t IDNRegs[] = { Tile::IDN0, Tile::IDN1 };
+
 namespace {
 struct TileExpandPseudo : public MachineFunctionPass {
 
@@ -44,6 +59,12 @@ private:
   void ExpandBuildPairF64(MachineBasicBlock &, MachineBasicBlock::iterator);
   void
   ExpandExtractElementF64(MachineBasicBlock &, MachineBasicBlock::iterator);
+
+  bool isNetworkAccess(const MachineInstr *MI) const;
+  bool canAccessNetwork(const MachineInstr *MI) const;
+  void addNetworkOrdering(MachineInstr *MI, unsigned NetReg);
+  bool foldNetworkRead(MachineBasicBlock &MBB, MachineInstr *MI);
+  bool foldNetworkSend(MachineBasicBlock &MBB, MachineInstr *MI);
 };
 char TileExpandPseudo::ID = 0;
 } // end of anonymous namespace
@@ -75,10 +96,17 @@ bool TileExpandPseudo::runOnMachineBasicBlock(MachineBasicBlock &MBB) {
       unsigned SrbReg = I->getOperand(2).getReg();
       if ((SraReg == Tile::UDN0  && SrbReg != Tile::ZERO)
 	      || (SraReg == Tile::IDN0 && SrbReg != Tile::ZERO)) {
-        BuildMI(MBB, I, I->getDebugLoc(), TII->get(Tile::ADD),
-                I->getOperand(1).getReg()).addReg(Tile::ZERO).addReg(SrbReg);
+        if (!foldNetworkSend(MBB, I)) {
+          MachineInstr *Send =
+              BuildMI(MBB, I, I->getDebugLoc(), TII->get(Tile::ADD), SraReg)
+                  .addReg(Tile::ZERO).addReg(SrbReg);
+          addNetworkOrdering(Send, SraReg);
+        }
         break;
       } else {
+        if (foldNetworkRead(MBB, I))
+          break;
+        addNetworkOrdering(I, SrbReg);
         ++I;
         continue;
       }
@@ -300,6 +328,164 @@ bool TileExpandPseudo::runOnMachineBasicBlock(MachineBasicBlock &MBB) {
   return Changed;
 }
 
+static const uint16_t *getNetworkRegs(unsigned Reg, unsigned &Num) {
+  for (unsigned i = 0; i != array_lengthof(UDNRegs); ++i)
+    if (Reg == UDNRegs[i]) {
+      Num = array_lengthof(UDNRegs);
+      return UDNRegs;
+    }
+  for (unsigned i = 0; i != array_lengthof(IDNRegs); ++i)
+    if (Reg == IDNRegs[i]) {
+      Num = array_lengthof(IDNRegs);
+      return IDNRegs;
+    }
+  Num = 0;
+  return 0;
+}
+
+// Returns true if MI reads or writes a network register, or may do so
+// behind our back.
+bool TileExpandPseudo::isNetworkAccess(const MachineInstr *MI) const {
+  if (MI->isCall() || MI->isInlineAsm() || MI->hasUnmodeledSideEffects() ||
+      MI->getOpcode() == Tile::NET)
+    return true;
+
+  const TargetRegisterInfo *TRI = TM.getRegisterInfo();
+  for (unsigned i = 0, e = MI->getNumOperands(); i != e; ++i) {
+    const MachineOperand &MO = MI->getOperand(i);
+    if (!MO.isReg() || !MO.getReg())
+      continue;
+    for (unsigned j = 0; j != array_lengthof(UDNRegs); ++j)
+      if (TRI->regsOverlap(MO.getReg(), UDNRegs[j]))
+        return true;
+    for (unsigned j = 0; j != array_lengthof(IDNRegs); ++j)
+      if (TRI->regsOverlap(MO.getReg(), IDNRegs[j]))
+        return true;
+  }
+  return false;
+}
+
+// Returns true if MI is a plain compute instruction which may name a network
+// register in place of one of its register operands.
+bool TileExpandPseudo::canAccessNetwork(const MachineInstr *MI) const {
+  const MCInstrDesc &MCID = MI->getDesc();
+  return !MI->isPseudo() && !MCID.isCall() && !MCID.isBranch() &&
+         !MCID.isReturn() && !MCID.mayLoad() && !MCID.mayStore() &&
+         !MCID.hasUnmodeledSideEffects() && !MCID.getImplicitDefs() &&
+         !MCID.getImplicitUses() &&
+         !((MCID.TSFlags >> TileII::SoloPos) & TileII::SoloMask);
+}
+
+// Each network delivers words in order, make MI define every register of the
+// network NetReg belongs to so that accesses to it stay ordered.
+void TileExpandPseudo::addNetworkOrdering(MachineInstr *MI, unsigned NetReg) {
+  const TargetRegisterInfo *TRI = TM.getRegisterInfo();
+  unsigned Num;
+  const uint16_t *Regs = getNetworkRegs(NetReg, Num);
+  MachineInstrBuilder MIB(*MI->getParent()->getParent(), MI);
+  for (unsigned i = 0; i != Num; ++i)
+    if (!MI->modifiesRegister(Regs[i], TRI))
+      MIB.addReg(Regs[i], RegState::ImplicitDefine);
+}
+
+// Fold "NET dst, zero, netreg" into the single following instruction that
+// reads dst, provided nothing in between touches a network.
+bool TileExpandPseudo::foldNetworkRead(MachineBasicBlock &MBB,
+                                       MachineInstr *MI) {
+  if (TM.getOptLevel() == CodeGenOpt::None)
+    return false;
+
+  const TargetRegisterInfo *TRI = TM.getRegisterInfo();
+  unsigned Dst = MI->getOperand(0).getReg();
+  unsigned NetReg = MI->getOperand(2).getReg();
+
+  MachineBasicBlock::iterator I = MI;
+  for (++I; I != MBB.end(); ++I) {
+    if (I->isDebugValue())
+      continue;
+
+    int UseIdx = -1;
+    for (unsigned i = 0, e = I->getNumOperands(); i != e; ++i) {
+      const MachineOperand &MO = I->getOperand(i);
+      if (!MO.isReg() || !MO.isUse() || !TRI->regsOverlap(MO.getReg(), Dst))
+        continue;
+      // Every read pops a word, the user must read it exactly once.
+      if (UseIdx != -1)
+        return false;
+      UseIdx = i;
+    }
+
+    if (UseIdx == -1) {
+      if (I->modifiesRegister(Dst, TRI) || isNetworkAccess(I))
+        return false;
+      continue;
+    }
+
+    MachineOperand &MO = I->getOperand(UseIdx);
+    if (!canAccessNetwork(I) || isNetworkAccess(I) || MO.isImplicit() ||
+        MO.isTied() || !MO.isKill())
+      return false;
+
+    unsigned Reg = NetReg;
+    if (MO.getReg() != Dst) {
+      // A 32-bit user reads the low half of the word.
+      if (MO.getReg() != TRI->getSubReg(Dst, Tile::sub_32))
+        return false;
+      Reg = TRI->getSubReg(NetReg, Tile::sub_32);
+    }
+    MO.setReg(Reg);
+    MO.setIsKill(false);
+    addNetworkOrdering(I, NetReg);
+    ++NumNetReadsFolded;
+    return true;
+  }
+  return false;
+}
+
+// Fold "NET netreg, src" into the instruction in front of it which computes
+// src, so that the result is written straight to the network.
+bool TileExpandPseudo::foldNetworkSend(MachineBasicBlock &MBB,
+                                       MachineInstr *MI) {
+  if (TM.getOptLevel() == CodeGenOpt::None || !MI->getOperand(2).isKill())
+    return false;
+
+  const TargetRegisterInfo *TRI = TM.getRegisterInfo();
+  unsigned NetReg = MI->getOperand(1).getReg();
+  unsigned Src = MI->getOperand(2).getReg();
+
+  MachineBasicBlock::iterator I = MI;
+  while (I != MBB.begin()) {
+    --I;
+    if (I->isDebugValue())
+      continue;
+
+    if (!I->modifiesRegister(Src, TRI)) {
+      if (I->readsRegister(Src, TRI) || isNetworkAccess(I))
+        return false;
+      continue;
+    }
+
+    // The def may already read a network, the read happens first.
+    if (!canAccessNetwork(I) || I->getDesc().getNumDefs() != 1)
+      return false;
+
+    MachineOperand &MO = I->getOperand(0);
+    unsigned Reg = NetReg;
+    if (MO.getReg() != Src) {
+      // 32-bit instructions write the whole register too.
+      if (MO.getReg() != TRI->getSubReg(Src, Tile::sub_32))
+        return false;
+      Reg = TRI->getSubReg(NetReg, Tile::sub_32);
+    }
+    MO.setReg(Reg);
+    MO.setIsDead(false);
+    addNetworkOrdering(I, NetReg);
+    ++NumNetSendsFolded;
+    return true;
+  }
+  return false;
+}
+
 /// Returns a pass that expands pseudo instrs into real instrs.
 FunctionPass *llvm::createTileExpandPseudoPass(TileTargetMachine &tm) {
   return new TileExpandPseudo(tm);
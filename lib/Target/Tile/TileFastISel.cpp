@@ -0,0 +1,1047 @@
+//===-- TileFastISel.cpp - Tile FastISel implementation -------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file defines the Tile-specific support for the FastISel class, used at
+// -O0 and by the JIT. It covers integer arithmetic, loads and stores, compares,
+// branches, selects, calls and returns on i32 and i64. Everything else, FP and
+// SIMD in particular, falls back to SelectionDAG.
+//
+// i32 values live in CPU32Regs sign-extended to 64 bits, as the DAG patterns
+// expect. i1, i8 and i16 values are promoted to CPU32Regs with undefined high
+// bits and are extended explicitly where the high bits matter.
+//
+//===----------------------------------------------------------------------===//
+
+#include "Tile.h"
+#include "TileCallingConv.h"
+#include "TileISelLowering.h"
+#include "TileInstrInfo.h"
+#include "TileMachineFunction.h"
+#include "TileTargetMachine.h"
+#include "MCTargetDesc/TileBaseInfo.h"
+#include "llvm/CodeGen/Analysis.h"
+#include "llvm/CodeGen/FastISel.h"
+#include "llvm/CodeGen/FunctionLoweringInfo.h"
+#include "llvm/CodeGen/MachineFrameInfo.h"
+#include "llvm/CodeGen/MachineInstrBuilder.h"
+#include "llvm/CodeGen/MachineMemOperand.h"
+#include "llvm/CodeGen/MachineRegisterInfo.h"
+#include "llvm/IR/CallingConv.h"
+#include "llvm/IR/DataLayout.h"
+#include "llvm/IR/DerivedTypes.h"
+#include "llvm/IR/GlobalVariable.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/IR/IntrinsicInst.h"
+#include "llvm/IR/Operator.h"
+#include "llvm/Support/CallSite.h"
+#include "llvm/Support/ErrorHandling.h"
+#include "llvm/Target/TargetLowering.h"
+#include "llvm/Target/TargetMachine.h"
+using namespace llvm;
+
+#include "TileGenCallingConv.inc"
+
+namespace {
+
+class TileFastISel : public FastISel {
+  const TargetMachine &TM;
+  LLVMContext *Context;
+
+public:
+  explicit TileFastISel(FunctionLoweringInfo &funcInfo,
+                        const TargetLibraryInfo *libInfo)
+      : FastISel(funcInfo, libInfo), TM(funcInfo.MF->getTarget()),
+        Context(&funcInfo.Fn->getContext()) {}
+
+  // Backend specific FastISel code.
+  virtual bool TargetSelectInstruction(const Instruction *I);
+  virtual unsigned TargetMaterializeConstant(const Constant *C);
+  virtual unsigned TargetMaterializeAlloca(const AllocaInst *AI);
+  virtual unsigned TargetMaterializeFloatZero(const ConstantFP *CFP);
+  virtual bool FastLowerArguments();
+
+  // These are what the generic code calls for binary operators, GEPs,
+  // casts and constants.
+  virtual unsigned FastEmit_r(MVT VT, MVT RetVT, unsigned Opcode, unsigned Op0,
+                              bool Op0IsKill);
+  virtual unsigned FastEmit_rr(MVT VT, MVT RetVT, unsigned Opcode,
+                               unsigned Op0, bool Op0IsKill, unsigned Op1,
+                               bool Op1IsKill);
+  virtual unsigned FastEmit_ri(MVT VT, MVT RetVT, unsigned Opcode,
+                               unsigned Op0, bool Op0IsKill, uint64_t Imm);
+  virtual unsigned FastEmit_i(MVT VT, MVT RetVT, unsigned Opcode,
+                              uint64_t Imm);
+  virtual unsigned FastEmit_f(MVT VT, MVT RetVT, unsigned Opcode,
+                              const ConstantFP *FPImm);
+
+private:
+  bool SelectLoad(const Instruction *I);
+  bool SelectStore(const Instruction *I);
+  bool SelectBranch(const Instruction *I);
+  bool SelectCmp(const Instruction *I);
+  bool SelectSelect(const Instruction *I);
+  bool SelectIntExt(const Instruction *I);
+  bool SelectTrunc(const Instruction *I);
+  bool SelectNarrowBinaryOp(const Instruction *I, unsigned ISDOpcode);
+  bool SelectCall(const Instruction *I);
+  bool SelectRet(const Instruction *I);
+
+  bool isTypeLegal(Type *Ty, MVT &VT);
+  const TargetRegisterClass *getRegClassFor(MVT VT) const {
+    return VT == MVT::i64 ? &Tile::CPURegsRegClass : &Tile::CPU32RegsRegClass;
+  }
+
+  unsigned materializeInt(int64_t Imm, MVT VT);
+  unsigned materializeFP(const ConstantFP *CFP);
+  unsigned materializeGV(const GlobalValue *GV);
+  unsigned emitAddrPair(const GlobalValue *GV, unsigned char HiFlag,
+                        unsigned char LoFlag);
+  unsigned emitIntExt(MVT SrcVT, unsigned SrcReg, MVT DestVT, bool IsZExt);
+  unsigned emitCmp(const CmpInst *CI);
+  void addMemOperand(MachineInstrBuilder &MIB, const Value *Ptr,
+                     unsigned Flags, MVT VT, unsigned Align);
+};
+
+} // end anonymous namespace
+
+// Types held in a register: i32 and i64, plus i1, i8 and i16 promoted to
+// CPU32Regs.
+bool TileFastISel::isTypeLegal(Type *Ty, MVT &VT) {
+  EVT Evt = TLI.getValueType(Ty, true);
+  if (Evt == MVT::Other || !Evt.isSimple())
+    return false;
+  VT = Evt.getSimpleVT();
+  return VT == MVT::i64 || VT == MVT::i32 || VT == MVT::i16 ||
+         VT == MVT::i8 || VT == MVT::i1;
+}
+
+void TileFastISel::addMemOperand(MachineInstrBuilder &MIB, const Value *Ptr,
+                                 unsigned Flags, MVT VT, unsigned Align) {
+  unsigned Size = VT == MVT::i1 ? 1 : VT.getStoreSize();
+  if (!Align)
+    Align = Size;
+  MachineMemOperand *MMO = FuncInfo.MF->getMachineMemOperand(
+      MachinePointerInfo(Ptr), Flags, Size, Align);
+  MIB.addMemOperand(MMO);
+}
+
+//===----------------------------------------------------------------------===//
+// Materialization
+//===----------------------------------------------------------------------===//
+
+// Same sequences as the immediate patterns in TileInstrInfo.td.
+unsigned TileFastISel::materializeInt(int64_t Imm, MVT VT) {
+  if (VT != MVT::i64 && VT != MVT::i32)
+    return 0;
+
+  bool Is64 = VT == MVT::i64;
+  const TargetRegisterClass *RC = getRegClassFor(VT);
+  // The generic code hands over zero-extended i32 immediates.
+  if (!Is64)
+    Imm = SignExtend64<32>(Imm);
+  uint64_t UImm = Imm;
+
+  if (isInt<8>(Imm))
+    return FastEmitInst_i(Is64 ? Tile::MOVEI : Tile::MOVEI32, RC, Imm);
+  if (isInt<16>(Imm))
+    return FastEmitInst_i(Is64 ? Tile::MOVELI : Tile::MOVELI32, RC, Imm);
+
+  unsigned Shl16 = Is64 ? Tile::SHL16INSLI : Tile::SHL16INSLI32;
+  unsigned Reg;
+  if (isInt<32>(Imm))
+    Reg = FastEmitInst_i(Is64 ? Tile::MOVELI : Tile::MOVELI32, RC,
+                         (UImm >> 16) & 0xFFFF);
+  else if (isInt<48>(Imm)) {
+    Reg = FastEmitInst_i(Tile::MOVELI, RC, (UImm >> 32) & 0xFFFF);
+    Reg = FastEmitInst_ri(Shl16, RC, Reg, true, (UImm >> 16) & 0xFFFF);
+  } else {
+    Reg = FastEmitInst_i(Tile::MOVELI, RC, (UImm >> 48) & 0xFFFF);
+    Reg = FastEmitInst_ri(Shl16, RC, Reg, true, (UImm >> 32) & 0xFFFF);
+    Reg = FastEmitInst_ri(Shl16, RC, Reg, true, (UImm >> 16) & 0xFFFF);
+  }
+  return FastEmitInst_ri(Shl16, RC, Reg, true, UImm & 0xFFFF);
+}
+
+// moveli hi(GV); shl16insli lo(GV)
+unsigned TileFastISel::emitAddrPair(const GlobalValue *GV, unsigned char HiFlag,
+                                    unsigned char LoFlag) {
+  const TargetRegisterClass *RC = &Tile::CPURegsRegClass;
+  unsigned Hi = createResultReg(RC);
+  BuildMI(*FuncInfo.MBB, FuncInfo.InsertPt, DL, TII.get(Tile::MOVELI), Hi)
+      .addGlobalAddress(GV, 0, HiFlag);
+  unsigned Lo = createResultReg(RC);
+  BuildMI(*FuncInfo.MBB, FuncInfo.InsertPt, DL, TII.get(Tile::SHL16INSLI), Lo)
+      .addReg(Hi, RegState::Kill).addGlobalAddress(GV, 0, LoFlag);
+  return Lo;
+}
+
+// Mirrors TileTargetLowering::lowerGlobalAddress.
+unsigned TileFastISel::materializeGV(const GlobalValue *GV) {
+  const GlobalVariable *GVar = dyn_cast<GlobalVariable>(GV);
+  if (GVar && GVar->isThreadLocal())
+    return 0;
+
+  TileFunctionInfo *TileFI = FuncInfo.MF->getInfo<TileFunctionInfo>();
+  const TargetRegisterClass *RC = &Tile::CPURegsRegClass;
+  bool UsePCRel;
+
+  if (TM.getRelocationModel() != Reloc::PIC_) {
+    CodeModel::Model CM = TM.getCodeModel();
+    if (CM == CodeModel::Small)
+      return emitAddrPair(GV, TileII::MO_HW1_LAST, TileII::MO_HW0);
+
+    bool IsLocal = GV->hasLocalLinkage() ||
+                   (!GV->isDeclaration() && !GV->isWeakForLinker());
+    UsePCRel = CM == CodeModel::Medium && IsLocal;
+    if (!UsePCRel) {
+      unsigned Hi = createResultReg(RC);
+      BuildMI(*FuncInfo.MBB, FuncInfo.InsertPt, DL, TII.get(Tile::MOVELI), Hi)
+          .addGlobalAddress(GV, 0, TileII::MO_HW2_LAST);
+      unsigned Mid = createResultReg(RC);
+      BuildMI(*FuncInfo.MBB, FuncInfo.InsertPt, DL, TII.get(Tile::SHL16INSLI),
+              Mid).addReg(Hi, RegState::Kill)
+          .addGlobalAddress(GV, 0, TileII::MO_HW1);
+      unsigned Lo = createResultReg(RC);
+      BuildMI(*FuncInfo.MBB, FuncInfo.InsertPt, DL, TII.get(Tile::SHL16INSLI),
+              Lo).addReg(Mid, RegState::Kill)
+          .addGlobalAddress(GV, 0, TileII::MO_HW0);
+      return Lo;
+    }
+  } else
+    UsePCRel = GV->hasInternalLinkage() ||
+               (GV->hasLocalLinkage() && !isa<Function>(GV));
+
+  if (UsePCRel) {
+    unsigned Off = emitAddrPair(GV, TileII::MO_HW1_LAST_PIC,
+                                TileII::MO_HW0_PIC);
+    return FastEmitInst_rr(Tile::ADD, RC, TileFI->getLinkReg(), false, Off,
+                           true);
+  }
+
+  // Load the address from the GOT.
+  unsigned Off = emitAddrPair(GV, TileII::MO_HW1_LAST_GOT, TileII::MO_HW0_GOT);
+  unsigned Entry = FastEmitInst_rr(Tile::ADD, RC, TileFI->getGlobalBaseReg(),
+                                   false, Off, true);
+  return FastEmitInst_r(Tile::LD, RC, Entry, true);
+}
+
+unsigned TileFastISel::TargetMaterializeConstant(const Constant *C) {
+  MVT VT;
+  if (const GlobalValue *GV = dyn_cast<GlobalValue>(C))
+    return materializeGV(GV);
+  if (const ConstantInt *CI = dyn_cast<ConstantInt>(C))
+    if (isTypeLegal(CI->getType(), VT))
+      return materializeInt(CI->getSExtValue(),
+                            VT == MVT::i64 ? MVT::i64 : MVT::i32);
+  return 0;
+}
+
+// FP values live in the integer registers, build their bit pattern.
+unsigned TileFastISel::materializeFP(const ConstantFP *CFP) {
+  EVT VT = TLI.getValueType(CFP->getType(), true);
+  if ((VT != MVT::f32 && VT != MVT::f64) || !TLI.isTypeLegal(VT))
+    return 0;
+  APInt Bits = CFP->getValueAPF().bitcastToAPInt();
+  return materializeInt(Bits.getSExtValue(),
+                        VT == MVT::f64 ? MVT::i64 : MVT::i32);
+}
+
+unsigned TileFastISel::TargetMaterializeFloatZero(const ConstantFP *CFP) {
+  return materializeFP(CFP);
+}
+
+unsigned TileFastISel::TargetMaterializeAlloca(const AllocaInst *AI) {
+  DenseMap<const AllocaInst *, int>::iterator SI =
+      FuncInfo.StaticAllocaMap.find(AI);
+  if (SI == FuncInfo.StaticAllocaMap.end())
+    return 0;
+
+  unsigned Reg = createResultReg(&Tile::CPURegsRegClass);
+  BuildMI(*FuncInfo.MBB, FuncInfo.InsertPt, DL, TII.get(Tile::TileFI), Reg)
+      .addFrameIndex(SI->second);
+  return Reg;
+}
+
+// Only arguments that all arrive in registers are handled here, the rest is
+// left to LowerFormalArguments.
+bool TileFastISel::FastLowerArguments() {
+  if (!FuncInfo.CanLowerReturn)
+    return false;
+
+  const Function *F = FuncInfo.Fn;
+  if (F->isVarArg() || F->arg_size() > TILEGX_AREG_NUM)
+    return false;
+
+  CallingConv::ID CC = F->getCallingConv();
+  if (CC != CallingConv::C && CC != CallingConv::Fast)
+    return false;
+
+  unsigned Idx = 1;
+  for (Function::const_arg_iterator I = F->arg_begin(), E = F->arg_end();
+       I != E; ++I, ++Idx) {
+    if (F->getAttributes().hasAttribute(Idx, Attribute::ByVal) ||
+        F->getAttributes().hasAttribute(Idx, Attribute::InReg) ||
+        F->getAttributes().hasAttribute(Idx, Attribute::StructRet) ||
+        F->getAttributes().hasAttribute(Idx, Attribute::Nest))
+      return false;
+
+    EVT ArgVT = TLI.getValueType(I->getType());
+    if (!ArgVT.isSimple())
+      return false;
+    switch (ArgVT.getSimpleVT().SimpleTy) {
+    case MVT::i1:
+    case MVT::i8:
+    case MVT::i16:
+    case MVT::i32:
+    case MVT::i64:
+      break;
+    case MVT::f32:
+    case MVT::f64:
+      if (!TLI.isTypeLegal(ArgVT))
+        return false;
+      break;
+    default:
+      return false;
+    }
+  }
+
+  // i1, i8 and i16 are promoted to i32. The 32 and 64-bit registers of an
+  // argument slot alias, so each argument takes the next slot.
+  static const uint16_t Tile32Regs[TILEGX_AREG_NUM] = {
+    Tile::R0_32, Tile::R1_32, Tile::R2_32, Tile::R3_32, Tile::R4_32,
+    Tile::R5_32, Tile::R6_32, Tile::R7_32, Tile::R8_32, Tile::R9_32
+  };
+
+  Idx = 0;
+  for (Function::const_arg_iterator I = F->arg_begin(), E = F->arg_end();
+       I != E; ++I, ++Idx) {
+    MVT VT = TLI.getSimpleValueType(I->getType());
+    bool Is64 = VT == MVT::i64 || VT == MVT::f64;
+    const TargetRegisterClass *RC =
+        Is64 ? &Tile::CPURegsRegClass : &Tile::CPU32RegsRegClass;
+    unsigned SrcReg = Is64 ? TileIntRegs[Idx] : Tile32Regs[Idx];
+    unsigned DstReg = FuncInfo.MF->addLiveIn(SrcReg, RC);
+    // Without the copy, EmitLiveInCopies will drop the live-in.
+    unsigned ResultReg = createResultReg(RC);
+    BuildMI(*FuncInfo.MBB, FuncInfo.InsertPt, DL, TII.get(TargetOpcode::COPY),
+            ResultReg).addReg(DstReg, getKillRegState(true));
+    UpdateValueMap(I, ResultReg);
+  }
+
+  TileFunctionInfo *TileFI = FuncInfo.MF->getInfo<TileFunctionInfo>();
+  TileFI->setVarArgsFrameIndex(0);
+  return true;
+}
+
+//===----------------------------------------------------------------------===//
+// Generic hooks
+//===----------------------------------------------------------------------===//
+
+unsigned TileFastISel::FastEmit_i(MVT VT, MVT RetVT, unsigned Opcode,
+                                  uint64_t Imm) {
+  if (Opcode != ISD::Constant || VT != RetVT)
+    return 0;
+  return materializeInt(Imm, VT);
+}
+
+unsigned TileFastISel::FastEmit_f(MVT VT, MVT RetVT, unsigned Opcode,
+                                  const ConstantFP *FPImm) {
+  if (Opcode != ISD::ConstantFP || VT != RetVT)
+    return 0;
+  return materializeFP(FPImm);
+}
+
+unsigned TileFastISel::FastEmit_r(MVT VT, MVT RetVT, unsigned Opcode,
+                                  unsigned Op0, bool Op0IsKill) {
+  if (VT == MVT::i32 && RetVT == MVT::i64) {
+    if (Opcode == ISD::SIGN_EXTEND || Opcode == ISD::ANY_EXTEND)
+      return FastEmitInst_r(Tile::ADD_EXTEND, &Tile::CPURegsRegClass, Op0,
+                            Op0IsKill);
+    if (Opcode == ISD::ZERO_EXTEND)
+      return FastEmitInst_r(Tile::V4INT_L, &Tile::CPURegsRegClass, Op0,
+                            Op0IsKill);
+  }
+
+  if (VT == MVT::i64 && RetVT == MVT::i32 && Opcode == ISD::TRUNCATE) {
+    unsigned Reg = FastEmitInst_r(Tile::V4INT_L32, &Tile::CPU32RegsRegClass,
+                                  Op0, Op0IsKill);
+    return FastEmitInst_r(Tile::ADD_TRUNC, &Tile::CPU32RegsRegClass, Reg,
+                          true);
+  }
+
+  return 0;
+}
+
+unsigned TileFastISel::FastEmit_rr(MVT VT, MVT RetVT, unsigned Opcode,
+                                   unsigned Op0, bool Op0IsKill, unsigned Op1,
+                                   bool Op1IsKill) {
+  if (VT != RetVT || (VT != MVT::i64 && VT != MVT::i32))
+    return 0;
+
+  bool Is64 = VT == MVT::i64;
+  unsigned Opc;
+  switch (Opcode) {
+  default:
+    return 0;
+  case ISD::ADD: Opc = Is64 ? Tile::ADD : Tile::ADDX; break;
+  case ISD::SUB: Opc = Is64 ? Tile::SUB : Tile::SUBX; break;
+  case ISD::AND: Opc = Is64 ? Tile::AND : Tile::AND32; break;
+  case ISD::OR:  Opc = Is64 ? Tile::OR : Tile::OR32; break;
+  case ISD::XOR: Opc = Is64 ? Tile::XOR : Tile::XOR32; break;
+  case ISD::SHL: Opc = Is64 ? Tile::SHL : Tile::SHLX; break;
+  case ISD::SRL: Opc = Is64 ? Tile::SHRU : Tile::SHRUX; break;
+  case ISD::SRA: Opc = Is64 ? Tile::SHRS : Tile::SHRS32; break;
+  case ISD::MUL:
+    if (!Is64) {
+      Opc = Tile::MULX;
+      break;
+    }
+    // The same sequence as TileDAGToDAGISel selects for i64 MUL.
+    {
+      const TargetRegisterClass *RC = &Tile::CPURegsRegClass;
+      unsigned Tmp =
+          FastEmitInst_rr(Tile::MUL_HU_LU, RC, Op0, false, Op1, false);
+      Tmp = FastEmitInst_rrr(Tile::MULA_HU_LU, RC, Tmp, true, Op1, false, Op0,
+                             false);
+      Tmp = FastEmitInst_ri(Tile::SHLI, RC, Tmp, true, 32);
+      return FastEmitInst_rrr(Tile::MULA_LU_LU, RC, Tmp, true, Op1, Op1IsKill,
+                              Op0, Op0IsKill);
+    }
+  }
+
+  return FastEmitInst_rr(Opc, getRegClassFor(VT), Op0, Op0IsKill, Op1,
+                         Op1IsKill);
+}
+
+unsigned TileFastISel::FastEmit_ri(MVT VT, MVT RetVT, unsigned Opcode,
+                                   unsigned Op0, bool Op0IsKill,
+                                   uint64_t Imm) {
+  if (VT != RetVT || (VT != MVT::i64 && VT != MVT::i32))
+    return 0;
+
+  bool Is64 = VT == MVT::i64;
+  int64_t SImm = Is64 ? Imm : SignExtend64<32>(Imm);
+  unsigned Opc = 0;
+
+  switch (Opcode) {
+  default:
+    break;
+  case ISD::SUB:
+    SImm = -SImm;
+    // Fall through.
+  case ISD::ADD:
+    if (isInt<8>(SImm))
+      Opc = Is64 ? Tile::ADDI : Tile::ADDXI;
+    else if (isInt<16>(SImm))
+      Opc = Is64 ? Tile::ADDLI : Tile::ADDXLI;
+    break;
+  case ISD::AND:
+    if (isInt<8>(SImm))
+      Opc = Is64 ? Tile::ANDI : Tile::ANDI32;
+    break;
+  case ISD::OR:
+    if (isInt<8>(SImm))
+      Opc = Is64 ? Tile::ORI : Tile::ORI32;
+    break;
+  case ISD::XOR:
+    if (isInt<8>(SImm))
+      Opc = Is64 ? Tile::XORI : Tile::XORI32;
+    break;
+  case ISD::SHL:
+    if (Imm < VT.getSizeInBits())
+      Opc = Is64 ? Tile::SHLI : Tile::SHLXI;
+    break;
+  case ISD::SRL:
+    if (Imm < VT.getSizeInBits())
+      Opc = Is64 ? Tile::SHRUI : Tile::SHRUXI;
+    break;
+  case ISD::SRA:
+    if (Imm < VT.getSizeInBits())
+      Opc = Is64 ? Tile::SHRSI : Tile::SHRSI32;
+    break;
+  }
+
+  if (!Opc)
+    return 0;
+  return FastEmitInst_ri(Opc, getRegClassFor(VT), Op0, Op0IsKill, SImm);
+}
+
+//===----------------------------------------------------------------------===//
+// Instructions
+//===----------------------------------------------------------------------===//
+
+// Extend a value held in a register to DestVT, which is i32 or i64.
+unsigned TileFastISel::emitIntExt(MVT SrcVT, unsigned SrcReg, MVT DestVT,
+                                  bool IsZExt) {
+  unsigned Reg = SrcReg;
+  if (SrcVT != MVT::i32 && SrcVT != MVT::i64) {
+    unsigned Bits = SrcVT == MVT::i1 ? 1 : SrcVT.getSizeInBits();
+    const TargetRegisterClass *RC = &Tile::CPU32RegsRegClass;
+    if (IsZExt)
+      Reg = FastEmitInst_rii(Tile::BFEXTU32, RC, Reg, false, 0, Bits - 1);
+    else {
+      // shlxi sign-extends bit 31, shrsi then shifts all 64 bits.
+      Reg = FastEmitInst_ri(Tile::SHLXI, RC, Reg, false, 32 - Bits);
+      Reg = FastEmitInst_ri(Tile::SHRSI32, RC, Reg, true, 32 - Bits);
+    }
+    SrcVT = MVT::i32;
+  }
+
+  if (SrcVT == MVT::i32 && DestVT == MVT::i64)
+    Reg = FastEmit_r(MVT::i32, MVT::i64,
+                     IsZExt ? ISD::ZERO_EXTEND : ISD::SIGN_EXTEND, Reg,
+                     Reg != SrcReg);
+  return Reg;
+}
+
+bool TileFastISel::SelectLoad(const Instruction *I) {
+  const LoadInst *LI = cast<LoadInst>(I);
+  if (LI->isAtomic())
+    return false;
+
+  MVT VT;
+  if (!isTypeLegal(LI->getType(), VT))
+    return false;
+
+  bool IsNonTemporal = LI->getMetadata("nontemporal") != 0;
+  unsigned Opc;
+  switch (VT.SimpleTy) {
+  default:
+    return false;
+  case MVT::i64: Opc = IsNonTemporal ? Tile::LDNT : Tile::LD; break;
+  case MVT::i32: Opc = IsNonTemporal ? Tile::LDNT4S32 : Tile::LD4S32; break;
+  case MVT::i16: Opc = IsNonTemporal ? Tile::LDNT2S32 : Tile::LD2S32; break;
+  case MVT::i8:
+  case MVT::i1: Opc = IsNonTemporal ? Tile::LDNT1U32 : Tile::LD1U32; break;
+  }
+
+  unsigned AddrReg = getRegForValue(LI->getPointerOperand());
+  if (!AddrReg)
+    return false;
+
+  unsigned ResultReg = createResultReg(getRegClassFor(VT));
+  unsigned Flags = MachineMemOperand::MOLoad;
+  if (LI->isVolatile())
+    Flags |= MachineMemOperand::MOVolatile;
+  if (IsNonTemporal)
+    Flags |= MachineMemOperand::MONonTemporal;
+  MachineInstrBuilder MIB =
+      BuildMI(*FuncInfo.MBB, FuncInfo.InsertPt, DL, TII.get(Opc), ResultReg)
+          .addReg(AddrReg);
+  addMemOperand(MIB, LI->getPointerOperand(), Flags, VT, LI->getAlignment());
+
+  UpdateValueMap(I, ResultReg);
+  return true;
+}
+
+bool TileFastISel::SelectStore(const Instruction *I) {
+  const StoreInst *SI = cast<StoreInst>(I);
+  if (SI->isAtomic())
+    return false;
+
+  const Value *Val = SI->getValueOperand();
+  MVT VT;
+  if (!isTypeLegal(Val->getType(), VT))
+    return false;
+
+  bool IsNonTemporal = SI->getMetadata("nontemporal") != 0;
+  unsigned Opc;
+  switch (VT.SimpleTy) {
+  default:
+    return false;
+  case MVT::i64: Opc = IsNonTemporal ? Tile::STNT : Tile::ST; break;
+  case MVT::i32: Opc = IsNonTemporal ? Tile::STNT432 : Tile::ST432; break;
+  case MVT::i16: Opc = IsNonTemporal ? Tile::STNT232 : Tile::ST232; break;
+  case MVT::i8:
+  case MVT::i1: Opc = IsNonTemporal ? Tile::STNT132 : Tile::ST132; break;
+  }
+
+  unsigned SrcReg = getRegForValue(Val);
+  if (!SrcReg)
+    return false;
+  // Only the low bit of an i1 is defined.
+  if (VT == MVT::i1)
+    SrcReg = FastEmitInst_ri(Tile::ANDI32, &Tile::CPU32RegsRegClass, SrcReg,
+                             false, 1);
+
+  unsigned AddrReg = getRegForValue(SI->getPointerOperand());
+  if (!AddrReg)
+    return false;
+
+  unsigned Flags = MachineMemOperand::MOStore;
+  if (SI->isVolatile())
+    Flags |= MachineMemOperand::MOVolatile;
+  if (IsNonTemporal)
+    Flags |= MachineMemOperand::MONonTemporal;
+  MachineInstrBuilder MIB =
+      BuildMI(*FuncInfo.MBB, FuncInfo.InsertPt, DL, TII.get(Opc))
+          .addReg(AddrReg).addReg(SrcReg);
+  addMemOperand(MIB, SI->getPointerOperand(), Flags, VT, SI->getAlignment());
+  return true;
+}
+
+// Compare two values of the same type into a 0/1 i32 register. Operands
+// narrower than i64 are extended so the 64-bit compares can be used; sign
+// extension preserves both the signed and the unsigned order of i32 values.
+unsigned TileFastISel::emitCmp(const CmpInst *CI) {
+  const ICmpInst *ICI = dyn_cast<ICmpInst>(CI);
+  if (!ICI)
+    return 0;
+
+  MVT VT;
+  if (!isTypeLegal(ICI->getOperand(0)->getType(), VT))
+    return 0;
+
+  unsigned LHS = getRegForValue(ICI->getOperand(0));
+  unsigned RHS = getRegForValue(ICI->getOperand(1));
+  if (!LHS || !RHS)
+    return 0;
+
+  if (VT != MVT::i64) {
+    bool IsZExt = VT != MVT::i32 && !ICI->isSigned();
+    LHS = emitIntExt(VT, LHS, MVT::i64, IsZExt);
+    RHS = emitIntExt(VT, RHS, MVT::i64, IsZExt);
+  }
+
+  unsigned Opc;
+  bool Swap = false;
+  switch (ICI->getPredicate()) {
+  default:
+    return 0;
+  case CmpInst::ICMP_EQ:  Opc = Tile::CMPEQ32_64; break;
+  case CmpInst::ICMP_NE:  Opc = Tile::CMPNE32_64; break;
+  case CmpInst::ICMP_SGT: Swap = true; // Fall through.
+  case CmpInst::ICMP_SLT: Opc = Tile::CMPLTS32_64; break;
+  case CmpInst::ICMP_SGE: Swap = true; // Fall through.
+  case CmpInst::ICMP_SLE: Opc = Tile::CMPLES32_64; break;
+  case CmpInst::ICMP_UGT: Swap = true; // Fall through.
+  case CmpInst::ICMP_ULT: Opc = Tile::CMPLTU32_64; break;
+  case CmpInst::ICMP_UGE: Swap = true; // Fall through.
+  case CmpInst::ICMP_ULE: Opc = Tile::CMPLEU32_64; break;
+  }
+
+  if (Swap)
+    std::swap(LHS, RHS);
+  return FastEmitInst_rr(Opc, &Tile::CPU32RegsRegClass, LHS, false, RHS,
+                         false);
+}
+
+bool TileFastISel::SelectCmp(const Instruction *I) {
+  unsigned ResultReg = emitCmp(cast<CmpInst>(I));
+  if (!ResultReg)
+    return false;
+  UpdateValueMap(I, ResultReg);
+  return true;
+}
+
+// Branch on a 64 or 32-bit register compared against zero.
+static unsigned getBranchOpcode(CmpInst::Predicate Pred, bool Is64) {
+  switch (Pred) {
+  default:
+    return 0;
+  case CmpInst::ICMP_EQ:
+  case CmpInst::ICMP_ULE:
+    return Is64 ? Tile::BEQZ : Tile::BEQZ32;
+  case CmpInst::ICMP_NE:
+  case CmpInst::ICMP_UGT:
+    return Is64 ? Tile::BNEZ : Tile::BNEZ32;
+  case CmpInst::ICMP_SLT:
+    return Is64 ? Tile::BLTZ : Tile::BLTZ32;
+  case CmpInst::ICMP_SLE:
+    return Is64 ? Tile::BLEZ : Tile::BLEZ32;
+  case CmpInst::ICMP_SGT:
+    return Is64 ? Tile::BGTZ : Tile::BGTZ32;
+  case CmpInst::ICMP_SGE:
+    return Is64 ? Tile::BGEZ : Tile::BGEZ32;
+  }
+}
+
+bool TileFastISel::SelectBranch(const Instruction *I) {
+  const BranchInst *BI = cast<BranchInst>(I);
+  MachineBasicBlock *TBB = FuncInfo.MBBMap[BI->getSuccessor(0)];
+  MachineBasicBlock *FBB = FuncInfo.MBBMap[BI->getSuccessor(1)];
+  const Value *Cond = BI->getCondition();
+
+  // Fold a compare in this block into the branch.
+  CmpInst::Predicate Pred = CmpInst::ICMP_NE;
+  unsigned CondReg = 0;
+  bool Is64 = false;
+  if (const ICmpInst *CI = dyn_cast<ICmpInst>(Cond)) {
+    if (CI->hasOneUse() && CI->getParent() == BI->getParent()) {
+      MVT VT;
+      const ConstantInt *Zero = dyn_cast<ConstantInt>(CI->getOperand(1));
+      if (Zero && Zero->isZero() && isTypeLegal(Zero->getType(), VT) &&
+          (VT == MVT::i64 || VT == MVT::i32) &&
+          getBranchOpcode(CI->getPredicate(), true)) {
+        // Branch on the value itself, i32 values are kept sign-extended.
+        CondReg = getRegForValue(CI->getOperand(0));
+        Pred = CI->getPredicate();
+        Is64 = VT == MVT::i64;
+      } else
+        CondReg = emitCmp(CI);
+      if (!CondReg)
+        return false;
+    }
+  }
+
+  if (!CondReg) {
+    CondReg = getRegForValue(Cond);
+    if (!CondReg)
+      return false;
+    // Only the low bit of an i1 is defined.
+    CondReg = FastEmitInst_ri(Tile::ANDI32, &Tile::CPU32RegsRegClass, CondReg,
+                              false, 1);
+  }
+
+  // Fall through to the true block when possible.
+  if (FuncInfo.MBB->isLayoutSuccessor(TBB)) {
+    std::swap(TBB, FBB);
+    Pred = CmpInst::getInversePredicate(Pred);
+  }
+
+  unsigned Opc = getBranchOpcode(Pred, Is64);
+  assert(Opc && "Unexpected branch predicate");
+  BuildMI(*FuncInfo.MBB, FuncInfo.InsertPt, DL, TII.get(Opc))
+      .addReg(CondReg).addMBB(TBB);
+  FastEmitBranch(FBB, DL);
+  FuncInfo.MBB->addSuccessor(TBB);
+  return true;
+}
+
+bool TileFastISel::SelectSelect(const Instruction *I) {
+  MVT VT;
+  if (!isTypeLegal(I->getType(), VT))
+    return false;
+
+  unsigned CondReg = getRegForValue(I->getOperand(0));
+  unsigned TrueReg = getRegForValue(I->getOperand(1));
+  unsigned FalseReg = getRegForValue(I->getOperand(2));
+  if (!CondReg || !TrueReg || !FalseReg)
+    return false;
+
+  CondReg = FastEmitInst_ri(Tile::ANDI32, &Tile::CPU32RegsRegClass, CondReg,
+                            false, 1);
+  unsigned Opc = Tile::CMOVNEZ32;
+  if (VT == MVT::i64) {
+    CondReg = emitIntExt(MVT::i32, CondReg, MVT::i64, false);
+    Opc = Tile::CMOVNEZ;
+  }
+
+  unsigned ResultReg = FastEmitInst_rrr(Opc, getRegClassFor(VT), CondReg, true,
+                                        TrueReg, false, FalseReg, false);
+  UpdateValueMap(I, ResultReg);
+  return true;
+}
+
+bool TileFastISel::SelectIntExt(const Instruction *I) {
+  MVT SrcVT, DestVT;
+  if (!isTypeLegal(I->getOperand(0)->getType(), SrcVT) ||
+      !isTypeLegal(I->getType(), DestVT))
+    return false;
+  // Extending into a narrow type is done in 32 bits.
+  if (DestVT != MVT::i64)
+    DestVT = MVT::i32;
+
+  unsigned SrcReg = getRegForValue(I->getOperand(0));
+  if (!SrcReg)
+    return false;
+
+  unsigned ResultReg = emitIntExt(SrcVT, SrcReg, DestVT, isa<ZExtInst>(I));
+  if (!ResultReg)
+    return false;
+  UpdateValueMap(I, ResultReg);
+  return true;
+}
+
+bool TileFastISel::SelectTrunc(const Instruction *I) {
+  MVT SrcVT, DestVT;
+  if (!isTypeLegal(I->getOperand(0)->getType(), SrcVT) ||
+      !isTypeLegal(I->getType(), DestVT))
+    return false;
+
+  unsigned SrcReg = getRegForValue(I->getOperand(0));
+  if (!SrcReg)
+    return false;
+
+  // Narrow values don't care about their high bits, i32 ones have to be
+  // sign-extended again.
+  unsigned ResultReg = SrcReg;
+  if (SrcVT == MVT::i64) {
+    if (DestVT == MVT::i32)
+      ResultReg = FastEmit_r(MVT::i64, MVT::i32, ISD::TRUNCATE, SrcReg, false);
+    else
+      ResultReg = FastEmitInst_r(Tile::V4INT_L32, &Tile::CPU32RegsRegClass,
+                                 SrcReg, false);
+  }
+  UpdateValueMap(I, ResultReg);
+  return true;
+}
+
+// Operators on i1, i8 and i16 whose low bits only depend on the low bits
+// of the operands are done in 32 bits.
+bool TileFastISel::SelectNarrowBinaryOp(const Instruction *I,
+                                        unsigned ISDOpcode) {
+  MVT VT;
+  if (!isTypeLegal(I->getType(), VT) || VT == MVT::i32 || VT == MVT::i64)
+    return false;
+
+  unsigned Op0 = getRegForValue(I->getOperand(0));
+  unsigned Op1 = getRegForValue(I->getOperand(1));
+  if (!Op0 || !Op1)
+    return false;
+
+  unsigned ResultReg =
+      FastEmit_rr(MVT::i32, MVT::i32, ISDOpcode, Op0, false, Op1, false);
+  if (!ResultReg)
+    return false;
+  UpdateValueMap(I, ResultReg);
+  return true;
+}
+
+bool TileFastISel::SelectCall(const Instruction *I) {
+  const CallInst *CI = cast<CallInst>(I);
+  const Value *Callee = CI->getCalledValue();
+
+  // Intrinsics and inline asm are left to SelectionDAG.
+  if (isa<IntrinsicInst>(CI) || isa<InlineAsm>(Callee))
+    return false;
+
+  ImmutableCallSite CS(CI);
+  CallingConv::ID CC = CS.getCallingConv();
+  PointerType *PT = cast<PointerType>(Callee->getType());
+  FunctionType *FTy = cast<FunctionType>(PT->getElementType());
+  if (FTy->isVarArg())
+    return false;
+
+  // The return value.
+  MVT RetVT = MVT::isVoid;
+  if (!I->getType()->isVoidTy() && !isTypeLegal(I->getType(), RetVT))
+    return false;
+
+  // Collect the arguments, everything has to fit in registers.
+  SmallVector<const Value *, 8> Args;
+  SmallVector<unsigned, 8> ArgRegs;
+  SmallVector<MVT, 8> ArgVTs;
+  SmallVector<ISD::ArgFlagsTy, 8> ArgFlags;
+  for (ImmutableCallSite::arg_iterator AI = CS.arg_begin(), AE = CS.arg_end();
+       AI != AE; ++AI) {
+    unsigned AttrInd = (AI - CS.arg_begin()) + 1;
+    if (CS.paramHasAttr(AttrInd, Attribute::InReg) ||
+        CS.paramHasAttr(AttrInd, Attribute::StructRet) ||
+        CS.paramHasAttr(AttrInd, Attribute::Nest) ||
+        CS.paramHasAttr(AttrInd, Attribute::ByVal))
+      return false;
+
+    MVT ArgVT;
+    if (!isTypeLegal((*AI)->getType(), ArgVT))
+      return false;
+    unsigned Reg = getRegForValue(*AI);
+    if (!Reg)
+      return false;
+
+    ISD::ArgFlagsTy Flags;
+    if (CS.paramHasAttr(AttrInd, Attribute::SExt))
+      Flags.setSExt();
+    if (CS.paramHasAttr(AttrInd, Attribute::ZExt))
+      Flags.setZExt();
+    Flags.setOrigAlign(TD.getABITypeAlignment((*AI)->getType()));
+
+    // CC_Tile has no rule for i1, narrow arguments are promoted to i32
+    // here, extended as their attributes ask.
+    if (ArgVT != MVT::i32 && ArgVT != MVT::i64) {
+      if (Flags.isSExt() || Flags.isZExt())
+        Reg = emitIntExt(ArgVT, Reg, MVT::i32, Flags.isZExt());
+      ArgVT = MVT::i32;
+    }
+
+    Args.push_back(*AI);
+    ArgRegs.push_back(Reg);
+    ArgVTs.push_back(ArgVT);
+    ArgFlags.push_back(Flags);
+  }
+
+  SmallVector<CCValAssign, 16> ArgLocs;
+  CCState CCInfo(CC, false, *FuncInfo.MF, TM, ArgLocs, *Context);
+  CCInfo.AnalyzeCallOperands(ArgVTs, ArgFlags, CC_Tile);
+  for (unsigned i = 0, e = ArgLocs.size(); i != e; ++i)
+    if (!ArgLocs[i].isRegLoc())
+      return false;
+
+  unsigned NumBytes = CCInfo.getNextStackOffset();
+  BuildMI(*FuncInfo.MBB, FuncInfo.InsertPt, DL,
+          TII.get(Tile::ADJCALLSTACKDOWN)).addImm(NumBytes);
+
+  // Copy the arguments into their registers.
+  SmallVector<unsigned, 8> RegArgs;
+  for (unsigned i = 0, e = ArgLocs.size(); i != e; ++i) {
+    CCValAssign &VA = ArgLocs[i];
+    unsigned Reg = ArgRegs[VA.getValNo()];
+    BuildMI(*FuncInfo.MBB, FuncInfo.InsertPt, DL, TII.get(TargetOpcode::COPY),
+            VA.getLocReg()).addReg(Reg);
+    RegArgs.push_back(VA.getLocReg());
+  }
+
+  // The call itself.
+  MachineInstrBuilder MIB;
+  const GlobalValue *GV = dyn_cast<GlobalValue>(Callee);
+  if (GV) {
+    bool IsPIC = TM.getRelocationModel() == Reloc::PIC_;
+    unsigned char Flag = IsPIC && !GV->hasInternalLinkage()
+                             ? TileII::MO_PLT_CALL
+                             : TileII::MO_NO_FLAG;
+    MIB = BuildMI(*FuncInfo.MBB, FuncInfo.InsertPt, DL, TII.get(Tile::JAL))
+              .addGlobalAddress(GV, 0, Flag);
+  } else {
+    unsigned CalleeReg = getRegForValue(Callee);
+    if (!CalleeReg)
+      return false;
+    MIB = BuildMI(*FuncInfo.MBB, FuncInfo.InsertPt, DL, TII.get(Tile::JALR))
+              .addReg(CalleeReg);
+  }
+
+  for (unsigned i = 0, e = RegArgs.size(); i != e; ++i)
+    MIB.addReg(RegArgs[i], RegState::Implicit);
+  MIB.addRegMask(TRI.getCallPreservedMask(CC));
+
+  BuildMI(*FuncInfo.MBB, FuncInfo.InsertPt, DL, TII.get(Tile::ADJCALLSTACKUP))
+      .addImm(NumBytes).addImm(0);
+
+  // Copy the result out of its register. Narrow values come back in the
+  // 32-bit registers.
+  SmallVector<unsigned, 1> UsedRegs;
+  if (RetVT != MVT::isVoid) {
+    MVT CopyVT = RetVT == MVT::i64 ? MVT::i64 : MVT::i32;
+    SmallVector<CCValAssign, 16> RVLocs;
+    CCState CCRetInfo(CC, false, *FuncInfo.MF, TM, RVLocs, *Context);
+    CCRetInfo.AnalyzeCallResult(CopyVT, RetCC_Tile);
+
+    unsigned ResultReg = createResultReg(getRegClassFor(CopyVT));
+    BuildMI(*FuncInfo.MBB, FuncInfo.InsertPt, DL, TII.get(TargetOpcode::COPY),
+            ResultReg).addReg(RVLocs[0].getLocReg());
+    UsedRegs.push_back(RVLocs[0].getLocReg());
+    MIB.addReg(RVLocs[0].getLocReg(), RegState::ImplicitDefine);
+    UpdateValueMap(I, ResultReg);
+  }
+
+  // lr is clobbered by the call.
+  static_cast<MachineInstr *>(MIB)->setPhysRegsDeadExcept(UsedRegs, TRI);
+  return true;
+}
+
+bool TileFastISel::SelectRet(const Instruction *I) {
+  const ReturnInst *Ret = cast<ReturnInst>(I);
+  const Function &F = *I->getParent()->getParent();
+
+  if (!FuncInfo.CanLowerReturn || F.isVarArg())
+    return false;
+
+  SmallVector<unsigned, 2> RetRegs;
+  if (Ret->getNumOperands() > 0) {
+    SmallVector<ISD::OutputArg, 4> Outs;
+    GetReturnInfo(F.getReturnType(), F.getAttributes(), Outs, TLI);
+    if (Outs.size() != 1)
+      return false;
+
+    // FP values are returned in the integer registers, a plain copy does.
+    const Value *RV = Ret->getOperand(0);
+    MVT VT;
+    if (!isTypeLegal(RV->getType(), VT) &&
+        !(RV->getType()->isFloatingPointTy() && TLI.isTypeLegal(VT)))
+      return false;
+    unsigned Reg = getRegForValue(RV);
+    if (!Reg)
+      return false;
+
+    SmallVector<CCValAssign, 16> ValLocs;
+    CCState CCInfo(F.getCallingConv(), false, *FuncInfo.MF, TM, ValLocs,
+                   *Context);
+    CCInfo.AnalyzeReturn(Outs, RetCC_Tile);
+    if (ValLocs.size() != 1)
+      return false;
+
+    // Narrow values were promoted to i32 by GetReturnInfo.
+    CCValAssign &VA = ValLocs[0];
+    if (VT != VA.getLocVT()) {
+      if (Outs[0].Flags.isSExt() || Outs[0].Flags.isZExt())
+        Reg = emitIntExt(VT, Reg, VA.getLocVT(), Outs[0].Flags.isZExt());
+      else if (VA.getLocVT() == MVT::i64)
+        return false;
+    }
+
+    BuildMI(*FuncInfo.MBB, FuncInfo.InsertPt, DL, TII.get(TargetOpcode::COPY),
+            VA.getLocReg()).addReg(Reg);
+    RetRegs.push_back(VA.getLocReg());
+  }
+
+  // The sret pointer goes back in r0, see LowerReturn.
+  if (F.hasStructRetAttr()) {
+    TileFunctionInfo *TileFI = FuncInfo.MF->getInfo<TileFunctionInfo>();
+    unsigned Reg = TileFI->getSRetReturnReg();
+    if (!Reg || !RetRegs.empty())
+      return false;
+    BuildMI(*FuncInfo.MBB, FuncInfo.InsertPt, DL, TII.get(TargetOpcode::COPY),
+            Tile::R0).addReg(Reg);
+    RetRegs.push_back(Tile::R0);
+  }
+
+  MachineInstrBuilder MIB =
+      BuildMI(*FuncInfo.MBB, FuncInfo.InsertPt, DL, TII.get(Tile::RET))
+          .addReg(Tile::LR);
+  for (unsigned i = 0, e = RetRegs.size(); i != e; ++i)
+    MIB.addReg(RetRegs[i], RegState::Implicit);
+  return true;
+}
+
+bool TileFastISel::TargetSelectInstruction(const Instruction *I) {
+  switch (I->getOpcode()) {
+  default:
+    break;
+  case Instruction::Load:
+    return SelectLoad(I);
+  case Instruction::Store:
+    return SelectStore(I);
+  case Instruction::Br:
+    return SelectBranch(I);
+  case Instruction::ICmp:
+    return SelectCmp(I);
+  case Instruction::Select:
+    return SelectSelect(I);
+  case Instruction::ZExt:
+  case Instruction::SExt:
+    return SelectIntExt(I);
+  case Instruction::Trunc:
+    return SelectTrunc(I);
+  case Instruction::Add:
+    return SelectNarrowBinaryOp(I, ISD::ADD);
+  case Instruction::Sub:
+    return SelectNarrowBinaryOp(I, ISD::SUB);
+  case Instruction::Mul:
+    return SelectNarrowBinaryOp(I, ISD::MUL);
+  case Instruction::And:
+    return SelectNarrowBinaryOp(I, ISD::AND);
+  case Instruction::Or:
+    return SelectNarrowBinaryOp(I, ISD::OR);
+  case Instruction::Xor:
+    return SelectNarrowBinaryOp(I, ISD::XOR);
+  case Instruction::Shl:
+    return SelectNarrowBinaryOp(I, ISD::SHL);
+  case Instruction::Call:
+    return SelectCall(I);
+  case Instruction::Ret:
+    return SelectRet(I);
+  }
+  return false;
+}
+
+namespace llvm {
+FastISel *Tile::createFastISel(FunctionLoweringInfo &funcInfo,
+                               const TargetLibraryInfo *libInfo) {
+  return new TileFastISel(funcInfo, libInfo);
+}
+}
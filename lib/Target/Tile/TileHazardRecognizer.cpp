@@ -0,0 +1,57 @@
+//===-- TileHazardRecognizer.cpp - Tile post-RA hazard recognizer ---------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// The post-RA scheduler issues an instruction once the latencies of its
+// predecessors have elapsed: two cycles for an L1 hit or a multiply, going by
+// the itineraries. While a load or multiply is in flight, independent
+// instructions from later in the block fill the bundles in between. Those
+// bundles are only formed by the packetizer, so an instruction is held back
+// to the next cycle when it would not fit the current bundle in X or Y mode.
+//
+//===----------------------------------------------------------------------===//
+
+#include "TileHazardRecognizer.h"
+#include "llvm/CodeGen/ScheduleDAG.h"
+
+using namespace llvm;
+
+TileHazardRecognizer::TileHazardRecognizer(const InstrItineraryData *ItinData,
+                                           const ScheduleDAG *DAG)
+    : ScoreboardHazardRecognizer(ItinData, DAG, "post-RA-sched"),
+      ResourceModel(DAG->TM, DAG->TM.getSubtargetImpl()->getSchedModel()
+                                 ->IssueWidth) {}
+
+bool TileHazardRecognizer::atIssueLimit() const {
+  return ResourceModel.isFull() || ScoreboardHazardRecognizer::atIssueLimit();
+}
+
+ScheduleHazardRecognizer::HazardType
+TileHazardRecognizer::getHazardType(SUnit *SU, int Stalls) {
+  // Only the current bundle is known, leave look-ahead to the scoreboard.
+  MachineInstr *MI = SU->getInstr();
+  if (Stalls == 0 && MI && !ResourceModel.isResourceAvailable(MI))
+    return Hazard;
+  return ScoreboardHazardRecognizer::getHazardType(SU, Stalls);
+}
+
+void TileHazardRecognizer::Reset() {
+  ResourceModel.reset();
+  ScoreboardHazardRecognizer::Reset();
+}
+
+void TileHazardRecognizer::EmitInstruction(SUnit *SU) {
+  if (MachineInstr *MI = SU->getInstr())
+    ResourceModel.reserveResources(MI);
+  ScoreboardHazardRecognizer::EmitInstruction(SU);
+}
+
+void TileHazardRecognizer::AdvanceCycle() {
+  ResourceModel.reset();
+  ScoreboardHazardRecognizer::AdvanceCycle();
+}
@@ -0,0 +1,41 @@
+//===-- TileHazardRecognizer.h - Tile post-RA hazard recognizer -*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// Hazard recognizer for the post-RA list scheduler. The scoreboard tracks the
+// pipes from TileSchedule.td; on top of it, the bundle of the current cycle
+// is checked the same way the VLIW packetizer will check it, so that what the
+// scheduler issues in one cycle ends up in one bundle.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef TILEHAZARDRECOGNIZER_H
+#define TILEHAZARDRECOGNIZER_H
+
+#include "TileMachineScheduler.h"
+#include "llvm/CodeGen/ScoreboardHazardRecognizer.h"
+
+namespace llvm {
+
+class TileHazardRecognizer : public ScoreboardHazardRecognizer {
+  TileResourceModel ResourceModel;
+
+public:
+  TileHazardRecognizer(const InstrItineraryData *ItinData,
+                       const ScheduleDAG *DAG);
+
+  virtual bool atIssueLimit() const;
+  virtual HazardType getHazardType(SUnit *SU, int Stalls);
+  virtual void Reset();
+  virtual void EmitInstruction(SUnit *SU);
+  virtual void AdvanceCycle();
+};
+
+} // End llvm namespace
+
+#endif
@@ -93,6 +93,13 @@ private:
   // Select MULHS/MULHU for i32 and i64
   SDNode *SelectMULHIPart32(SDNode *N);
   SDNode *SelectMULHIPart64(SDNode *N);
+  // Fold the shift that follows MULHS/MULHU for i32 division by constant.
+  SDNode *SelectMULHIShift32(SDNode *N);
+  // Select post-increment loads and stores.
+  SDNode *SelectIndexedLoad(SDNode *N);
+  SDNode *SelectIndexedStore(SDNode *N);
+  // Select cmpxchg as mtspr CMPEXCH_VALUE followed by cmpexch.
+  SDNode *SelectAtomicCmpSwap(SDNode *N);
 
   // Complex Pattern.
   bool SelectFI(SDValue N, SDValue &R1);
@@ -123,15 +130,17 @@ void TileDAGToDAGISel::GenPICHeader(MachineFunction &MF) {
   MachineBasicBlock::iterator I = MBB.begin();
   const TargetInstrInfo &TII = *MF.getTarget().getInstrInfo();
   DebugLoc DL = I != MBB.end() ? I->getDebugLoc() : DebugLoc();
-  unsigned GP = TileFI->getGlobalBaseReg();
   unsigned LP = TileFI->getLinkReg();
 
   BuildMI(MBB, I, DL, TII.get(Tile::LNK), LP)
       .addExternalSymbol("HOLDER", TileII::MO_NO_FLAG_PIC);
 
+  // Only set up gp when something uses it, PC-relative accesses under the
+  // medium code model need the link register alone.
   if (!TileFI->globalBaseRegSet())
     return;
 
+  unsigned GP = TileFI->getGlobalBaseReg();
   BuildMI(MBB, I, DL, TII.get(Tile::MOVELI), GP)
       .addExternalSymbol("_GLOBAL_OFFSET_TABLE_", TileII::MO_HW1_LAST_PIC);
   BuildMI(MBB, I, DL, TII.get(Tile::SHL16INSLI), GP).addReg(GP)
@@ -314,6 +323,29 @@ SDNode *TileDAGToDAGISel::SelectMULHIPart32(SDNode *N) {
       SDValue(Tmp, 0), CurDAG->getTargetConstant(32, MVT::i64));
 }
 
+// Division by a constant leaves (srl (mulhu x, magic), k) or
+// (sra (mulhs x, magic), k) behind. The 32x32 product is exact in 64 bits,
+// so the high part and the shift fold into one shift by 32 + k.
+SDNode *TileDAGToDAGISel::SelectMULHIShift32(SDNode *N) {
+  SDValue Mul = N->getOperand(0);
+  ConstantSDNode *Amt = dyn_cast<ConstantSDNode>(N->getOperand(1));
+  unsigned MulOpc = N->getOpcode() == ISD::SRL ? ISD::MULHU : ISD::MULHS;
+
+  if (!Amt || Amt->getZExtValue() >= 32 || Mul.getOpcode() != MulOpc ||
+      !Mul.hasOneUse())
+    return 0;
+
+  DebugLoc dl = N->getDebugLoc();
+  SDNode *Tmp = CurDAG->getMachineNode(
+      MulOpc == ISD::MULHU ? Tile::MUL_LU_LU32 : Tile::MUL_LS_LS32, dl,
+      MVT::i64, Mul.getOperand(0), Mul.getOperand(1));
+
+  return CurDAG->SelectNodeTo(
+      N, MulOpc == ISD::MULHU ? Tile::SHRUI32_64 : Tile::SHRSI32_64, MVT::i32,
+      SDValue(Tmp, 0),
+      CurDAG->getTargetConstant(32 + Amt->getZExtValue(), MVT::i64));
+}
+
 SDNode *TileDAGToDAGISel::SelectMULHIPart64(SDNode *N) {
   unsigned Opcode = N->getOpcode();
   DebugLoc dl = N->getDebugLoc();
@@ -370,6 +402,120 @@ SDNode *TileDAGToDAGISel::SelectMULHIPart64(SDNode *N) {
                                 SDValue(Tmp10, 0));
 }
 
+SDNode *TileDAGToDAGISel::SelectIndexedLoad(SDNode *N) {
+  LoadSDNode *LD = cast<LoadSDNode>(N);
+  if (LD->getAddressingMode() != ISD::POST_INC)
+    return NULL;
+
+  EVT VT = LD->getValueType(0);
+  bool Is32 = VT == MVT::i32 || VT == MVT::f32;
+  bool Signed = LD->getExtensionType() == ISD::SEXTLOAD;
+  unsigned Opc;
+
+  switch (LD->getMemoryVT().getSimpleVT().SimpleTy) {
+  default:
+    return NULL;
+  case MVT::i8:
+    if (Signed)
+      Opc = Is32 ? Tile::LD1S_ADD32 : Tile::LD1S_ADD;
+    else
+      Opc = Is32 ? Tile::LD1U_ADD32 : Tile::LD1U_ADD;
+    break;
+  case MVT::i16:
+    if (Signed)
+      Opc = Is32 ? Tile::LD2S_ADD32 : Tile::LD2S_ADD;
+    else
+      Opc = Is32 ? Tile::LD2U_ADD32 : Tile::LD2U_ADD;
+    break;
+  case MVT::i32:
+  case MVT::f32:
+    if (Is32)
+      Opc = Tile::LD4S_ADD32;
+    else
+      Opc = Signed ? Tile::LD4S_ADD : Tile::LD4U_ADD;
+    break;
+  case MVT::i64:
+  case MVT::f64:
+    Opc = Tile::LD_ADD;
+    break;
+  }
+
+  int64_t Inc = cast<ConstantSDNode>(LD->getOffset())->getSExtValue();
+  SDValue Ops[] = { LD->getBasePtr(), CurDAG->getTargetConstant(Inc, MVT::i64),
+                    LD->getChain() };
+  MachineSDNode *Res = CurDAG->getMachineNode(
+      Opc, N->getDebugLoc(), VT, MVT::i64, MVT::Other, Ops, 3);
+
+  MachineSDNode::mmo_iterator MemOp = MF->allocateMemRefsArray(1);
+  MemOp[0] = LD->getMemOperand();
+  Res->setMemRefs(MemOp, MemOp + 1);
+  return Res;
+}
+
+SDNode *TileDAGToDAGISel::SelectIndexedStore(SDNode *N) {
+  StoreSDNode *ST = cast<StoreSDNode>(N);
+  if (ST->getAddressingMode() != ISD::POST_INC)
+    return NULL;
+
+  EVT VT = ST->getValue().getValueType();
+  bool Is32 = VT == MVT::i32 || VT == MVT::f32;
+  unsigned Opc;
+
+  switch (ST->getMemoryVT().getSimpleVT().SimpleTy) {
+  default:
+    return NULL;
+  case MVT::i8:
+    Opc = Is32 ? Tile::ST1_ADD32 : Tile::ST1_ADD;
+    break;
+  case MVT::i16:
+    Opc = Is32 ? Tile::ST2_ADD32 : Tile::ST2_ADD;
+    break;
+  case MVT::i32:
+  case MVT::f32:
+    Opc = Is32 ? Tile::ST4_ADD32 : Tile::ST4_ADD;
+    break;
+  case MVT::i64:
+  case MVT::f64:
+    Opc = Tile::ST_ADD;
+    break;
+  }
+
+  int64_t Inc = cast<ConstantSDNode>(ST->getOffset())->getSExtValue();
+  SDValue Ops[] = { ST->getBasePtr(), ST->getValue(),
+                    CurDAG->getTargetConstant(Inc, MVT::i64), ST->getChain() };
+  MachineSDNode *Res = CurDAG->getMachineNode(
+      Opc, N->getDebugLoc(), MVT::i64, MVT::Other, Ops, 4);
+
+  MachineSDNode::mmo_iterator MemOp = MF->allocateMemRefsArray(1);
+  MemOp[0] = ST->getMemOperand();
+  Res->setMemRefs(MemOp, MemOp + 1);
+  return Res;
+}
+
+SDNode *TileDAGToDAGISel::SelectAtomicCmpSwap(SDNode *N) {
+  AtomicSDNode *AN = cast<AtomicSDNode>(N);
+  DebugLoc dl = N->getDebugLoc();
+  EVT VT = N->getValueType(0);
+  bool Is32 = VT == MVT::i32;
+
+  // The SPR write is glued to the cmpexch so nothing gets in between,
+  // and the implicit def/use of CMPEXCH_VALUE keeps them in separate
+  // bundles.
+  SDNode *SetCmp = CurDAG->getMachineNode(
+      Is32 ? Tile::MTSPR_CMPEXCH32 : Tile::MTSPR_CMPEXCH, dl, MVT::Other,
+      MVT::Glue, AN->getOperand(2), AN->getChain());
+
+  SDValue Ops[] = { AN->getBasePtr(), AN->getOperand(3), SDValue(SetCmp, 0),
+                    SDValue(SetCmp, 1) };
+  MachineSDNode *Res = CurDAG->getMachineNode(
+      Is32 ? Tile::CMPEXCH4 : Tile::CMPEXCH, dl, VT, MVT::Other, Ops, 4);
+
+  MachineSDNode::mmo_iterator MemOp = MF->allocateMemRefsArray(1);
+  MemOp[0] = AN->getMemOperand();
+  Res->setMemRefs(MemOp, MemOp + 1);
+  return Res;
+}
+
 SDNode *TileDAGToDAGISel::SelectDoubleFloatBinOp(SDNode *Node) {
 
   unsigned Opcode = Node->getOpcode();
@@ -463,7 +609,7 @@ SDNode *TileDAGToDAGISel::Select(SDNode *Node) {
     unsigned NetReg = 0xFFFFFFFF;
     switch (cast<ConstantSDNode>(Node->getOperand(1))->getZExtValue()) {
     default:
-      llvm_unreachable("INTRINSIC_VOID should not reach here.\n");
+      break;
     case Intrinsic::tilegx_netbarrier:
       ReplaceUses(SDValue(Node, 0), Node->getOperand(0));
       return NULL;
@@ -475,6 +621,10 @@ SDNode *TileDAGToDAGISel::Select(SDNode *Node) {
       break;
     }
 
+    // Everything else, e.g. wh64, is matched by patterns.
+    if (NetReg == 0xFFFFFFFF)
+      break;
+
     SDNode *ResNode = CurDAG->getMachineNode(
         Tile::NET, dl, MVT::i64, MVT::Other, CurDAG->getRegister(NetReg, MVT::i64),
         Node->getOperand(2), Node->getOperand(0));
@@ -518,6 +668,23 @@ SDNode *TileDAGToDAGISel::Select(SDNode *Node) {
     return NULL;
   }
 
+  case ISD::LOAD: {
+    SDNode *ResNode = SelectIndexedLoad(Node);
+    if (ResNode)
+      return ResNode;
+    break;
+  }
+
+  case ISD::STORE: {
+    SDNode *ResNode = SelectIndexedStore(Node);
+    if (ResNode)
+      return ResNode;
+    break;
+  }
+
+  case ISD::ATOMIC_CMP_SWAP:
+    return SelectAtomicCmpSwap(Node);
+
   // Carry-bit add/sub.
   case ISD::SUBE:
   case ISD::ADDE: {
@@ -556,11 +723,20 @@ SDNode *TileDAGToDAGISel::Select(SDNode *Node) {
   // 64bit mul.
   case ISD::MUL: {
 
-    if (NodeTy == MVT::i32)
+    // i32 and SIMD multiplies are matched by patterns.
+    if (NodeTy != MVT::i64)
       break;
 
     SDValue SrcA = Node->getOperand(0);
     SDValue SrcB = Node->getOperand(1);
+
+    // Multiplies by 3, 5 and 9 are a single shlNadd, see the patterns.
+    if (ConstantSDNode *C = dyn_cast<ConstantSDNode>(SrcB)) {
+      uint64_t Imm = C->getZExtValue();
+      if (Imm == 3 || Imm == 5 || Imm == 9)
+        break;
+    }
+
     SDNode *Tmp =
         CurDAG->getMachineNode(Tile::MUL_HU_LU, dl, MVT::i64, SrcA, SrcB);
 
@@ -582,6 +758,19 @@ SDNode *TileDAGToDAGISel::Select(SDNode *Node) {
 
     return SelectMULHIPart64(Node);
 
+  case TileISD::UDIVREM32:
+    return CurDAG->getMachineNode(Tile::UDIVREM32, dl, MVT::i64, MVT::i64,
+                                  Node->getOperand(0), Node->getOperand(1));
+
+  case ISD::SRL:
+  case ISD::SRA:
+
+    if (NodeTy == MVT::i32) {
+      if (SDNode *Res = SelectMULHIShift32(Node))
+        return Res;
+    }
+    break;
+
   case ISD::SINT_TO_FP:
   case ISD::UINT_TO_FP:
     assert(Node->getOperand(0).getValueType() == MVT::i32 &&
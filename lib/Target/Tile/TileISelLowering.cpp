@@ -80,6 +80,24 @@ const char *TileTargetLowering::getTargetNodeName(unsigned Opcode) const {
     return "TileISD::ALLOCA_SP";
   case TileISD::ALLOCA_ADDR:
     return "TileISD::ALLOCA_ADDR";
+  case TileISD::VSHL:
+    return "TileISD::VSHL";
+  case TileISD::VSRL:
+    return "TileISD::VSRL";
+  case TileISD::VSRA:
+    return "TileISD::VSRA";
+  case TileISD::SHUFFLEBYTES:
+    return "TileISD::SHUFFLEBYTES";
+  case TileISD::DBLALIGN:
+    return "TileISD::DBLALIGN";
+  case TileISD::VINT_L:
+    return "TileISD::VINT_L";
+  case TileISD::VINT_H:
+    return "TileISD::VINT_H";
+  case TileISD::VCMP:
+    return "TileISD::VCMP";
+  case TileISD::UDIVREM32:
+    return "TileISD::UDIVREM32";
   default:
     return NULL;
   }
@@ -90,7 +108,9 @@ TileTargetLowering::TileTargetLowering(TileTargetMachine &TM)
       Subtarget(&TM.getSubtarget<TileSubtarget>()) {
 
   setBooleanContents(ZeroOrOneBooleanContent);
-  setBooleanVectorContents(ZeroOrOneBooleanContent);
+  // Unrolled vector compares produce all ones lanes, so do the v1cmp* and
+  // v2cmp* ones once their 0/1 result is negated.
+  setBooleanVectorContents(ZeroOrNegativeOneBooleanContent);
 
   // Set up the register classes.
   addRegisterClass(MVT::i64, &Tile::CPURegsRegClass);
@@ -140,6 +160,35 @@ TileTargetLowering::TileTargetLowering(TileTargetMachine &TM)
     setOperationAction(ISD::BITCAST, MVT::v4i16, Legal);
     setOperationAction(ISD::BITCAST, MVT::v8i8, Legal);
 
+    static const MVT::SimpleValueType SIMDTypes[] = {
+      MVT::v2i32, MVT::v4i16, MVT::v8i8
+    };
+    for (unsigned i = 0; i < array_lengthof(SIMDTypes); ++i) {
+      MVT::SimpleValueType VT = SIMDTypes[i];
+      setOperationAction(ISD::AND, VT, Legal);
+      setOperationAction(ISD::OR, VT, Legal);
+      setOperationAction(ISD::XOR, VT, Legal);
+      // Uniform shift amounts map onto v*shl/v*shru/v*shrs,
+      // the rest are unrolled.
+      setOperationAction(ISD::SHL, VT, Custom);
+      setOperationAction(ISD::SRL, VT, Custom);
+      setOperationAction(ISD::SRA, VT, Custom);
+      // Lane moves are done in general registers with shufflebytes,
+      // v*int_*, dblalign, bfins and bfextu.
+      setOperationAction(ISD::VECTOR_SHUFFLE, VT, Custom);
+      setOperationAction(ISD::BUILD_VECTOR, VT, Custom);
+      setOperationAction(ISD::EXTRACT_VECTOR_ELT, VT, Custom);
+      setOperationAction(ISD::INSERT_VECTOR_ELT, VT, Custom);
+    }
+
+    // There are no 4 byte lane multiplies or compares.
+    setOperationAction(ISD::MUL, MVT::v4i16, Legal);
+    setOperationAction(ISD::MUL, MVT::v8i8, Legal);
+    setOperationAction(ISD::SETCC, MVT::v4i16, Custom);
+    setOperationAction(ISD::SETCC, MVT::v8i8, Custom);
+    setOperationAction(ISD::VSELECT, MVT::v4i16, Legal);
+    setOperationAction(ISD::VSELECT, MVT::v8i8, Legal);
+
     addRegisterClass(MVT::v2i32, &Tile::SIMDRegsRegClass);
     addRegisterClass(MVT::v4i16, &Tile::SIMDRegsRegClass);
     addRegisterClass(MVT::v8i8, &Tile::SIMDRegsRegClass);
@@ -150,6 +199,18 @@ TileTargetLowering::TileTargetLowering(TileTargetMachine &TM)
   setLoadExtAction(ISD::ZEXTLOAD, MVT::i1, Promote);
   setLoadExtAction(ISD::SEXTLOAD, MVT::i1, Promote);
 
+  // llvm.prefetch maps onto prefetch, prefetch_l2 and prefetch_l3.
+  setOperationAction(ISD::PREFETCH, MVT::Other, Custom);
+
+  // ld*_add/st*_add bump the address register after the access.
+  static const MVT::SimpleValueType PostIncTypes[] = {
+    MVT::i8, MVT::i16, MVT::i32, MVT::i64, MVT::f32, MVT::f64
+  };
+  for (unsigned i = 0; i != array_lengthof(PostIncTypes); ++i) {
+    setIndexedLoadAction(ISD::POST_INC, PostIncTypes[i], Legal);
+    setIndexedStoreAction(ISD::POST_INC, PostIncTypes[i], Legal);
+  }
+
   // For CTPOP, because tilegx pcnt only support 64bit operand
   // we need to zero extend i32 to i64.
   setOperationAction(ISD::CTPOP, MVT::i32, Promote);
@@ -197,10 +258,11 @@ TileTargetLowering::TileTargetLowering(TileTargetMachine &TM)
   setOperationAction(ISD::FP_TO_SINT, MVT::i64, Custom);
   setOperationAction(ISD::FP_TO_UINT, MVT::i32, Custom);
   setOperationAction(ISD::FP_TO_UINT, MVT::i64, Custom);
-  setOperationAction(ISD::FDIV, MVT::f32, Expand);
-  setOperationAction(ISD::FDIV, MVT::f64, Expand);
-  setOperationAction(ISD::FSQRT, MVT::f32, Expand);
-  setOperationAction(ISD::FSQRT, MVT::f64, Expand);
+  // Newton-Raphson under fast-math, libcalls otherwise.
+  setOperationAction(ISD::FDIV, MVT::f32, Custom);
+  setOperationAction(ISD::FDIV, MVT::f64, Custom);
+  setOperationAction(ISD::FSQRT, MVT::f32, Custom);
+  setOperationAction(ISD::FSQRT, MVT::f64, Custom);
   setOperationAction(ISD::FSIN, MVT::f32, Expand);
   setOperationAction(ISD::FSIN, MVT::f64, Expand);
   setOperationAction(ISD::FCOS, MVT::f32, Expand);
@@ -271,12 +333,13 @@ TileTargetLowering::TileTargetLowering(TileTargetMachine &TM)
   setOperationAction(ISD::SELECT, MVT::i64, Custom);
 
   setOperationAction(ISD::MUL, MVT::i64, Custom);
-  setOperationAction(ISD::SDIV, MVT::i32, Expand);
-  setOperationAction(ISD::SREM, MVT::i32, Expand);
+  // i32 division is done inline, see emitUDivRem32Loop.
+  setOperationAction(ISD::SDIV, MVT::i32, Custom);
+  setOperationAction(ISD::SREM, MVT::i32, Custom);
   setOperationAction(ISD::SDIV, MVT::i64, Expand);
   setOperationAction(ISD::SREM, MVT::i64, Expand);
-  setOperationAction(ISD::UDIV, MVT::i32, Expand);
-  setOperationAction(ISD::UREM, MVT::i32, Expand);
+  setOperationAction(ISD::UDIV, MVT::i32, Custom);
+  setOperationAction(ISD::UREM, MVT::i32, Custom);
   setOperationAction(ISD::UDIV, MVT::i64, Expand);
   setOperationAction(ISD::UREM, MVT::i64, Expand);
   setOperationAction(ISD::SDIVREM, MVT::i32, Expand);
@@ -314,12 +377,19 @@ TileTargetLowering::TileTargetLowering(TileTargetMachine &TM)
   setOperationAction(ISD::STACKSAVE, MVT::Other, Expand);
   setOperationAction(ISD::STACKRESTORE, MVT::Other, Expand);
 
-  setOperationAction(ISD::ATOMIC_LOAD, MVT::i32, Expand);
-  setOperationAction(ISD::ATOMIC_LOAD, MVT::i64, Expand);
-  setOperationAction(ISD::ATOMIC_STORE, MVT::i32, Expand);
-  setOperationAction(ISD::ATOMIC_STORE, MVT::i64, Expand);
-  setOperationAction(ISD::ATOMIC_LOAD_SUB, MVT::i32, Expand);
-  setOperationAction(ISD::ATOMIC_LOAD_SUB, MVT::i64, Expand);
+  // Atomic loads and stores are plain memory accesses and the
+  // read-modify-write operations are native or cmpexch loops. The
+  // promoted 1 and 2 byte forms use the __sync libcalls instead.
+  static const unsigned AtomicRMWOps[] = {
+    ISD::ATOMIC_CMP_SWAP, ISD::ATOMIC_SWAP, ISD::ATOMIC_LOAD_ADD,
+    ISD::ATOMIC_LOAD_SUB, ISD::ATOMIC_LOAD_AND, ISD::ATOMIC_LOAD_OR,
+    ISD::ATOMIC_LOAD_XOR, ISD::ATOMIC_LOAD_NAND, ISD::ATOMIC_LOAD_MIN,
+    ISD::ATOMIC_LOAD_MAX, ISD::ATOMIC_LOAD_UMIN, ISD::ATOMIC_LOAD_UMAX
+  };
+  for (unsigned i = 0; i != array_lengthof(AtomicRMWOps); ++i)
+    setOperationAction(AtomicRMWOps[i], MVT::i32, Custom);
+  setOperationAction(ISD::ATOMIC_LOAD_SUB, MVT::i64, Custom);
+  setOperationAction(ISD::ATOMIC_FENCE, MVT::Other, Custom);
 
   setInsertFencesForAtomic(true);
 
@@ -337,6 +407,8 @@ TileTargetLowering::TileTargetLowering(TileTargetMachine &TM)
 
   setTargetDAGCombine(ISD::SELECT);
   setTargetDAGCombine(ISD::ZERO_EXTEND);
+  setTargetDAGCombine(ISD::AND);
+  setTargetDAGCombine(ISD::VSELECT);
 
   setMinFunctionAlignment(3);
 
@@ -380,6 +452,60 @@ static SDValue PerformSELECTCombine(SDNode *N, SelectionDAG &DAG,
   return DAG.getNode(ISD::SELECT, DL, FalseTy, SetCC, False, True);
 }
 
+// v1cmp*/v2cmp* compare the lanes of v8i8 and v4i16 only.
+static bool isLaneCompare(SDValue SetCC) {
+  if (SetCC.getOpcode() != ISD::SETCC)
+    return false;
+  EVT VT = SetCC.getOperand(0).getValueType();
+  return VT == MVT::v8i8 || VT == MVT::v4i16;
+}
+
+static SDValue getLaneCompare(SDValue SetCC, SelectionDAG &DAG) {
+  return DAG.getNode(TileISD::VCMP, SetCC.getDebugLoc(),
+                     SetCC.getValueType(), SetCC.getOperand(0),
+                     SetCC.getOperand(1), SetCC.getOperand(2));
+}
+
+static SDValue PerformANDCombine(SDNode *N, SelectionDAG &DAG,
+                                 TargetLowering::DAGCombinerInfo &DCI,
+                                 const TileSubtarget *Subtarget) {
+  // v1cmp*/v2cmp* leave 0 or 1 in each lane, so a lane compare masked
+  // with 1, as when a vector of i1 is zero extended, needs no negation.
+  EVT VT = N->getValueType(0);
+  if (!VT.isVector())
+    return SDValue();
+
+  SDValue SetCC = N->getOperand(0);
+  BuildVectorSDNode *Mask = dyn_cast<BuildVectorSDNode>(N->getOperand(1));
+  if (!isLaneCompare(SetCC) || SetCC.getValueType() != VT || !Mask)
+    return SDValue();
+
+  unsigned EltBits = VT.getVectorElementType().getSizeInBits();
+  APInt SplatValue, SplatUndef;
+  unsigned SplatBitSize;
+  bool HasAnyUndefs;
+  if (!Mask->isConstantSplat(SplatValue, SplatUndef, SplatBitSize,
+                             HasAnyUndefs, EltBits) ||
+      SplatBitSize != EltBits || SplatValue != 1)
+    return SDValue();
+
+  return getLaneCompare(SetCC, DAG);
+}
+
+static SDValue PerformVSELECTCombine(SDNode *N, SelectionDAG &DAG,
+                                     TargetLowering::DAGCombinerInfo &DCI,
+                                     const TileSubtarget *Subtarget) {
+  // v1mnz/v2mnz only test the lanes for zero, the compare result does not
+  // have to be negated.
+  SDValue SetCC = N->getOperand(0);
+  if (!isLaneCompare(SetCC) || SetCC.getValueType() != N->getValueType(0))
+    return SDValue();
+
+  return DAG.getNode(ISD::VSELECT, N->getDebugLoc(), N->getValueType(0),
+                     getLaneCompare(SetCC, DAG), N->getOperand(1),
+                     N->getOperand(2));
+}
+
 static SDValue PerformZEXTCombine(SDNode *N, SelectionDAG &DAG,
                                   TargetLowering::DAGCombinerInfo &DCI,
                                   const TileSubtarget *Subtarget) {
@@ -411,6 +537,10 @@ TileTargetLowering::PerformDAGCombine(SDNode *N, DAGCombinerInfo &DCI) const {
     return PerformSELECTCombine(N, DAG, DCI, Subtarget);
   case ISD::ZERO_EXTEND:
     return PerformZEXTCombine(N, DAG, DCI, Subtarget);
+  case ISD::AND:
+    return PerformANDCombine(N, DAG, DCI, Subtarget);
+  case ISD::VSELECT:
+    return PerformVSELECTCombine(N, DAG, DCI, Subtarget);
   }
 
   return SDValue();
@@ -464,10 +594,56 @@ TileTargetLowering::LowerOperation(SDValue Op, SelectionDAG &DAG) const {
   // it's not nativelly supported on hardward.
   case ISD::MUL:
     return Op;
+  case ISD::SHL:
+  case ISD::SRL:
+  case ISD::SRA:
+    return lowerVectorShift(Op, DAG);
+  case ISD::SETCC:
+    return lowerVSETCC(Op, DAG);
+  case ISD::VECTOR_SHUFFLE:
+    return lowerVECTOR_SHUFFLE(Op, DAG);
+  case ISD::BUILD_VECTOR:
+    return lowerBUILD_VECTOR(Op, DAG);
+  case ISD::EXTRACT_VECTOR_ELT:
+    return lowerEXTRACT_VECTOR_ELT(Op, DAG);
+  case ISD::INSERT_VECTOR_ELT:
+    return lowerINSERT_VECTOR_ELT(Op, DAG);
+  case ISD::PREFETCH:
+    return lowerPREFETCH(Op, DAG);
+  case ISD::ATOMIC_FENCE:
+    return lowerATOMIC_FENCE(Op, DAG);
+  case ISD::ATOMIC_CMP_SWAP:
+  case ISD::ATOMIC_SWAP:
+  case ISD::ATOMIC_LOAD_ADD:
+  case ISD::ATOMIC_LOAD_SUB:
+  case ISD::ATOMIC_LOAD_AND:
+  case ISD::ATOMIC_LOAD_OR:
+  case ISD::ATOMIC_LOAD_XOR:
+  case ISD::ATOMIC_LOAD_NAND:
+  case ISD::ATOMIC_LOAD_MIN:
+  case ISD::ATOMIC_LOAD_MAX:
+  case ISD::ATOMIC_LOAD_UMIN:
+  case ISD::ATOMIC_LOAD_UMAX:
+    return lowerATOMIC_RMW(Op, DAG);
+  case ISD::SDIV:
+  case ISD::SREM:
+  case ISD::UDIV:
+  case ISD::UREM:
+    return lowerDIVREM32(Op, DAG);
+  case ISD::FDIV:
+    return lowerFDIV(Op, DAG);
+  case ISD::FSQRT:
+    return lowerFSQRT(Op, DAG);
   }
   return SDValue();
 }
 
+FastISel *
+TileTargetLowering::createFastISel(FunctionLoweringInfo &funcInfo,
+                                   const TargetLibraryInfo *libInfo) const {
+  return Tile::createFastISel(funcInfo, libInfo);
+}
+
 //===----------------------------------------------------------------------===//
 //  Lower helper functions
 //===----------------------------------------------------------------------===//
@@ -488,7 +664,270 @@ MachineBasicBlock *TileTargetLowering::EmitInstrWithCustomInserter(
   switch (MI->getOpcode()) {
   default:
     llvm_unreachable("Unexpected instr type to insert");
+  case Tile::ATOMIC_LOAD_NAND:
+  case Tile::ATOMIC_LOAD_NAND4:
+  case Tile::ATOMIC_LOAD_XOR:
+  case Tile::ATOMIC_LOAD_XOR4:
+  case Tile::ATOMIC_LOAD_MIN:
+  case Tile::ATOMIC_LOAD_MIN4:
+  case Tile::ATOMIC_LOAD_MAX:
+  case Tile::ATOMIC_LOAD_MAX4:
+  case Tile::ATOMIC_LOAD_UMIN:
+  case Tile::ATOMIC_LOAD_UMIN4:
+  case Tile::ATOMIC_LOAD_UMAX:
+  case Tile::ATOMIC_LOAD_UMAX4:
+    return emitAtomicRMWLoop(MI, BB);
+  case Tile::UDIVREM32:
+    return emitUDivRem32Loop(MI, BB);
+  }
+}
+
+// Expand an atomic read-modify-write without a fetch* instruction into
+//
+//   BB:
+//     init = ld ptr
+//   LoopMBB:
+//     old = phi [init, BB], [dst, LoopMBB]
+//     new = op old, val
+//     mtspr CMPEXCH_VALUE, old
+//     dst = cmpexch ptr, new
+//     bnez (cmpne dst, old), LoopMBB
+//   ExitMBB:
+//
+// The 4 byte forms work on sign-extended values, which is what ld4s and
+// cmpexch4 return, so the same compares can be used.
+MachineBasicBlock *
+TileTargetLowering::emitAtomicRMWLoop(MachineInstr *MI,
+                                      MachineBasicBlock *BB) const {
+  const TargetInstrInfo *TII = getTargetMachine().getInstrInfo();
+  MachineFunction *MF = BB->getParent();
+  MachineRegisterInfo &MRI = MF->getRegInfo();
+  const TargetRegisterClass *RC = &Tile::CPURegsRegClass;
+  DebugLoc dl = MI->getDebugLoc();
+
+  unsigned Dst = MI->getOperand(0).getReg();
+  unsigned Ptr = MI->getOperand(1).getReg();
+  unsigned Val = MI->getOperand(2).getReg();
+
+  unsigned LoadOpc = Tile::LD, CmpExchOpc = Tile::CMPEXCH;
+  switch (MI->getOpcode()) {
+  case Tile::ATOMIC_LOAD_NAND4:
+  case Tile::ATOMIC_LOAD_XOR4:
+  case Tile::ATOMIC_LOAD_MIN4:
+  case Tile::ATOMIC_LOAD_MAX4:
+  case Tile::ATOMIC_LOAD_UMIN4:
+  case Tile::ATOMIC_LOAD_UMAX4:
+    LoadOpc = Tile::LD4S;
+    CmpExchOpc = Tile::CMPEXCH464;
+    break;
+  }
+
+  const BasicBlock *LLVM_BB = BB->getBasicBlock();
+  MachineFunction::iterator It = BB;
+  ++It;
+  MachineBasicBlock *LoopMBB = MF->CreateMachineBasicBlock(LLVM_BB);
+  MachineBasicBlock *ExitMBB = MF->CreateMachineBasicBlock(LLVM_BB);
+  MF->insert(It, LoopMBB);
+  MF->insert(It, ExitMBB);
+
+  ExitMBB->splice(ExitMBB->begin(), BB,
+                  llvm::next(MachineBasicBlock::iterator(MI)), BB->end());
+  ExitMBB->transferSuccessorsAndUpdatePHIs(BB);
+  BB->addSuccessor(LoopMBB);
+  LoopMBB->addSuccessor(LoopMBB);
+  LoopMBB->addSuccessor(ExitMBB);
+
+  // The initial load only reads memory; give it a load-only memoperand.
+  MachineInstrBuilder Load = BuildMI(BB, dl, TII->get(LoadOpc),
+                                     MRI.createVirtualRegister(RC))
+                                 .addReg(Ptr);
+  if (MI->hasOneMemOperand()) {
+    MachineMemOperand *MMO = *MI->memoperands_begin();
+    Load.addMemOperand(MF->getMachineMemOperand(
+        MMO->getPointerInfo(), MachineMemOperand::MOLoad |
+                                   MachineMemOperand::MOVolatile,
+        MMO->getSize(), MMO->getAlignment(), MMO->getTBAAInfo()));
+  }
+  unsigned Init = Load->getOperand(0).getReg();
+
+  unsigned Old = MRI.createVirtualRegister(RC);
+  unsigned New = MRI.createVirtualRegister(RC);
+  unsigned Tmp = MRI.createVirtualRegister(RC);
+  unsigned Retry = MRI.createVirtualRegister(RC);
+
+  BuildMI(LoopMBB, dl, TII->get(Tile::PHI), Old)
+      .addReg(Init).addMBB(BB)
+      .addReg(Dst).addMBB(LoopMBB);
+
+  // Min and max keep old if it compares below (above) val:
+  //   new = cmovnez (cmplt old, val), old, val
+  unsigned CmpOpc = 0;
+  bool OldFirst = true;
+  switch (MI->getOpcode()) {
+  default:
+    llvm_unreachable("Unexpected atomic read-modify-write");
+  case Tile::ATOMIC_LOAD_NAND:
+  case Tile::ATOMIC_LOAD_NAND4:
+    BuildMI(LoopMBB, dl, TII->get(Tile::AND), Tmp).addReg(Old).addReg(Val);
+    BuildMI(LoopMBB, dl, TII->get(Tile::NOR), New).addReg(Tmp)
+        .addReg(Tile::ZERO);
+    break;
+  case Tile::ATOMIC_LOAD_XOR:
+  case Tile::ATOMIC_LOAD_XOR4:
+    BuildMI(LoopMBB, dl, TII->get(Tile::XOR), New).addReg(Old).addReg(Val);
+    break;
+  case Tile::ATOMIC_LOAD_MIN:
+  case Tile::ATOMIC_LOAD_MIN4:
+    CmpOpc = Tile::CMPLTS;
+    break;
+  case Tile::ATOMIC_LOAD_MAX:
+  case Tile::ATOMIC_LOAD_MAX4:
+    CmpOpc = Tile::CMPLTS;
+    OldFirst = false;
+    break;
+  case Tile::ATOMIC_LOAD_UMIN:
+  case Tile::ATOMIC_LOAD_UMIN4:
+    CmpOpc = Tile::CMPLTU;
+    break;
+  case Tile::ATOMIC_LOAD_UMAX:
+  case Tile::ATOMIC_LOAD_UMAX4:
+    CmpOpc = Tile::CMPLTU;
+    OldFirst = false;
+    break;
+  }
+  if (CmpOpc) {
+    BuildMI(LoopMBB, dl, TII->get(CmpOpc), Tmp)
+        .addReg(OldFirst ? Old : Val).addReg(OldFirst ? Val : Old);
+    BuildMI(LoopMBB, dl, TII->get(Tile::CMOVNEZ), New).addReg(Tmp)
+        .addReg(Old).addReg(Val);
   }
+
+  BuildMI(LoopMBB, dl, TII->get(Tile::MTSPR_CMPEXCH)).addReg(Old);
+  BuildMI(LoopMBB, dl, TII->get(CmpExchOpc), Dst).addReg(Ptr).addReg(New)
+      .setMemRefs(MI->memoperands_begin(), MI->memoperands_end());
+  BuildMI(LoopMBB, dl, TII->get(Tile::CMPNE), Retry).addReg(Dst).addReg(Old);
+  BuildMI(LoopMBB, dl, TII->get(Tile::BNEZ)).addReg(Retry).addMBB(LoopMBB);
+
+  MI->eraseFromParent();
+  return ExitMBB;
+}
+
+// Expand the 32-bit unsigned division into a shift-subtract loop that
+// only runs for the significant quotient bits:
+//
+//   BB:
+//     lt = cmpltu num, den
+//     cnt0 = sub (clz den), (clz num)
+//     ds0 = shl den, cnt0
+//     zero = movei 0
+//     bnez lt, ExitMBB
+//   LoopMBB:
+//     cnt = phi [cnt0, BB], [cnt1, LoopMBB]
+//     r = phi [num, BB], [r1, LoopMBB]
+//     q = phi [zero, BB], [q1, LoopMBB]
+//     ds = phi [ds0, BB], [ds1, LoopMBB]
+//     t = cmpleu ds, r
+//     r1 = cmovnez t, (sub r, ds), r
+//     q1 = or (shli q, 1), t
+//     ds1 = shrui ds, 1
+//     cnt1 = addi cnt, -1
+//     bgez cnt1, LoopMBB
+//   ExitMBB:
+//     quot = phi [zero, BB], [q1, LoopMBB]
+//     rem = phi [num, BB], [r1, LoopMBB]
+//
+// The operands are zero-extended, so the shifted divisor never overflows. A
+// zero divisor makes clz return 64 and the loop ends after a few rounds
+// with a meaningless result, as the division is undefined anyway.
+MachineBasicBlock *
+TileTargetLowering::emitUDivRem32Loop(MachineInstr *MI,
+                                      MachineBasicBlock *BB) const {
+  const TargetInstrInfo *TII = getTargetMachine().getInstrInfo();
+  MachineFunction *MF = BB->getParent();
+  MachineRegisterInfo &MRI = MF->getRegInfo();
+  const TargetRegisterClass *RC = &Tile::CPURegsRegClass;
+  DebugLoc dl = MI->getDebugLoc();
+
+  unsigned Quot = MI->getOperand(0).getReg();
+  unsigned Rem = MI->getOperand(1).getReg();
+  unsigned Num = MI->getOperand(2).getReg();
+  unsigned Den = MI->getOperand(3).getReg();
+
+  const BasicBlock *LLVM_BB = BB->getBasicBlock();
+  MachineFunction::iterator It = BB;
+  ++It;
+  MachineBasicBlock *LoopMBB = MF->CreateMachineBasicBlock(LLVM_BB);
+  MachineBasicBlock *ExitMBB = MF->CreateMachineBasicBlock(LLVM_BB);
+  MF->insert(It, LoopMBB);
+  MF->insert(It, ExitMBB);
+
+  ExitMBB->splice(ExitMBB->begin(), BB,
+                  llvm::next(MachineBasicBlock::iterator(MI)), BB->end());
+  ExitMBB->transferSuccessorsAndUpdatePHIs(BB);
+  BB->addSuccessor(LoopMBB);
+  BB->addSuccessor(ExitMBB);
+  LoopMBB->addSuccessor(LoopMBB);
+  LoopMBB->addSuccessor(ExitMBB);
+
+  unsigned Lt = MRI.createVirtualRegister(RC);
+  unsigned ClzNum = MRI.createVirtualRegister(RC);
+  unsigned ClzDen = MRI.createVirtualRegister(RC);
+  unsigned Cnt0 = MRI.createVirtualRegister(RC);
+  unsigned DS0 = MRI.createVirtualRegister(RC);
+  unsigned Zero = MRI.createVirtualRegister(RC);
+
+  BuildMI(BB, dl, TII->get(Tile::CMPLTU), Lt).addReg(Num).addReg(Den);
+  BuildMI(BB, dl, TII->get(Tile::CLZ), ClzNum).addReg(Num);
+  BuildMI(BB, dl, TII->get(Tile::CLZ), ClzDen).addReg(Den);
+  BuildMI(BB, dl, TII->get(Tile::SUB), Cnt0).addReg(ClzDen).addReg(ClzNum);
+  BuildMI(BB, dl, TII->get(Tile::SHL), DS0).addReg(Den).addReg(Cnt0);
+  BuildMI(BB, dl, TII->get(Tile::MOVEI), Zero).addImm(0);
+  BuildMI(BB, dl, TII->get(Tile::BNEZ)).addReg(Lt).addMBB(ExitMBB);
+
+  unsigned Cnt = MRI.createVirtualRegister(RC);
+  unsigned R = MRI.createVirtualRegister(RC);
+  unsigned Q = MRI.createVirtualRegister(RC);
+  unsigned DS = MRI.createVirtualRegister(RC);
+  unsigned T = MRI.createVirtualRegister(RC);
+  unsigned Diff = MRI.createVirtualRegister(RC);
+  unsigned R1 = MRI.createVirtualRegister(RC);
+  unsigned QS = MRI.createVirtualRegister(RC);
+  unsigned Q1 = MRI.createVirtualRegister(RC);
+  unsigned DS1 = MRI.createVirtualRegister(RC);
+  unsigned Cnt1 = MRI.createVirtualRegister(RC);
+
+  BuildMI(LoopMBB, dl, TII->get(Tile::PHI), Cnt)
+      .addReg(Cnt0).addMBB(BB)
+      .addReg(Cnt1).addMBB(LoopMBB);
+  BuildMI(LoopMBB, dl, TII->get(Tile::PHI), R)
+      .addReg(Num).addMBB(BB)
+      .addReg(R1).addMBB(LoopMBB);
+  BuildMI(LoopMBB, dl, TII->get(Tile::PHI), Q)
+      .addReg(Zero).addMBB(BB)
+      .addReg(Q1).addMBB(LoopMBB);
+  BuildMI(LoopMBB, dl, TII->get(Tile::PHI), DS)
+      .addReg(DS0).addMBB(BB)
+      .addReg(DS1).addMBB(LoopMBB);
+
+  BuildMI(LoopMBB, dl, TII->get(Tile::CMPLEU), T).addReg(DS).addReg(R);
+  BuildMI(LoopMBB, dl, TII->get(Tile::SUB), Diff).addReg(R).addReg(DS);
+  BuildMI(LoopMBB, dl, TII->get(Tile::CMOVNEZ), R1).addReg(T)
+      .addReg(Diff).addReg(R);
+  BuildMI(LoopMBB, dl, TII->get(Tile::SHLI), QS).addReg(Q).addImm(1);
+  BuildMI(LoopMBB, dl, TII->get(Tile::OR), Q1).addReg(QS).addReg(T);
+  BuildMI(LoopMBB, dl, TII->get(Tile::SHRUI), DS1).addReg(DS).addImm(1);
+  BuildMI(LoopMBB, dl, TII->get(Tile::ADDI), Cnt1).addReg(Cnt).addImm(-1);
+  BuildMI(LoopMBB, dl, TII->get(Tile::BGEZ)).addReg(Cnt1).addMBB(LoopMBB);
+
+  BuildMI(*ExitMBB, ExitMBB->begin(), dl, TII->get(Tile::PHI), Rem)
+      .addReg(Num).addMBB(BB)
+      .addReg(R1).addMBB(LoopMBB);
+  BuildMI(*ExitMBB, ExitMBB->begin(), dl, TII->get(Tile::PHI), Quot)
+      .addReg(Zero).addMBB(BB)
+      .addReg(Q1).addMBB(LoopMBB);
+
+  MI->eraseFromParent();
+  return ExitMBB;
 }
 
 //===----------------------------------------------------------------------===//
@@ -524,6 +963,75 @@ SDValue TileTargetLowering::lowerBR_JT(SDValue Op, SelectionDAG &DAG) const {
                      JTI);
 }
 
+// Create the target flavour of an address node, tagged with Flag.
+static SDValue getTargetNode(SDValue Op, SelectionDAG &DAG, unsigned char Flag) {
+  EVT Ty = Op.getValueType();
+
+  if (GlobalAddressSDNode *N = dyn_cast<GlobalAddressSDNode>(Op))
+    return DAG.getTargetGlobalAddress(N->getGlobal(), Op.getDebugLoc(), Ty,
+                                      N->getOffset(), Flag);
+  if (BlockAddressSDNode *N = dyn_cast<BlockAddressSDNode>(Op))
+    return DAG.getTargetBlockAddress(N->getBlockAddress(), Ty, N->getOffset(),
+                                     Flag);
+  if (JumpTableSDNode *N = dyn_cast<JumpTableSDNode>(Op))
+    return DAG.getTargetJumpTable(N->getIndex(), Ty, Flag);
+
+  ConstantPoolSDNode *N = cast<ConstantPoolSDNode>(Op);
+  return DAG.getTargetConstantPool(N->getConstVal(), Ty, N->getAlignment(),
+                                   N->getOffset(), Flag);
+}
+
+// Materialize the address of Op relative to the lnk of the function entry.
+// The link register is set up once per function by GenPICHeader.
+SDValue TileTargetLowering::getPCRelAddr(SDValue Op, SelectionDAG &DAG) const {
+  DebugLoc dl = Op.getDebugLoc();
+  EVT Ty = Op.getValueType();
+
+  SDValue Hi = getTargetNode(Op, DAG, TileII::MO_HW1_LAST_PIC);
+  SDValue Lo = getTargetNode(Op, DAG, TileII::MO_HW0_PIC);
+  SDValue Addr = DAG.getNode(TileISD::MOVE, dl, Ty, Hi);
+  Addr = DAG.getNode(TileISD::SAR16, dl, Ty, Addr, Lo);
+
+  return DAG.getNode(ISD::ADD, dl, Ty, GetLinkReg(DAG, Ty), Addr);
+}
+
+// Materialize the absolute address of Op. IsLocal says that the object is
+// defined in this module, which lets the medium code model address it
+// PC-relatively.
+SDValue TileTargetLowering::getAbsAddr(SDValue Op, SelectionDAG &DAG,
+                                       bool IsLocal) const {
+  DebugLoc dl = Op.getDebugLoc();
+  EVT Ty = Op.getValueType();
+
+  switch (getTargetMachine().getCodeModel()) {
+  case CodeModel::Small: {
+    // The whole image lives in the low 32 bits of the address space.
+    SDValue Hi = getTargetNode(Op, DAG, TileII::MO_HW1_LAST);
+    SDValue Lo = getTargetNode(Op, DAG, TileII::MO_HW0);
+    SDValue Addr = DAG.getNode(TileISD::MOVE, dl, Ty, Hi);
+    return DAG.getNode(TileISD::SAR16, dl, Ty, Addr, Lo);
+  }
+  case CodeModel::Medium:
+    // Module local data is within 2GB of the code.
+    if (IsLocal)
+      return getPCRelAddr(Op, DAG);
+    break;
+  default:
+    break;
+  }
+
+  SDValue High = getTargetNode(Op, DAG, TileII::MO_HW2_LAST);
+  SDValue Middle = getTargetNode(Op, DAG, TileII::MO_HW1);
+  SDValue Low = getTargetNode(Op, DAG, TileII::MO_HW0);
+
+  // >=32 part
+  SDValue Addr = DAG.getNode(TileISD::MOVE, dl, Ty, High);
+  // >=16 part
+  Addr = DAG.getNode(TileISD::SAR16, dl, Ty, Addr, Middle);
+  // >=0 part
+  return DAG.getNode(TileISD::SAR16, dl, Ty, Addr, Low);
+}
+
 SDValue
 TileTargetLowering::lowerGlobalAddress(SDValue Op, SelectionDAG &DAG) const {
   DebugLoc dl = Op.getDebugLoc();
@@ -531,41 +1039,23 @@ TileTargetLowering::lowerGlobalAddress(SDValue Op, SelectionDAG &DAG) const {
 
   // NON-PIC
   if (getTargetMachine().getRelocationModel() != Reloc::PIC_) {
-    SDValue GlobalAddrHigh =
-        DAG.getTargetGlobalAddress(GV, dl, MVT::i64, 0, TileII::MO_HW2_LAST);
-    SDValue GlobalAddrMiddle =
-        DAG.getTargetGlobalAddress(GV, dl, MVT::i64, 0, TileII::MO_HW1);
-    SDValue GlobalAddrLow =
-        DAG.getTargetGlobalAddress(GV, dl, MVT::i64, 0, TileII::MO_HW0);
-
-    // >=32 part
-    SDValue Addr = DAG.getNode(TileISD::MOVE, dl, MVT::i64, GlobalAddrHigh);
-    // >=16 part
-    Addr = DAG.getNode(TileISD::SAR16, dl, MVT::i64, Addr, GlobalAddrMiddle);
-    // >=0 part
-    return DAG.getNode(TileISD::SAR16, dl, MVT::i64, Addr, GlobalAddrLow);
+    bool IsLocal = GV->hasLocalLinkage() ||
+                   (!GV->isDeclaration() && !GV->isWeakForLinker());
+    return getAbsAddr(Op, DAG, IsLocal);
   }
 
   // PIC
-  unsigned char Flag1 = TileII::MO_HW1_LAST_GOT;
-  unsigned char Flag2 = TileII::MO_HW0_GOT;
-  SDValue BaseReg = GetGlobalReg(DAG, MVT::i64);
   bool Internal =
       GV->hasInternalLinkage() || (GV->hasLocalLinkage() && !isa<Function>(GV));
-  if (Internal) {
-    Flag1 = TileII::MO_HW1_LAST_PIC;
-    Flag2 = TileII::MO_HW0_PIC;
-    BaseReg = GetLinkReg(DAG, MVT::i64);
-  }
+  if (Internal)
+    return getPCRelAddr(Op, DAG);
 
-  SDValue GotEntryHigh = DAG.getTargetGlobalAddress(GV, dl, MVT::i64, 0, Flag1);
-  SDValue GotEntryLow = DAG.getTargetGlobalAddress(GV, dl, MVT::i64, 0, Flag2);
+  SDValue BaseReg = GetGlobalReg(DAG, MVT::i64);
+  SDValue GotEntryHigh = getTargetNode(Op, DAG, TileII::MO_HW1_LAST_GOT);
+  SDValue GotEntryLow = getTargetNode(Op, DAG, TileII::MO_HW0_GOT);
   SDValue Addr = DAG.getNode(TileISD::MOVE, dl, MVT::i64, GotEntryHigh);
   Addr = DAG.getNode(TileISD::SAR16, dl, MVT::i64, Addr, GotEntryLow);
 
-  if (Internal)
-    return DAG.getNode(ISD::ADD, dl, MVT::i64, BaseReg, Addr);
-
   Addr = DAG.getNode(ISD::ADD, dl, MVT::i64, BaseReg, Addr);
   return DAG.getLoad(MVT::i64, dl, DAG.getEntryNode(), Addr,
                      MachinePointerInfo(), false, false, false, 0);
@@ -573,37 +1063,10 @@ TileTargetLowering::lowerGlobalAddress(SDValue Op, SelectionDAG &DAG) const {
 
 SDValue
 TileTargetLowering::lowerBlockAddress(SDValue Op, SelectionDAG &DAG) const {
-  const BlockAddress *BA = cast<BlockAddressSDNode>(Op)->getBlockAddress();
-  DebugLoc dl = Op.getDebugLoc();
-
-  // NON-PIC
-  if (getTargetMachine().getRelocationModel() != Reloc::PIC_) {
-    SDValue BlockAddrHigh =
-        DAG.getTargetBlockAddress(BA, MVT::i64, 0, TileII::MO_HW2_LAST);
-    SDValue BlockAddrMiddle =
-        DAG.getTargetBlockAddress(BA, MVT::i64, 0, TileII::MO_HW1);
-    SDValue BlockAddrLow =
-        DAG.getTargetBlockAddress(BA, MVT::i64, 0, TileII::MO_HW0);
-
-    // >=32 part
-    SDValue Addr = DAG.getNode(TileISD::MOVE, dl, MVT::i64, BlockAddrHigh);
-    // >=16 part
-    Addr = DAG.getNode(TileISD::SAR16, dl, MVT::i64, Addr, BlockAddrMiddle);
-    // >=0 part
-    return DAG.getNode(TileISD::SAR16, dl, MVT::i64, Addr, BlockAddrLow);
-  }
-
-  // PIC
-  unsigned char Flag1 = TileII::MO_HW1_LAST_PIC;
-  unsigned char Flag2 = TileII::MO_HW0_PIC;
-  SDValue BaseReg = GetLinkReg(DAG, MVT::i64);
-
-  SDValue GotEntryHigh = DAG.getTargetBlockAddress(BA, MVT::i64, 0, Flag1);
-  SDValue GotEntryLow = DAG.getTargetBlockAddress(BA, MVT::i64, 0, Flag2);
-  SDValue Addr = DAG.getNode(TileISD::MOVE, dl, MVT::i64, GotEntryHigh);
-  Addr = DAG.getNode(TileISD::SAR16, dl, MVT::i64, Addr, GotEntryLow);
+  if (getTargetMachine().getRelocationModel() != Reloc::PIC_)
+    return getAbsAddr(Op, DAG, true);
 
-  return DAG.getNode(ISD::ADD, dl, MVT::i64, BaseReg, Addr);
+  return getPCRelAddr(Op, DAG);
 }
 
 SDValue
@@ -678,68 +1141,18 @@ TileTargetLowering::lowerGlobalTLSAddress(SDValue Op, SelectionDAG &DAG) const {
 
 SDValue
 TileTargetLowering::lowerJumpTable(SDValue Op, SelectionDAG &DAG) const {
-  SDValue Temp, JTI, JTILo;
-  DebugLoc dl = Op.getDebugLoc();
-  bool IsPIC = getTargetMachine().getRelocationModel() == Reloc::PIC_;
-  EVT PtrVT = Op.getValueType();
-  JumpTableSDNode *JT = cast<JumpTableSDNode>(Op);
-
-  unsigned char Flag1 = IsPIC ? TileII::MO_HW1_LAST_PIC : TileII::MO_HW2_LAST;
-  unsigned char Flag2 = IsPIC ? TileII::MO_HW0_PIC : TileII::MO_HW1;
-
-  JTI = DAG.getTargetJumpTable(JT->getIndex(), PtrVT, Flag1);
-  Temp = DAG.getNode(TileISD::MOVE, dl, PtrVT, JTI);
-  Temp = Temp.getValue(0);
-  JTI = DAG.getTargetJumpTable(JT->getIndex(), PtrVT, Flag2);
-  Temp = DAG.getNode(TileISD::SAR16, dl, PtrVT, Temp, JTI);
-  Temp = Temp.getValue(0);
-
-  if (!IsPIC) {
-    JTI = DAG.getTargetJumpTable(JT->getIndex(), PtrVT, TileII::MO_HW0);
-    return DAG.getNode(TileISD::SAR16, dl, PtrVT, Temp, JTI);
-  }
+  if (getTargetMachine().getRelocationModel() != Reloc::PIC_)
+    return getAbsAddr(Op, DAG, true);
 
-  return DAG.getNode(ISD::ADD, dl, PtrVT, Temp, GetLinkReg(DAG, PtrVT));
+  return getPCRelAddr(Op, DAG);
 }
 
 SDValue
 TileTargetLowering::lowerConstantPool(SDValue Op, SelectionDAG &DAG) const {
-  SDValue ResNode;
-  ConstantPoolSDNode *N = cast<ConstantPoolSDNode>(Op);
-  const Constant *C = N->getConstVal();
-  DebugLoc dl = Op.getDebugLoc();
-  EVT ValTy = Op.getValueType();
-
-  // NON-PIC
-  if (getTargetMachine().getRelocationModel() != Reloc::PIC_) {
-    SDValue AddrHigh = DAG.getTargetConstantPool(
-        C, ValTy, N->getAlignment(), N->getOffset(), TileII::MO_HW2_LAST);
-    SDValue AddrMiddle = DAG.getTargetConstantPool(
-        C, ValTy, N->getAlignment(), N->getOffset(), TileII::MO_HW1);
-    SDValue AddrLow = DAG.getTargetConstantPool(C, ValTy, N->getAlignment(),
-                                                N->getOffset(), TileII::MO_HW0);
-
-    // >=32 part
-    SDValue Addr = DAG.getNode(TileISD::MOVE, dl, ValTy, AddrHigh);
-    // >=16 part
-    Addr = DAG.getNode(TileISD::SAR16, dl, ValTy, Addr, AddrMiddle);
-    // >=0 part
-    return DAG.getNode(TileISD::SAR16, dl, ValTy, Addr, AddrLow);
-  }
-
-  // PIC
-  unsigned char Flag1 = TileII::MO_HW1_LAST_PIC;
-  unsigned char Flag2 = TileII::MO_HW0_PIC;
-  SDValue BaseReg = GetLinkReg(DAG, MVT::i64);
-
-  SDValue RelHigh = DAG.getTargetConstantPool(C, ValTy, N->getAlignment(),
-                                              N->getOffset(), Flag1);
-  SDValue RelLow = DAG.getTargetConstantPool(C, ValTy, N->getAlignment(),
-                                             N->getOffset(), Flag2);
-  SDValue Addr = DAG.getNode(TileISD::MOVE, dl, MVT::i64, RelHigh);
-  SDValue GotOff = DAG.getNode(TileISD::SAR16, dl, MVT::i64, Addr, RelLow);
+  if (getTargetMachine().getRelocationModel() != Reloc::PIC_)
+    return getAbsAddr(Op, DAG, true);
 
-  return DAG.getNode(ISD::ADD, dl, MVT::i64, BaseReg, GotOff);
+  return getPCRelAddr(Op, DAG);
 }
 
 SDValue TileTargetLowering::lowerVASTART(SDValue Op, SelectionDAG &DAG) const {
@@ -994,45 +1407,495 @@ TileTargetLowering::lowerFpIntConv(SDValue Op, SelectionDAG &DAG) const {
                      Op.getDebugLoc());
 }
 
+// There is no instruction cache prefetch, drop those and keep the
+// data prefetches for the patterns.
+SDValue
+TileTargetLowering::lowerPREFETCH(SDValue Op, SelectionDAG &DAG) const {
+  if (cast<ConstantSDNode>(Op.getOperand(4))->isNullValue())
+    return Op.getOperand(0);
+  return Op;
+}
+
+// A fence for a single thread only restrains the compiler, and a fence
+// right behind a cross-thread one has nothing left to order.
+SDValue
+TileTargetLowering::lowerATOMIC_FENCE(SDValue Op, SelectionDAG &DAG) const {
+  SDValue Chain = Op.getOperand(0);
+  SynchronizationScope Scope = static_cast<SynchronizationScope>(
+      cast<ConstantSDNode>(Op.getOperand(2))->getZExtValue());
+
+  if (Scope == SingleThread)
+    return Chain;
+
+  // A singlethread fence does not order anything across threads, so it
+  // cannot stand in for this one.
+  if (Chain.getOpcode() == ISD::ATOMIC_FENCE &&
+      cast<ConstantSDNode>(Chain.getOperand(2))->getZExtValue() == CrossThread)
+    return Chain;
+  return Op;
+}
+
+// Sub-word atomics are promoted to i32 but still access 1 or 2 bytes,
+// expand those into __sync libcalls. There is no fetchsub, subtract by
+// adding the negated value.
+SDValue
+TileTargetLowering::lowerATOMIC_RMW(SDValue Op, SelectionDAG &DAG) const {
+  AtomicSDNode *AN = cast<AtomicSDNode>(Op);
+  if (AN->getMemoryVT().getSizeInBits() < 32)
+    return SDValue();
+
+  if (Op.getOpcode() != ISD::ATOMIC_LOAD_SUB)
+    return Op;
+
+  DebugLoc dl = Op.getDebugLoc();
+  EVT VT = Op.getValueType();
+  SDValue NegVal =
+      DAG.getNode(ISD::SUB, dl, VT, DAG.getConstant(0, VT), AN->getVal());
+  return DAG.getAtomic(ISD::ATOMIC_LOAD_ADD, dl, AN->getMemoryVT(),
+                       AN->getChain(), AN->getBasePtr(), NegVal,
+                       AN->getMemOperand(), AN->getOrdering(),
+                       AN->getSynchScope());
+}
+
 //===----------------------------------------------------------------------===//
-//                      Calling Convention Implementation
+//                      SIMD Implementation
 //===----------------------------------------------------------------------===//
-static const uint16_t TileIntRegs[TILEGX_AREG_NUM] = {
-  Tile::R0, Tile::R1, Tile::R2, Tile::R3, Tile::R4, Tile::R5, Tile::R6,
-  Tile::R7, Tile::R8, Tile::R9
-};
-
-static bool
-CC_TileByval(unsigned ValNo, MVT ValVT, MVT LocVT, CCValAssign::LocInfo LocInfo,
-             ISD::ArgFlagsTy ArgFlags, CCState &State) {
-  unsigned Align = std::max(ArgFlags.getByValAlign(), (unsigned) 8);
-  unsigned Size = RoundUpToAlignment(ArgFlags.getByValSize(), Align);
-  unsigned FirstIdx = State.getFirstUnallocated(TileIntRegs, TILEGX_AREG_NUM);
-
-  assert(Align <= 16 && "Cannot handle alignments larger than 16.");
-
-  // If byval is 16-byte aligned, the first arg register must be even.
-  if ((Align == 16) && (FirstIdx % 2)) {
-    State.AllocateReg(TileIntRegs[FirstIdx]);
-    ++FirstIdx;
+// Return the scalar every lane of the vector shift amount Amt is equal to,
+// or a null SDValue if the lanes may differ.
+static SDValue getSplatShiftAmount(SDValue Amt) {
+  if (Amt.getOpcode() == ISD::BUILD_VECTOR) {
+    SDValue Elt = Amt.getOperand(0);
+    for (unsigned i = 1, e = Amt.getNumOperands(); i != e; ++i)
+      if (Amt.getOperand(i) != Elt)
+        return SDValue();
+    return Elt;
+  }
+
+  ShuffleVectorSDNode *SVN = dyn_cast<ShuffleVectorSDNode>(Amt);
+  if (!SVN || !SVN->isSplat())
+    return SDValue();
+
+  unsigned NumElts = Amt.getValueType().getVectorNumElements();
+  unsigned Idx = SVN->getSplatIndex();
+  SDValue Src = Amt.getOperand(Idx / NumElts);
+  Idx %= NumElts;
+
+  switch (Src.getOpcode()) {
+  case ISD::BUILD_VECTOR:
+    return Src.getOperand(Idx);
+  case ISD::SCALAR_TO_VECTOR:
+    if (Idx == 0)
+      return Src.getOperand(0);
+    break;
+  case ISD::INSERT_VECTOR_ELT:
+    if (ConstantSDNode *C = dyn_cast<ConstantSDNode>(Src.getOperand(2)))
+      if (C->getZExtValue() == Idx)
+        return Src.getOperand(1);
+    break;
   }
+  return SDValue();
+}
+
+// Vector booleans are all ones lanes, negate the 0 or 1 of the lane
+// compare.
+SDValue TileTargetLowering::lowerVSETCC(SDValue Op, SelectionDAG &DAG) const {
+  DebugLoc DL = Op.getDebugLoc();
+  EVT VT = Op.getValueType();
+  SDValue Zero = DAG.getNode(ISD::BITCAST, DL, VT,
+                             DAG.getConstant(0, MVT::i64));
+  return DAG.getNode(ISD::SUB, DL, VT, Zero, getLaneCompare(Op, DAG));
+}
 
-  // Mark the registers allocated.
-  for (unsigned I = FirstIdx; Size && (I < TILEGX_AREG_NUM); Size -= 8, ++I)
-    State.AllocateReg(TileIntRegs[I]);
+// TILE-Gx SIMD shifts move every lane by the same amount, so only
+// uniform shifts can be lowered. Returning a null SDValue lets the
+// legalizer unroll the others.
+SDValue
+TileTargetLowering::lowerVectorShift(SDValue Op, SelectionDAG &DAG) const {
+  EVT VT = Op.getValueType();
+  if (!VT.isVector())
+    return SDValue();
 
-  // Allocate space on caller's stack.
-  unsigned Offset = State.AllocateStack(Size, Align);
+  SDValue Amt = getSplatShiftAmount(Op.getOperand(1));
+  if (!Amt.getNode())
+    return SDValue();
 
-  if (FirstIdx < TILEGX_AREG_NUM)
-    State.addLoc(CCValAssign::getReg(ValNo, ValVT, TileIntRegs[FirstIdx], LocVT,
-                                     LocInfo));
-  else
-    State.addLoc(CCValAssign::getMem(ValNo, ValVT, Offset, LocVT, LocInfo));
+  DebugLoc DL = Op.getDebugLoc();
+  if (ConstantSDNode *C = dyn_cast<ConstantSDNode>(Amt)) {
+    uint64_t ShAmt = C->getZExtValue();
+    if (ShAmt >= VT.getVectorElementType().getSizeInBits())
+      return SDValue();
+    Amt = DAG.getConstant(ShAmt, MVT::i64);
+  } else
+    Amt = DAG.getAnyExtOrTrunc(Amt, DL, MVT::i64);
+
+  unsigned Opc;
+  switch (Op.getOpcode()) {
+  case ISD::SHL:
+    Opc = TileISD::VSHL;
+    break;
+  case ISD::SRL:
+    Opc = TileISD::VSRL;
+    break;
+  case ISD::SRA:
+    Opc = TileISD::VSRA;
+    break;
+  default:
+    llvm_unreachable("lowerVectorShift: unexpected opcode met!");
+  }
+
+  return DAG.getNode(Opc, DL, VT, Op.getOperand(0), Amt);
+}
+
+// The SIMD types all live in 64-bit general registers, so lane moves
+// are done on the i64 view of the vector.
+static SDValue bitcastToI64(SDValue V, SelectionDAG &DAG, DebugLoc DL) {
+  return DAG.getNode(ISD::BITCAST, DL, MVT::i64, V);
+}
+
+// Check whether Mask interleaves the low (or high) halves of two vectors,
+// and which of the two inputs feeds the even and the odd lanes.
+static bool isInterleaveMask(ArrayRef<int> Mask, bool Hi,
+                             unsigned &EvenSrc, unsigned &OddSrc) {
+  unsigned NumElts = Mask.size();
+  unsigned Base = Hi ? NumElts / 2 : 0;
+  int Src[2] = { -1, -1 };
+
+  for (unsigned i = 0; i != NumElts; ++i) {
+    if (Mask[i] < 0)
+      continue;
+    if ((unsigned) Mask[i] % NumElts != Base + i / 2)
+      return false;
+    int &S = Src[i & 1];
+    int MSrc = Mask[i] / NumElts;
+    if (S >= 0 && S != MSrc)
+      return false;
+    S = MSrc;
+  }
+
+  EvenSrc = Src[0] < 0 ? 0 : Src[0];
+  OddSrc = Src[1] < 0 ? 0 : Src[1];
+  return true;
+}
+
+// Check whether Mask takes consecutive lanes out of the concatenation
+// of the two inputs, and return the first lane in Start.
+static bool isWindowMask(ArrayRef<int> Mask, bool Unary, unsigned &Start) {
+  unsigned NumElts = Mask.size();
+  int First = -1;
+
+  for (unsigned i = 0; i != NumElts; ++i) {
+    if (Mask[i] < 0)
+      continue;
+    int S = Mask[i] - (int) i;
+    if (Unary)
+      S = (S + NumElts) % NumElts;
+    if (First >= 0 && S != First)
+      return false;
+    First = S;
+  }
 
+  if (First <= 0 || First >= (int) NumElts)
+    return false;
+  Start = First;
   return true;
 }
 
+// A single v*int_* or dblalign handles the interleaving and sliding window
+// masks, anything else is a shufflebytes with a constant selector.
+SDValue
+TileTargetLowering::lowerVECTOR_SHUFFLE(SDValue Op, SelectionDAG &DAG) const {
+  ShuffleVectorSDNode *SVN = cast<ShuffleVectorSDNode>(Op.getNode());
+  EVT VT = Op.getValueType();
+  ArrayRef<int> Mask = SVN->getMask();
+  unsigned NumElts = VT.getVectorNumElements();
+  unsigned EltBytes = 8 / NumElts;
+  bool Unary = Op.getOperand(1).getOpcode() == ISD::UNDEF;
+  DebugLoc DL = Op.getDebugLoc();
+
+  // v*int_* rd, rsa, rsb puts the lanes of rsb in the even positions.
+  unsigned EvenSrc, OddSrc;
+  if (isInterleaveMask(Mask, false, EvenSrc, OddSrc))
+    return DAG.getNode(TileISD::VINT_L, DL, VT, Op.getOperand(OddSrc),
+                       Op.getOperand(EvenSrc));
+  if (isInterleaveMask(Mask, true, EvenSrc, OddSrc))
+    return DAG.getNode(TileISD::VINT_H, DL, VT, Op.getOperand(OddSrc),
+                       Op.getOperand(EvenSrc));
+
+  SDValue V1 = bitcastToI64(Op.getOperand(0), DAG, DL);
+  SDValue V2 = Unary ? V1 : bitcastToI64(Op.getOperand(1), DAG, DL);
+  SDValue Res;
+
+  unsigned Start;
+  if (isWindowMask(Mask, Unary, Start)) {
+    Res = DAG.getNode(TileISD::DBLALIGN, DL, MVT::i64, V1, V2,
+                      DAG.getConstant(Start * EltBytes, MVT::i64));
+  } else {
+    // Selector values 0-7 pick bytes of V1, 8-15 bytes of V2.
+    uint64_t Sel = 0;
+    for (unsigned i = 0; i != NumElts; ++i) {
+      if (Mask[i] < 0)
+        continue;
+      uint64_t SrcByte = (Unary ? Mask[i] % NumElts : Mask[i]) * EltBytes;
+      for (unsigned b = 0; b != EltBytes; ++b)
+        Sel |= (SrcByte + b) << ((i * EltBytes + b) * 8);
+    }
+    Res = DAG.getNode(TileISD::SHUFFLEBYTES, DL, MVT::i64, V1, V2,
+                      DAG.getConstant(Sel, MVT::i64));
+  }
+
+  return DAG.getNode(ISD::BITCAST, DL, VT, Res);
+}
+
+// Constant lanes are folded into one 64-bit immediate, a splat is a
+// single shufflebytes (or v4int_l), the remaining lanes are bfins'ed.
+SDValue
+TileTargetLowering::lowerBUILD_VECTOR(SDValue Op, SelectionDAG &DAG) const {
+  EVT VT = Op.getValueType();
+  unsigned NumElts = VT.getVectorNumElements();
+  unsigned EltBits = VT.getVectorElementType().getSizeInBits();
+  uint64_t EltMask = (EltBits == 64) ? ~0ULL : (1ULL << EltBits) - 1;
+  DebugLoc DL = Op.getDebugLoc();
+
+  uint64_t Bits = 0;
+  bool HasConstant = false;
+  SDValue SplatVal;
+  bool IsSplat = true;
+  unsigned NumDefined = 0;
+  for (unsigned i = 0; i != NumElts; ++i) {
+    SDValue Elt = Op.getOperand(i);
+    if (Elt.getOpcode() == ISD::UNDEF)
+      continue;
+    ++NumDefined;
+    if (ConstantSDNode *C = dyn_cast<ConstantSDNode>(Elt)) {
+      Bits |= (C->getZExtValue() & EltMask) << (i * EltBits);
+      HasConstant = true;
+      continue;
+    }
+    if (SplatVal.getNode() && SplatVal != Elt)
+      IsSplat = false;
+    SplatVal = Elt;
+  }
+
+  if (!SplatVal.getNode())
+    return DAG.getNode(ISD::BITCAST, DL, VT, DAG.getConstant(Bits, MVT::i64));
+
+  // Only lane 0 is defined: the scalar already sits in the right place.
+  if (NumDefined == 1 && SplatVal == Op.getOperand(0))
+    return DAG.getNode(ISD::BITCAST, DL, VT,
+                       DAG.getAnyExtOrTrunc(SplatVal, DL, MVT::i64));
+
+  SDValue Res;
+  if (IsSplat && !HasConstant) {
+    SDValue X = DAG.getAnyExtOrTrunc(SplatVal, DL, MVT::i64);
+    if (EltBits == 32) {
+      X = DAG.getNode(ISD::BITCAST, DL, VT, X);
+      return DAG.getNode(TileISD::VINT_L, DL, VT, X, X);
+    }
+
+    uint64_t Sel = 0;
+    for (unsigned i = 0; i != 8; ++i)
+      Sel |= (uint64_t) (i % (EltBits / 8)) << (i * 8);
+    Res = DAG.getNode(TileISD::SHUFFLEBYTES, DL, MVT::i64, X, X,
+                      DAG.getConstant(Sel, MVT::i64));
+    return DAG.getNode(ISD::BITCAST, DL, VT, Res);
+  }
+
+  Res = DAG.getConstant(Bits, MVT::i64);
+  for (unsigned i = 0; i != NumElts; ++i) {
+    SDValue Elt = Op.getOperand(i);
+    if (Elt.getOpcode() == ISD::UNDEF || isa<ConstantSDNode>(Elt))
+      continue;
+    Res = DAG.getNode(TileISD::BFINS, DL, MVT::i64,
+                      DAG.getAnyExtOrTrunc(Elt, DL, MVT::i64),
+                      DAG.getConstant(i * EltBits, MVT::i64),
+                      DAG.getConstant((i + 1) * EltBits - 1, MVT::i64), Res);
+  }
+
+  return DAG.getNode(ISD::BITCAST, DL, VT, Res);
+}
+
+SDValue
+TileTargetLowering::lowerEXTRACT_VECTOR_ELT(SDValue Op,
+                                            SelectionDAG &DAG) const {
+  EVT VT = Op.getValueType();
+  EVT VecVT = Op.getOperand(0).getValueType();
+  unsigned EltBits = VecVT.getVectorElementType().getSizeInBits();
+  DebugLoc DL = Op.getDebugLoc();
+  SDValue Vec = bitcastToI64(Op.getOperand(0), DAG, DL);
+  SDValue Idx = Op.getOperand(1);
+
+  if (ConstantSDNode *C = dyn_cast<ConstantSDNode>(Idx)) {
+    uint64_t Start = C->getZExtValue() * EltBits;
+    return DAG.getNode(TileISD::BFEXTU, DL, VT, Vec,
+                       DAG.getConstant(Start, MVT::i64),
+                       DAG.getConstant(Start + EltBits - 1, MVT::i64));
+  }
+
+  // Variable lane: shift it down to the bottom. The bits above the lane
+  // are left undefined, as EXTRACT_VECTOR_ELT allows.
+  EVT IdxTy = Idx.getValueType();
+  SDValue Amt = DAG.getNode(ISD::SHL, DL, IdxTy, Idx,
+                            DAG.getConstant(Log2_32(EltBits),
+                                            getShiftAmountTy(IdxTy)));
+  SDValue Res = DAG.getNode(ISD::SRL, DL, MVT::i64, Vec,
+                            DAG.getZExtOrTrunc(Amt, DL,
+                                               getShiftAmountTy(MVT::i64)));
+  return DAG.getAnyExtOrTrunc(Res, DL, VT);
+}
+
+SDValue
+TileTargetLowering::lowerINSERT_VECTOR_ELT(SDValue Op,
+                                           SelectionDAG &DAG) const {
+  ConstantSDNode *C = dyn_cast<ConstantSDNode>(Op.getOperand(2));
+  if (!C)
+    return SDValue();
+
+  EVT VT = Op.getValueType();
+  unsigned EltBits = VT.getVectorElementType().getSizeInBits();
+  uint64_t Start = C->getZExtValue() * EltBits;
+  DebugLoc DL = Op.getDebugLoc();
+
+  SDValue Res =
+    DAG.getNode(TileISD::BFINS, DL, MVT::i64,
+                DAG.getAnyExtOrTrunc(Op.getOperand(1), DL, MVT::i64),
+                DAG.getConstant(Start, MVT::i64),
+                DAG.getConstant(Start + EltBits - 1, MVT::i64),
+                bitcastToI64(Op.getOperand(0), DAG, DL));
+  return DAG.getNode(ISD::BITCAST, DL, VT, Res);
+}
+
+// Lower i32 division and remainder to TileISD::UDIVREM32 on the 64-bit
+// extended operands. Signed forms divide the magnitudes and fix the signs
+// up afterwards; div and rem of the same operands share one loop. Functions
+// optimized for size keep the libcall.
+SDValue TileTargetLowering::lowerDIVREM32(SDValue Op, SelectionDAG &DAG) const {
+  unsigned Opc = Op.getOpcode();
+  bool Signed = Opc == ISD::SDIV || Opc == ISD::SREM;
+  bool IsRem = Opc == ISD::SREM || Opc == ISD::UREM;
+  DebugLoc DL = Op.getDebugLoc();
+
+  MachineFunction &MF = DAG.getMachineFunction();
+  if (MF.getFunction()->getAttributes().hasAttribute(
+          AttributeSet::FunctionIndex, Attribute::OptimizeForSize)) {
+    // Call the rem routine directly, the generic expansion of a rem with a
+    // custom div is a div call plus a multiply.
+    RTLIB::Libcall LC = Signed ? (IsRem ? RTLIB::SREM_I32 : RTLIB::SDIV_I32)
+                               : (IsRem ? RTLIB::UREM_I32 : RTLIB::UDIV_I32);
+    SDValue Ops[2] = { Op.getOperand(0), Op.getOperand(1) };
+    return makeLibCall(DAG, LC, MVT::i32, Ops, 2, Signed, DL);
+  }
+
+  unsigned ExtOpc = Signed ? ISD::SIGN_EXTEND : ISD::ZERO_EXTEND;
+
+  SDValue N = DAG.getNode(ExtOpc, DL, MVT::i64, Op.getOperand(0));
+  SDValue D = DAG.getNode(ExtOpc, DL, MVT::i64, Op.getOperand(1));
+  SDValue NSign, DSign;
+  if (Signed) {
+    // |x| = (x ^ s) - s, s = x >> 63.
+    SDValue Amt = DAG.getConstant(63, getShiftAmountTy(MVT::i64));
+    NSign = DAG.getNode(ISD::SRA, DL, MVT::i64, N, Amt);
+    DSign = DAG.getNode(ISD::SRA, DL, MVT::i64, D, Amt);
+    N = DAG.getNode(ISD::SUB, DL, MVT::i64,
+                    DAG.getNode(ISD::XOR, DL, MVT::i64, N, NSign), NSign);
+    D = DAG.getNode(ISD::SUB, DL, MVT::i64,
+                    DAG.getNode(ISD::XOR, DL, MVT::i64, D, DSign), DSign);
+  }
+
+  SDValue DivRem = DAG.getNode(TileISD::UDIVREM32, DL,
+                               DAG.getVTList(MVT::i64, MVT::i64), N, D);
+  SDValue Res = DivRem.getValue(IsRem ? 1 : 0);
+
+  if (Signed) {
+    // The remainder has the sign of the dividend, the quotient is negative
+    // when the signs differ.
+    SDValue Sign =
+        IsRem ? NSign : DAG.getNode(ISD::XOR, DL, MVT::i64, NSign, DSign);
+    Res = DAG.getNode(ISD::SUB, DL, MVT::i64,
+                      DAG.getNode(ISD::XOR, DL, MVT::i64, Res, Sign), Sign);
+  }
+  return DAG.getNode(ISD::TRUNCATE, DL, MVT::i32, Res);
+}
+
+// There is no reciprocal or square root estimate instruction. Seed
+// Newton-Raphson with the exponent trick on the integer image instead,
+// magic - bits(b) ~ 1/b and magic - (bits(a) >> 1) ~ 1/sqrt(a), and
+// refine with the fsingle/fdouble multiply and add sequences. The
+// iteration counts give a few ulp, which is only good enough for
+// fast-math; otherwise the operations stay libcalls.
+static SDValue getFPEstimate(SDValue X, uint64_t Magic, bool Sqrt,
+                             SelectionDAG &DAG, DebugLoc DL) {
+  EVT VT = X.getValueType();
+  EVT IntVT = VT == MVT::f64 ? MVT::i64 : MVT::i32;
+  SDValue Bits = DAG.getNode(ISD::BITCAST, DL, IntVT, X);
+  if (Sqrt)
+    Bits = DAG.getNode(
+        ISD::SRL, DL, IntVT, Bits,
+        DAG.getConstant(1, DAG.getTargetLoweringInfo().getShiftAmountTy(IntVT)));
+  SDValue Est = DAG.getNode(ISD::SUB, DL, IntVT,
+                            DAG.getConstant(Magic, IntVT), Bits);
+  return DAG.getNode(ISD::BITCAST, DL, VT, Est);
+}
+
+SDValue TileTargetLowering::lowerFDIV(SDValue Op, SelectionDAG &DAG) const {
+  if (!getTargetMachine().Options.UnsafeFPMath)
+    return SDValue();
+
+  EVT VT = Op.getValueType();
+  DebugLoc DL = Op.getDebugLoc();
+  SDValue A = Op.getOperand(0), B = Op.getOperand(1);
+  bool IsF64 = VT == MVT::f64;
+
+  // x' = x * (2 - b * x)
+  SDValue X = getFPEstimate(B, IsF64 ? 0x7FDE623822FC16E6ULL : 0x7EF311C3,
+                            false, DAG, DL);
+  SDValue Two = DAG.getConstantFP(2.0, VT);
+  for (unsigned i = 0, e = IsF64 ? 4 : 3; i != e; ++i) {
+    SDValue E = DAG.getNode(ISD::FSUB, DL, VT, Two,
+                            DAG.getNode(ISD::FMUL, DL, VT, B, X));
+    X = DAG.getNode(ISD::FMUL, DL, VT, X, E);
+  }
+  return DAG.getNode(ISD::FMUL, DL, VT, A, X);
+}
+
+SDValue TileTargetLowering::lowerFSQRT(SDValue Op, SelectionDAG &DAG) const {
+  if (!getTargetMachine().Options.UnsafeFPMath)
+    return SDValue();
+
+  EVT VT = Op.getValueType();
+  DebugLoc DL = Op.getDebugLoc();
+  SDValue A = Op.getOperand(0);
+  bool IsF64 = VT == MVT::f64;
+
+  // y' = y * (1.5 - (a / 2) * y * y), then sqrt(a) = a * y.
+  SDValue Y = getFPEstimate(A, IsF64 ? 0x5FE6EB50C7B537A9ULL : 0x5F3759DF,
+                            true, DAG, DL);
+  SDValue HalfA = DAG.getNode(ISD::FMUL, DL, VT, A,
+                              DAG.getConstantFP(0.5, VT));
+  SDValue ThreeHalves = DAG.getConstantFP(1.5, VT);
+  for (unsigned i = 0, e = IsF64 ? 4 : 3; i != e; ++i) {
+    SDValue YY = DAG.getNode(ISD::FMUL, DL, VT, Y, Y);
+    SDValue E = DAG.getNode(ISD::FSUB, DL, VT, ThreeHalves,
+                            DAG.getNode(ISD::FMUL, DL, VT, HalfA, YY));
+    Y = DAG.getNode(ISD::FMUL, DL, VT, Y, E);
+  }
+  SDValue Res = DAG.getNode(ISD::FMUL, DL, VT, A, Y);
+
+  // The estimate for +-0 grows to infinity, return the input unchanged.
+  EVT IntVT = IsF64 ? MVT::i64 : MVT::i32;
+  SDValue ABits = DAG.getNode(ISD::BITCAST, DL, IntVT, A);
+  SDValue Mag = DAG.getNode(ISD::AND, DL, IntVT, ABits,
+                            DAG.getConstant(IsF64 ? 0x7FFFFFFFFFFFFFFFULL : 0x7FFFFFFF,
+                                            IntVT));
+  SDValue IsZero = DAG.getSetCC(DL, getSetCCResultType(IntVT), Mag,
+                                DAG.getConstant(0, IntVT), ISD::SETEQ);
+  Res = DAG.getNode(ISD::SELECT, DL, IntVT, IsZero, ABits,
+                    DAG.getNode(ISD::BITCAST, DL, IntVT, Res));
+  return DAG.getNode(ISD::BITCAST, DL, VT, Res);
+}
+
+//===----------------------------------------------------------------------===//
+//                      Calling Convention Implementation
+//===----------------------------------------------------------------------===//
 #include "TileGenCallingConv.inc"
 
 static void AnalyzeTileCallOperands(
@@ -1741,7 +2604,46 @@ TileTargetLowering::isOffsetFoldingLegal(const GlobalAddressSDNode *GA) const {
   return false;
 }
 
+// Fold an add of a signed 8 bit constant to the address of a load or
+// store into a post-increment ld*_add/st*_add.
+bool TileTargetLowering::getPostIndexedAddressParts(SDNode *N, SDNode *Op,
+                                                    SDValue &Base,
+                                                    SDValue &Offset,
+                                                    ISD::MemIndexedMode &AM,
+                                                    SelectionDAG &DAG) const {
+  SDValue Ptr;
+  if (LoadSDNode *LD = dyn_cast<LoadSDNode>(N))
+    Ptr = LD->getBasePtr();
+  else if (StoreSDNode *ST = dyn_cast<StoreSDNode>(N))
+    Ptr = ST->getBasePtr();
+  else
+    return false;
+
+  // There are no non-temporal post-increment forms, keep ldnt/stnt.
+  if (cast<MemSDNode>(N)->isNonTemporal())
+    return false;
+
+  if (Op->getOpcode() != ISD::ADD && Op->getOpcode() != ISD::SUB)
+    return false;
+
+  ConstantSDNode *C = dyn_cast<ConstantSDNode>(Op->getOperand(1));
+  if (!C || Op->getOperand(0) != Ptr)
+    return false;
+
+  int64_t Inc = C->getSExtValue();
+  if (Op->getOpcode() == ISD::SUB)
+    Inc = -Inc;
+  if (!isInt<8>(Inc))
+    return false;
+
+  Base = Ptr;
+  Offset = DAG.getConstant(Inc, Ptr.getValueType());
+  AM = ISD::POST_INC;
+  return true;
+}
+
+// Any permutation of a SIMD register can be done by lowerVECTOR_SHUFFLE.
 bool TileTargetLowering::isShuffleMaskLegal(const SmallVectorImpl<int> &M,
                                             EVT VT) const {
-  return false;
+  return VT.isVector() && isTypeLegal(VT);
 }
@@ -56,7 +56,26 @@ enum NodeType {
   BRINDJT,
   VAARG_SP,
   ALLOCA_SP,
-  ALLOCA_ADDR
+  ALLOCA_ADDR,
+
+  // Vector shifts, all lanes by the same scalar amount
+  VSHL,
+  VSRL,
+  VSRA,
+
+  // Byte permutations
+  SHUFFLEBYTES,
+  DBLALIGN,
+
+  // Interleave the low/high halves of two vectors
+  VINT_L,
+  VINT_H,
+
+  // Lane compare leaving 0 or 1 in each lane, operands as for SETCC
+  VCMP,
+
+  // Unsigned quotient and remainder of zero-extended 32-bit operands
+  UDIVREM32
 };
 }
 
@@ -72,6 +91,11 @@ public:
 
   virtual bool isShuffleMaskLegal(const SmallVectorImpl<int> &M, EVT VT) const;
 
+  virtual bool getPostIndexedAddressParts(SDNode *N, SDNode *Op, SDValue &Base,
+                                          SDValue &Offset,
+                                          ISD::MemIndexedMode &AM,
+                                          SelectionDAG &DAG) const;
+
   virtual unsigned getJumpTableEncoding(void) const;
 
   virtual MVT getScalarShiftAmountTy(EVT LHSTy) const { return MVT::i32; }
@@ -87,6 +111,10 @@ public:
 
   virtual SDValue PerformDAGCombine(SDNode *N, DAGCombinerInfo &DCI) const;
 
+  // Return a FastISel object for -O0 and the JIT.
+  virtual FastISel *createFastISel(FunctionLoweringInfo &funcInfo,
+                                   const TargetLibraryInfo *libInfo) const;
+
 private:
   // Subtarget Info.
   const TileSubtarget *Subtarget;
@@ -97,6 +125,10 @@ private:
       const SmallVectorImpl<ISD::InputArg> &Ins, DebugLoc dl, SelectionDAG &DAG,
       SmallVectorImpl<SDValue> &InVals) const;
 
+  // Address materialization helpers.
+  SDValue getPCRelAddr(SDValue Op, SelectionDAG &DAG) const;
+  SDValue getAbsAddr(SDValue Op, SelectionDAG &DAG, bool IsLocal) const;
+
   // Lower Operand specifics.
   SDValue lowerBR_JT(SDValue Op, SelectionDAG &DAG) const;
   SDValue lowerConstantPool(SDValue Op, SelectionDAG &DAG) const;
@@ -115,8 +147,19 @@ private:
   SDValue lowerDYNAMIC_STACKALLOC(SDValue Op, SelectionDAG &DAG) const;
   SDValue lowerMEMBARRIER(SDValue Op, SelectionDAG &DAG) const;
   SDValue lowerATOMIC_FENCE(SDValue Op, SelectionDAG &DAG) const;
+  SDValue lowerATOMIC_RMW(SDValue Op, SelectionDAG &DAG) const;
   SDValue lowerFpFpConv(SDValue Op, SelectionDAG &DAG) const;
   SDValue lowerFpIntConv(SDValue Op, SelectionDAG &DAG) const;
+  SDValue lowerPREFETCH(SDValue Op, SelectionDAG &DAG) const;
+  SDValue lowerVSETCC(SDValue Op, SelectionDAG &DAG) const;
+  SDValue lowerVectorShift(SDValue Op, SelectionDAG &DAG) const;
+  SDValue lowerVECTOR_SHUFFLE(SDValue Op, SelectionDAG &DAG) const;
+  SDValue lowerBUILD_VECTOR(SDValue Op, SelectionDAG &DAG) const;
+  SDValue lowerEXTRACT_VECTOR_ELT(SDValue Op, SelectionDAG &DAG) const;
+  SDValue lowerINSERT_VECTOR_ELT(SDValue Op, SelectionDAG &DAG) const;
+  SDValue lowerDIVREM32(SDValue Op, SelectionDAG &DAG) const;
+  SDValue lowerFDIV(SDValue Op, SelectionDAG &DAG) const;
+  SDValue lowerFSQRT(SDValue Op, SelectionDAG &DAG) const;
 
   virtual SDValue LowerFormalArguments(
       SDValue Chain, CallingConv::ID CallConv, bool isVarArg,
@@ -134,6 +177,10 @@ private:
 
   virtual MachineBasicBlock *
   EmitInstrWithCustomInserter(MachineInstr *MI, MachineBasicBlock *MBB) const;
+  MachineBasicBlock *emitAtomicRMWLoop(MachineInstr *MI,
+                                       MachineBasicBlock *BB) const;
+  MachineBasicBlock *emitUDivRem32Loop(MachineInstr *MI,
+                                       MachineBasicBlock *BB) const;
 
   // Copy Tile byVal arg to registers and stack.
   void passByValArg(
@@ -154,6 +201,11 @@ private:
   std::pair<unsigned, const TargetRegisterClass *>
   getRegForInlineAsmConstraint(const std::string &Constraint, EVT VT) const;
 };
+
+namespace Tile {
+FastISel *createFastISel(FunctionLoweringInfo &funcInfo,
+                         const TargetLibraryInfo *libInfo);
+}
 }
 
 #endif // TileISELLOWERING_H
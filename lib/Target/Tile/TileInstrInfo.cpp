@@ -12,11 +12,13 @@
 //===----------------------------------------------------------------------===//
 
 #include "TileInstrInfo.h"
+#include "TileHazardRecognizer.h"
 #include "TileTargetMachine.h"
 #include "TileMachineFunction.h"
 #include "InstPrinter/TileInstPrinter.h"
 #include "llvm/CodeGen/MachineInstrBuilder.h"
 #include "llvm/CodeGen/MachineRegisterInfo.h"
+#include "llvm/Support/CommandLine.h"
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/TargetRegistry.h"
 #include "llvm/ADT/STLExtras.h"
@@ -26,6 +28,16 @@
 #include "TileGenDFAPacketizer.inc"
 
 using namespace llvm;
+using namespace TileII;
+
+// Load-use latency of an L2 hit. The itineraries assume loads hit in L1;
+// streaming code whose working set does not fit there is better scheduled
+// for the L2.
+static cl::opt<bool> TileGXL2LoadLatency(
+    "tilegx-l2-load-latency", cl::Hidden, cl::init(false),
+    cl::desc("Schedule TileGX loads for an L2 hit rather than an L1 hit"));
+
+static const int L2LoadLatency = 11;
 
 TileInstrInfo::TileInstrInfo(TileTargetMachine &tm)
     : TileGenInstrInfo(Tile::ADJCALLSTACKDOWN, Tile::ADJCALLSTACKUP), TM(tm),
@@ -89,7 +101,7 @@ void TileInstrInfo::storeRegToStackSlot(
   if (RC == &Tile::CPURegsRegClass || RC == &Tile::SIMDRegsRegClass)
     Opc = Tile::ST;
   else if (RC == &Tile::CPU32RegsRegClass)
-    Opc = Tile::ST4;
+    Opc = Tile::ST432;
 
   assert(Opc && "Register class not handled!");
   BuildMI(MBB, I, DL, get(Opc)).addFrameIndex(FI)
@@ -330,6 +342,121 @@ bool TileInstrInfo::ReverseBranchCondition(
   return false;
 }
 
+// Select the cmovnez variant for the register classes of the condition and
+// of the selected values.
+static unsigned getCMOVNEZOpc(bool Cond32, bool Val32) {
+  if (Cond32)
+    return Val32 ? Tile::CMOVNEZ32 : Tile::CMOVNEZC32;
+  return Val32 ? Tile::CMOVNEZ64_32 : Tile::CMOVNEZ;
+}
+
+bool TileInstrInfo::canInsertSelect(
+    const MachineBasicBlock &MBB, const SmallVectorImpl<MachineOperand> &Cond,
+    unsigned TrueReg, unsigned FalseReg, int &CondCycles, int &TrueCycles,
+    int &FalseCycles) const {
+  // Only the compare-with-zero branches.
+  if (Cond.size() != 2)
+    return false;
+
+  const MachineRegisterInfo &MRI = MBB.getParent()->getRegInfo();
+  const TargetRegisterClass *RC =
+      RI.getCommonSubClass(MRI.getRegClass(TrueReg), MRI.getRegClass(FalseReg));
+  if (!RC)
+    return false;
+  if (!Tile::CPURegsRegClass.hasSubClassEq(RC) &&
+      !Tile::CPU32RegsRegClass.hasSubClassEq(RC))
+    return false;
+
+  // cmovnez issues in X0 or Y0 and takes one cycle. The signed conditions
+  // need a compare against zero first, widened from a 32-bit register.
+  TrueCycles = FalseCycles = 1;
+  switch (Cond[0].getImm()) {
+  case Tile::BEQZ:
+  case Tile::BNEZ:
+  case Tile::BEQZ32:
+  case Tile::BNEZ32:
+    CondCycles = 1;
+    break;
+  case Tile::BGTZ32:
+  case Tile::BGEZ32:
+  case Tile::BLTZ32:
+  case Tile::BLEZ32:
+    CondCycles = 3;
+    break;
+  default:
+    CondCycles = 2;
+    break;
+  }
+  return true;
+}
+
+void TileInstrInfo::insertSelect(
+    MachineBasicBlock &MBB, MachineBasicBlock::iterator I, DebugLoc DL,
+    unsigned DstReg, const SmallVectorImpl<MachineOperand> &Cond,
+    unsigned TrueReg, unsigned FalseReg) const {
+  MachineRegisterInfo &MRI = MBB.getParent()->getRegInfo();
+  unsigned CondReg = Cond[1].getReg();
+  unsigned Opc = Cond[0].getImm();
+  bool Cond32 = false;
+  bool Swap = false;
+
+  switch (Opc) {
+  default:
+    llvm_unreachable("Unexpected branch condition!");
+  case Tile::BEQZ32:
+    Swap = true;
+    // Fall through.
+  case Tile::BNEZ32:
+    Cond32 = true;
+    break;
+  case Tile::BEQZ:
+    Swap = true;
+    // Fall through.
+  case Tile::BNEZ:
+    break;
+  case Tile::BGTZ32:
+  case Tile::BGEZ32:
+  case Tile::BLTZ32:
+  case Tile::BLEZ32:
+  case Tile::BGTZ:
+  case Tile::BGEZ:
+  case Tile::BLTZ:
+  case Tile::BLEZ: {
+    // There is no conditional move on the sign, turn it into a flag. Values
+    // in 32-bit registers are kept sign extended, so the 64-bit compare on
+    // the extended register gives the same answer.
+    if (Tile::CPU32RegsRegClass.hasSubClassEq(MRI.getRegClass(CondReg))) {
+      unsigned Ext = MRI.createVirtualRegister(&Tile::CPURegsRegClass);
+      BuildMI(MBB, I, DL, get(Tile::ADD_EXTEND), Ext).addReg(CondReg);
+      CondReg = Ext;
+    }
+    unsigned Flag = MRI.createVirtualRegister(&Tile::CPURegsRegClass);
+    if (Opc == Tile::BGTZ || Opc == Tile::BLEZ || Opc == Tile::BGTZ32 ||
+        Opc == Tile::BLEZ32)
+      BuildMI(MBB, I, DL, get(Tile::CMPLTS), Flag).addReg(Tile::ZERO)
+          .addReg(CondReg);
+    else
+      BuildMI(MBB, I, DL, get(Tile::CMPLTSI), Flag).addReg(CondReg).addImm(0);
+    CondReg = Flag;
+    Swap = Opc == Tile::BGEZ || Opc == Tile::BLEZ || Opc == Tile::BGEZ32 ||
+           Opc == Tile::BLEZ32;
+    break;
+  }
+  }
+
+  if (Swap)
+    std::swap(TrueReg, FalseReg);
+
+  bool Val32 = Tile::CPU32RegsRegClass.hasSubClassEq(MRI.getRegClass(DstReg));
+  BuildMI(MBB, I, DL, get(getCMOVNEZOpc(Cond32, Val32)), DstReg)
+      .addReg(CondReg).addReg(TrueReg).addReg(FalseReg);
+}
+
+ScheduleHazardRecognizer *TileInstrInfo::CreateTargetPostRAHazardRecognizer(
+    const InstrItineraryData *II, const ScheduleDAG *DAG) const {
+  return new TileHazardRecognizer(II, DAG);
+}
+
 DFAPacketizer *TileInstrInfo::CreateTargetScheduleState(
     const TargetMachine *TM, const ScheduleDAG *DAG) const {
   const InstrItineraryData *II = TM->getInstrItineraryData();
@@ -355,3 +482,66 @@ bool TileInstrInfo::isSchedulingBoundary(const MachineInstr *MI,
 
   return false;
 }
+
+int TileInstrInfo::getOperandLatency(const InstrItineraryData *ItinData,
+                                     const MachineInstr *DefMI, unsigned DefIdx,
+                                     const MachineInstr *UseMI,
+                                     unsigned UseIdx) const {
+  // Only the loaded value waits for the cache; the post-increment address
+  // write-back does not.
+  if (TileGXL2LoadLatency && DefIdx == 0 && DefMI->mayLoad() &&
+      !DefMI->mayStore())
+    return L2LoadLatency;
+
+  return TargetInstrInfo::getOperandLatency(ItinData, DefMI, DefIdx, UseMI,
+                                            UseIdx);
+}
+
+static TileIssueType TileIssueTypeOf(const MachineInstr *MI) {
+  const uint64_t F = MI->getDesc().TSFlags;
+  return (TileIssueType)((F >> IssueTypePos) & IssueTypeMask);
+}
+
+static bool isPipe2Conflict(const MachineInstr *MI) {
+  TileIssueType T = TileIssueTypeOf(MI);
+  return T == IT_X1 || T == IT_X1Y2;
+}
+
+static bool isPipe2Conflict(const MachineInstr *MI0, const MachineInstr *MI1,
+                            const MachineInstr *MI) {
+  TileIssueType T = TileIssueTypeOf(MI);
+  TileIssueType T0 = TileIssueTypeOf(MI0);
+  TileIssueType T1 = TileIssueTypeOf(MI1);
+  unsigned count = 0;
+  if (T == IT_X0X1Y0Y1)
+    count++;
+  else if (T == IT_X1 || T == IT_X0)
+    return true;
+  if (T0 == IT_X0X1Y0Y1)
+    count++;
+  else if (T0 == IT_X1 || T0 == IT_X0)
+    return true;
+  if (T1 == IT_X0X1Y0Y1)
+    count++;
+  else if (T1 == IT_X1 || T1 == IT_X0)
+    return true;
+  return count != 2;
+}
+
+bool TileInstrInfo::canBundleInXYMode(ArrayRef<MachineInstr *> Packet,
+                                      const MachineInstr *MI) const {
+  TileIssueType T = TileIssueTypeOf(MI);
+
+  switch (Packet.size()) {
+  case 0:
+    return true;
+  case 1:
+    if (!(T == IT_X1Y2 || T == IT_X1))
+      return true;
+    return !isPipe2Conflict(Packet[0]);
+  case 2:
+    return !isPipe2Conflict(Packet[0], Packet[1], MI);
+  default:
+    return false;
+  }
+}
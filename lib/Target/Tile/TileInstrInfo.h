@@ -92,12 +92,44 @@ public:
   virtual bool ReverseBranchCondition(
       SmallVectorImpl<MachineOperand> &Cond) const;
 
+  // Early if-conversion, a select is a cmovnez on the branch condition.
+  virtual bool canInsertSelect(
+      const MachineBasicBlock &MBB, const SmallVectorImpl<MachineOperand> &Cond,
+      unsigned TrueReg, unsigned FalseReg, int &CondCycles, int &TrueCycles,
+      int &FalseCycles) const;
+  virtual void insertSelect(
+      MachineBasicBlock &MBB, MachineBasicBlock::iterator I, DebugLoc DL,
+      unsigned DstReg, const SmallVectorImpl<MachineOperand> &Cond,
+      unsigned TrueReg, unsigned FalseReg) const;
+
+  // Keep the post-RA scheduler's cycles in step with the bundles the
+  // packetizer will form.
+  virtual ScheduleHazardRecognizer *
+  CreateTargetPostRAHazardRecognizer(const InstrItineraryData *II,
+                                     const ScheduleDAG *DAG) const;
+
   virtual DFAPacketizer *CreateTargetScheduleState(
       const TargetMachine *TM, const ScheduleDAG *DAG) const;
 
   virtual bool isSchedulingBoundary(const MachineInstr *MI,
                                     const MachineBasicBlock *MBB,
                                     const MachineFunction &MF) const;
+
+  using TargetInstrInfo::getOperandLatency;
+  virtual int getOperandLatency(const InstrItineraryData *ItinData,
+                                const MachineInstr *DefMI, unsigned DefIdx,
+                                const MachineInstr *UseMI,
+                                unsigned UseIdx) const;
+
+  // Return true if MI can join the instructions already in Packet in either
+  // X or Y mode.
+  //
+  // The DFA packetizer does not support an instruction occupying more than
+  // one functional unit, while an instruction issued to the X1 slot uses
+  // both pipe1 and pipe2. TileSchedule.td pretends X1 only occupies pipe1
+  // to keep the DFA happy; this check makes sure the bundle is encodable.
+  bool canBundleInXYMode(ArrayRef<MachineInstr *> Packet,
+                         const MachineInstr *MI) const;
 };
 
 }
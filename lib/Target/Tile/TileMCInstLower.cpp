@@ -131,12 +131,31 @@ mapToOpcodeWithIssueSlot(unsigned Op, const unsigned IssueSlot,
   switch (Op) {
   case Tile::BEQZ32:
   case Tile::BGEZ32:
+  case Tile::BGTZ32:
   case Tile::BLEZ32:
   case Tile::BLTZ32:
   case Tile::BNEZ32:
   case Tile::BFINS32:
   case Tile::BFEXTU32:
   case Tile::FSINGLE_PACK232_64:
+  case Tile::LD1S_ADD32:
+  case Tile::LD1U_ADD32:
+  case Tile::LD2S_ADD32:
+  case Tile::LD2U_ADD32:
+  case Tile::LD4S_ADD32:
+  case Tile::ST1_ADD32:
+  case Tile::ST2_ADD32:
+  case Tile::ST4_ADD32:
+  case Tile::CMPEXCH464:
+  case Tile::MTSPR_CMPEXCH32:
+  case Tile::LDNT1S32:
+  case Tile::LDNT1U32:
+  case Tile::LDNT2S32:
+  case Tile::LDNT2U32:
+  case Tile::LDNT4S32:
+  case Tile::STNT132:
+  case Tile::STNT232:
+  case Tile::STNT432:
     Op = Op - 2;
     break;
   case Tile::ST132:
@@ -219,11 +238,13 @@ mapToOpcodeWithIssueSlot(unsigned Op, const unsigned IssueSlot,
   case Tile::CMOVNEZF64:
     Op = Op - 8;
     break;
-  // Alphabetic overlapped with SHL16INSLI
-  case Tile::SHL64_32:
   case Tile::CMOVNEZF64_32:
     Op = Op - 9;
     break;
+  // Alphabetic overlapped with SHL16INSLI and the SHLnADD(X) families.
+  case Tile::SHL64_32:
+    Op = Tile::SHL;
+    break;
   default:
     break;
   }
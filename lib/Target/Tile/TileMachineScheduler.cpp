@@ -0,0 +1,242 @@
+//===-- TileMachineScheduler.cpp - Tile MI scheduler ----------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// The TILE-Gx issues up to three instructions per bundle and the packetizer
+// only bundles neighbouring instructions after register allocation, so the
+// order chosen before register allocation decides how full the bundles get.
+// This strategy schedules top-down one cycle at a time, filling the bundle of
+// the current cycle before moving on to the next.
+//
+//===----------------------------------------------------------------------===//
+
+#define DEBUG_TYPE "misched"
+
+#include "TileMachineScheduler.h"
+#include "TileInstrInfo.h"
+#include "llvm/CodeGen/DFAPacketizer.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/Target/TargetMachine.h"
+
+using namespace llvm;
+using namespace TileII;
+
+//===----------------------------------------------------------------------===//
+// TileResourceModel
+//===----------------------------------------------------------------------===//
+
+TileResourceModel::TileResourceModel(const TargetMachine &TM,
+                                     unsigned IssueWidth)
+    : TII(static_cast<const TileInstrInfo *>(TM.getInstrInfo())),
+      IssueWidth(IssueWidth), HasSolo(false), TotalPackets(0) {
+  ResourcesModel = TII->CreateTargetScheduleState(&TM, NULL);
+  assert(ResourcesModel && "Empty DFA table!");
+  Packet.reserve(IssueWidth);
+}
+
+TileResourceModel::~TileResourceModel() { delete ResourcesModel; }
+
+void TileResourceModel::reset() {
+  if (!empty())
+    ++TotalPackets;
+  ResourcesModel->clearResources();
+  Packet.clear();
+  HasSolo = false;
+}
+
+bool TileResourceModel::isFree(MachineInstr *MI) const {
+  if (MI->isTransient())
+    return true;
+
+  // Like the packetizer, ignore instructions without functional units.
+  const InstrItineraryData *II = ResourcesModel->getInstrItins();
+  return !II->beginStage(MI->getDesc().getSchedClass())->getUnits();
+}
+
+bool TileResourceModel::isResourceAvailable(MachineInstr *MI) {
+  if (isFree(MI))
+    return true;
+
+  if (HasSolo || Packet.size() >= IssueWidth)
+    return false;
+
+  if ((MI->getDesc().TSFlags >> SoloPos) & SoloMask)
+    return Packet.empty();
+
+  if (!ResourcesModel->canReserveResources(MI))
+    return false;
+
+  return TII->canBundleInXYMode(Packet, MI);
+}
+
+void TileResourceModel::reserveResources(MachineInstr *MI) {
+  if (isFree(MI))
+    return;
+
+  if (!isResourceAvailable(MI))
+    reset();
+
+  // Solo instructions, and anything the DFA rejects even in an empty bundle,
+  // get a bundle of their own.
+  if (((MI->getDesc().TSFlags >> SoloPos) & SoloMask) ||
+      !ResourcesModel->canReserveResources(MI)) {
+    HasSolo = true;
+    return;
+  }
+
+  ResourcesModel->reserveResources(MI);
+  Packet.push_back(MI);
+}
+
+//===----------------------------------------------------------------------===//
+// TileMachineSchedStrategy
+//===----------------------------------------------------------------------===//
+
+TileMachineSchedStrategy::~TileMachineSchedStrategy() {
+  delete ResourceModel;
+}
+
+void TileMachineSchedStrategy::initialize(ScheduleDAGMI *dag) {
+  DAG = dag;
+  SchedModel = DAG->getSchedModel();
+
+  delete ResourceModel;
+  ResourceModel = new TileResourceModel(DAG->TM, SchedModel->getIssueWidth());
+
+  Available.clear();
+  Pending.clear();
+  CurrCycle = 0;
+  MinReadyCycle = UINT_MAX;
+}
+
+void TileMachineSchedStrategy::releaseTopNode(SUnit *SU) {
+  if (SU->isScheduled)
+    return;
+
+  for (SUnit::pred_iterator I = SU->Preds.begin(), E = SU->Preds.end();
+       I != E; ++I) {
+    unsigned PredReadyCycle = I->getSUnit()->TopReadyCycle + I->getLatency();
+    if (SU->TopReadyCycle < PredReadyCycle)
+      SU->TopReadyCycle = PredReadyCycle;
+  }
+
+  if (SU->TopReadyCycle <= CurrCycle) {
+    Available.push(SU);
+    return;
+  }
+  Pending.push(SU);
+  MinReadyCycle = std::min(MinReadyCycle, SU->TopReadyCycle);
+}
+
+void TileMachineSchedStrategy::releasePending() {
+  if (MinReadyCycle > CurrCycle)
+    return;
+
+  MinReadyCycle = UINT_MAX;
+  for (ReadyQueue::iterator I = Pending.begin(); I != Pending.end();) {
+    SUnit *SU = *I;
+    if (SU->TopReadyCycle > CurrCycle) {
+      MinReadyCycle = std::min(MinReadyCycle, SU->TopReadyCycle);
+      ++I;
+      continue;
+    }
+    Available.push(SU);
+    I = Pending.remove(I);
+  }
+}
+
+void TileMachineSchedStrategy::bumpCycle() {
+  unsigned NextCycle = CurrCycle + 1;
+
+  // With nothing ready, skip ahead to the first cycle something is.
+  if (Available.empty() && MinReadyCycle != UINT_MAX &&
+      MinReadyCycle > NextCycle)
+    NextCycle = MinReadyCycle;
+
+  CurrCycle = NextCycle;
+  ResourceModel->reset();
+  DEBUG(dbgs() << "*** Next cycle " << CurrCycle << '\n');
+}
+
+bool TileMachineSchedStrategy::isBetterCandidate(
+    SUnit *A, const RegPressureDelta &DeltaA, SUnit *B,
+    const RegPressureDelta &DeltaB) const {
+  // Avoid exceeding the register pressure limit, spills cost more than a
+  // bundle slot.
+  if (DeltaA.Excess.UnitIncrease != DeltaB.Excess.UnitIncrease)
+    return DeltaA.Excess.UnitIncrease < DeltaB.Excess.UnitIncrease;
+
+  // Avoid raising the region's critical pressure.
+  if (DeltaA.CriticalMax.UnitIncrease != DeltaB.CriticalMax.UnitIncrease)
+    return DeltaA.CriticalMax.UnitIncrease < DeltaB.CriticalMax.UnitIncrease;
+
+  // Prefer the longest latency path to the end of the region.
+  if (A->getHeight() != B->getHeight())
+    return A->getHeight() > B->getHeight();
+
+  // Otherwise keep the original order.
+  return A->NodeNum < B->NodeNum;
+}
+
+SUnit *TileMachineSchedStrategy::pickNodeFromAvailable() {
+  RegPressureTracker &TempTracker =
+      const_cast<RegPressureTracker &>(DAG->getTopRPTracker());
+
+  // If even an empty bundle cannot take any of them, pick the best anyway
+  // and let it start a bundle of its own.
+  bool MustFit = !ResourceModel->empty();
+
+  SUnit *Best = NULL;
+  RegPressureDelta BestDelta;
+  for (ReadyQueue::iterator I = Available.begin(), E = Available.end();
+       I != E; ++I) {
+    SUnit *SU = *I;
+    if (!ResourceModel->isResourceAvailable(SU->getInstr()) && MustFit)
+      continue;
+
+    RegPressureDelta Delta;
+    TempTracker.getMaxPressureDelta(SU->getInstr(), Delta,
+                                    DAG->getRegionCriticalPSets(),
+                                    DAG->getRegPressure().MaxSetPressure);
+    if (!Best || isBetterCandidate(SU, Delta, Best, BestDelta)) {
+      Best = SU;
+      BestDelta = Delta;
+    }
+  }
+  return Best;
+}
+
+SUnit *TileMachineSchedStrategy::pickNode(bool &IsTopNode) {
+  if (DAG->top() == DAG->bottom()) {
+    assert(Available.empty() && Pending.empty() && "ReadyQ garbage");
+    return NULL;
+  }
+
+  IsTopNode = true;
+  SUnit *SU;
+  for (;;) {
+    releasePending();
+    if ((SU = pickNodeFromAvailable()))
+      break;
+    assert((!Available.empty() || !Pending.empty()) &&
+           "Nothing left to schedule");
+    bumpCycle();
+  }
+  Available.remove(Available.find(SU));
+
+  DEBUG(dbgs() << "*** Cycle " << CurrCycle << " picked ";
+        SU->dump(DAG));
+  return SU;
+}
+
+void TileMachineSchedStrategy::schedNode(SUnit *SU, bool IsTopNode) {
+  assert(IsTopNode && "Tile schedules top-down only");
+  ResourceModel->reserveResources(SU->getInstr());
+  SU->TopReadyCycle = CurrCycle;
+}
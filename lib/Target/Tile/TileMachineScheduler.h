@@ -0,0 +1,128 @@
+//===-- TileMachineScheduler.h - Tile MI scheduler --------------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// Pre-RA MachineScheduler strategy which orders instructions so that the
+// post-RA packetizer can fill TILE-Gx bundles.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef TILEMACHINESCHEDULER_H
+#define TILEMACHINESCHEDULER_H
+
+#include "llvm/CodeGen/MachineScheduler.h"
+#include <vector>
+
+namespace llvm {
+class DFAPacketizer;
+class TileInstrInfo;
+
+// Tracks the bundle being filled in the current cycle. Pipe usage comes from
+// the DFA generated from TileSchedule.td, the X/Y mode restrictions from
+// TileInstrInfo::canBundleInXYMode. Also used by the modulo scheduler to
+// check the rows of its reservation table.
+class TileResourceModel {
+  const TileInstrInfo *TII;
+  DFAPacketizer *ResourcesModel;
+  unsigned IssueWidth;
+
+  // Instructions placed in the current bundle.
+  std::vector<MachineInstr *> Packet;
+
+  // Set when a solo instruction owns the current bundle.
+  bool HasSolo;
+
+  // Total bundles started.
+  unsigned TotalPackets;
+
+public:
+  TileResourceModel(const TargetMachine &TM, unsigned IssueWidth);
+  ~TileResourceModel();
+
+  // Start a new, empty bundle.
+  void reset();
+
+  bool empty() const { return Packet.empty() && !HasSolo; }
+
+  // Return true if nothing more can join the current bundle.
+  bool isFull() const { return HasSolo || Packet.size() >= IssueWidth; }
+
+  // Return true if MI does not take an issue slot.
+  bool isFree(MachineInstr *MI) const;
+
+  // Return true if MI can join the current bundle.
+  bool isResourceAvailable(MachineInstr *MI);
+
+  // Add MI to the current bundle.
+  void reserveResources(MachineInstr *MI);
+
+  unsigned getTotalPackets() const { return TotalPackets; }
+};
+
+// Top-down list scheduler tracking the cycle each instruction issues in.
+// Among the instructions whose operands are ready, it picks one that still
+// fits the current bundle, preferring ones that do not push register
+// pressure over its limit and then the longest path to the end of the
+// region.
+class TileMachineSchedStrategy : public MachineSchedStrategy {
+  ScheduleDAGMI *DAG;
+  const TargetSchedModel *SchedModel;
+  TileResourceModel *ResourceModel;
+
+  // Instructions whose operands are ready in the current cycle, and those
+  // still waiting for a predecessor's latency.
+  ReadyQueue Available;
+  ReadyQueue Pending;
+
+  unsigned CurrCycle;
+
+  // Cycle of the soonest pending instruction.
+  unsigned MinReadyCycle;
+
+public:
+  enum {
+    TopQID = 1,
+    PendingQID = 2
+  };
+
+  TileMachineSchedStrategy()
+      : DAG(0), SchedModel(0), ResourceModel(0),
+        Available(TopQID, "TopQ.A"), Pending(PendingQID, "TopQ.P"),
+        CurrCycle(0), MinReadyCycle(UINT_MAX) {}
+
+  virtual ~TileMachineSchedStrategy();
+
+  virtual void initialize(ScheduleDAGMI *dag);
+
+  virtual SUnit *pickNode(bool &IsTopNode);
+
+  virtual void schedNode(SUnit *SU, bool IsTopNode);
+
+  virtual void releaseTopNode(SUnit *SU);
+
+  virtual void releaseBottomNode(SUnit *SU) {}
+
+private:
+  // Move to the next cycle and start a new bundle.
+  void bumpCycle();
+
+  // Move pending instructions whose operands are now ready to Available.
+  void releasePending();
+
+  // Return the best candidate in Available, or NULL if none fits the
+  // current bundle.
+  SUnit *pickNodeFromAvailable();
+
+  // Return true if A should be scheduled before B.
+  bool isBetterCandidate(SUnit *A, const RegPressureDelta &DeltaA, SUnit *B,
+                         const RegPressureDelta &DeltaB) const;
+};
+
+} // End llvm namespace
+
+#endif
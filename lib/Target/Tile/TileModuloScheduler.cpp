@@ -0,0 +1,1004 @@
+//===-- TileModuloScheduler.cpp - Software pipelining for TILE-Gx ---------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// The packetizer and the machine scheduler only reorder instructions within a
+// basic block, so the iterations of a loop never overlap and a loop body with
+// a long dependence chain leaves most of the bundle slots empty. This pass
+// software pipelines single block innermost loops before register allocation.
+//
+// The loop body is modulo scheduled: each instruction gets a cycle such that
+// a new iteration can start every II cycles without two instructions needing
+// the same pipes in the same row of the reservation table. Rows are checked
+// with the same resource model the machine scheduler uses. Instructions are
+// then grouped in stages of II cycles and the loop is rewritten as
+//
+//   Prologue: the first NumStages - 1 stages of the first iterations,
+//   Kernel:   one instance of every stage, each from a different iteration,
+//   Epilogue: the remaining stages of the last iterations.
+//
+// The code is still in SSA form, so values living longer than II cycles are
+// renamed with PHIs in the kernel and the register allocator takes care of
+// the copies. The trip count is derived from the loop's induction variable;
+// loops running fewer than NumStages iterations branch to the original loop.
+//
+//===----------------------------------------------------------------------===//
+
+#define DEBUG_TYPE "tile-pipeliner"
+
+#include "Tile.h"
+#include "TileInstrInfo.h"
+#include "TileMachineScheduler.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/Analysis/AliasAnalysis.h"
+#include "llvm/Analysis/ValueTracking.h"
+#include "llvm/CodeGen/MachineFunctionPass.h"
+#include "llvm/CodeGen/MachineInstrBuilder.h"
+#include "llvm/CodeGen/MachineLoopInfo.h"
+#include "llvm/CodeGen/MachineRegisterInfo.h"
+#include "llvm/CodeGen/TargetSchedule.h"
+#include "llvm/IR/DataLayout.h"
+#include "llvm/IR/Function.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/Target/TargetMachine.h"
+#include <algorithm>
+#include <map>
+
+using namespace llvm;
+
+STATISTIC(NumPipelined, "Number of loops software pipelined");
+
+static cl::opt<unsigned> PipelinerMaxStages(
+    "tilegx-pipeliner-max-stages", cl::Hidden, cl::init(4),
+    cl::desc("Maximum number of stages in a software pipelined loop"));
+
+static cl::opt<unsigned> PipelinerMaxSize(
+    "tilegx-pipeliner-max-size", cl::Hidden, cl::init(64),
+    cl::desc("Maximum number of instructions in a software pipelined loop"));
+
+namespace {
+// A dependence between two instructions of the loop body. Distance is the
+// number of iterations it crosses.
+struct PipeEdge {
+  unsigned Node;
+  int Latency;
+  unsigned Distance;
+
+  PipeEdge(unsigned N, int Lat, unsigned Dist)
+      : Node(N), Latency(Lat), Distance(Dist) {}
+};
+
+struct PipeNode {
+  MachineInstr *MI;
+  SmallVector<PipeEdge, 4> Preds;
+  SmallVector<PipeEdge, 4> Succs;
+  int Cycle;
+
+  explicit PipeNode(MachineInstr *MI) : MI(MI), Cycle(-1) {}
+};
+
+// A register used in the loop body traced back through the header PHIs to
+// the instruction computing it. Inits[i] is the value used in iteration i
+// when i < Hops.
+struct ResolvedReg {
+  unsigned DefReg;
+  unsigned Hops;
+  int DefStage;
+  SmallVector<unsigned, 2> Inits;
+
+  ResolvedReg() : DefReg(0), Hops(0), DefStage(0) {}
+};
+
+class TileModuloScheduler : public MachineFunctionPass {
+  const TileInstrInfo *TII;
+  MachineRegisterInfo *MRI;
+  MachineFunction *MF;
+  const DataLayout *DL;
+  TargetSchedModel SchedModel;
+  TileResourceModel *ResourceModel;
+
+  // The loop being pipelined.
+  MachineBasicBlock *Preheader;
+  MachineBasicBlock *LoopBB;
+  MachineBasicBlock *Exit;
+
+  // The loop branch, its condition in the "keep looping" sense, and the
+  // induction variable it tests: the loop runs until Inc, the value of Phi
+  // after adding Step, equals the bound.
+  MachineInstr *LoopBranch;
+  SmallVector<MachineOperand, 2> ContinueCond;
+  MachineInstr *CondDef;
+  MachineInstr *IncMI;
+  MachineInstr *PhiMI;
+  int64_t Step;
+  unsigned BoundReg;
+  int64_t BoundImm;
+
+  std::vector<PipeNode> Nodes;
+  DenseMap<MachineInstr *, unsigned> NodeOf;
+  unsigned II;
+  unsigned NumStages;
+
+  // The nodes by row of the reservation table, the order they are emitted.
+  std::vector<unsigned> Order;
+
+  // The blocks built for the pipelined loop and the registers defined there,
+  // by original register and step.
+  MachineBasicBlock *Prologue;
+  MachineBasicBlock *Kernel;
+  MachineBasicBlock *Epilogue;
+  std::map<std::pair<unsigned, unsigned>, unsigned> PrologueRegs;
+  std::map<std::pair<unsigned, unsigned>, unsigned> EpilogueRegs;
+  DenseMap<unsigned, unsigned> KernelRegs;
+  std::map<std::pair<unsigned, unsigned>, SmallVector<unsigned, 4> > Chains;
+  SmallVector<unsigned, 16> OutsideRegs;
+
+public:
+  static char ID;
+  TileModuloScheduler() : MachineFunctionPass(ID), ResourceModel(0) {}
+
+  virtual const char *getPassName() const {
+    return "Tile Software Pipeliner";
+  }
+
+  virtual void getAnalysisUsage(AnalysisUsage &AU) const {
+    AU.addRequired<MachineLoopInfo>();
+    MachineFunctionPass::getAnalysisUsage(AU);
+  }
+
+  virtual bool runOnMachineFunction(MachineFunction &Fn);
+
+private:
+  bool canPipeline(MachineLoop *L);
+  bool analyzeInductionVariable();
+  void buildGraph();
+  bool mayAlias(const MachineInstr *A, const MachineInstr *B) const;
+  bool isSameAccessEachIteration(const MachineInstr *A,
+                                 const MachineInstr *B) const;
+  bool fitsRow(const std::vector<MachineInstr *> &Row, MachineInstr *MI);
+  bool schedule(unsigned CandII, bool Modulo);
+  int stageOf(unsigned N) const { return Nodes[N].Cycle / II; }
+
+  void resolve(unsigned Reg, ResolvedReg &R) const;
+  unsigned prologueOperand(unsigned Reg, int Step, int UseStage);
+  unsigned kernelOperand(unsigned Reg, int UseStage);
+  unsigned epilogueOperand(unsigned Reg, int Step, int UseStage);
+  unsigned kernelChain(unsigned Reg, int UseStage, const ResolvedReg &R,
+                       unsigned Depth);
+  unsigned cloneInto(MachineBasicBlock *MBB, MachineInstr *MI,
+                     std::map<std::pair<unsigned, unsigned>, unsigned> *Regs,
+                     unsigned Step, bool InKernel, int StepNum);
+
+  void insertGuard();
+  void emitPipelinedLoop();
+  void fixLiveOuts();
+  void eliminateDeadCode(MachineBasicBlock *MBB);
+};
+char TileModuloScheduler::ID = 0;
+} // end of anonymous namespace
+
+static bool isLoopBranchOpc(unsigned Opc) {
+  return Opc == Tile::BNEZ || Opc == Tile::BNEZ32 || Opc == Tile::BEQZ ||
+         Opc == Tile::BEQZ32;
+}
+
+static bool isNonZeroBranchOpc(unsigned Opc) {
+  return Opc == Tile::BNEZ || Opc == Tile::BNEZ32;
+}
+
+// Return the value a loop header PHI takes from the loop itself.
+static unsigned getLoopIncoming(const MachineInstr *Phi,
+                                const MachineBasicBlock *LoopBB) {
+  for (unsigned i = 1, e = Phi->getNumOperands(); i != e; i += 2)
+    if (Phi->getOperand(i + 1).getMBB() == LoopBB)
+      return Phi->getOperand(i).getReg();
+  return 0;
+}
+
+static unsigned getInitIncoming(const MachineInstr *Phi,
+                                const MachineBasicBlock *LoopBB) {
+  for (unsigned i = 1, e = Phi->getNumOperands(); i != e; i += 2)
+    if (Phi->getOperand(i + 1).getMBB() != LoopBB)
+      return Phi->getOperand(i).getReg();
+  return 0;
+}
+
+bool TileModuloScheduler::canPipeline(MachineLoop *L) {
+  if (L->getNumBlocks() != 1)
+    return false;
+
+  LoopBB = L->getHeader();
+  if (LoopBB->hasAddressTaken() || LoopBB->isLandingPad() ||
+      LoopBB->pred_size() != 2 || LoopBB->succ_size() != 2)
+    return false;
+
+  Preheader = L->getLoopPreheader();
+  Exit = L->getExitBlock();
+  if (!Preheader || !Exit || Exit == LoopBB || Exit->isLandingPad())
+    return false;
+
+  // The preheader must end in something we can rewrite into the guard.
+  MachineBasicBlock *TBB = 0, *FBB = 0;
+  SmallVector<MachineOperand, 2> Cond;
+  if (TII->AnalyzeBranch(*Preheader, TBB, FBB, Cond, false) || !Cond.empty())
+    return false;
+
+  // The loop must end in a conditional branch back to itself.
+  TBB = FBB = 0;
+  Cond.clear();
+  if (TII->AnalyzeBranch(*LoopBB, TBB, FBB, Cond, false) || Cond.size() != 2 ||
+      !isLoopBranchOpc(Cond[0].getImm()))
+    return false;
+  if (TBB == LoopBB) {
+    if (FBB && FBB != Exit)
+      return false;
+  } else if (TBB == Exit && FBB == LoopBB) {
+    TII->ReverseBranchCondition(Cond);
+  } else
+    return false;
+  ContinueCond = Cond;
+
+  LoopBranch = 0;
+  for (MachineBasicBlock::iterator I = LoopBB->getFirstTerminator(),
+       E = LoopBB->end(); I != E; ++I)
+    if (isLoopBranchOpc(I->getOpcode()))
+      LoopBranch = I;
+  assert(LoopBranch && "Analyzed branch not found");
+
+  unsigned NumInstrs = 0;
+  for (MachineBasicBlock::iterator I = LoopBB->begin(), E = LoopBB->end();
+       I != E; ++I) {
+    MachineInstr *MI = I;
+    if (MI->isDebugValue())
+      continue;
+
+    if (MI->isPHI()) {
+      if (MI->getNumOperands() != 5)
+        return false;
+      unsigned Incoming = getLoopIncoming(MI, LoopBB);
+      MachineInstr *Def = MRI->getVRegDef(Incoming);
+      if (!Def || Def->getParent() != LoopBB)
+        return false;
+      continue;
+    }
+
+    if (MI->isCall() || MI->hasUnmodeledSideEffects() || MI->isInlineAsm() ||
+        MI->hasOrderedMemoryRef() || (MI->mayLoad() && MI->mayStore()))
+      return false;
+
+    // Physical registers would need their own renaming, and only ZERO shows
+    // up in the counted loops worth pipelining.
+    for (unsigned i = 0, e = MI->getNumOperands(); i != e; ++i) {
+      const MachineOperand &MO = MI->getOperand(i);
+      if (MO.isRegMask())
+        return false;
+      if (MO.isReg() && MO.getReg() &&
+          TargetRegisterInfo::isPhysicalRegister(MO.getReg()) &&
+          MO.getReg() != Tile::ZERO)
+        return false;
+    }
+
+    if (!MI->isTerminator() && ++NumInstrs > PipelinerMaxSize)
+      return false;
+  }
+
+  return analyzeInductionVariable();
+}
+
+// Find the induction variable the loop branch tests so that the trip count
+// can be checked before entering the pipelined loop.
+bool TileModuloScheduler::analyzeInductionVariable() {
+  unsigned CondReg = ContinueCond[1].getReg();
+  if (!TargetRegisterInfo::isVirtualRegister(CondReg))
+    return false;
+  CondDef = MRI->getVRegDef(CondReg);
+  if (!CondDef || CondDef->getParent() != LoopBB)
+    return false;
+
+  bool ContinueIfNonZero = isNonZeroBranchOpc(ContinueCond[0].getImm());
+  unsigned IncReg = 0;
+  BoundReg = 0;
+  BoundImm = 0;
+
+  switch (CondDef->getOpcode()) {
+  case Tile::CMPNE:
+  case Tile::CMPNE32_64:
+  case Tile::CMPEQ:
+  case Tile::CMPEQ32_64: {
+    bool IsNE = CondDef->getOpcode() == Tile::CMPNE ||
+                CondDef->getOpcode() == Tile::CMPNE32_64;
+    if (IsNE != ContinueIfNonZero)
+      return false;
+
+    // Either operand may be the induction variable.
+    for (unsigned i = 1; i <= 2 && !IncReg; ++i) {
+      unsigned Reg = CondDef->getOperand(i).getReg();
+      unsigned Other = CondDef->getOperand(3 - i).getReg();
+      MachineInstr *Def = MRI->getVRegDef(Reg);
+      if (!Def || Def->getParent() != LoopBB ||
+          (Def->getOpcode() != Tile::ADDI && Def->getOpcode() != Tile::ADDLI))
+        continue;
+
+      if (Other == Tile::ZERO) {
+        IncReg = Reg;
+        continue;
+      }
+      if (!TargetRegisterInfo::isVirtualRegister(Other))
+        continue;
+      MachineInstr *OtherDef = MRI->getVRegDef(Other);
+      if (!OtherDef)
+        continue;
+      if (OtherDef->getParent() != LoopBB) {
+        IncReg = Reg;
+        BoundReg = Other;
+      } else if ((OtherDef->getOpcode() == Tile::MOVEI ||
+                  OtherDef->getOpcode() == Tile::MOVELI) &&
+                 OtherDef->getOperand(1).isImm()) {
+        IncReg = Reg;
+        BoundImm = OtherDef->getOperand(1).getImm();
+      }
+    }
+    break;
+  }
+  case Tile::CMPEQI:
+  case Tile::CMPEQI32_64:
+    if (ContinueIfNonZero || !CondDef->getOperand(2).isImm())
+      return false;
+    IncReg = CondDef->getOperand(1).getReg();
+    BoundImm = CondDef->getOperand(2).getImm();
+    break;
+  case Tile::ADDI:
+  case Tile::ADDLI:
+    // Counting down to zero.
+    if (!ContinueIfNonZero)
+      return false;
+    IncReg = CondReg;
+    break;
+  default:
+    return false;
+  }
+
+  if (!IncReg || !TargetRegisterInfo::isVirtualRegister(IncReg))
+    return false;
+
+  IncMI = MRI->getVRegDef(IncReg);
+  if (!IncMI || IncMI->getParent() != LoopBB ||
+      (IncMI->getOpcode() != Tile::ADDI && IncMI->getOpcode() != Tile::ADDLI) ||
+      !IncMI->getOperand(2).isImm())
+    return false;
+
+  PhiMI = MRI->getVRegDef(IncMI->getOperand(1).getReg());
+  if (!PhiMI || !PhiMI->isPHI() || PhiMI->getParent() != LoopBB ||
+      getLoopIncoming(PhiMI, LoopBB) != IncReg)
+    return false;
+
+  Step = IncMI->getOperand(2).getImm();
+  return Step != 0 && isInt<16>(BoundImm);
+}
+
+bool TileModuloScheduler::mayAlias(const MachineInstr *A,
+                                   const MachineInstr *B) const {
+  if (!A->hasOneMemOperand() || !B->hasOneMemOperand())
+    return true;
+
+  const Value *VA = (*A->memoperands_begin())->getValue();
+  const Value *VB = (*B->memoperands_begin())->getValue();
+  if (!VA || !VB)
+    return true;
+
+  // Distinct identified objects, e.g. noalias arguments, never alias.
+  const Value *OA = GetUnderlyingObject(VA);
+  const Value *OB = GetUnderlyingObject(VB);
+  return OA == OB || !isIdentifiedObject(OA) || !isIdentifiedObject(OB);
+}
+
+// Return true if A and B access the same bytes through a pointer induction
+// variable of the loop, so iterations only depend on themselves: strength
+// reduced loads and stores of a[i] look like this.
+bool TileModuloScheduler::isSameAccessEachIteration(
+    const MachineInstr *A, const MachineInstr *B) const {
+  if (!A->hasOneMemOperand() || !B->hasOneMemOperand())
+    return false;
+
+  const MachineMemOperand *MMOA = *A->memoperands_begin();
+  const MachineMemOperand *MMOB = *B->memoperands_begin();
+  const PHINode *PN = dyn_cast_or_null<PHINode>(MMOA->getValue());
+  if (!PN || MMOA->getValue() != MMOB->getValue() ||
+      MMOA->getOffset() != MMOB->getOffset() ||
+      MMOA->getSize() != MMOB->getSize() ||
+      PN->getParent() != LoopBB->getBasicBlock())
+    return false;
+
+  int BlockIdx = PN->getBasicBlockIndex(LoopBB->getBasicBlock());
+  if (BlockIdx < 0)
+    return false;
+
+  int64_t Stride = 0;
+  Value *Next = const_cast<Value *>(PN->getIncomingValue(BlockIdx));
+  if (GetPointerBaseWithConstantOffset(Next, Stride, DL) != PN)
+    return false;
+  return (uint64_t)(Stride < 0 ? -Stride : Stride) >= MMOA->getSize();
+}
+
+void TileModuloScheduler::buildGraph() {
+  Nodes.clear();
+  NodeOf.clear();
+  for (MachineBasicBlock::iterator I = LoopBB->begin(),
+       E = LoopBB->getFirstTerminator(); I != E; ++I) {
+    if (I->isPHI() || I->isDebugValue())
+      continue;
+    NodeOf[I] = Nodes.size();
+    Nodes.push_back(PipeNode(I));
+  }
+
+  for (unsigned N = 0, NE = Nodes.size(); N != NE; ++N) {
+    MachineInstr *MI = Nodes[N].MI;
+
+    // Register dependences, looking through the header PHIs for the ones
+    // carried from earlier iterations.
+    for (unsigned i = 0, e = MI->getNumOperands(); i != e; ++i) {
+      const MachineOperand &MO = MI->getOperand(i);
+      if (!MO.isReg() || !MO.isUse() ||
+          !TargetRegisterInfo::isVirtualRegister(MO.getReg()))
+        continue;
+
+      ResolvedReg R;
+      resolve(MO.getReg(), R);
+      if (!R.DefReg)
+        continue;
+
+      MachineInstr *DefMI = MRI->getVRegDef(R.DefReg);
+      unsigned P = NodeOf[DefMI];
+      int DefIdx = DefMI->findRegisterDefOperandIdx(R.DefReg);
+      int Latency = SchedModel.computeOperandLatency(DefMI, DefIdx, MI, i,
+                                                     false);
+      Nodes[P].Succs.push_back(PipeEdge(N, Latency, R.Hops));
+      Nodes[N].Preds.push_back(PipeEdge(P, Latency, R.Hops));
+    }
+
+    // Memory dependences, both within an iteration and into the next one.
+    if (!MI->mayStore())
+      continue;
+    for (unsigned O = 0; O != NE; ++O) {
+      MachineInstr *Other = Nodes[O].MI;
+      if (O == N || !(Other->mayLoad() || Other->mayStore()) ||
+          (O < N && Other->mayStore()) || !mayAlias(MI, Other))
+        continue;
+      unsigned First = std::min(N, O), Second = std::max(N, O);
+      Nodes[First].Succs.push_back(PipeEdge(Second, 1, 0));
+      Nodes[Second].Preds.push_back(PipeEdge(First, 1, 0));
+      if (isSameAccessEachIteration(MI, Other))
+        continue;
+      Nodes[Second].Succs.push_back(PipeEdge(First, 1, 1));
+      Nodes[First].Preds.push_back(PipeEdge(Second, 1, 1));
+    }
+  }
+}
+
+bool TileModuloScheduler::fitsRow(const std::vector<MachineInstr *> &Row,
+                                  MachineInstr *MI) {
+  ResourceModel->reset();
+  for (unsigned i = 0, e = Row.size(); i != e; ++i)
+    ResourceModel->reserveResources(Row[i]);
+
+  // Like the machine scheduler, let anything start an empty bundle.
+  return ResourceModel->empty() || ResourceModel->isResourceAvailable(MI);
+}
+
+// Place the nodes in program order at the first cycle their scheduled
+// neighbours allow. Modulo is false when computing the length of a single
+// iteration, which is what the pipelined loop has to beat.
+bool TileModuloScheduler::schedule(unsigned CandII, bool Modulo) {
+  II = CandII;
+  std::vector<std::vector<MachineInstr *> > Rows(II);
+  if (Modulo)
+    Rows[II - 1].push_back(LoopBranch);
+
+  for (unsigned N = 0, NE = Nodes.size(); N != NE; ++N)
+    Nodes[N].Cycle = -1;
+
+  // Without Modulo this is a plain list schedule of one iteration, which
+  // only has to respect the dependencies inside it.
+  for (unsigned N = 0, NE = Nodes.size(); N != NE; ++N) {
+    PipeNode &Node = Nodes[N];
+    int Early = 0, Late = INT_MAX;
+    for (unsigned i = 0, e = Node.Preds.size(); i != e; ++i) {
+      const PipeEdge &Edge = Node.Preds[i];
+      if (!Modulo && Edge.Distance)
+        continue;
+      int Slack = Edge.Latency - (int)(II * Edge.Distance);
+      if (Edge.Node == N) {
+        if (Slack > 0)
+          return false;
+        continue;
+      }
+      if (Nodes[Edge.Node].Cycle >= 0)
+        Early = std::max(Early, Nodes[Edge.Node].Cycle + Slack);
+    }
+    for (unsigned i = 0, e = Node.Succs.size(); i != e; ++i) {
+      const PipeEdge &Edge = Node.Succs[i];
+      if (!Modulo && Edge.Distance)
+        continue;
+      if (Edge.Node != N && Nodes[Edge.Node].Cycle >= 0)
+        Late = std::min(Late, Nodes[Edge.Node].Cycle - Edge.Latency +
+                                  (int)(II * Edge.Distance));
+    }
+
+    int Last = std::min(Late, Early + (int)II - 1);
+    for (int Cycle = Early; Cycle <= Last; ++Cycle) {
+      std::vector<MachineInstr *> &Row = Rows[Cycle % II];
+      if (fitsRow(Row, Node.MI)) {
+        Row.push_back(Node.MI);
+        Node.Cycle = Cycle;
+        break;
+      }
+    }
+    if (Node.Cycle < 0)
+      return false;
+  }
+
+  NumStages = 1;
+  for (unsigned N = 0, NE = Nodes.size(); N != NE; ++N)
+    NumStages = std::max(NumStages, (unsigned)stageOf(N) + 1);
+
+  // The kernel branches on the condition of the iteration starting in it.
+  if (Modulo && (stageOf(NodeOf[CondDef]) != 0 || stageOf(NodeOf[IncMI]) != 0))
+    return false;
+  return true;
+}
+
+void TileModuloScheduler::resolve(unsigned Reg, ResolvedReg &R) const {
+  R = ResolvedReg();
+  MachineInstr *Def = MRI->getVRegDef(Reg);
+  while (Def && Def->getParent() == LoopBB && Def->isPHI()) {
+    R.Inits.push_back(getInitIncoming(Def, LoopBB));
+    Reg = getLoopIncoming(Def, LoopBB);
+    Def = MRI->getVRegDef(Reg);
+    ++R.Hops;
+  }
+  if (!Def || Def->getParent() != LoopBB)
+    return;
+  R.DefReg = Reg;
+  if (NodeOf.count(Def) && Nodes[NodeOf.lookup(Def)].Cycle >= 0)
+    R.DefStage = stageOf(NodeOf.lookup(Def));
+}
+
+// Step T of the prologue runs stage S of iteration T - S.
+unsigned TileModuloScheduler::prologueOperand(unsigned Reg, int Step,
+                                              int UseStage) {
+  ResolvedReg R;
+  resolve(Reg, R);
+  if (!R.DefReg) {
+    OutsideRegs.push_back(Reg);
+    return Reg;
+  }
+
+  int DefIter = Step - UseStage - (int)R.Hops;
+  if (DefIter < 0) {
+    unsigned Init = R.Inits[DefIter + R.Hops];
+    OutsideRegs.push_back(Init);
+    return Init;
+  }
+  unsigned NewReg = PrologueRegs[std::make_pair(R.DefReg,
+                                                DefIter + R.DefStage)];
+  assert(NewReg && "Use scheduled before its definition");
+  return NewReg;
+}
+
+unsigned TileModuloScheduler::kernelOperand(unsigned Reg, int UseStage) {
+  ResolvedReg R;
+  resolve(Reg, R);
+  if (!R.DefReg) {
+    OutsideRegs.push_back(Reg);
+    return Reg;
+  }
+
+  int Age = UseStage + R.Hops - R.DefStage;
+  assert(Age >= 0 && "Use scheduled before its definition");
+  return kernelChain(Reg, UseStage, R, Age);
+}
+
+// Step E of the epilogue runs stage S of iteration N + E - S, for the stages
+// whose iteration is still in range.
+unsigned TileModuloScheduler::epilogueOperand(unsigned Reg, int Step,
+                                              int UseStage) {
+  ResolvedReg R;
+  resolve(Reg, R);
+  if (!R.DefReg) {
+    OutsideRegs.push_back(Reg);
+    return Reg;
+  }
+
+  int Age = UseStage + R.Hops - R.DefStage;
+  if (Step >= Age) {
+    unsigned NewReg = EpilogueRegs[std::make_pair(R.DefReg, Step - Age)];
+    assert(NewReg && "Use scheduled before its definition");
+    return NewReg;
+  }
+  return kernelChain(Reg, UseStage, R, Age - Step - 1);
+}
+
+// Return the value R had Depth kernel iterations ago, as seen by a use of
+// Reg in stage UseStage. Each step back is a PHI at the top of the kernel
+// whose incoming value from the prologue is what the first kernel iteration
+// needs.
+unsigned TileModuloScheduler::kernelChain(unsigned Reg, int UseStage,
+                                          const ResolvedReg &R,
+                                          unsigned Depth) {
+  if (Depth == 0)
+    return KernelRegs[R.DefReg];
+
+  SmallVector<unsigned, 4> &Chain = Chains[std::make_pair(Reg, UseStage)];
+  const TargetRegisterClass *RC = MRI->getRegClass(R.DefReg);
+  while (Chain.size() < Depth) {
+    unsigned D = Chain.size() + 1;
+    unsigned Prev = D == 1 ? KernelRegs[R.DefReg] : Chain[D - 2];
+
+    // The first kernel iteration sees the value produced in prologue step
+    // NumStages - 1 - D, or the initial value if that iteration is before
+    // the loop.
+    int ProStep = NumStages - 1 - D;
+    int DefIter = ProStep - R.DefStage;
+    unsigned Incoming;
+    if (DefIter >= 0)
+      Incoming = PrologueRegs[std::make_pair(R.DefReg, ProStep)];
+    else if (DefIter + (int)R.Hops >= 0) {
+      Incoming = R.Inits[DefIter + R.Hops];
+      OutsideRegs.push_back(Incoming);
+    } else {
+      Incoming = MRI->createVirtualRegister(RC);
+      BuildMI(*Prologue, Prologue->end(), DebugLoc(),
+              TII->get(TargetOpcode::IMPLICIT_DEF), Incoming);
+    }
+    assert(Incoming && "Missing prologue value");
+
+    unsigned PhiReg = MRI->createVirtualRegister(RC);
+    BuildMI(*Kernel, Kernel->getFirstNonPHI(), DebugLoc(),
+            TII->get(TargetOpcode::PHI), PhiReg)
+        .addReg(Incoming).addMBB(Prologue)
+        .addReg(Prev).addMBB(Kernel);
+    Chain.push_back(PhiReg);
+  }
+  return Chain[Depth - 1];
+}
+
+// Copy MI to the end of MBB, renaming its uses for the given step and
+// giving its definitions new registers.
+unsigned TileModuloScheduler::cloneInto(
+    MachineBasicBlock *MBB, MachineInstr *MI,
+    std::map<std::pair<unsigned, unsigned>, unsigned> *Regs, unsigned Step,
+    bool InKernel, int StepNum) {
+  MachineInstr *NewMI = MF->CloneMachineInstr(MI);
+  int Stage = stageOf(NodeOf[MI]);
+
+  for (unsigned i = 0, e = NewMI->getNumOperands(); i != e; ++i) {
+    MachineOperand &MO = NewMI->getOperand(i);
+    if (!MO.isReg() || !TargetRegisterInfo::isVirtualRegister(MO.getReg()))
+      continue;
+    unsigned Reg = MO.getReg();
+
+    if (MO.isDef()) {
+      if (InKernel)
+        MO.setReg(KernelRegs[Reg]);
+      else {
+        unsigned NewReg = MRI->createVirtualRegister(MRI->getRegClass(Reg));
+        (*Regs)[std::make_pair(Reg, Step)] = NewReg;
+        MO.setReg(NewReg);
+      }
+      continue;
+    }
+
+    if (InKernel)
+      MO.setReg(kernelOperand(Reg, Stage));
+    else if (MBB == Prologue)
+      MO.setReg(prologueOperand(Reg, StepNum, Stage));
+    else
+      MO.setReg(epilogueOperand(Reg, StepNum, Stage));
+    MO.setIsKill(false);
+  }
+
+  MBB->push_back(NewMI);
+  return Stage;
+}
+
+// Check the trip count in the preheader. The loop runs (Bound - Init) / Step
+// times, so comparing the distance with NumStages * Step avoids a divide.
+void TileModuloScheduler::insertGuard() {
+  DebugLoc DL = LoopBranch->getDebugLoc();
+  MachineBasicBlock::iterator InsertPt = Preheader->getFirstTerminator();
+  const TargetRegisterClass *RC = &Tile::CPURegsRegClass;
+
+  unsigned Init = getInitIncoming(PhiMI, LoopBB);
+  unsigned Bound = BoundReg;
+  if (!Bound) {
+    Bound = MRI->createVirtualRegister(RC);
+    BuildMI(*Preheader, InsertPt, DL, TII->get(Tile::MOVELI), Bound)
+        .addImm(BoundImm);
+  }
+  OutsideRegs.push_back(Init);
+  OutsideRegs.push_back(Bound);
+
+  unsigned Distance = MRI->createVirtualRegister(RC);
+  BuildMI(*Preheader, InsertPt, DL, TII->get(Tile::SUB), Distance)
+      .addReg(Step > 0 ? Bound : Init)
+      .addReg(Step > 0 ? Init : Bound);
+
+  unsigned MinDistance = MRI->createVirtualRegister(RC);
+  BuildMI(*Preheader, InsertPt, DL, TII->get(Tile::MOVELI), MinDistance)
+      .addImm(NumStages * (Step > 0 ? Step : -Step));
+
+  unsigned TooShort = MRI->createVirtualRegister(RC);
+  BuildMI(*Preheader, InsertPt, DL, TII->get(Tile::CMPLTU), TooShort)
+      .addReg(Distance).addReg(MinDistance);
+
+  // The pipelined loop is laid out right after the preheader.
+  SmallVector<MachineOperand, 2> Cond;
+  Cond.push_back(MachineOperand::CreateImm(Tile::BNEZ));
+  Cond.push_back(MachineOperand::CreateReg(TooShort, false));
+  TII->RemoveBranch(*Preheader);
+  TII->InsertBranch(*Preheader, LoopBB, 0, Cond, DL);
+  Preheader->addSuccessor(Prologue);
+}
+
+namespace {
+// Emission order: by row of the reservation table, older iterations first.
+struct RowOrder {
+  const std::vector<PipeNode> &Nodes;
+  unsigned II;
+
+  RowOrder(const std::vector<PipeNode> &Nodes, unsigned II)
+      : Nodes(Nodes), II(II) {}
+
+  bool operator()(unsigned A, unsigned B) const {
+    int RowA = Nodes[A].Cycle % II, RowB = Nodes[B].Cycle % II;
+    if (RowA != RowB)
+      return RowA < RowB;
+    int StageA = Nodes[A].Cycle / II, StageB = Nodes[B].Cycle / II;
+    if (StageA != StageB)
+      return StageA > StageB;
+    return A < B;
+  }
+};
+} // end of anonymous namespace
+
+void TileModuloScheduler::emitPipelinedLoop() {
+  MachineFunction::iterator InsertPt = Preheader;
+  ++InsertPt;
+  const BasicBlock *BB = LoopBB->getBasicBlock();
+  Prologue = MF->CreateMachineBasicBlock(BB);
+  Kernel = MF->CreateMachineBasicBlock(BB);
+  Epilogue = MF->CreateMachineBasicBlock(BB);
+  MF->insert(InsertPt, Prologue);
+  MF->insert(InsertPt, Kernel);
+  MF->insert(InsertPt, Epilogue);
+  Prologue->addSuccessor(Kernel);
+  Kernel->addSuccessor(Kernel);
+  Kernel->addSuccessor(Epilogue);
+  Epilogue->addSuccessor(Exit);
+
+  PrologueRegs.clear();
+  EpilogueRegs.clear();
+  KernelRegs.clear();
+  Chains.clear();
+  OutsideRegs.clear();
+
+  Order.clear();
+  for (unsigned N = 0, NE = Nodes.size(); N != NE; ++N)
+    Order.push_back(N);
+  std::sort(Order.begin(), Order.end(), RowOrder(Nodes, II));
+
+  // Kernel values may be used before their definition in emission order,
+  // by the PHIs carrying them to the next iteration.
+  for (unsigned N = 0, NE = Nodes.size(); N != NE; ++N) {
+    MachineInstr *MI = Nodes[N].MI;
+    for (unsigned i = 0, e = MI->getNumOperands(); i != e; ++i) {
+      const MachineOperand &MO = MI->getOperand(i);
+      if (MO.isReg() && MO.isDef() &&
+          TargetRegisterInfo::isVirtualRegister(MO.getReg()))
+        KernelRegs[MO.getReg()] =
+            MRI->createVirtualRegister(MRI->getRegClass(MO.getReg()));
+    }
+  }
+
+  for (unsigned Step = 0; Step + 1 < NumStages; ++Step)
+    for (unsigned i = 0, e = Order.size(); i != e; ++i)
+      if (stageOf(Order[i]) <= (int)Step)
+        cloneInto(Prologue, Nodes[Order[i]].MI, &PrologueRegs, Step, false,
+                  Step);
+
+  for (unsigned i = 0, e = Order.size(); i != e; ++i)
+    cloneInto(Kernel, Nodes[Order[i]].MI, 0, 0, true, 0);
+
+  SmallVector<MachineOperand, 2> Cond(ContinueCond);
+  Cond[1] = MachineOperand::CreateReg(
+      kernelOperand(ContinueCond[1].getReg(), 0), false);
+  TII->InsertBranch(*Kernel, Kernel, 0, Cond, LoopBranch->getDebugLoc());
+
+  for (unsigned Step = 0; Step + 1 < NumStages; ++Step)
+    for (unsigned i = 0, e = Order.size(); i != e; ++i)
+      if (stageOf(Order[i]) > (int)Step)
+        cloneInto(Epilogue, Nodes[Order[i]].MI, &EpilogueRegs, Step, false,
+                  Step);
+  TII->InsertBranch(*Epilogue, Exit, 0, SmallVector<MachineOperand, 0>(),
+                    LoopBranch->getDebugLoc());
+}
+
+// The original loop is kept for short trip counts, so every value used
+// after the loop now also comes from the epilogue. Uses outside the exit
+// block's PHIs are only possible when the loop is the exit's only
+// predecessor.
+void TileModuloScheduler::fixLiveOuts() {
+  // The last iteration, N - 1, ran its last stage in the last epilogue step.
+  int LastStep = NumStages - 2, LastStage = NumStages - 1;
+
+  for (MachineBasicBlock::iterator I = Exit->begin(), E = Exit->end();
+       I != E && I->isPHI(); ++I) {
+    unsigned Reg = getLoopIncoming(I, LoopBB);
+    MachineInstrBuilder(*MF, I)
+        .addReg(epilogueOperand(Reg, LastStep, LastStage))
+        .addMBB(Epilogue);
+  }
+
+  for (MachineBasicBlock::iterator I = LoopBB->begin(), E = LoopBB->end();
+       I != E; ++I) {
+    for (unsigned i = 0, e = I->getNumOperands(); i != e; ++i) {
+      const MachineOperand &MO = I->getOperand(i);
+      if (!MO.isReg() || !MO.isDef() ||
+          !TargetRegisterInfo::isVirtualRegister(MO.getReg()))
+        continue;
+      unsigned Reg = MO.getReg();
+
+      SmallVector<MachineOperand *, 4> Uses;
+      for (MachineRegisterInfo::use_iterator UI = MRI->use_begin(Reg),
+           UE = MRI->use_end(); UI != UE; ++UI) {
+        MachineInstr *UseMI = &*UI;
+        if (UseMI->getParent() == LoopBB)
+          continue;
+        // PHIs in the exit block were given their epilogue value above.
+        if (UseMI->isPHI() &&
+            UseMI->getOperand(UI.getOperandNo() + 1).getMBB() == LoopBB)
+          continue;
+        Uses.push_back(&UI.getOperand());
+      }
+      if (Uses.empty())
+        continue;
+
+      unsigned NewReg = MRI->createVirtualRegister(MRI->getRegClass(Reg));
+      BuildMI(*Exit, Exit->begin(), DebugLoc(), TII->get(TargetOpcode::PHI),
+              NewReg)
+          .addReg(Reg).addMBB(LoopBB)
+          .addReg(epilogueOperand(Reg, LastStep, LastStage)).addMBB(Epilogue);
+      for (unsigned u = 0, ue = Uses.size(); u != ue; ++u)
+        Uses[u]->setReg(NewReg);
+    }
+  }
+}
+
+// The prologue and epilogue copies of the loop branch's compare, and any
+// value only needed by iterations that are not there, are dead.
+void TileModuloScheduler::eliminateDeadCode(MachineBasicBlock *MBB) {
+  bool Changed = true;
+  while (Changed) {
+    Changed = false;
+    for (MachineBasicBlock::iterator I = MBB->begin(), E = MBB->end();
+         I != E;) {
+      MachineInstr *MI = I++;
+      if (MI->isTerminator() || MI->mayStore() ||
+          MI->hasUnmodeledSideEffects())
+        continue;
+
+      bool Dead = true;
+      for (unsigned i = 0, e = MI->getNumOperands(); i != e && Dead; ++i) {
+        const MachineOperand &MO = MI->getOperand(i);
+        if (MO.isReg() && MO.isDef() &&
+            !MRI->use_nodbg_empty(MO.getReg()))
+          Dead = false;
+      }
+      if (Dead) {
+        MI->eraseFromParent();
+        Changed = true;
+      }
+    }
+  }
+}
+
+bool TileModuloScheduler::runOnMachineFunction(MachineFunction &Fn) {
+  if (Fn.getFunction()->getAttributes().hasAttribute(
+          AttributeSet::FunctionIndex, Attribute::OptimizeForSize))
+    return false;
+
+  MF = &Fn;
+  const TargetMachine &TM = Fn.getTarget();
+  TII = static_cast<const TileInstrInfo *>(TM.getInstrInfo());
+  MRI = &Fn.getRegInfo();
+  DL = TM.getDataLayout();
+  const TargetSubtargetInfo &ST = TM.getSubtarget<TargetSubtargetInfo>();
+  SchedModel.init(*ST.getSchedModel(), &ST, TII);
+
+  SmallVector<MachineLoop *, 8> Worklist;
+  MachineLoopInfo &MLI = getAnalysis<MachineLoopInfo>();
+  for (MachineLoopInfo::iterator I = MLI.begin(), E = MLI.end(); I != E; ++I)
+    Worklist.push_back(*I);
+
+  SmallVector<MachineLoop *, 8> Innermost;
+  while (!Worklist.empty()) {
+    MachineLoop *L = Worklist.pop_back_val();
+    if (L->empty())
+      Innermost.push_back(L);
+    Worklist.append(L->begin(), L->end());
+  }
+
+  ResourceModel = new TileResourceModel(TM, SchedModel.getIssueWidth());
+  bool Changed = false;
+  for (unsigned i = 0, e = Innermost.size(); i != e; ++i) {
+    if (!canPipeline(Innermost[i])) {
+      DEBUG(dbgs() << "Cannot pipeline loop at BB#"
+                   << Innermost[i]->getHeader()->getNumber() << '\n');
+      continue;
+    }
+
+    buildGraph();
+    unsigned NumSlots = 1;
+    for (unsigned N = 0, NE = Nodes.size(); N != NE; ++N)
+      if (!ResourceModel->isFree(Nodes[N].MI))
+        ++NumSlots;
+
+    // Without overlap an iteration takes as long as its list schedule.
+    unsigned FlatII = 1;
+    for (unsigned N = 0, NE = Nodes.size(); N != NE; ++N)
+      FlatII += std::max(SchedModel.computeInstrLatency(Nodes[N].MI), 1U);
+    if (!schedule(FlatII, false)) {
+      DEBUG(dbgs() << "Cannot list schedule BB#" << LoopBB->getNumber()
+                   << '\n');
+      continue;
+    }
+    unsigned FlatLength = 1;
+    for (unsigned N = 0, NE = Nodes.size(); N != NE; ++N)
+      FlatLength = std::max(FlatLength, (unsigned)Nodes[N].Cycle + 1);
+
+    unsigned MinII = (NumSlots + SchedModel.getIssueWidth() - 1) /
+                     SchedModel.getIssueWidth();
+    bool Found = false;
+    for (unsigned CandII = MinII; CandII < FlatLength && !Found; ++CandII)
+      Found = schedule(CandII, true);
+    if (!Found || NumStages < 2 || NumStages > PipelinerMaxStages ||
+        !isInt<16>(NumStages * (Step > 0 ? Step : -Step))) {
+      DEBUG(dbgs() << "No profitable schedule for BB#" << LoopBB->getNumber()
+                   << ", " << FlatLength << " cycles unpipelined\n");
+      continue;
+    }
+
+    DEBUG(dbgs() << "Pipelining BB#" << LoopBB->getNumber() << " in "
+                 << Fn.getName() << ": II " << II << ", " << NumStages
+                 << " stages, " << FlatLength << " cycles unpipelined\n");
+
+    emitPipelinedLoop();
+    insertGuard();
+    fixLiveOuts();
+    eliminateDeadCode(Prologue);
+    eliminateDeadCode(Epilogue);
+    for (unsigned r = 0, re = OutsideRegs.size(); r != re; ++r)
+      MRI->clearKillFlags(OutsideRegs[r]);
+
+    ++NumPipelined;
+    Changed = true;
+  }
+
+  delete ResourceModel;
+  ResourceModel = 0;
+  return Changed;
+}
+
+FunctionPass *llvm::createTileModuloSchedulerPass() {
+  return new TileModuloScheduler();
+}
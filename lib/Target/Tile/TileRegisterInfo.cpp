@@ -101,6 +101,12 @@ bool TileRegisterInfo::requiresRegisterScavenging(
   return true;
 }
 
+// The post-RA scheduler needs accurate live-ins to break anti-dependencies.
+bool TileRegisterInfo::trackLivenessAfterRegAlloc(
+    const MachineFunction &MF) const {
+  return true;
+}
+
 // FrameIndex represent objects inside a abstract stack.
 // We must replace FrameIndex with an stack/frame pointer
 // direct reference.
@@ -132,8 +138,8 @@ void TileRegisterInfo::eliminateFrameIndex(MachineBasicBlock::iterator II,
   if (Opc == Tile::TileFI) {
     DestReg = MI.getOperand(0).getReg();
     FrameIndexOp = &MI.getOperand(1);
-  } else if (Opc == Tile::ST || Opc == Tile::ST4 || Opc == Tile::LD ||
-             Opc == Tile::LD4S32 || MI.isDebugValue()) {
+  } else if (Opc == Tile::ST || Opc == Tile::ST4 || Opc == Tile::ST432 ||
+             Opc == Tile::LD || Opc == Tile::LD4S32 || MI.isDebugValue()) {
     DestReg = Tile::R49;
     FrameIndexOp = &MI.getOperand(FIOperandNum);
   }
@@ -189,6 +195,7 @@ void TileRegisterInfo::eliminateFrameIndex(MachineBasicBlock::iterator II,
     break;
   case Tile::ST:
   case Tile::ST4:
+  case Tile::ST432:
   case Tile::LD:
   case Tile::LD4S32:
     FrameIndexOp->ChangeToRegister(DestReg, false);
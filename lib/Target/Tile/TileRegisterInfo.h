@@ -49,6 +49,8 @@ struct TileRegisterInfo : public TileGenRegisterInfo {
 
   virtual bool requiresRegisterScavenging(const MachineFunction &MF) const;
 
+  virtual bool trackLivenessAfterRegAlloc(const MachineFunction &MF) const;
+
   /// Stack Frame Processing Methods.
   void eliminateFrameIndex(MachineBasicBlock::iterator II, int SPAdj,
                            unsigned FIOperandNum,
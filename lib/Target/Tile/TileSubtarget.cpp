@@ -34,6 +34,9 @@ TileSubtarget::TileSubtarget(const std::string &TT, const std::string &CPU,
   // Parse features string.
   ParseSubtargetFeatures(CPUName, FS);
 
+  // The CPU defaults to tilegx above, make sure its MCSchedModel is used.
+  InitMCProcessorInfo(CPUName, FS);
+
   // Initialize scheduling itinerary for the specified CPU.
   InstrItins = getInstrItineraryForCPU(CPUName);
 }
@@ -41,7 +44,7 @@ TileSubtarget::TileSubtarget(const std::string &TT, const std::string &CPU,
 bool TileSubtarget::enablePostRAScheduler(
     CodeGenOpt::Level OptLevel, TargetSubtargetInfo::AntiDepBreakMode &Mode,
     RegClassVector &CriticalPathRCs) const {
-  Mode = TargetSubtargetInfo::ANTIDEP_NONE;
+  Mode = TargetSubtargetInfo::ANTIDEP_CRITICAL;
   CriticalPathRCs.clear();
   CriticalPathRCs.push_back(&Tile::CPURegsRegClass);
   return OptLevel >= CodeGenOpt::Aggressive;
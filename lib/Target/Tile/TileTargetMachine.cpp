@@ -13,6 +13,7 @@
 
 #include "TileTargetMachine.h"
 #include "Tile.h"
+#include "TileMachineScheduler.h"
 #include "llvm/PassManager.h"
 #include "llvm/CodeGen/Passes.h"
 #include "llvm/Support/CommandLine.h"
@@ -23,6 +24,26 @@ static cl::opt<bool> DisableTileGXVLIWPacketizer(
     "disable-tilegx-packetizer", cl::Hidden, cl::ZeroOrMore, cl::init(false),
     cl::desc("Disable TileGX VLIW Packetizer"));
 
+static cl::opt<bool> DisableTileGXMISched(
+    "disable-tilegx-misched", cl::Hidden, cl::ZeroOrMore, cl::init(false),
+    cl::desc("Disable TileGX bundle-aware MI scheduling"));
+
+static cl::opt<bool> DisableTileGXPipeliner(
+    "disable-tilegx-pipeliner", cl::Hidden, cl::ZeroOrMore, cl::init(false),
+    cl::desc("Disable TileGX software pipelining of innermost loops"));
+
+static cl::opt<bool> DisableTileGXEarlyIfConv(
+    "disable-tilegx-early-ifcvt", cl::Hidden, cl::ZeroOrMore, cl::init(false),
+    cl::desc("Disable TileGX early if-conversion to cmovnez"));
+
+static cl::opt<bool> DisableTileGXBitIdioms(
+    "disable-tilegx-bit-idioms", cl::Hidden, cl::ZeroOrMore, cl::init(false),
+    cl::desc("Disable TileGX crc32 and revbits idiom recognition"));
+
+static cl::opt<bool> DisableTileGXWriteHint(
+    "disable-tilegx-wh64", cl::Hidden, cl::ZeroOrMore, cl::init(false),
+    cl::desc("Disable TileGX wh64 insertion for overwritten lines"));
+
 extern "C" void LLVMInitializeTileTarget() {
   // Register the target.
   RegisterTargetMachine<TileGXTargetMachine> B(TheTileGXTarget);
@@ -45,12 +66,26 @@ TileGXTargetMachine::TileGXTargetMachine(
     CodeGenOpt::Level OL)
     : TileTargetMachine(T, TT, CPU, FS, Options, RM, CM, OL) {}
 
+static ScheduleDAGInstrs *createTileMachineSched(MachineSchedContext *C) {
+  return new ScheduleDAGMI(C, new TileMachineSchedStrategy());
+}
+
+static MachineSchedRegistry
+TileSchedRegistry("tile", "Schedule for TileGX bundle density",
+                  createTileMachineSched);
+
 namespace {
 // Tile Code Generator Pass Configuration Options.
 class TilePassConfig : public TargetPassConfig {
 public:
   TilePassConfig(TileTargetMachine *TM, PassManagerBase &PM)
-      : TargetPassConfig(TM, PM) {}
+      : TargetPassConfig(TM, PM) {
+    // Order instructions for the packetizer before register allocation.
+    if (TM->getOptLevel() != CodeGenOpt::None && !DisableTileGXMISched) {
+      enablePass(&MachineSchedulerID);
+      MachineSchedRegistry::setDefault(createTileMachineSched);
+    }
+  }
 
   TileTargetMachine &getTileTargetMachine() const {
     return getTM<TileTargetMachine>();
@@ -60,7 +95,10 @@ public:
     return *getTileTargetMachine().getSubtargetImpl();
   }
 
+  virtual void addIRPasses();
   virtual bool addInstSelector();
+  virtual bool addILPOpts();
+  virtual bool addPreRegAlloc();
   virtual bool addPreSched2();
   virtual bool addPreEmitPass();
 };
@@ -70,6 +108,15 @@ TargetPassConfig *TileTargetMachine::createPassConfig(PassManagerBase &PM) {
   return new TilePassConfig(this, PM);
 }
 
+void TilePassConfig::addIRPasses() {
+  TargetPassConfig::addIRPasses();
+
+  if (getOptLevel() != CodeGenOpt::None && !DisableTileGXBitIdioms)
+    addPass(createTileBitIdiomsPass());
+  if (getOptLevel() != CodeGenOpt::None && !DisableTileGXWriteHint)
+    addPass(createTileWriteHintPass());
+}
+
 // Install an instruction selector pass using
 // the ISelDag to gen Tile code.
 bool TilePassConfig::addInstSelector() {
@@ -77,6 +124,22 @@ bool TilePassConfig::addInstSelector() {
   return false;
 }
 
+// Short diamonds are cheaper as cmovnez: both sides fill empty bundle slots
+// while a mispredicted branch stalls the pipeline.
+bool TilePassConfig::addILPOpts() {
+  if (getOptLevel() != CodeGenOpt::None && !DisableTileGXEarlyIfConv) {
+    addPass(&EarlyIfConverterID);
+    return true;
+  }
+  return false;
+}
+
+bool TilePassConfig::addPreRegAlloc() {
+  if (getOptLevel() != CodeGenOpt::None && !DisableTileGXPipeliner)
+    addPass(createTileModuloSchedulerPass());
+  return false;
+}
+
 bool TilePassConfig::addPreSched2() {
   addPass(createTileExpandPseudoPass(getTileTargetMachine()));
   return true;
@@ -14,7 +14,7 @@
 ///
 //===----------------------------------------------------------------------===//
 
-#define DEBUG_TYPE "ppctti"
+#define DEBUG_TYPE "tiletti"
 #include "Tile.h"
 #include "TileTargetMachine.h"
 #include "llvm/Analysis/TargetTransformInfo.h"
@@ -77,6 +77,9 @@ public:
   /// \name Scalar TTI Implementations
   /// @{
   virtual PopcntSupportKind getPopcntSupport(unsigned TyWidth) const;
+  virtual bool isLegalAddressingMode(Type *Ty, GlobalValue *BaseGV,
+                                     int64_t BaseOffset, bool HasBaseReg,
+                                     int64_t Scale) const;
 
   /// @}
 
@@ -100,6 +103,8 @@ public:
   virtual unsigned getMemoryOpCost(unsigned Opcode, Type *Src,
                                    unsigned Alignment,
                                    unsigned AddressSpace) const;
+  virtual unsigned getIntrinsicInstrCost(Intrinsic::ID ID, Type *RetTy,
+                                         ArrayRef<Type *> Tys) const;
 
   /// @}
 };
@@ -129,6 +134,26 @@ TileTTI::PopcntSupportKind TileTTI::getPopcntSupport(unsigned TyWidth) const {
   return PSK_Software;
 }
 
+// Loads and stores only take a plain register address, an offset or an
+// index costs an add per access. Reporting that keeps LoopStrengthReduce
+// from sharing one index between several streams, and the separate pointer
+// IVs it chooses instead fold into post-increment ld*_add/st*_add.
+bool TileTTI::isLegalAddressingMode(Type *Ty, GlobalValue *BaseGV,
+                                    int64_t BaseOffset, bool HasBaseReg,
+                                    int64_t Scale) const {
+  if (BaseGV || BaseOffset)
+    return false;
+
+  switch (Scale) {
+  case 0:
+    return true;
+  case 1:
+    return !HasBaseReg;
+  default:
+    return false;
+  }
+}
+
 unsigned TileTTI::getNumberOfRegisters(bool Vector) const {
   return 64;
 }
@@ -137,14 +162,128 @@ unsigned TileTTI::getRegisterBitWidth(bool Vector) const {
   return 64;
 }
 
+// Three issue slots, 64 registers and a two cycle load to use latency on an
+// in-order core: four independent copies of a small loop body are needed to
+// keep the slots busy.
 unsigned TileTTI::getMaximumUnrollFactor() const {
-  return 2;
+  return 4;
+}
+
+unsigned TileTTI::getScalarizationOverhead(Type *Ty, bool Insert,
+                                           bool Extract) const {
+  assert(Ty->isVectorTy() && "Can only scalarize vectors");
+  unsigned Cost = 0;
+
+  for (unsigned i = 0, e = Ty->getVectorNumElements(); i < e; ++i) {
+    if (Insert)
+      Cost += getVectorInstrCost(Instruction::InsertElement, Ty, i);
+    if (Extract)
+      Cost += getVectorInstrCost(Instruction::ExtractElement, Ty, i);
+  }
+
+  return Cost;
 }
 
 unsigned TileTTI::getArithmeticInstrCost(unsigned Opcode, Type *Ty,
                                         OperandValueKind Op1Info,
                                         OperandValueKind Op2Info) const {
-  assert(TLI->InstructionOpcodeToISD(Opcode) && "Invalid opcode");
+  int ISD = TLI->InstructionOpcodeToISD(Opcode);
+  assert(ISD && "Invalid opcode");
+
+  std::pair<unsigned, MVT> LT = TLI->getTypeLegalizationCost(Ty);
+
+  // SIMD shifts take a single amount for all the lanes.
+  static const CostTblEntry<MVT::SimpleValueType> UniformShiftCostTable[] = {
+    { ISD::SHL, MVT::v8i8,  1 }, // v1shli/v1shl
+    { ISD::SRL, MVT::v8i8,  1 }, // v1shrui/v1shru
+    { ISD::SRA, MVT::v8i8,  1 }, // v1shrsi/v1shrs
+    { ISD::SHL, MVT::v4i16, 1 }, // v2shli/v2shl
+    { ISD::SRL, MVT::v4i16, 1 }, // v2shrui/v2shru
+    { ISD::SRA, MVT::v4i16, 1 }, // v2shrsi/v2shrs
+    { ISD::SHL, MVT::v2i32, 1 }, // v4shl
+    { ISD::SRL, MVT::v2i32, 1 }, // v4shru
+    { ISD::SRA, MVT::v2i32, 1 }, // v4shrs
+  };
+
+  if (Ty->isVectorTy() && (ISD == ISD::SHL || ISD == ISD::SRL ||
+                           ISD == ISD::SRA)) {
+    int Idx = CostTableLookup<MVT::SimpleValueType>(
+        UniformShiftCostTable, array_lengthof(UniformShiftCostTable), ISD,
+        LT.second.SimpleTy);
+
+    if (Idx != -1 && Op2Info != OK_AnyValue)
+      return LT.first * UniformShiftCostTable[Idx].Cost;
+
+    // Otherwise the shift gets unrolled.
+    Type *EltTy = Ty->getVectorElementType();
+    return getScalarizationOverhead(Ty, true, true) +
+           Ty->getVectorNumElements() *
+           getArithmeticInstrCost(Opcode, EltTy, Op1Info, Op2Info);
+  }
+
+  // SIMD operations. There is no 4 byte lane multiply, v2i32 multiplies
+  // are done lane by lane with bfextu/mulx/bfins.
+  static const CostTblEntry<MVT::SimpleValueType> SIMDCostTable[] = {
+    { ISD::ADD, MVT::v8i8,  1 },  // v1add
+    { ISD::ADD, MVT::v4i16, 1 },  // v2add
+    { ISD::ADD, MVT::v2i32, 1 },  // v4add
+    { ISD::SUB, MVT::v8i8,  1 },  // v1sub
+    { ISD::SUB, MVT::v4i16, 1 },  // v2sub
+    { ISD::SUB, MVT::v2i32, 1 },  // v4sub
+    { ISD::AND, MVT::v8i8,  1 },
+    { ISD::AND, MVT::v4i16, 1 },
+    { ISD::AND, MVT::v2i32, 1 },
+    { ISD::OR,  MVT::v8i8,  1 },
+    { ISD::OR,  MVT::v4i16, 1 },
+    { ISD::OR,  MVT::v2i32, 1 },
+    { ISD::XOR, MVT::v8i8,  1 },
+    { ISD::XOR, MVT::v4i16, 1 },
+    { ISD::XOR, MVT::v2i32, 1 },
+    { ISD::MUL, MVT::v8i8,  1 },  // v1multu
+    { ISD::MUL, MVT::v4i16, 1 },  // v2mults
+    { ISD::MUL, MVT::v2i32, 10 },
+  };
+
+  // Scalar operations that are not a single instruction. Float add and
+  // multiply are sequences of the fsingle_* and fdouble_* helpers. There
+  // is no divider: i32 division is the inline UDIVREM32 shift-subtract
+  // loop, which takes about three bundles per significant quotient bit
+  // after a clz setup, signed forms add the sign fixups. Wider division
+  // and FP division are calls into libgcc.
+  static const CostTblEntry<MVT::SimpleValueType> ScalarCostTable[] = {
+    { ISD::MUL,  MVT::i64, 4 },   // mul_hu_lu, mula_hu_lu, shli, mula_lu_lu
+    { ISD::SDIV, MVT::i32, 26 },  // abs, UDIVREM32 loop, sign fixup
+    { ISD::UDIV, MVT::i32, 20 },  // UDIVREM32 loop
+    { ISD::SREM, MVT::i32, 26 },
+    { ISD::UREM, MVT::i32, 20 },
+    { ISD::SDIV, MVT::i64, 40 },  // __divdi3
+    { ISD::UDIV, MVT::i64, 40 },  // __udivdi3
+    { ISD::SREM, MVT::i64, 40 },  // __moddi3
+    { ISD::UREM, MVT::i64, 40 },  // __umoddi3
+    { ISD::FADD, MVT::f32, 4 },
+    { ISD::FSUB, MVT::f32, 4 },
+    { ISD::FMUL, MVT::f32, 4 },
+    { ISD::FADD, MVT::f64, 6 },
+    { ISD::FSUB, MVT::f64, 6 },
+    { ISD::FMUL, MVT::f64, 15 },
+    { ISD::FDIV, MVT::f32, 40 },  // __divsf3
+    { ISD::FDIV, MVT::f64, 60 },  // __divdf3
+    { ISD::FREM, MVT::f32, 60 },  // fmodf
+    { ISD::FREM, MVT::f64, 80 },  // fmod
+  };
+
+  if (Ty->isVectorTy()) {
+    int Idx = CostTableLookup<MVT::SimpleValueType>(
+        SIMDCostTable, array_lengthof(SIMDCostTable), ISD, LT.second.SimpleTy);
+    if (Idx != -1)
+      return LT.first * SIMDCostTable[Idx].Cost;
+  } else {
+    int Idx = CostTableLookup<MVT::SimpleValueType>(
+        ScalarCostTable, array_lengthof(ScalarCostTable), ISD,
+        LT.second.SimpleTy);
+    if (Idx != -1)
+      return LT.first * ScalarCostTable[Idx].Cost;
+  }
 
   // Fallback to the default implementation.
   return TargetTransformInfo::getArithmeticInstrCost(Opcode, Ty, Op1Info,
@@ -153,17 +292,101 @@ unsigned TileTTI::getArithmeticInstrCost(unsigned Opcode, Type *Ty,
 
 unsigned TileTTI::getShuffleCost(ShuffleKind Kind, Type *Tp, int Index,
                                 Type *SubTp) const {
+  std::pair<unsigned, MVT> LT = TLI->getTypeLegalizationCost(Tp);
+
+  // A broadcast or reverse within one SIMD register is a single
+  // shufflebytes (v4int_l for 32-bit lanes) on a loop invariant selector.
+  if (LT.second.isVector() && (Kind == SK_Broadcast || Kind == SK_Reverse))
+    return LT.first * 1;
+
   return TargetTransformInfo::getShuffleCost(Kind, Tp, Index, SubTp);
 }
 
 unsigned TileTTI::getCastInstrCost(unsigned Opcode, Type *Dst, Type *Src) const {
-  assert(TLI->InstructionOpcodeToISD(Opcode) && "Invalid opcode");
+  int ISD = TLI->InstructionOpcodeToISD(Opcode);
+  assert(ISD && "Invalid opcode");
+
+  // Float conversions are custom lowered to fsingle_*/fdouble_* sequences,
+  // lane width changes of SIMD vectors are done lane by lane.
+  static const TypeConversionCostTblEntry<MVT::SimpleValueType>
+  ConversionCostTable[] = {
+    { ISD::SINT_TO_FP,  MVT::f32,   MVT::i32,   9 },
+    { ISD::SINT_TO_FP,  MVT::f32,   MVT::i64,   8 },
+    { ISD::SINT_TO_FP,  MVT::f64,   MVT::i32,   10 },
+    { ISD::SINT_TO_FP,  MVT::f64,   MVT::i64,   8 },
+    { ISD::UINT_TO_FP,  MVT::f32,   MVT::i32,   9 },
+    { ISD::UINT_TO_FP,  MVT::f32,   MVT::i64,   8 },
+    { ISD::UINT_TO_FP,  MVT::f64,   MVT::i32,   10 },
+    { ISD::UINT_TO_FP,  MVT::f64,   MVT::i64,   8 },
+    { ISD::FP_TO_SINT,  MVT::i32,   MVT::f32,   8 },
+    { ISD::FP_TO_SINT,  MVT::i64,   MVT::f32,   8 },
+    { ISD::FP_TO_SINT,  MVT::i32,   MVT::f64,   8 },
+    { ISD::FP_TO_SINT,  MVT::i64,   MVT::f64,   8 },
+    { ISD::FP_TO_UINT,  MVT::i32,   MVT::f32,   8 },
+    { ISD::FP_TO_UINT,  MVT::i64,   MVT::f32,   8 },
+    { ISD::FP_TO_UINT,  MVT::i32,   MVT::f64,   8 },
+    { ISD::FP_TO_UINT,  MVT::i64,   MVT::f64,   8 },
+    { ISD::FP_EXTEND,   MVT::f64,   MVT::f32,   8 },
+    { ISD::FP_ROUND,    MVT::f32,   MVT::f64,   8 },
+
+    { ISD::ZERO_EXTEND, MVT::v8i16, MVT::v8i8,  32 },
+    { ISD::SIGN_EXTEND, MVT::v8i16, MVT::v8i8,  30 },
+    { ISD::ZERO_EXTEND, MVT::v8i32, MVT::v8i8,  35 },
+    { ISD::SIGN_EXTEND, MVT::v8i32, MVT::v8i8,  35 },
+    { ISD::ZERO_EXTEND, MVT::v4i32, MVT::v4i16, 19 },
+    { ISD::SIGN_EXTEND, MVT::v4i32, MVT::v4i16, 19 },
+    { ISD::ZERO_EXTEND, MVT::v2i64, MVT::v2i32, 4 },
+    { ISD::SIGN_EXTEND, MVT::v2i64, MVT::v2i32, 4 },
+    { ISD::TRUNCATE,    MVT::v8i8,  MVT::v8i16, 26 },
+    { ISD::TRUNCATE,    MVT::v8i8,  MVT::v8i32, 26 },
+    { ISD::TRUNCATE,    MVT::v4i16, MVT::v4i32, 14 },
+    { ISD::TRUNCATE,    MVT::v2i32, MVT::v2i64, 4 },
+  };
+
+  EVT SrcTy = TLI->getValueType(Src);
+  EVT DstTy = TLI->getValueType(Dst);
+  if (SrcTy.isSimple() && DstTy.isSimple()) {
+    int Idx = ConvertCostTableLookup<MVT::SimpleValueType>(
+        ConversionCostTable, array_lengthof(ConversionCostTable), ISD,
+        DstTy.getSimpleVT().SimpleTy, SrcTy.getSimpleVT().SimpleTy);
+    if (Idx != -1)
+      return ConversionCostTable[Idx].Cost;
+  }
 
   return TargetTransformInfo::getCastInstrCost(Opcode, Dst, Src);
 }
 
 unsigned TileTTI::getCmpSelInstrCost(unsigned Opcode, Type *ValTy,
                                     Type *CondTy) const {
+  int ISD = TLI->InstructionOpcodeToISD(Opcode);
+  assert(ISD && "Invalid opcode");
+
+  // Selects on vectors are actually vector selects.
+  if (ISD == ISD::SELECT && CondTy && CondTy->isVectorTy())
+    ISD = ISD::VSELECT;
+
+  std::pair<unsigned, MVT> LT = TLI->getTypeLegalizationCost(ValTy);
+
+  // Float compares test the flags fsingle_add1/fdouble_add_flags leave
+  // in the result, ordered predicates take a few more instructions. There
+  // are no 4 byte lane compares, v2i32 is done lane by lane.
+  static const CostTblEntry<MVT::SimpleValueType> CmpSelCostTable[] = {
+    { ISD::SETCC,   MVT::f32,   6 },
+    { ISD::SETCC,   MVT::f64,   6 },
+    { ISD::SETCC,   MVT::v8i8,  1 },  // v1cmp*
+    { ISD::SETCC,   MVT::v4i16, 1 },  // v2cmp*
+    { ISD::SETCC,   MVT::v2i32, 10 },
+    { ISD::VSELECT, MVT::v8i8,  3 },  // v1mnz, v1mz, or
+    { ISD::VSELECT, MVT::v4i16, 3 },  // v2mnz, v2mz, or
+    { ISD::VSELECT, MVT::v2i32, 10 },
+  };
+
+  int Idx = CostTableLookup<MVT::SimpleValueType>(
+      CmpSelCostTable, array_lengthof(CmpSelCostTable), ISD,
+      LT.second.SimpleTy);
+  if (Idx != -1)
+    return LT.first * CmpSelCostTable[Idx].Cost;
+
   return TargetTransformInfo::getCmpSelInstrCost(Opcode, ValTy, CondTy);
 }
 
@@ -174,20 +397,18 @@ unsigned TileTTI::getVectorInstrCost(unsigned Opcode, Type *Val,
   int ISD = TLI->InstructionOpcodeToISD(Opcode);
   assert(ISD && "Invalid opcode");
 
-  // Estimated cost of a load-hit-store delay.  This was obtained
-  // experimentally as a minimum needed to prevent unprofitable
-  // vectorization for the paq8p benchmark.  It may need to be
-  // raised further if other unprofitable cases remain.
-  unsigned LHSPenalty = 12;
-
-  // Vector element insert/extract with Altivec is very expensive,
-  // because they require store and reload with the attendant
-  // processor stall for load-hit-store.  Until VSX is available,
-  // these need to be estimated as very costly.
-  if (ISD == ISD::EXTRACT_VECTOR_ELT ||
-      ISD == ISD::INSERT_VECTOR_ELT)
-    return LHSPenalty +
-      TargetTransformInfo::getVectorInstrCost(Opcode, Val, Index);
+  // Lanes live in general registers, an extract is a bfextu (plus a sign
+  // extension for 4 byte lanes) and an insert a bfins.
+  if (ISD == ISD::EXTRACT_VECTOR_ELT) {
+    std::pair<unsigned, MVT> LT = TLI->getTypeLegalizationCost(Val);
+    if (LT.second.isVector())
+      return LT.second.getVectorElementType() == MVT::i32 ? 2 : 1;
+  }
+  if (ISD == ISD::INSERT_VECTOR_ELT) {
+    std::pair<unsigned, MVT> LT = TLI->getTypeLegalizationCost(Val);
+    if (LT.second.isVector())
+      return 1;
+  }
 
   return TargetTransformInfo::getVectorInstrCost(Opcode, Val, Index);
 }
@@ -202,12 +423,63 @@ unsigned TileTTI::getMemoryOpCost(unsigned Opcode, Type *Src, unsigned Alignment
   // Each load/store unit costs 1.
   unsigned Cost = LT.first * 1;
 
-  // Tile in general does not support unaligned loads and stores. They'll need
-  // to be decomposed based on the alignment factor.
+  // Tile does not support unaligned loads and stores. They are split into
+  // Alignment sized pieces, which are shifted and or'ed together for a load
+  // and shifted out for a store.
+  static const CostTblEntry<unsigned> UnalignedCostTable[] = {
+    { ISD::LOAD,  2, 5 },
+    { ISD::LOAD,  4, 13 },
+    { ISD::LOAD,  8, 28 },
+    { ISD::STORE, 2, 4 },
+    { ISD::STORE, 4, 10 },
+    { ISD::STORE, 8, 21 },
+  };
+
   unsigned SrcBytes = LT.second.getStoreSize();
-  if (SrcBytes && Alignment && Alignment < SrcBytes)
+  if (SrcBytes && Alignment && Alignment < SrcBytes) {
+    int ISD = Opcode == Instruction::Load ? ISD::LOAD : ISD::STORE;
+    int Idx = CostTableLookup<unsigned>(UnalignedCostTable,
+                                        array_lengthof(UnalignedCostTable),
+                                        ISD, SrcBytes / Alignment);
+    if (Idx != -1)
+      return LT.first * UnalignedCostTable[Idx].Cost;
     Cost *= (SrcBytes/Alignment);
+  }
 
   return Cost;
 }
 
+unsigned TileTTI::getIntrinsicInstrCost(Intrinsic::ID ID, Type *RetTy,
+                                        ArrayRef<Type *> Tys) const {
+  // Square root goes to libm, fma has no fused instruction and goes there
+  // too.
+  static const CostTblEntry<MVT::SimpleValueType> LibcallCostTable[] = {
+    { ISD::FSQRT, MVT::f32, 40 },  // sqrtf
+    { ISD::FSQRT, MVT::f64, 60 },  // sqrt
+    { ISD::FMA,   MVT::f32, 40 },  // fmaf
+    { ISD::FMA,   MVT::f64, 60 },  // fma
+  };
+
+  int ISD = 0;
+  switch (ID) {
+  default:
+    break;
+  case Intrinsic::sqrt:
+    ISD = ISD::FSQRT;
+    break;
+  case Intrinsic::fma:
+    ISD = ISD::FMA;
+    break;
+  }
+
+  if (ISD && !RetTy->isVectorTy()) {
+    std::pair<unsigned, MVT> LT = TLI->getTypeLegalizationCost(RetTy);
+    int Idx = CostTableLookup<MVT::SimpleValueType>(
+        LibcallCostTable, array_lengthof(LibcallCostTable), ISD,
+        LT.second.SimpleTy);
+    if (Idx != -1)
+      return LT.first * LibcallCostTable[Idx].Cost;
+  }
+
+  return TargetTransformInfo::getIntrinsicInstrCost(ID, RetTy, Tys);
+}
@@ -11,20 +11,114 @@
 
 #include "Tile.h"
 #include "TileInstrInfo.h"
+#include "TileMachineScheduler.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/Statistic.h"
 #include "llvm/CodeGen/DFAPacketizer.h"
+#include "llvm/CodeGen/MachineBranchProbabilityInfo.h"
 #include "llvm/CodeGen/MachineDominators.h"
 #include "llvm/CodeGen/MachineFunctionPass.h"
+#include "llvm/CodeGen/MachineInstrBundle.h"
+#include "llvm/CodeGen/MachineJumpTableInfo.h"
 #include "llvm/CodeGen/MachineLoopInfo.h"
+#include "llvm/CodeGen/MachineRegisterInfo.h"
 #include "llvm/CodeGen/ScheduleDAG.h"
 #include "llvm/Target/TargetMachine.h"
 #include "llvm/Target/TargetInstrInfo.h"
 #include "llvm/MC/MCInstrItineraries.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/raw_ostream.h"
 
 using namespace llvm;
 using namespace TileII;
 
+STATISTIC(NumSpeculated, "Number of instructions speculated into a branch "
+                         "bundle");
+STATISTIC(NumFarBranches, "Number of far conditional branches taken out of "
+                          "their bundle");
+
+static cl::opt<bool> DisableTileGXBranchBundleFill(
+    "disable-tilegx-branch-bundle-fill", cl::Hidden, cl::ZeroOrMore,
+    cl::init(false),
+    cl::desc("Disable speculating successor instructions into TileGX branch "
+             "bundles"));
+
+// A conditional branch reaches a signed 17 bit count of bundles.
+static const uint64_t MaxBranchBytes = ((1 << 16) - 1) * 8;
+
+static const uint16_t NetworkRegs[] = { Tile::UDN0, Tile::UDN1, Tile::UDN2,
+                                        Tile::UDN3, Tile::IDN0, Tile::IDN1 };
+
+// Return true if MI writes, or unless OnlyDefs is set reads, a register
+// overlapping Reg.
+static bool accessesRegister(const MachineInstr *MI, unsigned Reg,
+                             bool OnlyDefs, const TargetRegisterInfo *TRI) {
+  for (unsigned i = 0, e = MI->getNumOperands(); i != e; ++i) {
+    const MachineOperand &MO = MI->getOperand(i);
+    if (MO.isRegMask() && MO.clobbersPhysReg(Reg))
+      return true;
+    if (!MO.isReg() || !MO.getReg() || (OnlyDefs && !MO.isDef()))
+      continue;
+    if (TRI->regsOverlap(MO.getReg(), Reg))
+      return true;
+  }
+  return false;
+}
+
+// Collect the instructions issued together with MI, MI included.
+static void getPacket(MachineInstr *MI,
+                      SmallVectorImpl<MachineInstr *> &Packet) {
+  MachineBasicBlock::instr_iterator I = MI;
+  while (I->isBundledWithPred())
+    --I;
+  if (I->isBundle())
+    ++I;
+  for (;; ++I) {
+    Packet.push_back(I);
+    if (!I->isBundledWithSucc())
+      break;
+  }
+}
+
+// Return an upper bound on the bytes MI adds to the function, counting it as
+// a bundle of its own. Inline asm has no bound and counts as MaxBranchBytes,
+// so a branch over it is always considered far.
+static uint64_t getMaxInstrBytes(const MachineInstr *MI,
+                                 const MachineJumpTableInfo *MJTI) {
+  if (MI->isBundle() || MI->isDebugValue() || MI->isLabel() ||
+      MI->isTransient())
+    return 0;
+  if (MI->isInlineAsm())
+    return MaxBranchBytes;
+  // A relaxed conditional branch is the inverted branch and a jump.
+  if (MI->isConditionalBranch(MachineInstr::IgnoreBundle))
+    return 16;
+  // The jump table is emitted right after its indirect jump.
+  if (MI->getOpcode() == Tile::BRINDJT)
+    return 8 + 8 * MJTI->getJumpTables()[MI->getOperand(1).getIndex()]
+                       .MBBs.size();
+  return 8;
+}
+
+// Dissolve the bundle holding Packet, if any.
+static void unbundlePacket(MachineBasicBlock &MBB,
+                           ArrayRef<MachineInstr *> Packet) {
+  if (!Packet.front()->isBundledWithPred())
+    return;
+  for (unsigned i = 0, e = Packet.size(); i != e; ++i)
+    Packet[i]->unbundleFromPred();
+  MachineBasicBlock::instr_iterator Header = Packet.front();
+  MBB.erase(--Header);
+}
+
 namespace {
 class TileVLIWPacketizer : public MachineFunctionPass {
+  const TileInstrInfo *TII;
+  const TargetRegisterInfo *TRI;
+  const MachineRegisterInfo *MRI;
+  const MachineBranchProbabilityInfo *MBPI;
+  TileResourceModel *ResourceModel;
 
 public:
   static char ID;
@@ -32,6 +126,7 @@ public:
 
   void getAnalysisUsage(AnalysisUsage &AU) const {
     AU.setPreservesCFG();
+    AU.addRequired<MachineBranchProbabilityInfo>();
     AU.addRequired<MachineDominatorTree>();
     AU.addPreserved<MachineDominatorTree>();
     AU.addRequired<MachineLoopInfo>();
@@ -42,6 +137,22 @@ public:
   const char *getPassName() const { return "Tile VLIW Packetizer"; }
 
   bool runOnMachineFunction(MachineFunction &Fn);
+
+private:
+  // Move instructions from the top of the likely successor of MBB into the
+  // bundle of its conditional branch while the bundle has room.
+  bool fillBranchBundle(MachineBasicBlock &MBB);
+
+  // Take conditional branches whose target may be out of the reach of a
+  // bundled branch out of their bundle, so the assembler can relax them.
+  bool unbundleFarBranches(MachineFunction &Fn);
+
+  // Return true if MI, one of the instructions in Packet, may issue in
+  // Bundle with the branch instead, and so on the path to Other as well.
+  bool canSpeculateIntoBundle(MachineInstr *MI,
+                              ArrayRef<MachineInstr *> Bundle,
+                              ArrayRef<MachineInstr *> Packet,
+                              MachineBasicBlock *Other) const;
 };
 char TileVLIWPacketizer::ID = 0;
 
@@ -66,15 +177,7 @@ public:
   virtual bool isLegalToPacketizeTogether(SUnit *SUI, SUnit *SUJ);
 
   // Do a second check to see if MI can be bundled into current
-  // packet in either X or Y mode.
-  //
-  // The original DFA packetizer do not support multi func unit
-  // occupation, while for Tile, one instruction which issued
-  // at X1 slot actually occupy physical pipe1 and pipe2.
-  //
-  // In TileSchedule.td, we pretend X1 only occupy pipe1 to make
-  // the DFA machine happy, we do a second check here to make sure
-  // the instruction is correctly bundled.
+  // packet in either X or Y mode. See TileInstrInfo::canBundleInXYMode.
   bool isLegalToTileGXXYMode(MachineInstr *MI);
 
   // Is it legal to prune dependece between SUI and SUJ.
@@ -84,12 +187,9 @@ private:
   // Return true if the instruction is a direct jump.
   bool isDirectJump(const MachineInstr *MI) const;
 
-  // Return TileType of MI.
-  TileIssueType TileIssueTypeOf(const MachineInstr *MI) const;
-
-  bool isPipe2Conflict(const MachineInstr *MI) const;
-  bool isPipe2Conflict(const MachineInstr *MI0, const MachineInstr *MI1,
-                       const MachineInstr *MI) const;
+  // Return true if SU would hold up the current packet waiting for the
+  // result of a recent packet.
+  bool wouldStallPacket(SUnit *SU);
 };
 }
 
@@ -98,7 +198,11 @@ TileVLIWPacketizerList::TileVLIWPacketizerList(
     : VLIWPacketizerList(MF, MLI, MDT, true) {}
 
 bool TileVLIWPacketizer::runOnMachineFunction(MachineFunction &Fn) {
-  const TargetInstrInfo *TII = Fn.getTarget().getInstrInfo();
+  const TargetMachine &TM = Fn.getTarget();
+  TII = static_cast<const TileInstrInfo *>(TM.getInstrInfo());
+  TRI = TM.getRegisterInfo();
+  MRI = &Fn.getRegInfo();
+  MBPI = &getAnalysis<MachineBranchProbabilityInfo>();
   MachineLoopInfo &MLI = getAnalysis<MachineLoopInfo>();
   MachineDominatorTree &MDT = getAnalysis<MachineDominatorTree>();
 
@@ -117,9 +221,12 @@ bool TileVLIWPacketizer::runOnMachineFunction(MachineFunction &Fn) {
          RegionEnd != MBBb;) {
       // The next region starts above the previous region. Look backward in the
       // instruction stream until we find the nearest boundary.
+      // Branches and returns end the block, not the region, so they can
+      // share a bundle with the instructions before them.
       MachineBasicBlock::iterator I = RegionEnd;
       for (; I != MBBb; --I) {
-        if (TII->isSchedulingBoundary(llvm::prior(I), MBB, Fn))
+        MachineInstr *Prev = llvm::prior(I);
+        if (!Prev->isTerminator() && TII->isSchedulingBoundary(Prev, MBB, Fn))
           break;
       }
 
@@ -135,6 +242,229 @@ bool TileVLIWPacketizer::runOnMachineFunction(MachineFunction &Fn) {
     }
   }
 
+  if (!DisableTileGXBranchBundleFill) {
+    ResourceModel =
+        new TileResourceModel(TM, TM.getSubtargetImpl()->getSchedModel()
+                                      ->IssueWidth);
+    for (MachineFunction::iterator MBB = Fn.begin(), MBBe = Fn.end();
+         MBB != MBBe; ++MBB)
+      fillBranchBundle(*MBB);
+    delete ResourceModel;
+  }
+
+  unbundleFarBranches(Fn);
+
+  return true;
+}
+
+// A solo conditional branch out of range is relaxed by the assembler into
+// the inverted branch over a j. A bundle is one word and can not be split
+// there, so a bundled branch has to be known to reach its target. Every
+// instruction is counted as a bundle of its own, which bounds the distance
+// from above however the instructions end up packed.
+bool TileVLIWPacketizer::unbundleFarBranches(MachineFunction &Fn) {
+  const MachineJumpTableInfo *MJTI = Fn.getJumpTableInfo();
+
+  // Bound the offset of every block and bundled conditional branch.
+  DenseMap<const MachineBasicBlock *, uint64_t> BlockOffsets;
+  SmallVector<std::pair<MachineInstr *, uint64_t>, 16> Branches;
+  uint64_t Offset = 0;
+  for (MachineFunction::iterator MBB = Fn.begin(), MBBe = Fn.end();
+       MBB != MBBe; ++MBB) {
+    Offset += (1ULL << MBB->getAlignment()) - 1;
+    BlockOffsets[MBB] = Offset;
+    for (MachineBasicBlock::instr_iterator I = MBB->instr_begin(),
+                                           E = MBB->instr_end();
+         I != E; ++I) {
+      if (I->isInsideBundle() &&
+          I->isConditionalBranch(MachineInstr::IgnoreBundle))
+        Branches.push_back(std::make_pair(&*I, Offset));
+      Offset += getMaxInstrBytes(I, MJTI);
+    }
+  }
+  if (Offset < MaxBranchBytes)
+    return false;
+
+  bool Changed = false;
+  for (unsigned i = 0, e = Branches.size(); i != e; ++i) {
+    MachineInstr *Br = Branches[i].first;
+    uint64_t BrOffset = Branches[i].second;
+    MachineBasicBlock *Dest = 0;
+    for (unsigned j = 0, je = Br->getNumOperands(); j != je && !Dest; ++j)
+      if (Br->getOperand(j).isMBB())
+        Dest = Br->getOperand(j).getMBB();
+    assert(Dest && "Conditional branch without a target block!");
+
+    uint64_t DestOffset = BlockOffsets[Dest];
+    uint64_t Distance = DestOffset > BrOffset ? DestOffset - BrOffset
+                                              : BrOffset - DestOffset;
+    if (Distance < MaxBranchBytes)
+      continue;
+
+    DEBUG(dbgs() << "Unbundling far branch in BB#"
+                 << Br->getParent()->getNumber() << ": " << *Br);
+
+    // The branch is the last instruction of its bundle and reads nothing
+    // the rest of the bundle writes, so it can issue after it.
+    MachineBasicBlock &MBB = *Br->getParent();
+    SmallVector<MachineInstr *, 4> Packet;
+    getPacket(Br, Packet);
+    assert(Packet.back() == Br && "Branch is not last in its bundle!");
+    unbundlePacket(MBB, Packet);
+    Packet.pop_back();
+    if (Packet.size() > 1)
+      finalizeBundle(MBB, Packet.front(),
+                     MachineBasicBlock::instr_iterator(Br));
+
+    ++NumFarBranches;
+    Changed = true;
+  }
+  return Changed;
+}
+
+// Short blocks leave the bundle of their conditional branch mostly empty.
+// The instructions at the top of the successor the branch most likely goes
+// to can issue in that bundle instead. On the other path they compute a
+// register nobody reads, in a slot that was empty anyway.
+bool TileVLIWPacketizer::fillBranchBundle(MachineBasicBlock &MBB) {
+  if (MBB.succ_size() != 2)
+    return false;
+
+  // Find the conditional branch, possibly followed by an unconditional one.
+  MachineBasicBlock::instr_iterator Br = MBB.instr_end();
+  while (Br != MBB.instr_begin()) {
+    --Br;
+    if (Br->isDebugValue() || Br->getOpcode() == Tile::J)
+      continue;
+    break;
+  }
+  if (Br == MBB.instr_end() || !Br->isConditionalBranch())
+    return false;
+
+  MachineBasicBlock *Likely = *MBB.succ_begin();
+  MachineBasicBlock *Other = *llvm::next(MBB.succ_begin());
+  if (MBPI->getEdgeWeight(&MBB, Other) > MBPI->getEdgeWeight(&MBB, Likely))
+    std::swap(Likely, Other);
+
+  // The instructions moved out of Likely must not be missed on another path
+  // into it.
+  if (Likely == &MBB || Likely->pred_size() != 1 || Likely->isLandingPad())
+    return false;
+
+  bool Changed = false;
+  for (;;) {
+    SmallVector<MachineInstr *, 4> Bundle;
+    getPacket(Br, Bundle);
+
+    // The candidates are the instructions issued first in Likely.
+    MachineBasicBlock::instr_iterator Top = Likely->instr_begin();
+    while (Top != Likely->instr_end() && Top->isDebugValue())
+      ++Top;
+    if (Top == Likely->instr_end())
+      break;
+    SmallVector<MachineInstr *, 4> TopPacket;
+    getPacket(Top, TopPacket);
+
+    ResourceModel->reset();
+    for (unsigned i = 0, e = Bundle.size(); i != e; ++i)
+      if (!Bundle[i]->isDebugValue())
+        ResourceModel->reserveResources(Bundle[i]);
+
+    MachineInstr *MI = 0;
+    for (unsigned i = 0, e = TopPacket.size(); i != e && !MI; ++i) {
+      MachineInstr *Cand = TopPacket[i];
+      if (Cand->isDebugValue() ||
+          !canSpeculateIntoBundle(Cand, Bundle, TopPacket, Other) ||
+          !ResourceModel->isResourceAvailable(Cand))
+        continue;
+      MI = Cand;
+    }
+    if (!MI)
+      break;
+
+    DEBUG(dbgs() << "Speculating into BB#" << MBB.getNumber()
+                 << " branch bundle: " << *MI);
+
+    // Take MI out of its packet and rebuild both packets.
+    unbundlePacket(*Likely, TopPacket);
+    unbundlePacket(MBB, Bundle);
+    Likely->remove(MI);
+    MBB.insert(Br, MI);
+
+    MachineBasicBlock::instr_iterator First = Bundle.front();
+    if (First == Br)
+      First = MI;
+    finalizeBundle(MBB, First, llvm::next(MachineBasicBlock::instr_iterator(
+                                   Bundle.back())));
+    TopPacket.erase(std::find(TopPacket.begin(), TopPacket.end(), MI));
+    if (TopPacket.size() > 1)
+      finalizeBundle(*Likely, TopPacket.front(),
+                     llvm::next(MachineBasicBlock::instr_iterator(
+                         TopPacket.back())));
+
+    // The value now flows in from MBB, and a use killed in Likely may
+    // still be live on the way to Other.
+    for (unsigned i = 0, e = MI->getNumOperands(); i != e; ++i) {
+      MachineOperand &MO = MI->getOperand(i);
+      if (!MO.isReg() || !MO.getReg())
+        continue;
+      if (MO.isDef()) {
+        if (!MO.isDead() && !Likely->isLiveIn(MO.getReg()))
+          Likely->addLiveIn(MO.getReg());
+      } else
+        MO.setIsKill(false);
+    }
+
+    ++NumSpeculated;
+    Changed = true;
+  }
+  return Changed;
+}
+
+bool TileVLIWPacketizer::canSpeculateIntoBundle(
+    MachineInstr *MI, ArrayRef<MachineInstr *> Bundle,
+    ArrayRef<MachineInstr *> Packet, MachineBasicBlock *Other) const {
+  if (MI->isTerminator() || MI->isCall() || MI->mayLoad() || MI->mayStore() ||
+      MI->hasUnmodeledSideEffects() || MI->isInlineAsm() ||
+      MI->isTransient() || ResourceModel->isFree(MI) ||
+      ((MI->getDesc().TSFlags >> SoloPos) & SoloMask))
+    return false;
+
+  for (unsigned i = 0, e = MI->getNumOperands(); i != e; ++i) {
+    const MachineOperand &MO = MI->getOperand(i);
+    if (MO.isRegMask())
+      return false;
+    if (!MO.isReg() || !MO.getReg())
+      continue;
+    unsigned Reg = MO.getReg();
+
+    // Network registers are queues, reading one consumes a word.
+    for (unsigned j = 0; j != array_lengthof(NetworkRegs); ++j)
+      if (TRI->regsOverlap(Reg, NetworkRegs[j]))
+        return false;
+
+    if (MO.isDef()) {
+      if (MRI->isReserved(Reg))
+        return false;
+      // The other path must not see the new value.
+      for (MCRegAliasIterator AI(Reg, TRI, true); AI.isValid(); ++AI)
+        if (Other->isLiveIn(*AI))
+          return false;
+    }
+
+    // A bundle reads its operands before any of its results are written, so
+    // MI can neither read what the bundle computes nor change what the
+    // bundle reads.
+    for (unsigned j = 0, je = Bundle.size(); j != je; ++j)
+      if (accessesRegister(Bundle[j], Reg, !MO.isDef(), TRI))
+        return false;
+
+    // Likewise the rest of its own packet must keep reading the old value.
+    if (MO.isDef())
+      for (unsigned j = 0, je = Packet.size(); j != je; ++j)
+        if (Packet[j] != MI && accessesRegister(Packet[j], Reg, false, TRI))
+          return false;
+  }
   return true;
 }
 
@@ -168,24 +498,10 @@ bool TileVLIWPacketizerList::isSoloInstruction(MachineInstr *MI) {
 }
 
 bool TileVLIWPacketizerList::isLegalToTileGXXYMode(MachineInstr *MI) {
-  MachineInstr *MI0, *MI1;
-  TileIssueType T = TileIssueTypeOf(MI);
-
-  switch (CurrentPacketMIs.size()) {
-  case 0:
-    llvm_unreachable("isLegalToTileGXXYMode shouldn't reach here!");
-  case 1:
-    if (!(T == IT_X1Y2 || T == IT_X1))
-      return true;
-    MI0 = CurrentPacketMIs[0];
-    return !isPipe2Conflict(MI0);
-  case 2:
-    MI0 = CurrentPacketMIs[0];
-    MI1 = CurrentPacketMIs[1];
-    return !isPipe2Conflict(MI0, MI1, MI);
-  default:
-    llvm_unreachable("3 pipelines can't execute more than 3 instructions!");
-  }
+  assert(!CurrentPacketMIs.empty() && CurrentPacketMIs.size() < 3 &&
+         "3 pipelines can't execute more than 3 instructions!");
+  return static_cast<const TileInstrInfo *>(TII)
+      ->canBundleInXYMode(CurrentPacketMIs, MI);
 }
 
 // SUI is the current instruction that is out side of the current packet.
@@ -202,6 +518,9 @@ bool TileVLIWPacketizerList::isLegalToPacketizeTogether(SUnit *SUI,
   if (!isLegalToTileGXXYMode(I))
     return false;
 
+  if (wouldStallPacket(SUI))
+    return false;
+
   const MCInstrDesc &MCIDI = I->getDesc();
   const MCInstrDesc &MCIDJ = J->getDesc();
 
@@ -265,37 +584,35 @@ bool TileVLIWPacketizerList::isDirectJump(const MachineInstr *MI) const {
   return (MI->getOpcode() == Tile::J);
 }
 
-TileIssueType
-TileVLIWPacketizerList::TileIssueTypeOf(const MachineInstr *MI) const {
-  const uint64_t F = MI->getDesc().TSFlags;
-  return (TileIssueType)((F >> IssueTypePos) & IssueTypeMask);
-}
-
-bool TileVLIWPacketizerList::isPipe2Conflict(const MachineInstr *MI) const {
-  TileIssueType T = TileIssueTypeOf(MI);
-  return T == IT_X1 || T == IT_X1Y2;
-}
-
-bool TileVLIWPacketizerList::isPipe2Conflict(const MachineInstr *MI0,
-                                             const MachineInstr *MI1,
-                                             const MachineInstr *MI) const {
-  TileIssueType T = TileIssueTypeOf(MI);
-  TileIssueType T0 = TileIssueTypeOf(MI0);
-  TileIssueType T1 = TileIssueTypeOf(MI1);
-  unsigned count = 0;
-  if (T == IT_X0X1Y0Y1)
-    count++;
-  else if (T == IT_X1 || T == IT_X0)
-    return true;
-  if (T0 == IT_X0X1Y0Y1)
-    count++;
-  else if (T0 == IT_X1 || T0 == IT_X0)
-    return true;
-  if (T1 == IT_X0X1Y0Y1)
-    count++;
-  else if (T1 == IT_X1 || T1 == IT_X0)
-    return true;
-  return count != 2;
+// A bundle issues as a whole, so an instruction still waiting for a load or
+// multiply stalls the instructions bundled with it. The post-RA scheduler
+// placed it a cycle or more later for that reason; start a new packet for it
+// instead of delaying the current one.
+bool TileVLIWPacketizerList::wouldStallPacket(SUnit *SU) {
+  MachineBasicBlock::iterator Begin = CurrentPacketMIs.front();
+  MachineBasicBlock *MBB = Begin->getParent();
+
+  for (SUnit::const_pred_iterator P = SU->Preds.begin(), E = SU->Preds.end();
+       P != E; ++P) {
+    if (P->getKind() != SDep::Data || P->getLatency() <= 1)
+      continue;
+    MachineInstr *Def = P->getSUnit()->getInstr();
+    if (!Def)
+      continue;
+    MachineInstr *DefBundle = getBundleStart(Def);
+
+    // Count the packets issued since the def.
+    unsigned Distance = 1;
+    for (MachineBasicBlock::iterator I = Begin;
+         I != MBB->begin() && Distance < P->getLatency();) {
+      --I;
+      if (&*I == DefBundle)
+        return true;
+      if (I->isBundle() || !ignorePseudoInstruction(I, MBB))
+        ++Distance;
+    }
+  }
+  return false;
 }
 
 //===----------------------------------------------------------------------===//
@@ -0,0 +1,325 @@
+//===-- TileWriteHint.cpp - Insert wh64 for fully overwritten lines -------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This pass finds innermost loops which store to every byte of a contiguous
+// region and, in the loop preheader, issues a wh64 for each 64 byte cache
+// line that lies entirely in the region. wh64 allocates the line without
+// fetching it, which saves the read-for-ownership traffic on the mesh for
+// lines that are about to be clobbered anyway. The hints run in a loop of
+// their own ahead of the store loop, whose body is left untouched.
+//
+// The line contents are undefined after wh64, so the loop must not read the
+// region and must run to completion once entered: loops with calls or
+// early exits are left alone.
+//
+//===----------------------------------------------------------------------===//
+
+#define DEBUG_TYPE "tile-wh64"
+#include "Tile.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/Analysis/AliasAnalysis.h"
+#include "llvm/Analysis/Dominators.h"
+#include "llvm/Analysis/LoopInfo.h"
+#include "llvm/Analysis/ScalarEvolution.h"
+#include "llvm/Analysis/ScalarEvolutionExpander.h"
+#include "llvm/Analysis/ScalarEvolutionExpressions.h"
+#include "llvm/IR/DataLayout.h"
+#include "llvm/IR/IRBuilder.h"
+#include "llvm/IR/IntrinsicInst.h"
+#include "llvm/IR/Intrinsics.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Pass.h"
+#include "llvm/Support/Debug.h"
+using namespace llvm;
+
+STATISTIC(NumWriteHints, "Number of store streams given a wh64");
+
+// TILE-Gx L1/L2 cache line size.
+static const int64_t LineSize = 64;
+
+// Lines hinted much further ahead than the store loop will get to soon are
+// evicted again before they are written. Hint at most a quarter of the
+// 256KB L2.
+static const int64_t MaxHintLines = 1024;
+
+namespace {
+// The stores of one iteration which together write Step contiguous bytes.
+struct WriteStream {
+  Loop *L;
+  BasicBlock *BB;
+  int64_t Step;
+  // Address SCEV the offsets below are relative to.
+  const SCEV *Base;
+  SmallVector<std::pair<StoreInst *, int64_t>, 4> Stores;
+
+  // Filled in once the stream is known to cover its chunk: the region the
+  // loop writes is [Base, End).
+  const SCEV *End;
+  Value *BaseV;
+  Value *EndV;
+};
+
+class TileWriteHint : public FunctionPass {
+  LoopInfo *LI;
+  ScalarEvolution *SE;
+  AliasAnalysis *AA;
+  DominatorTree *DT;
+  const DataLayout *TD;
+
+public:
+  static char ID;
+  TileWriteHint() : FunctionPass(ID) {}
+
+  virtual const char *getPassName() const {
+    return "Tile wh64 Insertion";
+  }
+
+  virtual void getAnalysisUsage(AnalysisUsage &AU) const {
+    AU.addRequired<LoopInfo>();
+    AU.addRequired<ScalarEvolution>();
+    AU.addRequired<AliasAnalysis>();
+    AU.addRequired<DominatorTree>();
+  }
+
+  virtual bool runOnFunction(Function &F);
+
+private:
+  void collectStreams(Loop *L, SmallVectorImpl<WriteStream> &Streams);
+  bool coversChunk(WriteStream &S);
+  void insertWriteHints(WriteStream &S);
+};
+char TileWriteHint::ID = 0;
+} // end of anonymous namespace
+
+bool TileWriteHint::runOnFunction(Function &F) {
+  LI = &getAnalysis<LoopInfo>();
+  SE = &getAnalysis<ScalarEvolution>();
+  AA = &getAnalysis<AliasAnalysis>();
+  DT = &getAnalysis<DominatorTree>();
+  TD = getAnalysisIfAvailable<DataLayout>();
+  if (!TD)
+    return false;
+
+  SmallVector<Loop *, 8> Worklist(LI->begin(), LI->end());
+  SmallVector<WriteStream, 4> Streams;
+  while (!Worklist.empty()) {
+    Loop *L = Worklist.pop_back_val();
+    Worklist.append(L->begin(), L->end());
+    collectStreams(L, Streams);
+  }
+
+  if (Streams.empty())
+    return false;
+
+  // Expand the region bounds while the loop analyses are still valid,
+  // then add the hint loops.
+  SCEVExpander Expander(*SE, "wh64");
+  Type *IntPtrTy = TD->getIntPtrType(F.getContext());
+  for (unsigned i = 0, e = Streams.size(); i != e; ++i) {
+    WriteStream &S = Streams[i];
+    Instruction *IP = S.L->getLoopPreheader()->getTerminator();
+    S.BaseV = Expander.expandCodeFor(S.Base, IntPtrTy, IP);
+    S.EndV = Expander.expandCodeFor(S.End, IntPtrTy, IP);
+  }
+
+  for (unsigned i = 0, e = Streams.size(); i != e; ++i)
+    insertWriteHints(Streams[i]);
+
+  NumWriteHints += Streams.size();
+  return true;
+}
+
+void TileWriteHint::collectStreams(Loop *L,
+                                   SmallVectorImpl<WriteStream> &Streams) {
+  if (!L->empty())
+    return;
+
+  BasicBlock *Preheader = L->getLoopPreheader();
+  BasicBlock *Latch = L->getLoopLatch();
+  if (!Preheader || !Latch || L->getExitingBlock() != Latch)
+    return;
+
+  const SCEV *BTC = SE->getBackedgeTakenCount(L);
+  if (isa<SCEVCouldNotCompute>(BTC))
+    return;
+
+  SmallVector<StoreInst *, 8> Stores;
+  SmallVector<LoadInst *, 8> Loads;
+  for (Loop::block_iterator BI = L->block_begin(), BE = L->block_end();
+       BI != BE; ++BI) {
+    for (BasicBlock::iterator I = (*BI)->begin(), E = (*BI)->end(); I != E;
+         ++I) {
+      if (isa<DbgInfoIntrinsic>(I))
+        continue;
+      // A call may read the region or never come back.
+      if (isa<CallInst>(I) || isa<InvokeInst>(I))
+        return;
+      if (StoreInst *SI = dyn_cast<StoreInst>(I)) {
+        if (!SI->isSimple())
+          return;
+        Stores.push_back(SI);
+      } else if (I->mayReadFromMemory()) {
+        LoadInst *LD = dyn_cast<LoadInst>(I);
+        if (!LD || !LD->isSimple())
+          return;
+        Loads.push_back(LD);
+      }
+    }
+  }
+
+  // Group the stores executed on every iteration by stride and base.
+  SmallVector<WriteStream, 4> Candidates;
+  for (unsigned i = 0, e = Stores.size(); i != e; ++i) {
+    StoreInst *SI = Stores[i];
+    if (!DT->dominates(SI->getParent(), Latch))
+      continue;
+
+    const SCEVAddRecExpr *AR =
+        dyn_cast<SCEVAddRecExpr>(SE->getSCEV(SI->getPointerOperand()));
+    if (!AR || AR->getLoop() != L || !AR->isAffine())
+      continue;
+    const SCEVConstant *StepC =
+        dyn_cast<SCEVConstant>(AR->getStepRecurrence(*SE));
+    if (!StepC)
+      continue;
+    int64_t Step = StepC->getValue()->getSExtValue();
+    if (Step <= 0 || Step > LineSize)
+      continue;
+
+    bool Found = false;
+    for (unsigned j = 0, je = Candidates.size(); j != je && !Found; ++j) {
+      WriteStream &S = Candidates[j];
+      if (S.Step != Step || S.BB != SI->getParent())
+        continue;
+      const SCEVConstant *Diff =
+          dyn_cast<SCEVConstant>(SE->getMinusSCEV(AR->getStart(), S.Base));
+      if (!Diff)
+        continue;
+      S.Stores.push_back(std::make_pair(SI, Diff->getValue()->getSExtValue()));
+      Found = true;
+    }
+
+    if (!Found) {
+      WriteStream S;
+      S.L = L;
+      S.BB = SI->getParent();
+      S.Step = Step;
+      S.Base = AR->getStart();
+      S.Stores.push_back(std::make_pair(SI, 0));
+      Candidates.push_back(S);
+    }
+  }
+
+  Type *IntPtrTy = TD->getIntPtrType(L->getHeader()->getContext());
+  const SCEV *TripCount = SE->getAddExpr(SE->getNoopOrZeroExtend(BTC, IntPtrTy),
+                                         SE->getConstant(IntPtrTy, 1));
+
+  for (unsigned i = 0, e = Candidates.size(); i != e; ++i) {
+    WriteStream &S = Candidates[i];
+
+    // A loop that writes fewer than two lines rarely owns a whole one.
+    if (const SCEVConstant *TC = dyn_cast<SCEVConstant>(TripCount))
+      if (TC->getValue()->getZExtValue() * S.Step < 2 * LineSize)
+        continue;
+
+    if (!coversChunk(S))
+      continue;
+
+    // Nothing in the loop may read the stream, the not yet written part
+    // of a hinted line is garbage.
+    bool MayRead = false;
+    for (unsigned j = 0, je = Loads.size(); j != je && !MayRead; ++j)
+      for (unsigned k = 0, ke = S.Stores.size(); k != ke && !MayRead; ++k)
+        MayRead = AA->alias(
+            AliasAnalysis::Location(Loads[j]->getPointerOperand()),
+            AliasAnalysis::Location(S.Stores[k].first->getPointerOperand())) !=
+            AliasAnalysis::NoAlias;
+    if (MayRead)
+      continue;
+
+    const SCEV *Bytes =
+        SE->getMulExpr(TripCount, SE->getConstant(IntPtrTy, S.Step));
+    S.End = SE->getAddExpr(S.Base, Bytes);
+    Streams.push_back(S);
+  }
+}
+
+// Check that the stores of S write every byte of one Step sized chunk and
+// nothing outside of it. On success rebase S on the start of the chunk.
+bool TileWriteHint::coversChunk(WriteStream &S) {
+  int64_t MinOff = S.Stores[0].second;
+  for (unsigned i = 1, e = S.Stores.size(); i != e; ++i)
+    MinOff = std::min(MinOff, S.Stores[i].second);
+
+  SmallVector<bool, 64> Covered(S.Step, false);
+  for (unsigned i = 0, e = S.Stores.size(); i != e; ++i) {
+    StoreInst *SI = S.Stores[i].first;
+    int64_t Off = S.Stores[i].second - MinOff;
+    int64_t Size = TD->getTypeStoreSize(SI->getValueOperand()->getType());
+    if (Off + Size > S.Step)
+      return false;
+    for (int64_t b = Off; b != Off + Size; ++b)
+      Covered[b] = true;
+  }
+  for (int64_t b = 0; b != S.Step; ++b)
+    if (!Covered[b])
+      return false;
+
+  Type *IntPtrTy = TD->getIntPtrType(S.BB->getContext());
+  S.Base = SE->getAddExpr(S.Base, SE->getConstant(IntPtrTy, MinOff));
+  return true;
+}
+
+// At the end of the preheader, hint the lines the loop writes in full:
+//
+//   Line = (Base + 63) & -64
+//   Limit = umin(End & -64, Line + MaxHintLines * 64)
+//   for (; Line < Limit; Line += 64)
+//     wh64 Line
+//
+// The loop is entered, so it runs to completion and overwrites every one of
+// these lines before anything reads them.
+void TileWriteHint::insertWriteHints(WriteStream &S) {
+  BasicBlock *Preheader = S.L->getLoopPreheader();
+  LLVMContext &Ctx = Preheader->getContext();
+  Type *IntPtrTy = TD->getIntPtrType(Ctx);
+  IRBuilder<> B(Preheader->getTerminator());
+
+  Value *First = B.CreateAnd(
+      B.CreateAdd(S.BaseV, ConstantInt::get(IntPtrTy, LineSize - 1)),
+      ConstantInt::get(IntPtrTy, -LineSize));
+  Value *End = B.CreateAnd(S.EndV, ConstantInt::get(IntPtrTy, -LineSize));
+  Value *Cap =
+      B.CreateAdd(First, ConstantInt::get(IntPtrTy, MaxHintLines * LineSize));
+  Value *Limit = B.CreateSelect(B.CreateICmpULT(End, Cap), End, Cap);
+  Value *Any = B.CreateICmpULT(First, Limit);
+
+  // Preheader -> HintLoop -> Tail -> loop header, with Tail the new
+  // preheader.
+  BasicBlock *Tail = Preheader->splitBasicBlock(Preheader->getTerminator(),
+                                                Preheader->getName() + ".wh64");
+  BasicBlock *HintLoop = BasicBlock::Create(Ctx, "wh64.loop",
+                                            Preheader->getParent(), Tail);
+  Preheader->getTerminator()->eraseFromParent();
+  BranchInst::Create(HintLoop, Tail, Any, Preheader);
+
+  IRBuilder<> LB(HintLoop);
+  PHINode *Line = LB.CreatePHI(IntPtrTy, 2);
+  Module *M = Preheader->getParent()->getParent();
+  Function *WH64 = Intrinsic::getDeclaration(M, Intrinsic::tilegx_wh64);
+  LB.CreateCall(WH64, LB.CreateIntToPtr(Line, LB.getInt8PtrTy()));
+  Value *Next = LB.CreateAdd(Line, ConstantInt::get(IntPtrTy, LineSize));
+  LB.CreateCondBr(LB.CreateICmpULT(Next, Limit), HintLoop, Tail);
+  Line->addIncoming(First, Preheader);
+  Line->addIncoming(Next, HintLoop);
+}
+
+FunctionPass *llvm::createTileWriteHintPass() {
+  return new TileWriteHint();
+}
@@ -0,0 +1,60 @@
+; RUN: opt < %s -cost-model -analyze -mtriple=tilegx-unknown-linux-gnu | FileCheck %s
+target triple = "tilegx-unknown-linux-gnu"
+
+define void @simd(<8 x i8> %a, <4 x i16> %b, <2 x i32> %c) {
+  ; CHECK: cost of 1 {{.*}} add <8 x i8>
+  %1 = add <8 x i8> %a, %a
+  ; CHECK: cost of 1 {{.*}} mul <4 x i16>
+  %2 = mul <4 x i16> %b, %b
+  ; There is no 4 byte lane multiply.
+  ; CHECK: cost of 10 {{.*}} mul <2 x i32>
+  %3 = mul <2 x i32> %c, %c
+  ; CHECK: cost of 1 {{.*}} shl <8 x i8>
+  %4 = shl <8 x i8> %a, <i8 1, i8 1, i8 1, i8 1, i8 1, i8 1, i8 1, i8 1>
+  ; CHECK: cost of 1 {{.*}} icmp slt <4 x i16>
+  %5 = icmp slt <4 x i16> %b, %b
+  ; CHECK: cost of 3 {{.*}} select <4 x i1>
+  %6 = select <4 x i1> %5, <4 x i16> %b, <4 x i16> %b
+  ; CHECK: cost of 2 {{.*}} extractelement <2 x i32>
+  %7 = extractelement <2 x i32> %c, i32 1
+  ; CHECK: cost of 1 {{.*}} insertelement <8 x i8>
+  %8 = insertelement <8 x i8> %a, i8 0, i32 3
+  ret void
+}
+
+define void @scalar(i64 %a, i32 %b, float %f, double %d) {
+  ; CHECK: cost of 4 {{.*}} mul i64
+  %1 = mul i64 %a, %a
+  ; i64 division is a call into libgcc, i32 division an inline loop.
+  ; CHECK: cost of 40 {{.*}} sdiv i64
+  %2 = sdiv i64 %a, %a
+  ; CHECK: cost of 20 {{.*}} urem i32
+  %3 = urem i32 %b, %b
+  ; CHECK: cost of 4 {{.*}} fadd float
+  %4 = fadd float %f, %f
+  ; CHECK: cost of 15 {{.*}} fmul double
+  %5 = fmul double %d, %d
+  ; CHECK: cost of 40 {{.*}} fdiv float
+  %6 = fdiv float %f, %f
+  ; CHECK: cost of 60 {{.*}} fdiv double
+  %7 = fdiv double %d, %d
+  ; CHECK: cost of 60 {{.*}} @llvm.sqrt.f64
+  %8 = call double @llvm.sqrt.f64(double %d)
+  ; CHECK: cost of 6 {{.*}} fcmp olt double
+  %9 = fcmp olt double %d, %d
+  ret void
+}
+
+define void @casts(i64 %a, float %f, <8 x i8> %v, <4 x i32> %w) {
+  ; CHECK: cost of 8 {{.*}} sitofp i64
+  %1 = sitofp i64 %a to double
+  ; CHECK: cost of 8 {{.*}} fpext float
+  %2 = fpext float %f to double
+  ; CHECK: cost of 32 {{.*}} zext <8 x i8>
+  %3 = zext <8 x i8> %v to <8 x i16>
+  ; CHECK: cost of 14 {{.*}} trunc <4 x i32>
+  %4 = trunc <4 x i32> %w to <4 x i16>
+  ret void
+}
+
+declare double @llvm.sqrt.f64(double)
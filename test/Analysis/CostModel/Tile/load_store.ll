@@ -0,0 +1,19 @@
+; RUN: opt < %s -cost-model -analyze -mtriple=tilegx-unknown-linux-gnu | FileCheck %s
+target triple = "tilegx-unknown-linux-gnu"
+
+; Unaligned accesses are split into aligned pieces.
+define void @unaligned(i64* %p, i32* %q, <8 x i8>* %v) {
+  ; CHECK: cost of 1 {{.*}} load i64* %p, align 8
+  %1 = load i64* %p, align 8
+  ; CHECK: cost of 5 {{.*}} load i64* %p, align 4
+  %2 = load i64* %p, align 4
+  ; CHECK: cost of 28 {{.*}} load <8 x i8>* %v, align 1
+  %3 = load <8 x i8>* %v, align 1
+  ; CHECK: cost of 13 {{.*}} load i32* %q, align 1
+  %4 = load i32* %q, align 1
+  ; CHECK: cost of 1 {{.*}} store i32 0, i32* %q, align 4
+  store i32 0, i32* %q, align 4
+  ; CHECK: cost of 10 {{.*}} store i64 0, i64* %p, align 2
+  store i64 0, i64* %p, align 2
+  ret void
+}
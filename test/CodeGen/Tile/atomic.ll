@@ -1,5 +1,7 @@
 ; RUN: llc -march=tilegx < %s | FileCheck %s
 
+declare i64 @llvm.tilegx.fetchaddgez(i8*, i64)
+
 define i32 @exchange_and_add32(i32* %mem, i32 %val) nounwind {
 ; CHECK: exchange_and_add32:
 
@@ -39,7 +41,8 @@ entry:
   store atomic i32 %val, i32* %mem release, align 64
   ret void
 
-; CHECK: exch4
+; CHECK: mf
+; CHECK-NEXT: st4 r0, r1
 }
 
 define i32 @atomic_load32(i32* %mem) nounwind {
@@ -49,8 +52,9 @@ entry:
   %tmp = load atomic i32* %mem acquire, align 64
   ret i32 %tmp
 
-; CHECK: mtspr CMPEXCH_VALUE
-; CHECK: cmpexch4
+; CHECK-NOT: cmpexch4
+; CHECK: ld4s r0, r0
+; CHECK-NEXT: mf
 }
 
 define i64 @exchange_and_add(i64* %mem, i64 %val) nounwind {
@@ -92,7 +96,8 @@ entry:
   store atomic i64 %val, i64* %mem release, align 64
   ret void
 
-; CHECK: exch
+; CHECK: mf
+; CHECK-NEXT: st r0, r1
 }
 
 define i64 @atomic_load(i64* %mem) nounwind {
@@ -102,6 +107,133 @@ entry:
   %tmp = load atomic i64* %mem acquire, align 64
   ret i64 %tmp
 
+; CHECK-NOT: cmpexch
+; CHECK: ld r0, r0
+; CHECK-NEXT: mf
+}
+
+define i64 @cas(i64* %p, i64 %o, i64 %n) {
+; CHECK: cas:
+entry:
+  %r = cmpxchg i64* %p, i64 %o, i64 %n monotonic
+  ret i64 %r
+
+; CHECK-NOT: mf
+; CHECK: mtspr CMPEXCH_VALUE, r1
+; CHECK: cmpexch r0, r0, r2
+; CHECK-NOT: mf
+; CHECK: jr
+}
+
+define i32 @cas4(i32* %p, i32 %o, i32 %n) {
+; CHECK: cas4:
+entry:
+  %r = cmpxchg i32* %p, i32 %o, i32 %n seq_cst
+  ret i32 %r
+
+; CHECK: mf
+; CHECK: mtspr CMPEXCH_VALUE, r1
+; CHECK: cmpexch4 r0, r0, r2
+; CHECK: mf
+}
+
+define i64 @sub(i64* %p, i64 %v) {
+; CHECK: sub:
+entry:
+  %r = atomicrmw sub i64* %p, i64 %v monotonic
+  ret i64 %r
+
+; CHECK: sub [[NEG:r[0-9]+]], zero, r1
+; CHECK: fetchadd r0, r0, [[NEG]]
+}
+
+; Back to back sequentially consistent operations share the fence
+; between them.
+define i64 @seqcst(i64* %p, i64 %v) {
+; CHECK: seqcst:
+entry:
+  %a = atomicrmw add i64* %p, i64 %v seq_cst
+  %b = atomicrmw or i64* %p, i64 %a seq_cst
+  ret i64 %b
+
+; CHECK: mf
+; CHECK: fetchadd
+; CHECK: mf
+; CHECK-NOT: mf
+; CHECK: fetchor
+; CHECK: mf
+; CHECK-NOT: mf
+; CHECK: jr
+}
+
+define void @compiler_barrier() {
+; CHECK: compiler_barrier:
+entry:
+  fence singlethread seq_cst
+  ret void
+
+; CHECK-NOT: mf
+; CHECK: jr
+}
+
+; A singlethread fence does not cover a cross-thread fence behind it.
+define void @singlethread_then_crossthread() {
+; CHECK: singlethread_then_crossthread:
+entry:
+  fence singlethread seq_cst
+  fence seq_cst
+  ret void
+
+; CHECK: mf
+; CHECK: jr
+}
+
+define i64 @singlethread_atomic_then_fence(i64* %p, i64 %v) {
+; CHECK: singlethread_atomic_then_fence:
+entry:
+  %a = atomicrmw add i64* %p, i64 %v singlethread seq_cst
+  fence seq_cst
+  ret i64 %a
+
+; CHECK-NOT: mf
+; CHECK: fetchadd
+; CHECK: mf
+; CHECK: jr
+}
+
+define i64 @min(i64* %p, i64 %v) {
+; CHECK: min:
+entry:
+  %r = atomicrmw min i64* %p, i64 %v monotonic
+  ret i64 %r
+
+; CHECK: ld [[INIT:r[0-9]+]], r0
+; CHECK: .LBB{{[0-9_]+}}:
+; CHECK: cmplts
 ; CHECK: mtspr CMPEXCH_VALUE
+; CHECK: cmovnez
 ; CHECK: cmpexch
+; CHECK: bnez
+}
+
+define i32 @umax4(i32* %p, i32 %v) {
+; CHECK: umax4:
+entry:
+  %r = atomicrmw umax i32* %p, i32 %v monotonic
+  ret i32 %r
+
+; CHECK: ld4s
+; CHECK: cmpltu
+; CHECK: cmovnez
+; CHECK: cmpexch4
+; CHECK: bnez
+}
+
+define i64 @gez(i8* %p, i64 %v) {
+; CHECK: gez:
+entry:
+  %r = call i64 @llvm.tilegx.fetchaddgez(i8* %p, i64 %v)
+  ret i64 %r
+
+; CHECK: fetchaddgez r0, r0, r1
 }
@@ -0,0 +1,68 @@
+; RUN: llc -march=tilegx < %s | FileCheck %s
+
+; The first instruction of the likely successor issues with the branch. The
+; other path does not read r1.
+define i64 @f1(i64 %a, i64 %b, i64 %c, i64* %p) nounwind {
+; CHECK: f1:
+; CHECK: cmpne [[COND:r[0-9]+]], r0,
+; CHECK-NEXT: {
+; CHECK-NEXT: xor r1, r1, r2
+; CHECK-NEXT: bnez [[COND]], .LBB0_2
+; CHECK-NEXT: }
+; CHECK: ld
+entry:
+  %cmp = icmp eq i64 %a, 0
+  br i1 %cmp, label %t, label %f, !prof !0
+t:
+  %x = xor i64 %b, %c
+  %y = load i64* %p
+  %z = add i64 %x, %y
+  ret i64 %z
+f:
+  store i64 0, i64* %p
+  ret i64 %a
+}
+
+; The multiply would overwrite the branch condition, and its result is
+; returned on the other path as well; it stays behind the branch.
+define i64 @f2(i64 %a, i64 %b, i64 %c, i64* %p) nounwind {
+; CHECK: f2:
+; CHECK: cmpne [[COND:r[0-9]+]], r0,
+; CHECK-NEXT: bnez [[COND]], .LBB1_2
+; CHECK-NOT: }
+; CHECK: mul_hu_lu
+entry:
+  %cmp = icmp eq i64 %a, 0
+  br i1 %cmp, label %t, label %f, !prof !0
+t:
+  %x = mul i64 %b, %c
+  %y = xor i64 %x, %b
+  ret i64 %y
+f:
+  store i64 %b, i64* %p
+  ret i64 %c
+}
+
+; Unconditional branches share a bundle with the instructions before them.
+declare void @g(i64)
+
+define void @f3(i64 %n, i64 %a) nounwind {
+; CHECK: f3:
+; CHECK: movei r{{[0-9]+}}, 0
+; CHECK-NEXT: j .LBB2_
+; CHECK-NEXT: }
+entry:
+  br label %head
+head:
+  %i = phi i64 [ 0, %entry ], [ %i.next, %body ]
+  %c = icmp eq i64 %i, %n
+  br i1 %c, label %exit, label %body
+body:
+  call void @g(i64 %i)
+  %i.next = add i64 %i, %a
+  br label %head
+exit:
+  ret void
+}
+
+!0 = metadata !{metadata !"branch_weights", i32 100, i32 1}
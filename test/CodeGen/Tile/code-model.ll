@@ -0,0 +1,50 @@
+; RUN: llc -march=tilegx -relocation-model=static -code-model=small < %s | FileCheck %s -check-prefix=SMALL
+; RUN: llc -march=tilegx -relocation-model=static -code-model=medium < %s | FileCheck %s -check-prefix=MEDIUM
+
+@s1 = internal global i32 8, align 4
+@g1 = external global i32
+
+define i32 @foo() nounwind {
+entry:
+  %0 = load i32* @s1, align 4
+  %1 = load i32* @g1, align 4
+  %add = add i32 %0, %1
+  ret i32 %add
+
+; SMALL: foo:
+; SMALL-NOT: hw2_last
+; SMALL: moveli [[REG0:r[0-9]+]], hw1_last(g1)
+; SMALL: moveli [[REG1:r[0-9]+]], hw1_last(s1)
+; SMALL: shl16insli {{r[0-9]+}}, [[REG0]], hw0(g1)
+; SMALL: shl16insli {{r[0-9]+}}, [[REG1]], hw0(s1)
+; SMALL-NOT: lnk
+; SMALL: jr lr
+
+; s1 is local to the module and addressed from the lnk at function entry,
+; g1 may be anywhere and gets the full 48-bit sequence. No gp is set up.
+; MEDIUM: foo:
+; MEDIUM: moveli [[REG0:r[0-9]+]], hw2_last(g1)
+; MEDIUM: moveli [[REG1:r[0-9]+]], hw1_last(s1 - .L0$pb)
+; MEDIUM: lnk [[LP:r50]]
+; MEDIUM: shl16insli {{r[0-9]+}}, [[REG0]], hw1(g1)
+; MEDIUM: shl16insli [[REG2:r[0-9]+]], [[REG1]], hw0(s1 - .L0$pb)
+; MEDIUM: add {{r[0-9]+}}, [[LP]], [[REG2]]
+; MEDIUM-NOT: _GLOBAL_OFFSET_TABLE_
+; MEDIUM: jr lr
+}
+
+define double @cp(double %x) nounwind {
+entry:
+  %r = fadd double %x, 1.5
+  ret double %r
+
+; SMALL: cp:
+; SMALL: moveli [[REG:r[0-9]+]], hw1_last(.LCPI1_0)
+; SMALL: shl16insli {{r[0-9]+}}, [[REG]], hw0(.LCPI1_0)
+
+; MEDIUM: cp:
+; MEDIUM: moveli [[REG:r[0-9]+]], hw1_last(.LCPI1_0 - .L1$pb)
+; MEDIUM: lnk [[LP:r50]]
+; MEDIUM: shl16insli [[REG1:r[0-9]+]], [[REG]], hw0(.LCPI1_0 - .L1$pb)
+; MEDIUM: add {{r[0-9]+}}, [[LP]], [[REG1]]
+}
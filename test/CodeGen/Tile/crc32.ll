@@ -0,0 +1,319 @@
+; RUN: llc -march=tilegx < %s | FileCheck %s
+; RUN: llc -march=tilegx -disable-tilegx-bit-idioms < %s \
+; RUN:   | FileCheck %s -check-prefix=NOIDIOM
+
+; Table driven and bitwise CRC-32 over the reflected 0xEDB88320 polynomial
+; become crc32_8 and crc32_32.
+
+@crc_table = internal unnamed_addr constant [256 x i32] [
+  i32 0, i32 1996959894, i32 -301047508, i32 -1727442502, i32 124634137, i32
+  1886057615, i32 -379345611, i32 -1637575261, i32 249268274, i32 2044508324,
+  i32 -522852066, i32 -1747789432, i32 162941995, i32 2125561021, i32
+  -407360249, i32 -1866523247, i32 498536548, i32 1789927666, i32 -205950648,
+  i32 -2067906082, i32 450548861, i32 1843258603, i32 -187386543, i32
+  -2083289657, i32 325883990, i32 1684777152, i32 -43845254, i32 -1973040660,
+  i32 335633487, i32 1661365465, i32 -99664541, i32 -1928851979, i32
+  997073096, i32 1281953886, i32 -715111964, i32 -1570279054, i32 1006888145,
+  i32 1258607687, i32 -770865667, i32 -1526024853, i32 901097722, i32
+  1119000684, i32 -608450090, i32 -1396901568, i32 853044451, i32 1172266101,
+  i32 -589951537, i32 -1412350631, i32 651767980, i32 1373503546, i32
+  -925412992, i32 -1076862698, i32 565507253, i32 1454621731, i32 -809855591,
+  i32 -1195530993, i32 671266974, i32 1594198024, i32 -972236366, i32
+  -1324619484, i32 795835527, i32 1483230225, i32 -1050600021, i32
+  -1234817731, i32 1994146192, i32 31158534, i32 -1731059524, i32 -271249366,
+  i32 1907459465, i32 112637215, i32 -1614814043, i32 -390540237, i32
+  2013776290, i32 251722036, i32 -1777751922, i32 -519137256, i32 2137656763,
+  i32 141376813, i32 -1855689577, i32 -429695999, i32 1802195444, i32
+  476864866, i32 -2056965928, i32 -228458418, i32 1812370925, i32 453092731,
+  i32 -2113342271, i32 -183516073, i32 1706088902, i32 314042704, i32
+  -1950435094, i32 -54949764, i32 1658658271, i32 366619977, i32 -1932296973,
+  i32 -69972891, i32 1303535960, i32 984961486, i32 -1547960204, i32
+  -725929758, i32 1256170817, i32 1037604311, i32 -1529756563, i32 -740887301,
+  i32 1131014506, i32 879679996, i32 -1385723834, i32 -631195440, i32
+  1141124467, i32 855842277, i32 -1442165665, i32 -586318647, i32 1342533948,
+  i32 654459306, i32 -1106571248, i32 -921952122, i32 1466479909, i32
+  544179635, i32 -1184443383, i32 -832445281, i32 1591671054, i32 702138776,
+  i32 -1328506846, i32 -942167884, i32 1504918807, i32 783551873, i32
+  -1212326853, i32 -1061524307, i32 -306674912, i32 -1698712650, i32 62317068,
+  i32 1957810842, i32 -355121351, i32 -1647151185, i32 81470997, i32
+  1943803523, i32 -480048366, i32 -1805370492, i32 225274430, i32 2053790376,
+  i32 -468791541, i32 -1828061283, i32 167816743, i32 2097651377, i32
+  -267414716, i32 -2029476910, i32 503444072, i32 1762050814, i32 -144550051,
+  i32 -2140837941, i32 426522225, i32 1852507879, i32 -19653770, i32
+  -1982649376, i32 282753626, i32 1742555852, i32 -105259153, i32 -1900089351,
+  i32 397917763, i32 1622183637, i32 -690576408, i32 -1580100738, i32
+  953729732, i32 1340076626, i32 -776247311, i32 -1497606297, i32 1068828381,
+  i32 1219638859, i32 -670225446, i32 -1358292148, i32 906185462, i32
+  1090812512, i32 -547295293, i32 -1469587627, i32 829329135, i32 1181335161,
+  i32 -882789492, i32 -1134132454, i32 628085408, i32 1382605366, i32
+  -871598187, i32 -1156888829, i32 570562233, i32 1426400815, i32 -977650754,
+  i32 -1296233688, i32 733239954, i32 1555261956, i32 -1026031705, i32
+  -1244606671, i32 752459403, i32 1541320221, i32 -1687895376, i32 -328994266,
+  i32 1969922972, i32 40735498, i32 -1677130071, i32 -351390145, i32
+  1913087877, i32 83908371, i32 -1782625662, i32 -491226604, i32 2075208622,
+  i32 213261112, i32 -1831694693, i32 -438977011, i32 2094854071, i32
+  198958881, i32 -2032938284, i32 -237706686, i32 1759359992, i32 534414190,
+  i32 -2118248755, i32 -155638181, i32 1873836001, i32 414664567, i32
+  -2012718362, i32 -15766928, i32 1711684554, i32 285281116, i32 -1889165569,
+  i32 -127750551, i32 1634467795, i32 376229701, i32 -1609899400, i32
+  -686959890, i32 1308918612, i32 956543938, i32 -1486412191, i32 -799009033,
+  i32 1231636301, i32 1047427035, i32 -1362007478, i32 -640263460, i32
+  1088359270, i32 936918000, i32 -1447252397, i32 -558129467, i32 1202900863,
+  i32 817233897, i32 -1111625188, i32 -893730166, i32 1404277552, i32
+  615818150, i32 -1160759803, i32 -841546093, i32 1423857449, i32 601450431,
+  i32 -1285129682, i32 -1000256840, i32 1567103746, i32 711928724, i32
+  -1274298825, i32 -1022587231, i32 1510334235, i32 755167117], align 4
+
+; crc = table[(crc ^ *p++) & 0xff] ^ (crc >> 8)
+define i32 @f1(i8* %p, i64 %n, i32 %crc) nounwind readonly {
+; CHECK: f1:
+; CHECK-NOT: crc_table
+; CHECK: crc32_8
+; CHECK-NOT: crc_table
+; CHECK: jr lr
+; NOIDIOM: f1:
+; NOIDIOM-NOT: crc32_8
+; NOIDIOM: jr lr
+entry:
+  %cmp = icmp eq i64 %n, 0
+  br i1 %cmp, label %exit, label %loop
+
+loop:
+  %i = phi i64 [ 0, %entry ], [ %i.next, %loop ]
+  %c = phi i32 [ %crc, %entry ], [ %c.next, %loop ]
+  %a = getelementptr i8* %p, i64 %i
+  %b = load i8* %a, align 1
+  %bz = zext i8 %b to i32
+  %x = xor i32 %c, %bz
+  %idx = and i32 %x, 255
+  %idx64 = zext i32 %idx to i64
+  %t = getelementptr inbounds [256 x i32]* @crc_table, i64 0, i64 %idx64
+  %tv = load i32* %t, align 4
+  %sh = lshr i32 %c, 8
+  %c.next = xor i32 %tv, %sh
+  %i.next = add i64 %i, 1
+  %done = icmp eq i64 %i.next, %n
+  br i1 %done, label %exit, label %loop
+
+exit:
+  %r = phi i32 [ %crc, %entry ], [ %c.next, %loop ]
+  ret i32 %r
+}
+
+; The bitwise loop over one byte, the byte is folded into crc32_8.
+define i32 @f2(i32 %crc, i8 %b) nounwind readnone {
+; CHECK: f2:
+; CHECK-NOT: bnez
+; CHECK: crc32_8
+; CHECK-NOT: bnez
+; CHECK: jr lr
+entry:
+  %bz = zext i8 %b to i32
+  %x = xor i32 %crc, %bz
+  br label %loop
+
+loop:
+  %k = phi i32 [ 0, %entry ], [ %k.next, %loop ]
+  %c = phi i32 [ %x, %entry ], [ %c.next, %loop ]
+  %bit = and i32 %c, 1
+  %tst = icmp ne i32 %bit, 0
+  %sh = lshr i32 %c, 1
+  %xp = xor i32 %sh, -306674912
+  %c.next = select i1 %tst, i32 %xp, i32 %sh
+  %k.next = add i32 %k, 1
+  %done = icmp eq i32 %k.next, 8
+  br i1 %done, label %exit, label %loop
+
+exit:
+  ret i32 %c.next
+}
+
+
+; 32 unrolled steps in the mask form instcombine leaves, over a whole word.
+define i32 @f3(i32 %crc, i32 %w) nounwind readnone {
+; CHECK: f3:
+; CHECK-NOT: shrui
+; CHECK: crc32_32
+; CHECK-NOT: shrui
+; CHECK: jr lr
+entry:
+  %c0 = xor i32 %crc, %w
+  %s0 = shl i32 %c0, 31
+  %m0 = ashr exact i32 %s0, 31
+  %p0 = and i32 %m0, -306674912
+  %h0 = lshr i32 %c0, 1
+  %c1 = xor i32 %p0, %h0
+  %s1 = shl i32 %c1, 31
+  %m1 = ashr exact i32 %s1, 31
+  %p1 = and i32 %m1, -306674912
+  %h1 = lshr i32 %c1, 1
+  %c2 = xor i32 %p1, %h1
+  %s2 = shl i32 %c2, 31
+  %m2 = ashr exact i32 %s2, 31
+  %p2 = and i32 %m2, -306674912
+  %h2 = lshr i32 %c2, 1
+  %c3 = xor i32 %p2, %h2
+  %s3 = shl i32 %c3, 31
+  %m3 = ashr exact i32 %s3, 31
+  %p3 = and i32 %m3, -306674912
+  %h3 = lshr i32 %c3, 1
+  %c4 = xor i32 %p3, %h3
+  %s4 = shl i32 %c4, 31
+  %m4 = ashr exact i32 %s4, 31
+  %p4 = and i32 %m4, -306674912
+  %h4 = lshr i32 %c4, 1
+  %c5 = xor i32 %p4, %h4
+  %s5 = shl i32 %c5, 31
+  %m5 = ashr exact i32 %s5, 31
+  %p5 = and i32 %m5, -306674912
+  %h5 = lshr i32 %c5, 1
+  %c6 = xor i32 %p5, %h5
+  %s6 = shl i32 %c6, 31
+  %m6 = ashr exact i32 %s6, 31
+  %p6 = and i32 %m6, -306674912
+  %h6 = lshr i32 %c6, 1
+  %c7 = xor i32 %p6, %h6
+  %s7 = shl i32 %c7, 31
+  %m7 = ashr exact i32 %s7, 31
+  %p7 = and i32 %m7, -306674912
+  %h7 = lshr i32 %c7, 1
+  %c8 = xor i32 %p7, %h7
+  %s8 = shl i32 %c8, 31
+  %m8 = ashr exact i32 %s8, 31
+  %p8 = and i32 %m8, -306674912
+  %h8 = lshr i32 %c8, 1
+  %c9 = xor i32 %p8, %h8
+  %s9 = shl i32 %c9, 31
+  %m9 = ashr exact i32 %s9, 31
+  %p9 = and i32 %m9, -306674912
+  %h9 = lshr i32 %c9, 1
+  %c10 = xor i32 %p9, %h9
+  %s10 = shl i32 %c10, 31
+  %m10 = ashr exact i32 %s10, 31
+  %p10 = and i32 %m10, -306674912
+  %h10 = lshr i32 %c10, 1
+  %c11 = xor i32 %p10, %h10
+  %s11 = shl i32 %c11, 31
+  %m11 = ashr exact i32 %s11, 31
+  %p11 = and i32 %m11, -306674912
+  %h11 = lshr i32 %c11, 1
+  %c12 = xor i32 %p11, %h11
+  %s12 = shl i32 %c12, 31
+  %m12 = ashr exact i32 %s12, 31
+  %p12 = and i32 %m12, -306674912
+  %h12 = lshr i32 %c12, 1
+  %c13 = xor i32 %p12, %h12
+  %s13 = shl i32 %c13, 31
+  %m13 = ashr exact i32 %s13, 31
+  %p13 = and i32 %m13, -306674912
+  %h13 = lshr i32 %c13, 1
+  %c14 = xor i32 %p13, %h13
+  %s14 = shl i32 %c14, 31
+  %m14 = ashr exact i32 %s14, 31
+  %p14 = and i32 %m14, -306674912
+  %h14 = lshr i32 %c14, 1
+  %c15 = xor i32 %p14, %h14
+  %s15 = shl i32 %c15, 31
+  %m15 = ashr exact i32 %s15, 31
+  %p15 = and i32 %m15, -306674912
+  %h15 = lshr i32 %c15, 1
+  %c16 = xor i32 %p15, %h15
+  %s16 = shl i32 %c16, 31
+  %m16 = ashr exact i32 %s16, 31
+  %p16 = and i32 %m16, -306674912
+  %h16 = lshr i32 %c16, 1
+  %c17 = xor i32 %p16, %h16
+  %s17 = shl i32 %c17, 31
+  %m17 = ashr exact i32 %s17, 31
+  %p17 = and i32 %m17, -306674912
+  %h17 = lshr i32 %c17, 1
+  %c18 = xor i32 %p17, %h17
+  %s18 = shl i32 %c18, 31
+  %m18 = ashr exact i32 %s18, 31
+  %p18 = and i32 %m18, -306674912
+  %h18 = lshr i32 %c18, 1
+  %c19 = xor i32 %p18, %h18
+  %s19 = shl i32 %c19, 31
+  %m19 = ashr exact i32 %s19, 31
+  %p19 = and i32 %m19, -306674912
+  %h19 = lshr i32 %c19, 1
+  %c20 = xor i32 %p19, %h19
+  %s20 = shl i32 %c20, 31
+  %m20 = ashr exact i32 %s20, 31
+  %p20 = and i32 %m20, -306674912
+  %h20 = lshr i32 %c20, 1
+  %c21 = xor i32 %p20, %h20
+  %s21 = shl i32 %c21, 31
+  %m21 = ashr exact i32 %s21, 31
+  %p21 = and i32 %m21, -306674912
+  %h21 = lshr i32 %c21, 1
+  %c22 = xor i32 %p21, %h21
+  %s22 = shl i32 %c22, 31
+  %m22 = ashr exact i32 %s22, 31
+  %p22 = and i32 %m22, -306674912
+  %h22 = lshr i32 %c22, 1
+  %c23 = xor i32 %p22, %h22
+  %s23 = shl i32 %c23, 31
+  %m23 = ashr exact i32 %s23, 31
+  %p23 = and i32 %m23, -306674912
+  %h23 = lshr i32 %c23, 1
+  %c24 = xor i32 %p23, %h23
+  %s24 = shl i32 %c24, 31
+  %m24 = ashr exact i32 %s24, 31
+  %p24 = and i32 %m24, -306674912
+  %h24 = lshr i32 %c24, 1
+  %c25 = xor i32 %p24, %h24
+  %s25 = shl i32 %c25, 31
+  %m25 = ashr exact i32 %s25, 31
+  %p25 = and i32 %m25, -306674912
+  %h25 = lshr i32 %c25, 1
+  %c26 = xor i32 %p25, %h25
+  %s26 = shl i32 %c26, 31
+  %m26 = ashr exact i32 %s26, 31
+  %p26 = and i32 %m26, -306674912
+  %h26 = lshr i32 %c26, 1
+  %c27 = xor i32 %p26, %h26
+  %s27 = shl i32 %c27, 31
+  %m27 = ashr exact i32 %s27, 31
+  %p27 = and i32 %m27, -306674912
+  %h27 = lshr i32 %c27, 1
+  %c28 = xor i32 %p27, %h27
+  %s28 = shl i32 %c28, 31
+  %m28 = ashr exact i32 %s28, 31
+  %p28 = and i32 %m28, -306674912
+  %h28 = lshr i32 %c28, 1
+  %c29 = xor i32 %p28, %h28
+  %s29 = shl i32 %c29, 31
+  %m29 = ashr exact i32 %s29, 31
+  %p29 = and i32 %m29, -306674912
+  %h29 = lshr i32 %c29, 1
+  %c30 = xor i32 %p29, %h29
+  %s30 = shl i32 %c30, 31
+  %m30 = ashr exact i32 %s30, 31
+  %p30 = and i32 %m30, -306674912
+  %h30 = lshr i32 %c30, 1
+  %c31 = xor i32 %p30, %h30
+  %s31 = shl i32 %c31, 31
+  %m31 = ashr exact i32 %s31, 31
+  %p31 = and i32 %m31, -306674912
+  %h31 = lshr i32 %c31, 1
+  %c32 = xor i32 %p31, %h31
+  ret i32 %c32
+}
+
+declare i64 @llvm.tilegx.crc32.8(i64, i64) nounwind readnone
+declare i64 @llvm.tilegx.crc32.32(i64, i64) nounwind readnone
+
+define i64 @f4(i64 %a, i64 %b) nounwind readnone {
+; CHECK: f4:
+; CHECK: crc32_8 r0, r0, r1
+  %r = call i64 @llvm.tilegx.crc32.8(i64 %a, i64 %b)
+  ret i64 %r
+}
+
+define i64 @f5(i64 %a, i64 %b) nounwind readnone {
+; CHECK: f5:
+; CHECK: crc32_32 r0, r0, r1
+  %r = call i64 @llvm.tilegx.crc32.32(i64 %a, i64 %b)
+  ret i64 %r
+}
@@ -7,7 +7,16 @@ entry:
   %tmp1 = sdiv i32 %a, %b
   ret i32 %tmp1
 
-; CHECK: __divsi3
+; CHECK: shrsi {{r[0-9]+}}, {{r[0-9]+}}, 63
+; CHECK: cmpltu
+; CHECK: bnez
+; CHECK: clz
+; CHECK: [[LOOP:.LBB[0-9_]+]]:
+; CHECK: cmpleu
+; CHECK: cmovnez
+; CHECK: bgez {{r[0-9]+}}, [[LOOP]]
+; CHECK-NOT: __divsi3
+; CHECK: jr lr
 }
 
 define i32 @f2(i32 %a, i32 %b) {
@@ -17,7 +26,15 @@ entry:
   %tmp1 = udiv i32 %a, %b
   ret i32 %tmp1
 
-; CHECK: __udivsi3
+; CHECK: cmpltu
+; CHECK: bnez
+; CHECK: clz
+; CHECK: [[LOOP:.LBB[0-9_]+]]:
+; CHECK: cmpleu
+; CHECK: cmovnez
+; CHECK: bgez {{r[0-9]+}}, [[LOOP]]
+; CHECK-NOT: __udivsi3
+; CHECK: jr lr
 }
 
 define i32 @f3(i32 %a, i32 %b) {
@@ -27,7 +44,10 @@ entry:
   %tmp1 = srem i32 %a, %b
   ret i32 %tmp1
 
-; CHECK: __modsi3
+; CHECK: cmpleu
+; CHECK: bgez
+; CHECK-NOT: __modsi3
+; CHECK: jr lr
 }
 
 define i32 @f4(i32 %a, i32 %b) {
@@ -37,7 +57,10 @@ entry:
   %tmp1 = urem i32 %a, %b
   ret i32 %tmp1
 
-; CHECK: __umodsi3
+; CHECK: cmpleu
+; CHECK: bgez
+; CHECK-NOT: __umodsi3
+; CHECK: jr lr
 }
 
 define i64 @f5(i64 %a, i64 %b) {
@@ -79,3 +102,72 @@ entry:
 
 ; CHECK: __umoddi3
 }
+
+; Division and remainder of the same operands share one loop.
+define i32 @f9(i32 %a, i32 %b) {
+; CHECK: f9:
+
+entry:
+  %tmp1 = udiv i32 %a, %b
+  %tmp2 = urem i32 %a, %b
+  %tmp3 = add i32 %tmp1, %tmp2
+  ret i32 %tmp3
+
+; CHECK: cmpleu
+; CHECK-NOT: cmpleu
+; CHECK: jr lr
+}
+
+; The high part of the multiply and the shift of a division by constant
+; fold into one shift.
+define i32 @f10(i32 %a) {
+; CHECK: f10:
+
+entry:
+  %tmp1 = udiv i32 %a, 1000
+  ret i32 %tmp1
+
+; CHECK: mul_lu_lu [[REG0:r[0-9]+]]
+; CHECK-NEXT: shrui {{r[0-9]+}}, [[REG0]], 38
+}
+
+; Functions optimized for size keep the libcalls.
+define i32 @f11(i32 %a, i32 %b) optsize {
+; CHECK: f11:
+
+entry:
+  %tmp1 = sdiv i32 %a, %b
+  ret i32 %tmp1
+
+; CHECK: __divsi3
+}
+
+define i32 @f12(i32 %a, i32 %b) optsize {
+; CHECK: f12:
+
+entry:
+  %tmp1 = udiv i32 %a, %b
+  ret i32 %tmp1
+
+; CHECK: __udivsi3
+}
+
+define i32 @f13(i32 %a, i32 %b) optsize {
+; CHECK: f13:
+
+entry:
+  %tmp1 = srem i32 %a, %b
+  ret i32 %tmp1
+
+; CHECK: __modsi3
+}
+
+define i32 @f14(i32 %a, i32 %b) optsize {
+; CHECK: f14:
+
+entry:
+  %tmp1 = urem i32 %a, %b
+  ret i32 %tmp1
+
+; CHECK: __umodsi3
+}
@@ -0,0 +1,81 @@
+; RUN: llc -march=tilegx < %s | FileCheck %s
+; RUN: llc -march=tilegx -disable-tilegx-early-ifcvt < %s \
+; RUN:   | FileCheck %s -check-prefix=NOCVT
+
+; Both sides of a short diamond are computed and the result is picked with
+; cmovnez instead of branching.
+define i64 @f1(i64 %a, i64 %b, i64 %c) nounwind readnone {
+; CHECK: f1:
+; CHECK-NOT: bnez
+; CHECK-NOT: beqz
+; CHECK: cmovnez
+; CHECK: jr lr
+; NOCVT: f1:
+; NOCVT: beqz
+entry:
+  %cmp = icmp eq i64 %a, 0
+  br i1 %cmp, label %then, label %else
+then:
+  %x = add i64 %b, %c
+  br label %end
+else:
+  %y = sub i64 %b, %c
+  br label %end
+end:
+  %r = phi i64 [ %x, %then ], [ %y, %else ]
+  ret i64 %r
+}
+
+; A triangle on 32-bit values.
+define i32 @f2(i32 %a, i32 %b, i32 %c) nounwind readnone {
+; CHECK: f2:
+; CHECK: xor
+; CHECK-NOT: bnez
+; CHECK: cmovnez
+; CHECK: jr lr
+entry:
+  %cmp = icmp slt i32 %a, 0
+  br i1 %cmp, label %then, label %end
+then:
+  %x = xor i32 %b, %c
+  br label %end
+end:
+  %r = phi i32 [ %x, %then ], [ %b, %entry ]
+  ret i32 %r
+}
+
+; The 32 to 64-bit moves feeding the shift are speculated too.
+define i64 @f3(i64 %a, i64 %b, i64 %c) nounwind readnone {
+; CHECK: f3:
+; CHECK-NOT: bnez
+; CHECK: shl
+; CHECK: cmovnez
+; CHECK: jr lr
+entry:
+  %cmp = icmp sgt i64 %a, 0
+  br i1 %cmp, label %then, label %else
+then:
+  %x = mul i64 %b, %c
+  br label %end
+else:
+  %y = shl i64 %b, %c
+  br label %end
+end:
+  %r = phi i64 [ %x, %then ], [ %y, %else ]
+  ret i64 %r
+}
+
+; Stores are never speculated.
+define i64 @f4(i64 %a, i64* %p, i64 %c) nounwind {
+; CHECK: f4:
+; CHECK: bnez
+; CHECK: st
+entry:
+  %cmp = icmp eq i64 %a, 0
+  br i1 %cmp, label %then, label %end
+then:
+  store i64 %c, i64* %p
+  br label %end
+end:
+  ret i64 %a
+}
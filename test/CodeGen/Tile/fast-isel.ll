@@ -0,0 +1,167 @@
+; RUN: llc -march=tilegx -O0 -relocation-model=static -fast-isel-abort -fast-isel-abort-args -verify-machineinstrs < %s | FileCheck %s
+
+@g = global i64 0
+@h = internal global i32 0
+
+declare i64 @ext(i64, i32)
+declare signext i8 @narrow(i8 zeroext, i16 signext)
+declare void @takebool(i1 zeroext)
+declare void @takechar(i8)
+
+define i64 @arith(i64 %a, i64 %b) nounwind {
+entry:
+  %add = add i64 %a, %b
+  %sub = sub i64 %add, 5
+  %mul = mul i64 %sub, %b
+  %shl = shl i64 %mul, 3
+  %and = and i64 %shl, 123456789012
+  ret i64 %and
+
+; CHECK: arith:
+; CHECK: add [[ADD:r[0-9]+]], r0, r1
+; CHECK: addi [[SUB:r[0-9]+]], [[ADD]], -5
+; CHECK: mul_hu_lu [[MUL:r[0-9]+]], [[SUB]], r1
+; CHECK: mula_hu_lu [[MUL]], r1, [[SUB]]
+; CHECK: shli [[MUL]], [[MUL]], 32
+; CHECK: mula_lu_lu [[MUL]], r1, [[SUB]]
+; CHECK: shli [[SHL:r[0-9]+]], [[MUL]], 3
+; CHECK: moveli [[IMM:r[0-9]+]], 28
+; CHECK: shl16insli [[IMM]], [[IMM]], -16743
+; CHECK: shl16insli [[IMM]], [[IMM]], 6676
+; CHECK: and r0, [[SHL]], [[IMM]]
+; CHECK: jr lr
+}
+
+define i32 @arith32(i32 %a, i32 %b) nounwind {
+entry:
+  %add = add i32 %a, 300
+  %mul = mul i32 %add, %b
+  %shr = lshr i32 %mul, 2
+  %or = or i32 %shr, -70000
+  ret i32 %or
+
+; CHECK: arith32:
+; CHECK: addxli [[ADD:r[0-9]+]], r0, 300
+; CHECK: mulx [[MUL:r[0-9]+]], [[ADD]], r1
+; CHECK: shruxi [[SHR:r[0-9]+]], [[MUL]], 2
+; CHECK: moveli [[IMM:r[0-9]+]], -2
+; CHECK: shl16insli [[IMM]], [[IMM]], -4464
+; CHECK: or r0, [[SHR]], [[IMM]]
+}
+
+define i32 @mem(i32* %p, i64 %i) nounwind {
+entry:
+  %q = getelementptr i32* %p, i64 %i
+  %v = load i32* %q
+  %w = load i64* @g
+  %t = trunc i64 %w to i32
+  %s = add i32 %v, %t
+  store i32 %s, i32* @h
+  %b = bitcast i32* %p to i8*
+  %c = load i8* %b
+  %d = sext i8 %c to i32
+  %r = add i32 %s, %d
+  ret i32 %r
+
+; CHECK: mem:
+; CHECK: shli [[OFF:r[0-9]+]], r1, 2
+; CHECK: add [[ADDR:r[0-9]+]], r0, [[OFF]]
+; CHECK: ld4s [[V:r[0-9]+]], [[ADDR]]
+; CHECK: ld [[W:r[0-9]+]], {{r[0-9]+}}
+; CHECK: v4int_l [[T:r[0-9]+]], zero, [[W]]
+; CHECK: addx [[T]], [[T]], zero
+; CHECK: addx [[S:r[0-9]+]], [[V]], [[T]]
+; CHECK: st4 {{r[0-9]+}}, [[S]]
+; CHECK: ld1u [[C:r[0-9]+]], r0
+; CHECK: shlxi [[D:r[0-9]+]], [[C]], 24
+; CHECK: shrsi [[D]], [[D]], 24
+; CHECK: addx r0, [[S]], [[D]]
+}
+
+; Compares against zero become the branch, others are folded into it.
+define i64 @branch(i64 %a, i32 %b) nounwind {
+entry:
+  %c = icmp sgt i64 %a, 0
+  br i1 %c, label %t, label %f
+t:
+  %c2 = icmp ult i32 %b, 10
+  br i1 %c2, label %f, label %done
+f:
+  %x = phi i64 [ 1, %entry ], [ 2, %t ]
+  %y = call i64 @ext(i64 %x, i32 %b)
+  ret i64 %y
+done:
+  ret i64 %a
+
+; CHECK: branch:
+; CHECK: blez r0, [[F:.LBB[0-9_]+]]
+; CHECK: addx [[B:r[0-9]+]], {{r[0-9]+}}, zero
+; CHECK: addx [[TEN:r[0-9]+]], {{r[0-9]+}}, zero
+; CHECK: cmpltu [[CMP:r[0-9]+]], [[B]], [[TEN]]
+; CHECK: beqz [[CMP]], [[DONE:.LBB[0-9_]+]]
+; CHECK: [[F]]:
+; CHECK: jal ext
+; CHECK: [[DONE]]:
+}
+
+define i64 @sel(i1 %c, i64 %a) nounwind {
+entry:
+  %s = select i1 %c, i64 %a, i64 7
+  ret i64 %s
+
+; CHECK: sel:
+; CHECK: movei [[F:r[0-9]+]], 7
+; CHECK: andi [[C:r[0-9]+]], r0, 1
+; CHECK: addx [[C64:r[0-9]+]], [[C]], zero
+; CHECK: cmovnez [[F]], [[C64]], r1
+}
+
+; Narrow arguments and results are extended as their attributes ask.
+define zeroext i8 @narrowcall(i8 %a, i16 %b) nounwind {
+entry:
+  %r = call signext i8 @narrow(i8 zeroext %a, i16 signext %b)
+  %c = icmp eq i8 %r, 3
+  %e = zext i1 %c to i8
+  ret i8 %e
+
+; CHECK: narrowcall:
+; CHECK: bfextu r0, r0, 0, 7
+; CHECK: shlxi r1, r1, 16
+; CHECK: shrsi r1, r1, 16
+; CHECK: jal narrow
+; CHECK: cmpeq
+; CHECK: bfextu r0, {{r[0-9]+}}, 0, 0
+; CHECK: bfextu r0, r0, 0, 7
+; CHECK: jr lr
+}
+
+; C and C++ bool parameters are zeroext i1, which CC_Tile has no rule for.
+define void @boolcall(i64 %a, i8 %b) nounwind {
+entry:
+  %c = icmp eq i64 %a, 0
+  call void @takebool(i1 zeroext %c)
+  call void @takechar(i8 %b)
+  ret void
+
+; CHECK: boolcall:
+; CHECK: cmpeq [[C:r[0-9]+]], r0, {{r[0-9]+|zero}}
+; CHECK: bfextu r0, [[C]], 0, 0
+; CHECK: jal takebool
+; CHECK-NOT: bfextu
+; CHECK-NOT: shrsi
+; CHECK: jal takechar
+}
+
+define void @indirect(void ()* %f) nounwind {
+entry:
+  %a = alloca i64
+  store i64 5, i64* %a
+  call void %f()
+  ret void
+
+; CHECK: indirect:
+; CHECK: movei [[FIVE:r[0-9]+]], 5
+; CHECK: addi [[SLOT:r[0-9]+]], sp, {{[0-9]+}}
+; CHECK: st [[SLOT]], [[FIVE]]
+; CHECK: jalr r0
+}
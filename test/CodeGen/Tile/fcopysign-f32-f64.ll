@@ -14,9 +14,9 @@ entry:
   %call = tail call float @copysignf(float %add, float %conv) nounwind readnone
   ret float %call
 
+; CHECK: bfextu [[REG1:r[0-9]+]], {{r[0-9]+}}, 63, 63
 ; CHECK: fsingle_pack1 {{r[0-9]+}}, {{r[0-9]+}}
 ; CHECK: fsingle_pack2 [[REG0:r[0-9]+]], {{r[0-9]+}}, {{r[0-9]+}}
-; CHECK: bfextu [[REG1:r[0-9]+]], {{r[0-9]+}}, 63, 63
 ; CHECK: bfins [[REG0]], [[REG1]], 31, 31
 }
 
@@ -30,8 +30,8 @@ entry:
   %call = tail call double @copysign(double %add, double %conv) nounwind readnone
   ret double %call
 
+; CHECK: bfextu [[REG1:r[0-9]+]], {{r[0-9]+}}, 31, 31
 ; CHECK: fdouble_pack1 {{r[0-9]+}}, {{r[0-9]+}}
 ; CHECK: fdouble_pack2 [[REG0:r[0-9]+]], {{r[0-9]+}}, zero
-; CHECK: bfextu [[REG1:r[0-9]+]], {{r[0-9]+}}, 31, 31
 ; CHECK: bfins [[REG0]], [[REG1]], 63, 63
 }
@@ -0,0 +1,65 @@
+; RUN: llc -march=tilegx -enable-unsafe-fp-math < %s | FileCheck %s
+
+; Under fast-math, division and square root are Newton-Raphson iterations
+; seeded from the integer image of the operand.
+
+define float @test0(float %a, float %b) {
+; CHECK: test0
+
+entry:
+  %0 = fdiv float %a, %b
+  ret float %0
+
+; CHECK: moveli [[REG0:r[0-9]+]], 32499
+; CHECK: shl16insli [[REG1:r[0-9]+]], [[REG0]], 4547
+; CHECK: subx {{r[0-9]+}}, [[REG1]], r1
+; CHECK: fsingle_mul1
+; CHECK: fsingle_sub1
+; CHECK-NOT: __divsf3
+; CHECK: jr lr
+}
+
+define double @test1(double %a, double %b) {
+; CHECK: test1
+
+entry:
+  %0 = fdiv double %a, %b
+  ret double %0
+
+; CHECK: sub {{r[0-9]+}}, {{r[0-9]+}}, r1
+; CHECK: fdouble_mul_flags
+; CHECK: fdouble_sub_flags
+; CHECK-NOT: __divdf3
+; CHECK: jr lr
+}
+
+define float @test2(float %a) {
+; CHECK: test2
+
+entry:
+  %0 = call float @llvm.sqrt.f32(float %a)
+  ret float %0
+
+; CHECK: shruxi
+; CHECK: fsingle_mul1
+; CHECK-NOT: sqrtf
+; CHECK: cmovnez
+; CHECK: jr lr
+}
+
+define double @test3(double %a) {
+; CHECK: test3
+
+entry:
+  %0 = call double @llvm.sqrt.f64(double %a)
+  ret double %0
+
+; CHECK: shrui {{r[0-9]+}}, r0, 1
+; CHECK: fdouble_mul_flags
+; CHECK-NOT: sqrt
+; CHECK: cmovnez
+; CHECK: jr lr
+}
+
+declare float @llvm.sqrt.f32(float)
+declare double @llvm.sqrt.f64(double)
@@ -41,7 +41,8 @@ entry:
 
 ; SOFT: __muldf3
 ; HARD: fdouble_unpack_max [[B_UNPACKED:r[0-9]+]], [[SRCB:r[0-9]+]], zero
-; HARD: fdouble_unpack_max [[A_UNPACKED:r[0-9]+]], [[SRCA:r[0-9]+]], zero
+; HARD: fdouble_mul_flags [[FLAG:r[0-9]+]], [[SRCA:r[0-9]+]], [[SRCB]]
+; HARD: fdouble_unpack_max [[A_UNPACKED:r[0-9]+]], [[SRCA]], zero
 ; HARD: mul_hu_lu [[MID:r[0-9]+]], [[A_UNPACKED]], [[B_UNPACKED]]
 ; HARD: mula_hu_lu [[MID:r[0-9]+]], [[B_UNPACKED]], [[A_UNPACKED]]
 ; HARD: mul_hu_hu [[HIGH1:r[0-9]+]], [[A_UNPACKED]], [[B_UNPACKED]]
@@ -52,7 +53,6 @@ entry:
 ; HARD: add [[LOW:r[0-9]+]], [[LOW1]], [[MID_L32]]
 ; HARD: cmpltu [[LOW_C:r[0-9]+]], [[LOW]], [[MID_L32]]
 ; HARD: add [[HIGH:r[0-9]+]], [[TMP1]], [[LOW_C]]
-; HARD: fdouble_mul_flags [[FLAG:r[0-9]+]], [[SRCA]], [[SRCB]]
 ; HARD: fdouble_pack1 [[RESULT:r[0-9]+]], [[HIGH]], [[FLAG]]
 ; HARD: fdouble_pack2 [[RESULT]], [[HIGH]], [[LOW]]
 }
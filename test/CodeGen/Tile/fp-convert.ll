@@ -10,10 +10,10 @@ entry:
   ret float %a
 
 ; SOFT: __floatsisf
+; HARD: moveli [[EXP:r[0-9]+]], 158
 ; HARD: sub [[NEGA:r[0-9]+]], zero, [[SRCA:r[0-9]+]]
 ; HARD: cmpltsi [[SIGN:r[0-9]+]], [[SRCA]], 0
 ; HARD: cmovnez [[SRCA]], [[SIGN]], [[NEGA]]
-; HARD: moveli [[EXP:r[0-9]+]], 158
 ; HARD: bfins [[EXP]], [[SIGN]], 10, 10
 ; HARD: bfins [[EXP]], [[SRCA]], 32, 63
 ; HARD: fsingle_pack1 [[FLAG:r[0-9]+]], [[EXP]]
@@ -29,10 +29,10 @@ entry:
   ret double %a
 
 ; SOFT: __floatsidf
+; HARD: moveli [[ENP:r[0-9]+]], 539
 ; HARD: sub [[NEGA:r[0-9]+]], zero, [[SRCA:r[0-9]+]]
 ; HARD: cmpltsi [[SIGN:r[0-9]+]], [[SRCA]], 0
 ; HARD: cmovnez [[SRCA]], [[SIGN]], [[NEGA]]
-; HARD: moveli [[ENP:r[0-9]+]], 539
 ; HARD: shli [[EXP:r[0-9]+]], [[ENP]], 8
 ; HARD: bfins [[EXP]], [[SIGN]], 20, 20
 ; HARD: shli [[TMP1:r[0-9]+]], [[SRCA]], 4
@@ -64,8 +64,8 @@ entry:
   ret double %a
 
 ; SOFT: __floatunsidf
-; HARD: bfins [[TMP1:r[0-9]+]], [[SRCA:r[0-9]+]], 4, 35
 ; HARD: moveli [[ENP:r[0-9]+]], 539
+; HARD: bfins [[TMP1:r[0-9]+]], [[SRCA:r[0-9]+]], 4, 35
 ; HARD: shli [[EXP:r[0-9]+]], [[ENP]], 8
 ; HARD: fdouble_pack1 [[TMP2:r[0-9]+]], [[TMP1]], [[EXP]]
 ; HARD: fdouble_pack2 [[TMP2]], [[TMP1]], zero
@@ -17,16 +17,16 @@ entry:
   store i32 %add, i32* @g1, align 4
   ret void
 
-; setup gp.
-; PIC:      .L0$pb = . + 8
+; for s1, it is a internal variable, so use pc-relative access. The gp
+; setup for the call and the GOT access below is interleaved with it.
+; PIC:      moveli [[REG0:r[0-9]+]], hw1_last(s1 - .L0$pb)
+; PIC-NEXT: .L0$pb = . + 8
 ; PIC-NEXT: lnk [[TP:r50]]
+; PIC:      shl16insli [[REG1:r[0-9]+]], [[REG0]], hw0(s1 - .L0$pb)
 ; PIC:      moveli [[GP:r51]], hw1_last([[GOT:_GLOBAL_OFFSET_TABLE_]] - .L0$pb)
+; PIC:      add {{r[0-9]+}}, [[TP]], [[REG1]]
 ; PIC:      shl16insli [[GP]], [[GP]], hw0([[GOT]] - .L0$pb)
 ; PIC:      add [[GP]], [[GP]], [[TP]]
-; for s1, it is a internal variable, so use pc-relative access.
-; PIC:      moveli [[REG0:r[0-9]+]], hw1_last(s1 - .L0$pb)
-; PIC:      shl16insli [[REG1:r[0-9]+]], [[REG0]], hw0(s1 - .L0$pb)
-; PIC:      add {{r[0-9]+}}, [[TP]], [[REG1]]
 ; for g1, it is a external variable, so use GOT based access.
 ; PIC:      moveli [[REG0:r[0-9]+]], hw1_last_got(g1)
 ; PIC:      shl16insli [[REG1:r[0-9]+]], [[REG0]], hw0_got(g1)
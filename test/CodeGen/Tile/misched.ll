@@ -0,0 +1,34 @@
+; RUN: llc -march=tilegx < %s | FileCheck %s
+
+; The loads feeding the second product are hoisted above the first one and
+; the two multiply chains are interleaved.
+define i64 @sum4(i64* %p) {
+; CHECK: sum4:
+entry:
+  %p1 = getelementptr i64* %p, i64 1
+  %p2 = getelementptr i64* %p, i64 2
+  %p3 = getelementptr i64* %p, i64 3
+  %a = load i64* %p
+  %b = load i64* %p1
+  %ab = mul i64 %a, %b
+  %c = load i64* %p2
+  %d = load i64* %p3
+  %cd = mul i64 %c, %d
+  %r = add i64 %ab, %cd
+  ret i64 %r
+
+; CHECK: ld {{r[0-9]+}}, r
+; CHECK-NOT: mul
+; CHECK: ld {{r[0-9]+}}, r
+; CHECK-NOT: mul
+; CHECK: ld {{r[0-9]+}}, r
+; CHECK-NOT: mul
+; CHECK: ld {{r[0-9]+}}, r
+; CHECK: mul_hu_lu
+; CHECK: mul_hu_lu
+; CHECK: mula_hu_lu
+; CHECK: mula_hu_lu
+; CHECK: mula_lu_lu
+; CHECK: mula_lu_lu
+; CHECK: add
+}
@@ -0,0 +1,44 @@
+; RUN: llc -march=tilegx < %s | FileCheck %s
+
+; The loop is guarded by a trip count check, the pipelined kernel overlaps
+; the loads of one iteration with the multiply of the previous one, and the
+; original loop is kept for short trip counts.
+
+define i64 @dot(i64* %a, i64* %b, i64 %n) {
+entry:
+  br label %loop
+
+loop:
+  %i = phi i64 [ 0, %entry ], [ %i.next, %loop ]
+  %s = phi i64 [ 0, %entry ], [ %s.next, %loop ]
+  %pa = getelementptr i64* %a, i64 %i
+  %pb = getelementptr i64* %b, i64 %i
+  %x = load i64* %pa
+  %y = load i64* %pb
+  %m = mul i64 %x, %y
+  %s.next = add i64 %s, %m
+  %i.next = add i64 %i, 1
+  %c = icmp eq i64 %i.next, %n
+  br i1 %c, label %exit, label %loop
+
+exit:
+  ret i64 %s.next
+
+; CHECK: dot:
+; CHECK: moveli [[MIN:r[0-9]+]], 3
+; CHECK: cmpltu [[SHORT:r[0-9]+]], {{r[0-9]+}}, [[MIN]]
+; CHECK: beqz [[SHORT]], [[PROLOGUE:.LBB0_[0-9]+]]
+; CHECK: [[ORIG:.LBB0_[0-9]+]]:
+; CHECK: ld_add
+; CHECK: bnez {{r[0-9]+}}, [[ORIG]]
+; CHECK: [[PROLOGUE]]:
+; CHECK: ld_add
+; CHECK: mul_hu_lu
+; CHECK: [[KERNEL:.LBB0_[0-9]+]]:
+; CHECK: ld_add
+; CHECK: add {{r[0-9]+}}, {{r[0-9]+}}, {{r[0-9]+}}
+; CHECK: mul_hu_lu
+; CHECK: bnez {{r[0-9]+}}, [[KERNEL]]
+; CHECK: mula_lu_lu
+; CHECK: jr lr
+}
@@ -30,8 +30,7 @@ entry:
 	%tmp = mul i32 %u, 5
         ret i32 %tmp
 
-; CHECK: movei r{{[0-9]+}}, 5
-; CHECK: mulx
+; CHECK: shl2addx [[REG:r[0-9]+]], [[REG]], [[REG]]
 }
 
 define i32 @f4(i32 %u) {
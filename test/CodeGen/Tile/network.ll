@@ -0,0 +1,81 @@
+; RUN: llc -march=tilegx -verify-machineinstrs < %s | FileCheck %s
+
+; Network reads and sends are folded into the instructions consuming and
+; producing the word.
+
+define i64 @test0(i64 %k) nounwind {
+; CHECK: test0:
+
+entry:
+  %a = call i64 @llvm.tilegx.udn0r()
+  %b = add i64 %a, %k
+  call void @llvm.tilegx.usend(i64 %b)
+  ret i64 %k
+
+; CHECK: add udn0, udn0, r0
+; CHECK-NEXT: jr lr
+}
+
+define void @test1(i64 %a, i64 %b) nounwind {
+; CHECK: test1:
+
+entry:
+  %c = xor i64 %a, %b
+  call void @llvm.tilegx.isend(i64 %c)
+  ret void
+
+; CHECK: xor idn0, r0, r1
+; CHECK-NEXT: jr lr
+}
+
+define i64 @test2(i64 %k) nounwind {
+; CHECK: test2:
+
+entry:
+  %a = call i64 @llvm.tilegx.udn1r()
+  %b = call i64 @llvm.tilegx.udn2r()
+  %c = sub i64 %k, %a
+  %d = sub i64 %c, %b
+  ret i64 %d
+
+; CHECK: add [[REG0:r[0-9]+]], zero, udn1
+; CHECK: sub [[REG1:r[0-9]+]], r0, [[REG0]]
+; CHECK: sub r0, [[REG1]], udn2
+}
+
+; A word read twice must stay in a register.
+define i64 @test3() nounwind {
+; CHECK: test3:
+
+entry:
+  %a = call i64 @llvm.tilegx.udn3r()
+  %b = mul i64 %a, %a
+  ret i64 %b
+
+; CHECK: add [[REG0:r[0-9]+]], zero, udn3
+; CHECK-NOT: udn3
+; CHECK: jr lr
+}
+
+; Reads of the same queue stay in order.
+define i64 @test4() nounwind {
+; CHECK: test4:
+
+entry:
+  %a = call i64 @llvm.tilegx.udn0r()
+  %b = call i64 @llvm.tilegx.udn0r()
+  %c = shl i64 %b, 1
+  %d = sub i64 %a, %c
+  ret i64 %d
+
+; CHECK: add [[REG0:r[0-9]+]], zero, udn0
+; CHECK: shli {{r[0-9]+}}, udn0, 1
+; CHECK: jr lr
+}
+
+declare i64 @llvm.tilegx.udn0r()
+declare i64 @llvm.tilegx.udn1r()
+declare i64 @llvm.tilegx.udn2r()
+declare i64 @llvm.tilegx.udn3r()
+declare void @llvm.tilegx.usend(i64)
+declare void @llvm.tilegx.isend(i64)
@@ -0,0 +1,110 @@
+; RUN: llc -march=tilegx < %s | FileCheck %s
+; RUN: llc -march=tilegx -O0 < %s | FileCheck %s -check-prefix=FAST
+
+define i64 @f1(i64* %p) {
+; CHECK: f1:
+; CHECK: ldnt r0, r0
+; FAST: f1:
+; FAST: ldnt
+entry:
+  %v = load i64* %p, align 8, !nontemporal !0
+  ret i64 %v
+}
+
+define i32 @f2(i32* %p) {
+; CHECK: f2:
+; CHECK: ldnt4s r0, r0
+; FAST: f2:
+; FAST: ldnt4s
+entry:
+  %v = load i32* %p, align 4, !nontemporal !0
+  ret i32 %v
+}
+
+define i64 @f3(i8* %p, i16* %q) {
+; CHECK: f3:
+; CHECK: ldnt2s r1, r1
+; CHECK: ldnt1u r0, r0
+entry:
+  %a = load i8* %p, align 1, !nontemporal !0
+  %b = load i16* %q, align 2, !nontemporal !0
+  %a64 = zext i8 %a to i64
+  %b64 = sext i16 %b to i64
+  %r = add i64 %a64, %b64
+  ret i64 %r
+}
+
+define void @f4(i64* %p, i64 %v) {
+; CHECK: f4:
+; CHECK: stnt r0, r1
+; FAST: f4:
+; FAST: stnt
+entry:
+  store i64 %v, i64* %p, align 8, !nontemporal !0
+  ret void
+}
+
+define void @f5(i32* %p, i32 %v, i8* %q) {
+; CHECK: f5:
+; CHECK: stnt4 r0, r1
+; CHECK: stnt1 r2, r1
+entry:
+  store i32 %v, i32* %p, align 4, !nontemporal !0
+  %t = trunc i32 %v to i8
+  store i8 %t, i8* %q, align 1, !nontemporal !0
+  ret void
+}
+
+; Streaming copies keep the hint and do not turn into post-increment forms.
+define void @f6(i64* %dst, i64* %src, i64 %n) {
+; CHECK: f6:
+; CHECK: ldnt
+; CHECK-NOT: st_add
+; CHECK: stnt
+entry:
+  %cmp = icmp eq i64 %n, 0
+  br i1 %cmp, label %exit, label %loop
+
+loop:
+  %i = phi i64 [ 0, %entry ], [ %i.next, %loop ]
+  %s = getelementptr i64* %src, i64 %i
+  %d = getelementptr i64* %dst, i64 %i
+  %v = load i64* %s, align 8, !nontemporal !0
+  store i64 %v, i64* %d, align 8, !nontemporal !0
+  %i.next = add i64 %i, 1
+  %done = icmp eq i64 %i.next, %n
+  br i1 %done, label %exit, label %loop
+
+exit:
+  ret void
+}
+
+; Accesses without the hint keep the regular forms.
+define i64 @f7(i64* %p) {
+; CHECK: f7:
+; CHECK: ld r0, r0
+entry:
+  %v = load i64* %p, align 8
+  ret i64 %v
+}
+
+define void @f8(i8* %p, i64 %va) {
+; CHECK: f8:
+; CHECK: flush r0
+; CHECK: finv r0
+; CHECK: inv r0
+; CHECK: dtlbpr r1
+entry:
+  call void @llvm.tilegx.flush(i8* %p)
+  call void @llvm.tilegx.finv(i8* %p)
+  call void @llvm.tilegx.inv(i8* %p)
+  call void @llvm.tilegx.dtlbpr(i64 %va)
+  ret void
+}
+
+declare void @llvm.tilegx.flush(i8*)
+declare void @llvm.tilegx.finv(i8*)
+declare void @llvm.tilegx.inv(i8*)
+declare void @llvm.tilegx.dtlbpr(i64)
+
+!0 = metadata !{i32 1}
@@ -0,0 +1,58 @@
+; RUN: llc -march=tilegx -codegen-threads=2 %s -o %t
+; RUN: FileCheck %s -check-prefix=P0 < %t
+; RUN: FileCheck %s -check-prefix=P1 < %t.1
+
+; After LTO internalizes everything but main, the call graph is made of
+; local symbols. Those called from the other partition become hidden and
+; external, so the work is still split; b stays local to main's partition.
+
+; P0: .hidden [[A:a\.llvm\.[0-9A-F]+]]
+; P0: .globl [[A]]
+; P0: [[A]]:
+; P0: .hidden [[C:c\.llvm\.[0-9A-F]+]]
+; P0: .globl [[C]]
+; P0: [[C]]:
+; P0-NOT: main:
+
+; P1-NOT: .globl b
+; P1: {{^}}b:
+; P1: .globl main
+; P1: main:
+; P1: jal {{a\.llvm\.[0-9A-F]+}}
+; P1: jal b
+; P1: jal {{c\.llvm\.[0-9A-F]+}}
+
+define internal i64 @a(i64 %x) {
+entry:
+  %m = mul i64 %x, %x
+  %s = add i64 %m, 1
+  %t = mul i64 %s, %x
+  %u = xor i64 %t, 5
+  ret i64 %u
+}
+
+define internal i64 @b(i64 %x) {
+entry:
+  %m = mul i64 %x, 3
+  %s = sub i64 %m, %x
+  %t = mul i64 %s, %s
+  %u = or i64 %t, 6
+  ret i64 %u
+}
+
+define internal i64 @c(i64 %x) {
+entry:
+  %m = shl i64 %x, 2
+  %s = add i64 %m, %x
+  %t = mul i64 %s, %m
+  %u = and i64 %t, 255
+  ret i64 %u
+}
+
+define i64 @main(i64 %x) {
+entry:
+  %a = call i64 @a(i64 %x)
+  %b = call i64 @b(i64 %a)
+  %c = call i64 @c(i64 %b)
+  ret i64 %c
+}
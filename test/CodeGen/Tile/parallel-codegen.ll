@@ -0,0 +1,72 @@
+; RUN: llc -march=tilegx -codegen-threads=2 %s -o %t
+; RUN: FileCheck %s -check-prefix=P0 < %t
+; RUN: FileCheck %s -check-prefix=P1 < %t.1
+
+; Definitions are balanced between the partitions and referenced across
+; them by name. helper is called from the other partition, so it becomes
+; hidden and external; counter is only used next to it and stays local.
+
+; P0: .hidden [[HELPER:helper\.llvm\.[0-9A-F]+]]
+; P0: .globl [[HELPER]]
+; P0: [[HELPER]]:
+; P0: .globl h
+; P0: h:
+; P0: jal ga
+; P0: .local counter
+; P0: .globl table
+; P0: table:
+; P0: [[HELPER]]
+; P0-NOT: f:
+; P0-NOT: g:
+; P0-NOT: k:
+
+; P1-NOT: counter
+; P1: .globl f
+; P1: f:
+; P1: jal [[HELPER:helper\.llvm\.[0-9A-F]+]]
+; P1: .globl g
+; P1: g:
+; P1: .globl k
+; P1: k:
+; P1: jal f
+; P1: .hidden [[HELPER]]
+; P1: ga = g
+
+@counter = internal global i64 0
+@table = global [2 x i64 (i64)*] [i64 (i64)* @helper, i64 (i64)* @g]
+@ga = alias i64 (i64)* @g
+
+define internal i64 @helper(i64 %x) {
+entry:
+  %c = load i64* @counter
+  %r = add i64 %c, %x
+  store i64 %r, i64* @counter
+  ret i64 %r
+}
+
+define i64 @f(i64 %x) {
+entry:
+  %r = call i64 @helper(i64 %x)
+  ret i64 %r
+}
+
+define i64 @g(i64 %x) {
+entry:
+  %a = mul i64 %x, %x
+  %b = add i64 %a, 7
+  %c = mul i64 %b, %x
+  ret i64 %c
+}
+
+define i64 @h(i64 %x) {
+entry:
+  %r = call i64 @ga(i64 %x)
+  %s = sub i64 %r, 1
+  ret i64 %s
+}
+
+define i64 @k(i64 %x) {
+entry:
+  %r = call i64 @f(i64 %x)
+  ret i64 %r
+}
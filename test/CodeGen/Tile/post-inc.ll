@@ -0,0 +1,56 @@
+; RUN: llc -march=tilegx < %s | FileCheck %s
+
+define void @copy32(i32* nocapture %d, i32* nocapture %s, i64 %n) {
+; CHECK: copy32:
+entry:
+  %c = icmp eq i64 %n, 0
+  br i1 %c, label %exit, label %loop
+
+loop:
+  %i = phi i64 [ 0, %entry ], [ %i.next, %loop ]
+  %sp = getelementptr i32* %s, i64 %i
+  %v = load i32* %sp
+  %dp = getelementptr i32* %d, i64 %i
+  store i32 %v, i32* %dp
+  %i.next = add i64 %i, 1
+  %done = icmp eq i64 %i.next, %n
+  br i1 %done, label %exit, label %loop
+
+exit:
+  ret void
+
+; CHECK: ld4s_add r{{[0-9]+}}, r1, 4
+; CHECK: st4_add r0, r{{[0-9]+}}, 4
+}
+
+define i64 @sum8(i8* nocapture %p, i64 %n) {
+; CHECK: sum8:
+entry:
+  br label %loop
+
+loop:
+  %i = phi i64 [ 0, %entry ], [ %i.next, %loop ]
+  %acc = phi i64 [ 0, %entry ], [ %acc.next, %loop ]
+  %a = getelementptr i8* %p, i64 %i
+  %b = load i8* %a
+  %e = zext i8 %b to i64
+  %acc.next = add i64 %acc, %e
+  %i.next = add i64 %i, 1
+  %done = icmp eq i64 %i.next, %n
+  br i1 %done, label %exit, label %loop
+
+exit:
+  ret i64 %acc.next
+
+; CHECK: ld1u_add r{{[0-9]+}}, r0, 1
+}
+
+define i64* @store_dec(i64* %p, i64 %v) {
+; CHECK: store_dec:
+entry:
+  store i64 %v, i64* %p
+  %q = getelementptr i64* %p, i64 -2
+  ret i64* %q
+
+; CHECK: st_add r0, r1, -16
+}
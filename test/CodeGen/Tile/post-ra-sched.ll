@@ -0,0 +1,24 @@
+; RUN: llc -march=tilegx -O3 -disable-tilegx-misched < %s | FileCheck %s
+
+; The post-RA scheduler issues the load first and fills the load-use delay
+; with the independent logic. The add waiting for the load gets a bundle of
+; its own rather than stalling the and.
+define i64 @f1(i64* %p, i64 %a, i64 %b, i64 %c) nounwind {
+; CHECK: f1:
+; CHECK: {
+; CHECK-NEXT: ld [[LD:r[0-9]+]], r0
+; CHECK-NEXT: or
+; CHECK-NEXT: xor
+; CHECK-NEXT: }
+; CHECK-NEXT: and
+; CHECK-NEXT: add {{r[0-9]+}}, [[LD]], r1
+; CHECK-NEXT: sub
+entry:
+  %x = load i64* %p
+  %y = add i64 %x, %a
+  %v = xor i64 %a, %b
+  %u = or i64 %b, %c
+  %w = and i64 %v, %u
+  %s = sub i64 %y, %w
+  ret i64 %s
+}
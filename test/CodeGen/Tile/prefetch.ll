@@ -0,0 +1,63 @@
+; RUN: llc -march=tilegx < %s | FileCheck %s
+
+declare void @llvm.prefetch(i8*, i32, i32, i32)
+declare void @llvm.tilegx.wh64(i8*)
+
+define void @pf(i8* %p) {
+; CHECK: pf:
+entry:
+  call void @llvm.prefetch(i8* %p, i32 0, i32 3, i32 1)
+  call void @llvm.prefetch(i8* %p, i32 0, i32 2, i32 1)
+  call void @llvm.prefetch(i8* %p, i32 1, i32 1, i32 1)
+  call void @llvm.prefetch(i8* %p, i32 0, i32 0, i32 1)
+  call void @llvm.prefetch(i8* %p, i32 0, i32 3, i32 0)
+  ret void
+
+; CHECK: prefetch r0
+; CHECK: prefetch_l2 r0
+; CHECK: prefetch_l3 r0
+; CHECK: prefetch_l3 r0
+; CHECK-NOT: prefetch
+; CHECK: jr
+}
+
+define void @hint(i8* %p) {
+; CHECK: hint:
+entry:
+  call void @llvm.tilegx.wh64(i8* %p)
+  ret void
+
+; CHECK: wh64 r0
+}
+
+define void @fill(i64* %p, i64 %n) {
+; CHECK: fill:
+entry:
+  %c = icmp eq i64 %n, 0
+  br i1 %c, label %exit, label %loop
+
+loop:
+  %i = phi i64 [ 0, %entry ], [ %i.next, %loop ]
+  %a = getelementptr i64* %p, i64 %i
+  store i64 0, i64* %a
+  %i.next = add i64 %i, 1
+  %done = icmp eq i64 %i.next, %n
+  br i1 %done, label %exit, label %loop
+
+exit:
+  ret void
+
+; The lines are hinted ahead of the loop, which stays a single block.
+; CHECK: andi r{{[0-9]+}}, r{{[0-9]+}}, -64
+; CHECK: [[HINT:.LBB2_[0-9]+]]: {{.*}}%wh64.loop
+; CHECK-NOT: .LBB
+; CHECK: wh64 r{{[0-9]+}}
+; CHECK: bnez r{{[0-9]+}}, [[HINT]]
+; CHECK-NEXT: [[LOOP:.LBB2_[0-9]+]]: {{.*}}%loop
+; CHECK-NOT: wh64
+; CHECK-NOT: .LBB
+; CHECK: st_add
+; CHECK-NOT: .LBB
+; CHECK: bnez r{{[0-9]+}}, [[LOOP]]
+; CHECK-NEXT: .LBB2_{{[0-9]+}}: {{.*}}%exit
+}
@@ -0,0 +1,137 @@
+; REQUIRES: asserts
+; RUN: llc -march=tilegx -stats -o %t1 < %s 2>&1 | FileCheck %s
+; RUN: llc -march=tilegx -greedy-eviction-cache=false -o %t2 < %s
+; RUN: diff %t1 %t2
+
+; The loaded values are all live across the call, more than the callee saved
+; registers can hold. When an evicted live range is dequeued again, the costs
+; of the physregs without new assignments come from the cache. The result is
+; the same as without it.
+; CHECK: Number of eviction costs reused from the cache
+
+define void @f(i64* %p, i64* %q) nounwind {
+entry:
+  %a0 = getelementptr i64* %p, i64 0
+  %v0 = load i64* %a0
+  %a1 = getelementptr i64* %p, i64 1
+  %v1 = load i64* %a1
+  %a2 = getelementptr i64* %p, i64 2
+  %v2 = load i64* %a2
+  %a3 = getelementptr i64* %p, i64 3
+  %v3 = load i64* %a3
+  %a4 = getelementptr i64* %p, i64 4
+  %v4 = load i64* %a4
+  %a5 = getelementptr i64* %p, i64 5
+  %v5 = load i64* %a5
+  %a6 = getelementptr i64* %p, i64 6
+  %v6 = load i64* %a6
+  %a7 = getelementptr i64* %p, i64 7
+  %v7 = load i64* %a7
+  %a8 = getelementptr i64* %p, i64 8
+  %v8 = load i64* %a8
+  %a9 = getelementptr i64* %p, i64 9
+  %v9 = load i64* %a9
+  %a10 = getelementptr i64* %p, i64 10
+  %v10 = load i64* %a10
+  %a11 = getelementptr i64* %p, i64 11
+  %v11 = load i64* %a11
+  %a12 = getelementptr i64* %p, i64 12
+  %v12 = load i64* %a12
+  %a13 = getelementptr i64* %p, i64 13
+  %v13 = load i64* %a13
+  %a14 = getelementptr i64* %p, i64 14
+  %v14 = load i64* %a14
+  %a15 = getelementptr i64* %p, i64 15
+  %v15 = load i64* %a15
+  %a16 = getelementptr i64* %p, i64 16
+  %v16 = load i64* %a16
+  %a17 = getelementptr i64* %p, i64 17
+  %v17 = load i64* %a17
+  %a18 = getelementptr i64* %p, i64 18
+  %v18 = load i64* %a18
+  %a19 = getelementptr i64* %p, i64 19
+  %v19 = load i64* %a19
+  %a20 = getelementptr i64* %p, i64 20
+  %v20 = load i64* %a20
+  %a21 = getelementptr i64* %p, i64 21
+  %v21 = load i64* %a21
+  %a22 = getelementptr i64* %p, i64 22
+  %v22 = load i64* %a22
+  %a23 = getelementptr i64* %p, i64 23
+  %v23 = load i64* %a23
+  call void @g()
+  %m0 = mul i64 %v0, %v3
+  %b0 = getelementptr i64* %q, i64 0
+  store i64 %m0, i64* %b0
+  %m1 = mul i64 %v1, %v10
+  %b1 = getelementptr i64* %q, i64 1
+  store i64 %m1, i64* %b1
+  %m2 = mul i64 %v2, %v17
+  %b2 = getelementptr i64* %q, i64 2
+  store i64 %m2, i64* %b2
+  %m3 = mul i64 %v3, %v0
+  %b3 = getelementptr i64* %q, i64 3
+  store i64 %m3, i64* %b3
+  %m4 = mul i64 %v4, %v7
+  %b4 = getelementptr i64* %q, i64 4
+  store i64 %m4, i64* %b4
+  %m5 = mul i64 %v5, %v14
+  %b5 = getelementptr i64* %q, i64 5
+  store i64 %m5, i64* %b5
+  %m6 = mul i64 %v6, %v21
+  %b6 = getelementptr i64* %q, i64 6
+  store i64 %m6, i64* %b6
+  %m7 = mul i64 %v7, %v4
+  %b7 = getelementptr i64* %q, i64 7
+  store i64 %m7, i64* %b7
+  %m8 = mul i64 %v8, %v11
+  %b8 = getelementptr i64* %q, i64 8
+  store i64 %m8, i64* %b8
+  %m9 = mul i64 %v9, %v18
+  %b9 = getelementptr i64* %q, i64 9
+  store i64 %m9, i64* %b9
+  %m10 = mul i64 %v10, %v1
+  %b10 = getelementptr i64* %q, i64 10
+  store i64 %m10, i64* %b10
+  %m11 = mul i64 %v11, %v8
+  %b11 = getelementptr i64* %q, i64 11
+  store i64 %m11, i64* %b11
+  %m12 = mul i64 %v12, %v15
+  %b12 = getelementptr i64* %q, i64 12
+  store i64 %m12, i64* %b12
+  %m13 = mul i64 %v13, %v22
+  %b13 = getelementptr i64* %q, i64 13
+  store i64 %m13, i64* %b13
+  %m14 = mul i64 %v14, %v5
+  %b14 = getelementptr i64* %q, i64 14
+  store i64 %m14, i64* %b14
+  %m15 = mul i64 %v15, %v12
+  %b15 = getelementptr i64* %q, i64 15
+  store i64 %m15, i64* %b15
+  %m16 = mul i64 %v16, %v19
+  %b16 = getelementptr i64* %q, i64 16
+  store i64 %m16, i64* %b16
+  %m17 = mul i64 %v17, %v2
+  %b17 = getelementptr i64* %q, i64 17
+  store i64 %m17, i64* %b17
+  %m18 = mul i64 %v18, %v9
+  %b18 = getelementptr i64* %q, i64 18
+  store i64 %m18, i64* %b18
+  %m19 = mul i64 %v19, %v16
+  %b19 = getelementptr i64* %q, i64 19
+  store i64 %m19, i64* %b19
+  %m20 = mul i64 %v20, %v23
+  %b20 = getelementptr i64* %q, i64 20
+  store i64 %m20, i64* %b20
+  %m21 = mul i64 %v21, %v6
+  %b21 = getelementptr i64* %q, i64 21
+  store i64 %m21, i64* %b21
+  %m22 = mul i64 %v22, %v13
+  %b22 = getelementptr i64* %q, i64 22
+  store i64 %m22, i64* %b22
+  %m23 = mul i64 %v23, %v20
+  %b23 = getelementptr i64* %q, i64 23
+  store i64 %m23, i64* %b23
+  ret void
+}
+declare void @g()
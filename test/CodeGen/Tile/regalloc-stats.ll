@@ -0,0 +1,17 @@
+; RUN: llc -march=tilegx -regalloc-stats -o /dev/null < %s 2>&1 | FileCheck %s
+
+; -regalloc-stats reports the register allocator timers without -time-passes.
+; CHECK: Register Allocation
+; CHECK: Seed Live Regs
+; CHECK-NOT: Pass execution timing report
+
+declare i64 @g(i64)
+
+define i64 @f(i64 %a, i64 %b) {
+entry:
+  %x = call i64 @g(i64 %a)
+  %y = add i64 %x, %b
+  %z = call i64 @g(i64 %y)
+  %r = mul i64 %z, %a
+  ret i64 %r
+}
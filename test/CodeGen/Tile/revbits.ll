@@ -0,0 +1,111 @@
+; RUN: llc -march=tilegx < %s | FileCheck %s
+
+; Bit reversal by shifts and masks, or one bit at a time, becomes revbits.
+
+define i32 @f1(i32 %x) nounwind readnone {
+; CHECK: f1:
+; CHECK-NOT: shli
+; CHECK: revbits
+; CHECK-NOT: shli
+; CHECK: jr lr
+  %a1 = lshr i32 %x, 1
+  %a2 = and i32 %a1, 1431655765
+  %a3 = and i32 %x, 1431655765
+  %a4 = shl i32 %a3, 1
+  %a = or i32 %a2, %a4
+  %b1 = lshr i32 %a, 2
+  %b2 = and i32 %b1, 858993459
+  %b3 = and i32 %a, 858993459
+  %b4 = shl i32 %b3, 2
+  %b = or i32 %b2, %b4
+  %c1 = lshr i32 %b, 4
+  %c2 = and i32 %c1, 252645135
+  %c3 = and i32 %b, 252645135
+  %c4 = shl i32 %c3, 4
+  %c = or i32 %c2, %c4
+  %d1 = lshr i32 %c, 8
+  %d2 = and i32 %d1, 16711935
+  %d3 = and i32 %c, 16711935
+  %d4 = shl i32 %d3, 8
+  %d = or i32 %d2, %d4
+  %e1 = lshr i32 %d, 16
+  %e2 = shl i32 %d, 16
+  %e = or i32 %e1, %e2
+  ret i32 %e
+}
+
+declare i64 @llvm.bswap.i64(i64) nounwind readnone
+
+; The byte swap part done with bswap.
+define i64 @f2(i64 %x) nounwind readnone {
+; CHECK: f2:
+; CHECK-NOT: revbytes
+; CHECK: revbits r0, r0
+; CHECK-NOT: revbytes
+; CHECK: jr lr
+  %a1 = lshr i64 %x, 1
+  %a2 = and i64 %a1, 6148914691236517205
+  %a3 = and i64 %x, 6148914691236517205
+  %a4 = shl i64 %a3, 1
+  %a = or i64 %a2, %a4
+  %b1 = lshr i64 %a, 2
+  %b2 = and i64 %b1, 3689348814741910323
+  %b3 = and i64 %a, 3689348814741910323
+  %b4 = shl i64 %b3, 2
+  %b = or i64 %b2, %b4
+  %c1 = lshr i64 %b, 4
+  %c2 = and i64 %c1, 1085102592571150095
+  %c3 = and i64 %b, 1085102592571150095
+  %c4 = shl i64 %c3, 4
+  %c = or i64 %c2, %c4
+  %r = call i64 @llvm.bswap.i64(i64 %c)
+  ret i64 %r
+}
+
+; r = (r << 1) | (x & 1), x >>= 1 for every bit of x.
+define i64 @f3(i64 %x) nounwind readnone {
+; CHECK: f3:
+; CHECK-NOT: bnez
+; CHECK: revbits r0, r0
+; CHECK-NOT: bnez
+; CHECK: jr lr
+entry:
+  br label %loop
+
+loop:
+  %i = phi i32 [ 0, %entry ], [ %i.next, %loop ]
+  %r = phi i64 [ 0, %entry ], [ %r.next, %loop ]
+  %v = phi i64 [ %x, %entry ], [ %v.next, %loop ]
+  %bit = and i64 %v, 1
+  %rs = shl i64 %r, 1
+  %r.next = or i64 %rs, %bit
+  %v.next = lshr i64 %v, 1
+  %i.next = add i32 %i, 1
+  %done = icmp eq i32 %i.next, 64
+  br i1 %done, label %exit, label %loop
+
+exit:
+  ret i64 %r.next
+}
+
+; A partial reversal is left alone.
+define i32 @f4(i32 %x) nounwind readnone {
+; CHECK: f4:
+; CHECK-NOT: revbits
+; CHECK: jr lr
+  %a1 = lshr i32 %x, 1
+  %a2 = and i32 %a1, 1431655765
+  %a3 = and i32 %x, 1431655765
+  %a4 = shl i32 %a3, 1
+  %a = or i32 %a2, %a4
+  ret i32 %a
+}
+
+declare i64 @llvm.tilegx.revbits(i64) nounwind readnone
+
+define i64 @f5(i64 %x) nounwind readnone {
+; CHECK: f5:
+; CHECK: revbits r0, r0
+  %r = call i64 @llvm.tilegx.revbits(i64 %x)
+  ret i64 %r
+}
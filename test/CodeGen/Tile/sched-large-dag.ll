@@ -0,0 +1,63 @@
+; RUN: llc -march=tilegx -sched-large-dag-threshold=0 -verify-machineinstrs < %s | FileCheck %s
+; RUN: llc -march=tilegx -sched-large-dag-threshold=0 -pre-RA-sched=source < %s | FileCheck %s
+; RUN: llc -march=tilegx -sched-large-dag-threshold=0 -pre-RA-sched=list-burr < %s | FileCheck %s
+; RUN: llc -march=tilegx -O0 -fast-isel=false -sched-large-dag-threshold=0 \
+; RUN:   -pre-RA-sched=source < %s | FileCheck %s -check-prefix=SRC
+
+; Blocks above the threshold are scheduled from the static-priority heap.
+
+define i64 @f1(i64* %p, i64 %a, i64 %b) {
+; CHECK: f1:
+; CHECK: ld {{r[0-9]+}}, r0
+; CHECK: mula_lu_lu
+; CHECK: xor
+; CHECK: st
+; CHECK: jr lr
+entry:
+  %q = getelementptr i64* %p, i64 1
+  %x = load i64* %p, align 8
+  %y = load i64* %q, align 8
+  %m = mul i64 %x, %a
+  %n = mul i64 %y, %b
+  %s = add i64 %m, %n
+  %t = xor i64 %s, %x
+  store i64 %t, i64* %q, align 8
+  ret i64 %s
+}
+
+declare i64 @g(i64)
+
+define i64 @f2(i64 %a, i64 %b) {
+; CHECK: f2:
+; CHECK: jal g
+; CHECK: jal g
+; CHECK: jr lr
+entry:
+  %x = call i64 @g(i64 %a)
+  %y = call i64 @g(i64 %b)
+  %s = add i64 %x, %y
+  ret i64 %s
+}
+
+; Nothing orders the three operations but the source, and the source
+; scheduler keeps it.
+define void @f3(i64* %p, i64* %q, i64* %r, i64 %a, i64 %b, i64 %c) {
+; SRC: f3:
+; SRC: {{[[:space:]]}}xor{{[[:space:]]}}
+; SRC-NOT: {{[[:space:]]}}st{{[[:space:]]}}
+; SRC: {{[[:space:]]}}or{{[[:space:]]}}
+; SRC-NOT: {{[[:space:]]}}st{{[[:space:]]}}
+; SRC: {{[[:space:]]}}and{{[[:space:]]}}
+; SRC: {{[[:space:]]}}st{{[[:space:]]}}
+; SRC: {{[[:space:]]}}st{{[[:space:]]}}
+; SRC: {{[[:space:]]}}st{{[[:space:]]}}
+; SRC: jr lr
+entry:
+  %x = xor i64 %a, %b
+  %y = or i64 %a, %c
+  %z = and i64 %b, %c
+  store i64 %x, i64* %p, align 8
+  store i64 %y, i64* %q, align 8
+  store i64 %z, i64* %r, align 8
+  ret void
+}
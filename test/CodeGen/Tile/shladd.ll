@@ -0,0 +1,79 @@
+; RUN: llc -march=tilegx < %s | FileCheck %s
+
+; Scaled adds and the multiplies by 3, 5 and 9 are a single shlNadd.
+
+define i64 @f1(i64 %a, i64 %b) nounwind readnone {
+; CHECK: f1:
+; CHECK: shl1add r0, r0, r1
+  %s = shl i64 %a, 1
+  %r = add i64 %s, %b
+  ret i64 %r
+}
+
+define i64 @f2(i64 %a, i64 %b) nounwind readnone {
+; CHECK: f2:
+; CHECK: shl2add r0, r0, r1
+  %s = shl i64 %a, 2
+  %r = add i64 %b, %s
+  ret i64 %r
+}
+
+define i64 @f3(i64 %a, i64 %b) nounwind readnone {
+; CHECK: f3:
+; CHECK: shl3add r0, r0, r1
+  %s = shl i64 %a, 3
+  %r = add i64 %s, %b
+  ret i64 %r
+}
+
+; 32-bit sums are sign-extended like addx.
+define i32 @f4(i32 %a, i32 %b) nounwind readnone {
+; CHECK: f4:
+; CHECK: shl2addx r0, r0, r1
+  %s = shl i32 %a, 2
+  %r = add i32 %s, %b
+  ret i32 %r
+}
+
+; Indexing an array of 8 byte elements.
+define i64 @f5(i64* %p, i64 %i) nounwind readonly {
+; CHECK: f5:
+; CHECK: shl3add [[R:r[0-9]+]], r1, r0
+; CHECK: ld r0, [[R]]
+  %a = getelementptr i64* %p, i64 %i
+  %v = load i64* %a
+  ret i64 %v
+}
+
+define i64 @f6(i64 %a) nounwind readnone {
+; CHECK: f6:
+; CHECK-NOT: mul
+; CHECK: shl1add r0, r0, r0
+  %r = mul i64 %a, 3
+  ret i64 %r
+}
+
+define i64 @f7(i64 %a) nounwind readnone {
+; CHECK: f7:
+; CHECK-NOT: mul
+; CHECK: shl3add r0, r0, r0
+  %r = mul i64 %a, 9
+  ret i64 %r
+}
+
+define i32 @f8(i32 %a) nounwind readnone {
+; CHECK: f8:
+; CHECK-NOT: mul
+; CHECK: shl2addx r0, r0, r0
+  %r = mul i32 %a, 5
+  ret i32 %r
+}
+
+declare i64 @llvm.tilegx.addxsc(i64, i64) nounwind readnone
+
+define i64 @f9(i64 %a, i64 %b) nounwind readnone {
+; CHECK: f9:
+; CHECK: addxsc r0, r0, r1
+  %r = call i64 @llvm.tilegx.addxsc(i64 %a, i64 %b)
+  ret i64 %r
+}
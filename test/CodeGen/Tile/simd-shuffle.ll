@@ -0,0 +1,80 @@
+; RUN: llc -march=tilegx < %s | FileCheck %s
+
+define <8 x i8> @int_l8(<8 x i8> %a, <8 x i8> %b) {
+; CHECK: int_l8:
+entry:
+  %r = shufflevector <8 x i8> %a, <8 x i8> %b,
+         <8 x i32> <i32 0, i32 8, i32 1, i32 9, i32 2, i32 10, i32 3, i32 11>
+  ret <8 x i8> %r
+
+; CHECK: v1int_l r{{[0-9]+}}, r1, r0
+}
+
+define <4 x i16> @int_h16(<4 x i16> %a, <4 x i16> %b) {
+; CHECK: int_h16:
+entry:
+  %r = shufflevector <4 x i16> %a, <4 x i16> %b,
+         <4 x i32> <i32 2, i32 6, i32 3, i32 7>
+  ret <4 x i16> %r
+
+; CHECK: v2int_h r{{[0-9]+}}, r1, r0
+}
+
+define <8 x i8> @window8(<8 x i8> %a, <8 x i8> %b) {
+; CHECK: window8:
+entry:
+  %r = shufflevector <8 x i8> %a, <8 x i8> %b,
+         <8 x i32> <i32 3, i32 4, i32 5, i32 6, i32 7, i32 8, i32 9, i32 10>
+  ret <8 x i8> %r
+
+; CHECK: dblalign r0, r1, r{{[0-9]+}}
+}
+
+define <8 x i8> @reverse8(<8 x i8> %a) {
+; CHECK: reverse8:
+entry:
+  %r = shufflevector <8 x i8> %a, <8 x i8> undef,
+         <8 x i32> <i32 7, i32 6, i32 5, i32 4, i32 3, i32 2, i32 1, i32 0>
+  ret <8 x i8> %r
+
+; CHECK: shufflebytes r{{[0-9]+}}, r{{[0-9]+}}, r{{[0-9]+}}
+}
+
+define <4 x i16> @splat16(i16 %x) {
+; CHECK: splat16:
+entry:
+  %i = insertelement <4 x i16> undef, i16 %x, i32 0
+  %r = shufflevector <4 x i16> %i, <4 x i16> undef, <4 x i32> zeroinitializer
+  ret <4 x i16> %r
+
+; CHECK: shufflebytes r{{[0-9]+}}, r{{[0-9]+}}, r{{[0-9]+}}
+}
+
+define <8 x i8> @const8() {
+; CHECK: const8:
+entry:
+  ret <8 x i8> <i8 1, i8 2, i8 3, i8 4, i8 5, i8 6, i8 7, i8 8>
+
+; CHECK: moveli
+; CHECK-NOT: ld
+; CHECK: shl16insli
+; CHECK: jr
+}
+
+define i8 @extract8(<8 x i8> %a) {
+; CHECK: extract8:
+entry:
+  %r = extractelement <8 x i8> %a, i32 5
+  ret i8 %r
+
+; CHECK: bfextu r0, r0, 40, 47
+}
+
+define <4 x i16> @insert16(<4 x i16> %a, i16 %x) {
+; CHECK: insert16:
+entry:
+  %r = insertelement <4 x i16> %a, i16 %x, i32 2
+  ret <4 x i16> %r
+
+; CHECK: bfins r0, r{{[0-9]+}}, 32, 47
+}
@@ -0,0 +1,121 @@
+; RUN: llc -march=tilegx < %s | FileCheck %s
+
+define <8 x i8> @mul8(<8 x i8> %a, <8 x i8> %b) {
+; CHECK: mul8:
+entry:
+  %r = mul <8 x i8> %a, %b
+  ret <8 x i8> %r
+
+; CHECK: v1multu r{{[0-9]+}}, r{{[0-9]+}}, r{{[0-9]+}}
+}
+
+define <4 x i16> @mul16(<4 x i16> %a, <4 x i16> %b) {
+; CHECK: mul16:
+entry:
+  %r = mul <4 x i16> %a, %b
+  ret <4 x i16> %r
+
+; CHECK: v2mults r{{[0-9]+}}, r{{[0-9]+}}, r{{[0-9]+}}
+}
+
+define <2 x i32> @and32(<2 x i32> %a, <2 x i32> %b) {
+; CHECK: and32:
+entry:
+  %r = and <2 x i32> %a, %b
+  ret <2 x i32> %r
+
+; CHECK: and r{{[0-9]+}}, r{{[0-9]+}}, r{{[0-9]+}}
+}
+
+define <8 x i8> @cmp8(<8 x i8> %a, <8 x i8> %b) {
+; CHECK: cmp8:
+entry:
+  %c = icmp ult <8 x i8> %a, %b
+  %r = zext <8 x i1> %c to <8 x i8>
+  ret <8 x i8> %r
+
+; CHECK: v1cmpltu r{{[0-9]+}}, r{{[0-9]+}}, r{{[0-9]+}}
+}
+
+define <4 x i16> @cmp16(<4 x i16> %a, <4 x i16> %b) {
+; CHECK: cmp16:
+entry:
+  %c = icmp sgt <4 x i16> %a, %b
+  %r = zext <4 x i1> %c to <4 x i16>
+  ret <4 x i16> %r
+
+; CHECK: v2cmplts r{{[0-9]+}}, r1, r0
+}
+
+define <8 x i8> @sextcmp8(<8 x i8> %a, <8 x i8> %b) {
+; CHECK: sextcmp8:
+entry:
+  %c = icmp eq <8 x i8> %a, %b
+  %r = sext <8 x i1> %c to <8 x i8>
+  ret <8 x i8> %r
+
+; CHECK: v1cmpeq [[C:r[0-9]+]], r{{[0-9]+}}, r{{[0-9]+}}
+; CHECK: v1sub r{{[0-9]+}}, {{r[0-9]+|zero}}, [[C]]
+}
+
+define <8 x i8> @maxu8(<8 x i8> %a, <8 x i8> %b) {
+; CHECK: maxu8:
+entry:
+  %c = icmp ugt <8 x i8> %a, %b
+  %r = select <8 x i1> %c, <8 x i8> %a, <8 x i8> %b
+  ret <8 x i8> %r
+
+; CHECK: v1maxu r{{[0-9]+}}, r{{[0-9]+}}, r{{[0-9]+}}
+}
+
+define <4 x i16> @mins16(<4 x i16> %a, <4 x i16> %b) {
+; CHECK: mins16:
+entry:
+  %c = icmp slt <4 x i16> %a, %b
+  %r = select <4 x i1> %c, <4 x i16> %a, <4 x i16> %b
+  ret <4 x i16> %r
+
+; CHECK: v2mins r{{[0-9]+}}, r{{[0-9]+}}, r{{[0-9]+}}
+}
+
+define <8 x i8> @select8(<8 x i8> %a, <8 x i8> %b, <8 x i8> %x, <8 x i8> %y) {
+; CHECK: select8:
+entry:
+  %c = icmp eq <8 x i8> %a, %b
+  %r = select <8 x i1> %c, <8 x i8> %x, <8 x i8> %y
+  ret <8 x i8> %r
+
+; CHECK: v1cmpeq
+; CHECK-DAG: v1mnz
+; CHECK-DAG: v1mz
+; CHECK: or
+}
+
+define <8 x i8> @shli8(<8 x i8> %a) {
+; CHECK: shli8:
+entry:
+  %r = shl <8 x i8> %a, <i8 3, i8 3, i8 3, i8 3, i8 3, i8 3, i8 3, i8 3>
+  ret <8 x i8> %r
+
+; CHECK: v1shli r{{[0-9]+}}, r{{[0-9]+}}, 3
+}
+
+define <4 x i16> @shrsi16(<4 x i16> %a) {
+; CHECK: shrsi16:
+entry:
+  %r = ashr <4 x i16> %a, <i16 5, i16 5, i16 5, i16 5>
+  ret <4 x i16> %r
+
+; CHECK: v2shrsi r{{[0-9]+}}, r{{[0-9]+}}, 5
+}
+
+define <2 x i32> @shru32(<2 x i32> %a, i32 %n) {
+; CHECK: shru32:
+entry:
+  %i = insertelement <2 x i32> undef, i32 %n, i32 0
+  %s = shufflevector <2 x i32> %i, <2 x i32> undef, <2 x i32> zeroinitializer
+  %r = lshr <2 x i32> %a, %s
+  ret <2 x i32> %r
+
+; CHECK: v4shru r{{[0-9]+}}, r0, r1
+}
@@ -132,14 +132,14 @@ bb39:
 default:
         ret i32 0
 
+; The jump table is addressed from the lnk alone, gp is not set up.
+; PIC-NOT:  _GLOBAL_OFFSET_TABLE_
 ; PIC:      .L0$pb = . + 8
 ; PIC-NEXT: lnk [[TP:r50]]
-; PIC:      moveli [[GP:r51]], hw1_last([[GOT:_GLOBAL_OFFSET_TABLE_]] - .L0$pb)
-; PIC:      shl16insli [[GP]], [[GP]], hw0([[GOT]] - .L0$pb)
-; PIC:      add [[GP]], [[GP]], [[TP]]
+; PIC-NOT:  _GLOBAL_OFFSET_TABLE_
 ; PIC:      moveli [[REG1:r[0-9]+]], hw1_last(.LJTI0_0 - .L0$pb)
 ; PIC:      shl16insli [[REG2:r[0-9]+]], [[REG1]], hw0(.LJTI0_0 - .L0$pb)
-; PIC:      add {{r[0-9]+}}, [[REG1]], [[TP]]
+; PIC:      add {{r[0-9]+}}, [[TP]], [[REG2]]
 ; PIC:      jrp {{r[0-9]+}}
 ; PIC:      .LJTI0_0:
 ; PIC:      .quad{{.+}}-
@@ -12,13 +12,13 @@ entry:
   ret i32 %tmp
 
 ; setup gp.
-; PIC:      .L[[NUM:[0-9]+]]$pb = . + 8
+; PIC:      moveli [[GP:r51]], hw1_last([[GOT:_GLOBAL_OFFSET_TABLE_]] - .L[[NUM:[0-9]+]]$pb)
+; PIC-NEXT: .L[[NUM]]$pb = . + 8
 ; PIC-NEXT: lnk [[TP:r50]]
-; PIC:      moveli [[GP:r51]], hw1_last([[GOT:_GLOBAL_OFFSET_TABLE_]] - .L[[NUM]]$pb)
 ; PIC:      shl16insli [[GP]], [[GP]], hw0([[GOT]] - .L[[NUM]]$pb)
-; PIC:      add [[GP]], [[GP]], [[TP]]
 ; fetch GD descriptor from GOT.
 ; PIC:      moveli [[REG0:r[0-9]+]], hw1_last_tls_gd(t1)
+; PIC:      add [[GP]], [[GP]], [[TP]]
 ; PIC:      shl16insli [[REG1:r[0-9]+]], [[REG0]], hw0_tls_gd(t1)
 ; the result must be placed in r0 as the first arg to tls_gd_call.
 ; PIC:      addi r0, [[GP]], tls_add(t1)
@@ -42,26 +42,26 @@ entry:
   ret i32 %tmp
 
 ; setup gp.
-; PIC:      .L[[NUM:[0-9]+]]$pb = . + 8
+; PIC:      moveli [[GP:r51]], hw1_last([[GOT:_GLOBAL_OFFSET_TABLE_]] - .L[[NUM:[0-9]+]]$pb)
+; PIC-NEXT: .L[[NUM]]$pb = . + 8
 ; PIC-NEXT: lnk [[TP:r50]]
-; PIC:      moveli [[GP:r51]], hw1_last([[GOT:_GLOBAL_OFFSET_TABLE_]] - .L[[NUM]]$pb)
 ; PIC:      shl16insli [[GP]], [[GP]], hw0([[GOT]] - .L[[NUM]]$pb)
-; PIC:      add [[GP]], [[GP]], [[TP]]
 ; fetch GD descriptor from GOT.
 ; PIC:      moveli [[REG0:r[0-9]+]], hw1_last_tls_gd(t2)
+; PIC:      add [[GP]], [[GP]], [[TP]]
 ; PIC:      shl16insli [[REG1:r[0-9]+]], [[REG0]], hw0_tls_gd(t2)
 ; the result must be placed in r0 as the first arg to tls_gd_call.
 ; PIC:      addi r0, [[GP]], tls_add(t2)
 ; PIC:      jal tls_gd_call(t2)
 ; PIC:      addi {{r[0-9]+}}, r0, tls_gd_add(t2)
 
-; STATIC:      .L[[NUM:[0-9]+]]$pb = . + 8
+; STATIC:      moveli [[GP:r51]], hw1_last([[GOT:_GLOBAL_OFFSET_TABLE_]] - .L[[NUM:[0-9]+]]$pb)
+; STATIC-NEXT: .L[[NUM]]$pb = . + 8
 ; STATIC-NEXT: lnk [[TP:r50]]
-; STATIC:      moveli [[GP:r51]], hw1_last([[GOT:_GLOBAL_OFFSET_TABLE_]] - .L[[NUM]]$pb)
 ; STATIC:      shl16insli [[GP]], [[GP]], hw0([[GOT]] - .L[[NUM]]$pb)
-; STATIC:      add [[GP]], [[GP]], [[TP]]
 ; fetch IE descriptor from GOT.
 ; STATIC:      moveli [[REG0:r[0-9]+]], hw1_last_tls_ie(t2)
+; STATIC:      add [[GP]], [[GP]], [[TP]]
 ; STATIC:      shl16insli [[REG1:r[0-9]+]], [[REG0]], hw0_tls_ie(t2)
 ; STATIC:      addi {{r[0-9]+}}, [[GP]], tls_add(t2)
 ; STATIC:      ld_tls {{r[0-9]+}}, {{r[0-9]+}}, tls_ie_load(t2)
@@ -21,6 +21,12 @@ add lr, tp, r52
 # CHECK: add lr, tp, r52    # encoding: [0x00,0x30,0x48,0xd1,0xbb,0xa6,0x07,0x28]
 add lr, tp, zero 
 # CHECK: add lr, tp, zero    # encoding: [0x00,0x30,0x48,0xd1,0xbb,0xfe,0x07,0x28]
+add lr, udn0, r27 
+# CHECK: add lr, udn0, r27    # encoding: [0x00,0x30,0x48,0xd1,0x7b,0xdf,0x06,0x28]
+add udn0, tp, idn1 
+# CHECK: add udn0, tp, idn1    # encoding: [0x00,0x30,0x48,0xd1,0xbd,0xd6,0x07,0x28]
+addx r7, udn3, r50 
+# CHECK: addx r7, udn3, r50    # encoding: [0x00,0x30,0x48,0xd1,0xc3,0x97,0x05,0x28]
 addx r7, r27, r50 
 # CHECK: addx r7, r27, r50    # encoding: [0x00,0x30,0x48,0xd1,0x63,0x93,0x05,0x28]
 addi r7, r27, 127 
@@ -73,6 +79,20 @@ moveli r33, 32767
 # CHECK: moveli r33, 32767    # encoding: [0x00,0x30,0x48,0xd1,0xf0,0xff,0xff,0x03]
 shl16insli r0, zero, -127 
 # CHECK: shl16insli r0, zero, -127    # encoding: [0x00,0x30,0x48,0x51,0xe0,0x0f,0xfc,0x3f]
+shl1add r1, r2, r3 
+# CHECK: shl1add r1, r2, r3    # encoding: [0x00,0x30,0x48,0xd1,0x40,0x18,0x40,0x28]
+shl2add r1, r2, r3 
+# CHECK: shl2add r1, r2, r3    # encoding: [0x00,0x30,0x48,0xd1,0x40,0x18,0x44,0x28]
+shl3add r1, r2, r3 
+# CHECK: shl3add r1, r2, r3    # encoding: [0x00,0x30,0x48,0xd1,0x40,0x18,0x48,0x28]
+shl1addx r1, r2, r3 
+# CHECK: shl1addx r1, r2, r3    # encoding: [0x00,0x30,0x48,0xd1,0x40,0x18,0x3e,0x28]
+shl2addx r1, r2, r3 
+# CHECK: shl2addx r1, r2, r3    # encoding: [0x00,0x30,0x48,0xd1,0x40,0x18,0x42,0x28]
+shl3addx r1, r2, r3 
+# CHECK: shl3addx r1, r2, r3    # encoding: [0x00,0x30,0x48,0xd1,0x40,0x18,0x46,0x28]
+addxsc r1, r2, r3 
+# CHECK: addxsc r1, r2, r3    # encoding: [0x00,0x30,0x48,0xd1,0x40,0x18,0x02,0x28]
 
 #--------------------------------------------------------
 # BIT 
@@ -89,6 +109,20 @@ pcnt r1, r39
 # CHECK: pcnt r1, r39    # encoding: [0xc1,0x69,0x48,0x51,0x00,0x30,0x6a,0x28]
 revbytes r7, r17 
 # CHECK: revbytes r7, r17    # encoding: [0x47,0x84,0x48,0x51,0x00,0x30,0x6a,0x28]
+revbits r7, r17 
+# CHECK: revbits r7, r17    # encoding: [0x47,0x74,0x48,0x51,0x00,0x30,0x6a,0x28]
+tblidxb0 r1, r2 
+# CHECK: tblidxb0 r1, r2    # encoding: [0x81,0x90,0x48,0x51,0x00,0x30,0x6a,0x28]
+tblidxb3 r1, r2 
+# CHECK: tblidxb3 r1, r2    # encoding: [0x81,0xc0,0x48,0x51,0x00,0x30,0x6a,0x28]
+crc32_8 r1, r2, r3 
+# CHECK: crc32_8 r1, r2, r3    # encoding: [0x81,0x30,0x54,0x50,0x00,0x30,0x6a,0x28]
+crc32_32 r1, r2, r3 
+# CHECK: crc32_32 r1, r2, r3    # encoding: [0x81,0x30,0x50,0x50,0x00,0x30,0x6a,0x28]
+shufflebytes r1, r2, r3 
+# CHECK: shufflebytes r1, r2, r3    # encoding: [0x81,0x30,0x38,0x51,0x00,0x30,0x6a,0x28]
+dblalign r4, r5, r6 
+# CHECK: dblalign r4, r5, r6    # encoding: [0x44,0x61,0x64,0x50,0x00,0x30,0x6a,0x28]
 
 #--------------------------------------------------------
 # CMP 
@@ -127,6 +161,56 @@ st2 r2, r3
 # CHECK: st2 r2, r3    # encoding: [0x00,0x30,0x2c,0x34,0x00,0x40,0x1e,0xdc]
 st4 r3, r4 
 # CHECK: st4 r3, r4    # encoding: [0x00,0x30,0x3c,0x30,0x00,0x40,0x26,0xde]
+ld_add r1, r2, 8 
+# CHECK: ld_add r1, r2, 8    # encoding: [0x00,0x30,0x48,0xd1,0x40,0x40,0xa0,0x18]
+ld1s_add r3, r4, -1 
+# CHECK: ld1s_add r3, r4, -1    # encoding: [0x00,0x30,0x48,0xd1,0x81,0xf8,0x3f,0x18]
+ld4u_add r5, r6, 127 
+# CHECK: ld4u_add r5, r6, 127    # encoding: [0x00,0x30,0x48,0xd1,0xc2,0xf8,0x63,0x18]
+st_add r1, r2, 8 
+# CHECK: st_add r1, r2, 8    # encoding: [0x00,0x30,0x48,0x51,0x24,0x10,0x00,0x19]
+st1_add r3, r4, -128 
+# CHECK: st1_add r3, r4, -128    # encoding: [0x00,0x30,0x48,0x51,0x60,0x20,0xcc,0x18]
+st4_add r5, r6, 100 
+# CHECK: st4_add r5, r6, 100    # encoding: [0x00,0x30,0x48,0x51,0xb2,0x30,0xda,0x18]
+prefetch r5 
+# CHECK: prefetch r5    # encoding: [0x00,0x30,0x48,0xd1,0xbf,0x80,0x6a,0x28]
+prefetch_l2 r5 
+# CHECK: prefetch_l2 r5    # encoding: [0x00,0x30,0x48,0xd1,0xbf,0x90,0x6a,0x28]
+prefetch_l3 r5 
+# CHECK: prefetch_l3 r5    # encoding: [0x00,0x30,0x48,0xd1,0xbf,0xa0,0x6a,0x28]
+wh64 r5 
+# CHECK: wh64 r5    # encoding: [0x00,0x30,0x48,0x51,0xa0,0x30,0x6b,0x28]
+ldnt r7, r17 
+# CHECK: ldnt r7, r17    # encoding: [0x00,0x30,0x48,0xd1,0x23,0xe2,0x6a,0x28]
+ldnt1s r8, r18 
+# CHECK: ldnt1s r8, r18    # encoding: [0x00,0x30,0x48,0x51,0x44,0xb2,0x6a,0x28]
+ldnt1u r9, r19 
+# CHECK: ldnt1u r9, r19    # encoding: [0x00,0x30,0x48,0xd1,0x64,0xba,0x6a,0x28]
+ldnt2s r10, r20 
+# CHECK: ldnt2s r10, r20    # encoding: [0x00,0x30,0x48,0x51,0x85,0xc2,0x6a,0x28]
+ldnt2u r11, r21 
+# CHECK: ldnt2u r11, r21    # encoding: [0x00,0x30,0x48,0xd1,0xa5,0xca,0x6a,0x28]
+ldnt4s r12, r22 
+# CHECK: ldnt4s r12, r22    # encoding: [0x00,0x30,0x48,0x51,0xc6,0xd2,0x6a,0x28]
+ldnt4u r13, r23 
+# CHECK: ldnt4u r13, r23    # encoding: [0x00,0x30,0x48,0xd1,0xe6,0xda,0x6a,0x28]
+stnt r0, r1 
+# CHECK: stnt r0, r1    # encoding: [0x00,0x30,0x48,0x51,0x00,0x08,0x60,0x28]
+stnt1 r1, r2 
+# CHECK: stnt1 r1, r2    # encoding: [0x00,0x30,0x48,0x51,0x20,0x10,0x5a,0x28]
+stnt2 r2, r3 
+# CHECK: stnt2 r2, r3    # encoding: [0x00,0x30,0x48,0x51,0x40,0x18,0x5c,0x28]
+stnt4 r3, r4 
+# CHECK: stnt4 r3, r4    # encoding: [0x00,0x30,0x48,0x51,0x60,0x20,0x5e,0x28]
+flush r5 
+# CHECK: flush r5    # encoding: [0x00,0x30,0x48,0x51,0xa0,0x28,0x6a,0x28]
+finv r5 
+# CHECK: finv r5    # encoding: [0x00,0x30,0x48,0x51,0xa0,0x18,0x6a,0x28]
+inv r5 
+# CHECK: inv r5    # encoding: [0x00,0x30,0x48,0x51,0xa0,0x48,0x6a,0x28]
+dtlbpr r5 
+# CHECK: dtlbpr r5    # encoding: [0x00,0x30,0x48,0x51,0xa0,0x10,0x6a,0x28]
 
 #--------------------------------------------------------
 # CMOV
@@ -141,6 +225,14 @@ fetchadd r20, r30, r40
 # CHECK: fetchadd r20, r30, r40    # encoding: [0x00,0x30,0x48,0x51,0xca,0x43,0x2b,0x28]
 fetchadd4 r21, r31, r41 
 # CHECK: fetchadd4 r21, r31, r41    # encoding: [0x00,0x30,0x48,0xd1,0xea,0x4b,0x25,0x28]
+fetchaddgez r1, r2, r3 
+# CHECK: fetchaddgez r1, r2, r3    # encoding: [0x00,0x30,0x48,0xd1,0x40,0x18,0x28,0x28]
+fetchaddgez4 r1, r2, r3 
+# CHECK: fetchaddgez4 r1, r2, r3    # encoding: [0x00,0x30,0x48,0xd1,0x40,0x18,0x26,0x28]
+cmpexch r1, r2, r3 
+# CHECK: cmpexch r1, r2, r3    # encoding: [0x00,0x30,0x48,0xd1,0x40,0x18,0x0e,0x28]
+cmpexch4 r1, r2, r3 
+# CHECK: cmpexch4 r1, r2, r3    # encoding: [0x00,0x30,0x48,0xd1,0x40,0x18,0x0c,0x28]
 fetchand r22, r32, r42 
 # CHECK: fetchand r22, r32, r42    # encoding: [0x00,0x30,0x48,0x51,0x0b,0x54,0x2f,0x28]
 fetchand4 r23, r33, r43 
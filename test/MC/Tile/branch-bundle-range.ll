@@ -0,0 +1,35 @@
+; RUN: llc -march=tilegx -filetype=obj < %s -o %t
+; RUN: llvm-objdump -d %t 2>/dev/null | FileCheck %s
+; RUN: llc -march=tilegx -filetype=obj -disable-tilegx-branch-bundle-fill \
+; RUN:   < %s -o %t.solo
+; RUN: llvm-objdump -d %t.solo 2>/dev/null | FileCheck %s -check-prefix=SOLO
+
+; The xor of the likely successor would issue in one bundle with the branch.
+; A bundle can not be relaxed and the target may be out of range, so the
+; branch issues alone and becomes the inverted branch over a jump.
+; CHECK: xor r1, r1, r2
+; CHECK-NEXT: beqz {{r[0-9]+}}, 16
+; CHECK-NEXT: j 600032
+; CHECK-NEXT: ld r0, r3
+
+; SOLO: beqz {{r[0-9]+}}, 16
+; SOLO-NEXT: j 600032
+; SOLO-NEXT: { xor r1, r1, r2 ; ld r0, r3 }
+
+define i64 @f(i64 %a, i64 %b, i64 %c, i64* %p) nounwind {
+entry:
+  %cmp = icmp eq i64 %a, 0
+  br i1 %cmp, label %t, label %f, !prof !0
+t:
+  %x = xor i64 %b, %c
+  %y = load i64* %p
+  %z = add i64 %x, %y
+  call void asm sideeffect ".space 600000", ""() nounwind
+  ret i64 %z
+f:
+  store i64 0, i64* %p
+  call void asm sideeffect ".space 600000", ""() nounwind
+  ret i64 %a
+}
+
+!0 = metadata !{metadata !"branch_weights", i32 64, i32 4}
@@ -0,0 +1,24 @@
+# RUN: llvm-mc -triple=tilegx -filetype=obj %s -o %t
+# RUN: llvm-objdump -d %t 2>/dev/null | FileCheck %s
+
+# Conditional branches reach +/-512KB. Out of range ones are relaxed to the
+# inverted branch over a jump.
+
+  .globl _func
+_func:
+# CHECK: _func:
+# CHECK-NEXT: 0: {{.*}} beqz r1, 16
+# CHECK-NEXT: 8: {{.*}} j 600024
+  bnez r1, far
+# CHECK-NEXT: 10: {{.*}} blez r2, 16
+  blez r2, near
+  jr lr
+near:
+  .space 600000
+
+# CHECK: far:
+# CHECK-NEXT: 927e0: {{.*}} bnez r3, 16
+# CHECK-NEXT: 927e8: {{.*}} j -600040
+far:
+  beqz r3, _func
+  jr lr
@@ -0,0 +1,20 @@
+# RUN: llvm-mc -triple=tilegx -filetype=obj %s -o %t
+# RUN: llvm-objdump -d %t | FileCheck %s
+
+# Code alignment is padded with { fnop ; fnop } bundles.
+
+  .globl _func
+_func:
+  add r0, r1, r2
+  .align 32
+loop:
+  addi r0, r0, -1
+  bnez r0, loop
+  jr lr
+
+# CHECK: 0: 00 30 48 51 20 10 06 28 add r0, r1, r2
+# CHECK-NEXT: 8: 00 30 48 51 00 30 6a 28 fnop
+# CHECK-NEXT: 10: 00 30 48 51 00 30 6a 28 fnop
+# CHECK-NEXT: 18: 00 30 48 51 00 30 6a 28 fnop
+# CHECK: loop:
+# CHECK-NEXT: 20: {{.*}} addi r0, r0, -1
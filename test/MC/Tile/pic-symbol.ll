@@ -1,10 +1,19 @@
-; RUN: llc -march=tilegx -O3 -relocation-model=pic -filetype=obj < %s
+; RUN: llc -march=tilegx -O3 -relocation-model=pic -filetype=obj < %s | \
+; RUN:   llvm-readobj -r | FileCheck %s
 
 target datalayout = "e-p:64:64:64-i1:8:8-i8:8:32-i16:16:32-i32:32:32-i64:64:64-f32:32:32-f64:64:64-v64:64:64-n32"
 target triple = "tilegx-unknown-linux-gnu"
 
 @global_a = global i32 16, align 4
 
+; The GOT base is built PC-relative to the lnk, in the X0 slot, and the
+; slot of global_a is addressed GOT-relative.
+; CHECK: Relocations [
+; CHECK: R_TILEGX_IMM16_X1_HW1_LAST_GOT global_a 0x0
+; CHECK: R_TILEGX_IMM16_X0_HW1_LAST_PCREL _GLOBAL_OFFSET_TABLE_
+; CHECK: R_TILEGX_IMM16_X0_HW0_PCREL _GLOBAL_OFFSET_TABLE_
+; CHECK: R_TILEGX_IMM16_X1_HW0_GOT global_a 0x0
+
 define i32 @cal(i32 %a) #0 {
 entry:
   %0 = load i32* @global_a, align 4, !tbaa !0
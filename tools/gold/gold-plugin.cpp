@@ -77,6 +77,8 @@ namespace options {
   static std::string extra_library_path;
   static std::string triple;
   static std::string mcpu;
+  // Number of threads, and object files, to generate code with.
+  static unsigned jobs = 1;
   // Additional options to pass into the code generator.
   // Note: This array will contain all plugin options which are not claimed
   // as plugin exclusive to pass to the code generator.
@@ -98,6 +100,9 @@ namespace options {
       extra_library_path = opt.substr(strlen("extra_library_path="));
     } else if (opt.startswith("mtriple=")) {
       triple = opt.substr(strlen("mtriple="));
+    } else if (opt.startswith("jobs=")) {
+      if (opt.substr(strlen("jobs=")).getAsInteger(10, jobs) || jobs == 0)
+        (*message)(LDPL_FATAL, "Invalid jobs value: %s", opt_);
     } else if (opt.startswith("obj-path=")) {
       obj_path = opt.substr(strlen("obj-path="));
     } else if (opt == "emit-llvm") {
@@ -420,10 +425,14 @@ static ld_plugin_status all_symbols_read_hook(void) {
     if (options::generate_bc_file == options::BC_ONLY)
       exit(0);
   }
-  const char *objPath;
-  if (lto_codegen_compile_to_file(code_gen, &objPath)) {
+  const char **objPaths;
+  unsigned numObjPaths;
+  if (lto_codegen_compile_to_files(code_gen, options::jobs, &objPaths,
+                                   &numObjPaths)) {
     (*message)(LDPL_ERROR, "Could not produce a combined object file\n");
+    numObjPaths = 0;
   }
+  std::vector<std::string> objFiles(objPaths, objPaths + numObjPaths);
 
   lto_codegen_dispose(code_gen);
   for (std::list<claimed_file>::iterator I = Modules.begin(),
@@ -434,10 +443,12 @@ static ld_plugin_status all_symbols_read_hook(void) {
     }
   }
 
-  if ((*add_input_file)(objPath) != LDPS_OK) {
-    (*message)(LDPL_ERROR, "Unable to add .o file to the link.");
-    (*message)(LDPL_ERROR, "File left behind in: %s", objPath);
-    return LDPS_ERR;
+  for (unsigned i = 0; i != objFiles.size(); ++i) {
+    if ((*add_input_file)(objFiles[i].c_str()) != LDPS_OK) {
+      (*message)(LDPL_ERROR, "Unable to add .o file to the link.");
+      (*message)(LDPL_ERROR, "File left behind in: %s", objFiles[i].c_str());
+      return LDPS_ERR;
+    }
   }
 
   if (!options::extra_library_path.empty() &&
@@ -447,7 +458,8 @@ static ld_plugin_status all_symbols_read_hook(void) {
   }
 
   if (options::obj_path.empty())
-    Cleanup.push_back(sys::Path(objPath));
+    for (unsigned i = 0; i != objFiles.size(); ++i)
+      Cleanup.push_back(sys::Path(objFiles[i]));
 
   return LDPS_OK;
 }
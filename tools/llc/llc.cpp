@@ -14,11 +14,14 @@
 //===----------------------------------------------------------------------===//
 
 #include "llvm/IR/LLVMContext.h"
+#include "llvm/ADT/OwningPtr.h"
+#include "llvm/ADT/StringExtras.h"
 #include "llvm/ADT/Triple.h"
 #include "llvm/Assembly/PrintModulePass.h"
 #include "llvm/CodeGen/CommandFlags.h"
 #include "llvm/CodeGen/LinkAllAsmWriterComponents.h"
 #include "llvm/CodeGen/LinkAllCodegenComponents.h"
+#include "llvm/CodeGen/ParallelCG.h"
 #include "llvm/IR/DataLayout.h"
 #include "llvm/IR/Module.h"
 #include "llvm/IRReader/IRReader.h"
@@ -69,6 +72,12 @@ OptLevel("O",
 static cl::opt<std::string>
 TargetTriple("mtriple", cl::desc("Override target triple for module"));
 
+static cl::opt<unsigned>
+CodeGenThreads("codegen-threads", cl::init(1u), cl::value_desc("N"),
+               cl::desc("Split the module into N partitions generated on "
+                        "their own threads, partition I > 0 is written to "
+                        "<output>.I"));
+
 cl::opt<bool> NoVerify("disable-verify", cl::Hidden,
                        cl::desc("Do not verify input module"));
 
@@ -340,6 +349,46 @@ static int compileModule(char **argv, LLVMContext &Context) {
       Target.setMCRelaxAll(true);
   }
 
+  if (CodeGenThreads > 1) {
+    if (OutputFilename == "-" || !StartAfter.empty() || !StopAfter.empty()) {
+      errs() << argv[0] << ": -codegen-threads needs an output file and "
+             << "cannot be combined with -start-after or -stop-after\n";
+      return 1;
+    }
+
+    // Partition 0 goes to the output file itself.
+    OwningArrayPtr<OwningPtr<tool_output_file> >
+      PartOuts(new OwningPtr<tool_output_file>[CodeGenThreads]);
+    std::vector<raw_ostream*> PartOSs(1, &Out->os());
+    for (unsigned I = 1; I != CodeGenThreads; ++I) {
+      std::string PartFilename = OutputFilename + "." + utostr(I);
+      std::string Error;
+      unsigned OpenFlags = 0;
+      if (FileType != TargetMachine::CGFT_AssemblyFile)
+        OpenFlags |= raw_fd_ostream::F_Binary;
+      PartOuts[I].reset(new tool_output_file(PartFilename.c_str(), Error,
+                                             OpenFlags));
+      if (!Error.empty()) {
+        errs() << argv[0] << ": " << Error << '\n';
+        return 1;
+      }
+      PartOSs.push_back(&PartOuts[I]->os());
+    }
+
+    cl::PrintOptionValues();
+
+    std::string Error;
+    if (splitCodeGen(*mod, PartOSs, Target, FileType, Error)) {
+      errs() << argv[0] << ": " << Error << '\n';
+      return 1;
+    }
+
+    for (unsigned I = 1; I != CodeGenThreads; ++I)
+      PartOuts[I]->keep();
+    Out->keep();
+    return 0;
+  }
+
   {
     formatted_raw_ostream FOS(Out->os());
 
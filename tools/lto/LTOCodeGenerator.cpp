@@ -14,10 +14,12 @@
 
 #include "LTOCodeGenerator.h"
 #include "LTOModule.h"
+#include "llvm/ADT/OwningPtr.h"
 #include "llvm/ADT/StringExtras.h"
 #include "llvm/Analysis/Passes.h"
 #include "llvm/Analysis/Verifier.h"
 #include "llvm/Bitcode/ReaderWriter.h"
+#include "llvm/CodeGen/ParallelCG.h"
 #include "llvm/Config/config.h"
 #include "llvm/IR/Constants.h"
 #include "llvm/IR/DataLayout.h"
@@ -192,6 +194,66 @@ bool LTOCodeGenerator::compile_to_file(const char** name, std::string& errMsg) {
   return false;
 }
 
+bool LTOCodeGenerator::compile_to_files(unsigned parallelism,
+                                        const char ***names, unsigned *count,
+                                        std::string &errMsg) {
+  if (parallelism == 0)
+    parallelism = 1;
+
+  // make unique temp .o files to put the partitions in
+  std::vector<sys::PathWithStatus> objPaths;
+  OwningArrayPtr<OwningPtr<tool_output_file> >
+    objFiles(new OwningPtr<tool_output_file>[parallelism]);
+  std::vector<raw_ostream*> outs;
+  bool failed = false;
+  for (unsigned i = 0; i != parallelism && !failed; ++i) {
+    sys::PathWithStatus uniqueObjPath("lto-llvm.o");
+    if (uniqueObjPath.createTemporaryFileOnDisk(false, &errMsg)) {
+      uniqueObjPath.eraseFromDisk();
+      failed = true;
+      break;
+    }
+    sys::RemoveFileOnSignal(uniqueObjPath);
+    objPaths.push_back(uniqueObjPath);
+
+    objFiles[i].reset(new tool_output_file(uniqueObjPath.c_str(), errMsg));
+    if (!errMsg.empty())
+      failed = true;
+    else
+      outs.push_back(&objFiles[i]->os());
+  }
+
+  // generate the object files
+  if (!failed)
+    failed = this->generateObjectFiles(outs, errMsg);
+  for (unsigned i = 0; i != objPaths.size(); ++i) {
+    if (!objFiles[i])
+      continue;
+    objFiles[i]->os().close();
+    if (objFiles[i]->os().has_error()) {
+      objFiles[i]->os().clear_error();
+      failed = true;
+    }
+    objFiles[i]->keep();
+  }
+
+  if (failed) {
+    for (unsigned i = 0; i != objPaths.size(); ++i)
+      objPaths[i].eraseFromDisk();
+    return true;
+  }
+
+  _nativeObjectPaths.clear();
+  _nativeObjectNames.clear();
+  for (unsigned i = 0; i != objPaths.size(); ++i)
+    _nativeObjectPaths.push_back(objPaths[i].str());
+  for (unsigned i = 0; i != _nativeObjectPaths.size(); ++i)
+    _nativeObjectNames.push_back(_nativeObjectPaths[i].c_str());
+  *names = &_nativeObjectNames[0];
+  *count = _nativeObjectNames.size();
+  return false;
+}
+
 const void* LTOCodeGenerator::compile(size_t* length, std::string& errMsg) {
   const char *name;
   if (compile_to_file(&name, errMsg))
@@ -355,6 +417,15 @@ void LTOCodeGenerator::applyScopeRestrictions() {
 /// Optimize merged modules using various IPO passes
 bool LTOCodeGenerator::generateObjectFile(raw_ostream &out,
                                           std::string &errMsg) {
+  raw_ostream *outs[] = { &out };
+  return this->generateObjectFiles(outs, errMsg);
+}
+
+/// generateObjectFiles - Optimize the merged module and generate code for it
+/// into outs.size() object files, compiled in parallel when there is more
+/// than one.
+bool LTOCodeGenerator::generateObjectFiles(ArrayRef<raw_ostream*> outs,
+                                           std::string &errMsg) {
   if (this->determineTarget(errMsg))
     return true;
 
@@ -391,12 +462,23 @@ bool LTOCodeGenerator::generateObjectFile(raw_ostream &out,
   // Make sure everything is still good.
   passes.add(createVerifierPass());
 
+  if (outs.size() > 1) {
+    // If the bitcode files contain ARC code and were compiled with
+    // optimization, the ObjCARCContractPass must be run, so do it
+    // unconditionally here.
+    passes.add(createObjCARCContractPass());
+    passes.run(*mergedModule);
+
+    return splitCodeGen(*mergedModule, outs, *_target,
+                        TargetMachine::CGFT_ObjectFile, errMsg);
+  }
+
   PassManager codeGenPasses;
 
   codeGenPasses.add(new DataLayout(*_target->getDataLayout()));
   _target->addAnalysisPasses(codeGenPasses);
 
-  formatted_raw_ostream Out(out);
+  formatted_raw_ostream Out(*outs[0]);
 
   // If the bitcode files contain ARC code and were compiled with optimization,
   // the ObjCARCContractPass must be run, so do it unconditionally here.
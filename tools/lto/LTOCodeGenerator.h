@@ -15,10 +15,12 @@
 #define LTO_CODE_GENERATOR_H
 
 #include "llvm-c/lto.h"
+#include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/ADT/StringMap.h"
 #include "llvm/Linker.h"
 #include <string>
+#include <vector>
 
 namespace llvm {
   class LLVMContext;
@@ -51,11 +53,15 @@ struct LTOCodeGenerator {
 
   bool writeMergedModules(const char *path, std::string &errMsg);
   bool compile_to_file(const char **name, std::string &errMsg);
+  bool compile_to_files(unsigned parallelism, const char ***names,
+                        unsigned *count, std::string &errMsg);
   const void *compile(size_t *length, std::string &errMsg);
   void setCodeGenDebugOptions(const char *opts);
 
 private:
   bool generateObjectFile(llvm::raw_ostream &out, std::string &errMsg);
+  bool generateObjectFiles(llvm::ArrayRef<llvm::raw_ostream*> outs,
+                           std::string &errMsg);
   void applyScopeRestrictions();
   void applyRestriction(llvm::GlobalValue &GV,
                         std::vector<const char*> &mustPreserveList,
@@ -77,6 +83,8 @@ private:
   std::vector<char*>          _codegenOptions;
   std::string                 _mCpu;
   std::string                 _nativeObjectPath;
+  std::vector<std::string>    _nativeObjectPaths;
+  std::vector<const char*>    _nativeObjectNames;
 };
 
 #endif // LTO_CODE_GENERATOR_H